@@ -28,6 +28,10 @@ extern "C" {
 
 #define MAX_NUM_OF_SUBQUERY_RETRY 3
 
+// sorted runs are pre-merged by several threads when there are too many of them
+#define TSC_MERGE_MIN_SOURCES_PER_THREAD 16
+#define TSC_MERGE_MAX_THREADS 8
+
 /*
  * @version 0.1
  * @date   2018/01/05
@@ -70,6 +74,9 @@ typedef struct SLocalReducer {
   tOrderDescriptor *     pDesc;
   SColumnModel *            resColModel;
   tExtMemBuffer **       pExtMemBuffer;      // disk-based buffer
+  tExtMemBuffer **       pMergeBuffer;       // output of parallel pre-merge, one for each thread
+  int32_t                numOfMergeBuffer;
+  bool                   needPreMerge;       // pre-merge the sorted runs before the first reduce
   SInterpolationInfo     interpolationInfo;  // interpolation support structure
   char *                 pFinalRes;          // result data after interpo
   tFilePage *            discardData;
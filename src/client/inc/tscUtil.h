@@ -207,6 +207,8 @@ void tscClearSubqueryInfo(SSqlCmd* pCmd);
 
 int  tscGetSTableVgroupInfo(SSqlObj* pSql, int32_t clauseIndex);
 int  tscGetTableMeta(SSqlObj* pSql, STableMetaInfo* pTableMetaInfo);
+int  tscGetTableMetaSync(SSqlObj* pSql, STableMetaInfo* pTableMetaInfo);
+int  tscGetTableMetaAsync(SSqlObj* pSql, STableMetaInfo* pTableMetaInfo, void (*fp)(), void* param);
 int  tscGetMeterMetaEx(SSqlObj* pSql, STableMetaInfo* pTableMetaInfo, bool createIfNotExists);
 
 void tscResetForNextRetrieve(SSqlRes* pRes);
@@ -255,6 +255,9 @@ typedef struct {
   // for parameter ('?') binding and batch processing
   int32_t batchSize;
   int32_t numOfParams;
+
+  bool bufferedInsert;  // table data blocks are kept in the write buffer of connection, instead of being sent
+  bool metaPrefetched;  // the uncached table metas of insert statement have been retrieved in one request
 } SSqlCmd;
 
 typedef struct SResRec {
@@ -287,6 +290,39 @@ typedef struct {
   struct SLocalReducer *pLocalReducer;
 } SSqlRes;
 
+/*
+ * client side write buffer of one connection, the rows of insert statements are coalesced into the per-table
+ * data blocks, and submitted to vnodes in batch.
+ */
+typedef struct SWriteBuffer {
+  struct STscObj *pObj;
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;           // signaled when a flush is completed
+  int32_t         refCount;       // one for the connection, and one for the flush timer if it is started
+  bool            closed;         // the connection does not use it anymore, the flush timer does nothing
+  int32_t         maxRows;        // flush when the number of buffered rows reaches this value
+  int32_t         flushInterval;  // flush the buffered rows in flushInterval ms, 0: no time based flush
+  int32_t         numOfRows;      // number of buffered rows
+  int32_t         numOfFlushing;  // number of flushes in progress
+  int32_t         code;           // the first error of the flushes since the last taos_flush
+  void *          pTimer;         // the flush timer that is started and not fired yet, guarded by mutex
+  void *          pTableList;     // table uid -> buffered data block
+  SDataBlockList *pDataBlocks;
+} SWriteBuffer;
+
+/*
+ * pipelined insertion of one connection, at most windowSize submits are outstanding for each vnode
+ */
+typedef struct SInsertPipe {
+  struct STscObj *pObj;
+  int32_t         windowSize;
+  int32_t         numOfPending;  // number of accepted statements, which are not completed yet
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;          // signaled when a submit or a statement is completed
+  void *          pVnodeList;    // vgId -> number of outstanding submits
+  void (*fp)(void *param, TAOS_RES *, int code);
+} SInsertPipe;
+
 typedef struct STscObj {
   void *             signature;
   void *             pTimer;
@@ -303,6 +339,12 @@ typedef struct STscObj {
   struct SSqlObj *   pHb;
   struct SSqlObj *   sqlList;
   struct SSqlStream *streamList;
+  SWriteBuffer *     pWriteBuf;
+  uint32_t           hbVersion;       // changes when a query or stream is added to or removed from the lists
+  uint32_t           hbSentVersion;   // version carried by the heartbeat in flight
+  uint32_t           hbAckedVersion;  // lists are left out of the heartbeat while the version is acked by mnode
+  int32_t            hbRounds;        // heartbeats sent since the lists were last carried
+  int32_t            hbDelay;         // ms, grows while the connection has no query or stream
   pthread_mutex_t    mutex;
 } STscObj;
 
@@ -318,6 +360,8 @@ typedef struct SSqlObj {
   uint32_t         queryId;
   void *           pStream;
   void *           pSubscription;
+  void *           pStmt;  // the prepared statement owning this object, kept after each response
+  SInsertPipe *    pPipe;
   char *           sqlstr;
   char             retry;
   char             maxRetry;
@@ -369,6 +413,7 @@ void tscProcessMsgFromServer(SRpcMsg *rpcMsg);
 int  tscProcessSql(SSqlObj *pSql);
 
 int  tscRenewMeterMeta(SSqlObj *pSql, char *tableId);
+int  tscGetMultiTableMeta(SSqlObj *pSql, const char *tableIds, int32_t numOfTables);
 void tscQueueAsyncRes(SSqlObj *pSql);
 
 void tscQueueAsyncError(void(*fp), void *param, int32_t code);
@@ -414,6 +459,16 @@ TAOS *taos_connect_a(char *ip, char *user, char *pass, char *db, uint16_t port,
 void doAsyncQuery(STscObj *pObj, SSqlObj *pSql, void (*fp)(), void *param, const char *sqlstr, size_t sqlLen);
 
 void tscProcessMultiVnodesInsertFromFile(SSqlObj *pSql);
+void tscProcessBufferedInsert(SSqlObj *pSql);
+
+void tscAcquireInsertWindow(SInsertPipe *pPipe, int32_t vgId);
+void tscReleaseInsertWindow(SInsertPipe *pPipe, int32_t vgId);
+void tscProcessPipeInsert(SSqlObj *pSql);
+
+int32_t tscSetWriteBuffer(STscObj *pObj, int32_t maxRows, int32_t flushInterval);
+int32_t tscFlushWriteBuffer(STscObj *pObj);
+int32_t tscDestroyWriteBuffer(STscObj *pObj);
+
 void tscKillSTableQuery(SSqlObj *pSql);
 void tscInitResObjForLocalQuery(SSqlObj *pObj, int32_t numOfRes, int32_t rowLen);
 bool tscIsUpdateQuery(STscObj *pObj);
@@ -14,10 +14,12 @@
  */
 
 #include "os.h"
+#include "hash.h"
 #include "trpc.h"
 #include "tscLog.h"
 #include "tscProfile.h"
 #include "tscSecondaryMerge.h"
+#include "tscSubquery.h"
 #include "tscUtil.h"
 #include "tsclient.h"
 #include "tsocket.h"
@@ -496,3 +498,228 @@ void tscTableMetaCallBack(void *param, TAOS_RES *res, int code) {
 
   tscDoQuery(pSql);
 }
+
+/*
+ * the metas of the tables in insert statement are retrieved in one request before parsing. If the request fails,
+ * the parse goes on as in tscTableMetaCallBack, and the tables are retrieved one by one on demand during parsing.
+ */
+void tscMultiTableMetaCallBack(void *param, TAOS_RES *res, int code) {
+  SSqlObj *pSql = (SSqlObj *)param;
+  if (pSql == NULL || pSql->signature != pSql) return;
+
+  if (code != TSDB_CODE_SUCCESS) {
+    tscTrace("%p failed to get multi table meta, code:%s, get them one by one", pSql, tstrerror(code));
+  }
+
+  tscTableMetaCallBack(param, res, TSDB_CODE_SUCCESS);
+}
+
+/*
+ * For pipelined insertion, the statement is parsed asynchronously as the other queries, while the parse result is
+ * returned to the caller of taos_pipe_insert, which launches the submit to each vnode when a slot in the window of
+ * the vnode is available, so the callers are blocked only by the vnodes that fall behind.
+ */
+typedef struct SPipeInsertSupporter {
+  SInsertPipe *pPipe;
+  SSqlObj *    pSql;
+  void *       param;
+  bool         parsed;      // the statement is parsed, and the sql object is kept for submit
+  bool         dispatched;  // the submit is launched, the remain callback reports the result of statement
+  int32_t      code;
+  tsem_t       sem;         // posted when the parse is completed
+} SPipeInsertSupporter;
+
+static int32_t *tscGetInsertWindow(SInsertPipe *pPipe, int32_t vgId) {
+  int32_t *num = taosHashGet(pPipe->pVnodeList, (const char *)&vgId, sizeof(vgId));
+  if (num == NULL) {
+    int32_t zero = 0;
+    taosHashPut(pPipe->pVnodeList, (const char *)&vgId, sizeof(vgId), (char *)&zero, sizeof(zero));
+    num = taosHashGet(pPipe->pVnodeList, (const char *)&vgId, sizeof(vgId));
+  }
+
+  return num;
+}
+
+void tscAcquireInsertWindow(SInsertPipe *pPipe, int32_t vgId) {
+  pthread_mutex_lock(&pPipe->mutex);
+
+  int32_t *num = tscGetInsertWindow(pPipe, vgId);
+  while (*num >= pPipe->windowSize) {
+    pthread_cond_wait(&pPipe->cond, &pPipe->mutex);
+  }
+
+  *num += 1;
+  pthread_mutex_unlock(&pPipe->mutex);
+}
+
+void tscReleaseInsertWindow(SInsertPipe *pPipe, int32_t vgId) {
+  pthread_mutex_lock(&pPipe->mutex);
+
+  int32_t *num = tscGetInsertWindow(pPipe, vgId);
+  assert(*num > 0);
+
+  *num -= 1;
+  pthread_cond_broadcast(&pPipe->cond);
+  pthread_mutex_unlock(&pPipe->mutex);
+}
+
+static void tscPipeInsertCompleted(SInsertPipe *pPipe) {
+  pthread_mutex_lock(&pPipe->mutex);
+  pPipe->numOfPending -= 1;
+  pthread_cond_broadcast(&pPipe->cond);
+  pthread_mutex_unlock(&pPipe->mutex);
+}
+
+void tscProcessPipeInsert(SSqlObj *pSql) {
+  SPipeInsertSupporter *pSupporter = (SPipeInsertSupporter *)pSql->param;
+  SSqlCmd *             pCmd = &pSql->cmd;
+
+  if (pCmd->command != TSDB_SQL_INSERT || pCmd->dataSourceType == DATA_FROM_DATA_FILE) {
+    tscError("%p only insert statement with values is allowed in pipelined insertion", pSql);
+    pSupporter->code = TSDB_CODE_INVALID_SQL;
+  }
+
+  pSupporter->parsed = true;
+  tsem_post(&pSupporter->sem);
+}
+
+static void tscPipeInsertCallback(void *param, TAOS_RES *tres, int code) {
+  SPipeInsertSupporter *pSupporter = (SPipeInsertSupporter *)param;
+
+  // failed to parse the sql, the sql object will be released automatically
+  if (!pSupporter->dispatched) {
+    assert(code != TSDB_CODE_SUCCESS);
+    pSupporter->code = code;
+    tsem_post(&pSupporter->sem);
+    return;
+  }
+
+  SInsertPipe *pPipe = pSupporter->pPipe;
+  SSqlObj *    pSql = pSupporter->pSql;
+
+  tscTrace("%p pipelined insertion completed, code:%d, rows:%" PRId64, pSql, code, pSql->res.numOfRows);
+  (*pPipe->fp)(pSupporter->param, NULL, (code < 0) ? code : (int32_t)pSql->res.numOfRows);
+
+  tscFreeSqlObj(pSql);
+  free(pSupporter);
+
+  tscPipeInsertCompleted(pPipe);
+}
+
+TAOS_PIPE *taos_open_pipe(TAOS *taos, int window, void (*fp)(void *param, TAOS_RES *, int code)) {
+  STscObj *pObj = (STscObj *)taos;
+  if (pObj == NULL || pObj->signature != pObj) {
+    terrno = TSDB_CODE_DISCONNECTED;
+    return NULL;
+  }
+
+  if (window <= 0 || fp == NULL) {
+    terrno = TSDB_CODE_INVALID_VALUE;
+    return NULL;
+  }
+
+  SInsertPipe *pPipe = calloc(1, sizeof(SInsertPipe));
+  if (pPipe == NULL) {
+    terrno = TSDB_CODE_CLI_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  pPipe->pVnodeList = taosHashInit(16, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), false);
+  if (pPipe->pVnodeList == NULL) {
+    free(pPipe);
+    terrno = TSDB_CODE_CLI_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  pPipe->pObj = pObj;
+  pPipe->windowSize = window;
+  pPipe->fp = fp;
+  pthread_mutex_init(&pPipe->mutex, NULL);
+  pthread_cond_init(&pPipe->cond, NULL);
+
+  tscTrace("pipe:%p is opened, pObj:%p window:%d", pPipe, pObj, window);
+  return pPipe;
+}
+
+int taos_pipe_insert(TAOS_PIPE *tpipe, const char *sqlstr, void *param) {
+  SInsertPipe *pPipe = (SInsertPipe *)tpipe;
+  if (pPipe == NULL || pPipe->pObj->signature != pPipe->pObj) {
+    terrno = TSDB_CODE_DISCONNECTED;
+    return TSDB_CODE_DISCONNECTED;
+  }
+
+  size_t sqlLen = strlen(sqlstr);
+  if (sqlLen > tsMaxSQLStringLen) {
+    tscError("sql string too long");
+    terrno = TSDB_CODE_INVALID_SQL;
+    return TSDB_CODE_INVALID_SQL;
+  }
+
+  SPipeInsertSupporter *pSupporter = calloc(1, sizeof(SPipeInsertSupporter));
+  SSqlObj *             pSql = calloc(1, sizeof(SSqlObj));
+  if (pSupporter == NULL || pSql == NULL) {
+    free(pSupporter);
+    free(pSql);
+    terrno = TSDB_CODE_CLI_OUT_OF_MEMORY;
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  tsem_init(&pSupporter->sem, 0, 0);
+  pSupporter->pPipe = pPipe;
+  pSupporter->pSql = pSql;
+  pSupporter->param = param;
+  pSql->pPipe = pPipe;
+
+  doAsyncQuery(pPipe->pObj, pSql, tscPipeInsertCallback, pSupporter, sqlstr, sqlLen);
+  tsem_wait(&pSupporter->sem);
+  tsem_destroy(&pSupporter->sem);
+
+  int32_t code = pSupporter->code;
+  if (code != TSDB_CODE_SUCCESS) {
+    if (pSupporter->parsed) {
+      tscFreeSqlObj(pSql);
+    }
+
+    free(pSupporter);
+    terrno = code;
+    return code;
+  }
+
+  pthread_mutex_lock(&pPipe->mutex);
+  pPipe->numOfPending += 1;
+  pthread_mutex_unlock(&pPipe->mutex);
+
+  pSupporter->dispatched = true;
+
+  code = tscHandleMultivnodeInsert(pSql);
+  if (code != TSDB_CODE_SUCCESS) {  // no submit is sent
+    tscFreeSqlObj(pSql);
+    free(pSupporter);
+
+    tscPipeInsertCompleted(pPipe);
+    terrno = code;
+  }
+
+  return code;
+}
+
+void taos_close_pipe(TAOS_PIPE *tpipe) {
+  SInsertPipe *pPipe = (SInsertPipe *)tpipe;
+  if (pPipe == NULL) {
+    return;
+  }
+
+  // wait for the completion of all accepted statements
+  pthread_mutex_lock(&pPipe->mutex);
+  while (pPipe->numOfPending > 0) {
+    pthread_cond_wait(&pPipe->cond, &pPipe->mutex);
+  }
+  pthread_mutex_unlock(&pPipe->mutex);
+
+  taosHashCleanup(pPipe->pVnodeList);
+  pthread_mutex_destroy(&pPipe->mutex);
+  pthread_cond_destroy(&pPipe->cond);
+
+  tscTrace("pipe:%p is closed", pPipe);
+  free(pPipe);
+}
@@ -20,6 +20,7 @@
 #include "qinterpolation.h"
 #include "qpercentile.h"
 #include "qsyntaxtreefunction.h"
+#include "qtdigest.h"
 #include "qtsbuf.h"
 #include "taosdef.h"
 #include "taosmsg.h"
@@ -133,8 +134,14 @@ typedef struct SLeastsquareInfo {
 
 typedef struct SAPercentileInfo {
   SHistogramInfo *pHisto;
+  int32_t         algo;  // APERCT_ALGO_DEFAULT or APERCT_ALGO_TDIGEST, the t-digest follows this struct
 } SAPercentileInfo;
 
+// the intermediate buffer is large enough for either one of the algorithms
+#define APERCT_INTER_BUF_SIZE                                                                         \
+  (sizeof(SAPercentileInfo) + MAX(sizeof(SHistogramInfo) + sizeof(SHistBin) * (MAX_HISTOGRAM_BIN + 1), \
+                                  sizeof(STDigest)))
+
 typedef struct STSCompInfo {
   STSBuf *pTSBuf;
 } STSCompInfo;
@@ -227,7 +234,7 @@ int32_t getResultDataInfo(int32_t dataType, int32_t dataBytes, int32_t functionI
       return TSDB_CODE_SUCCESS;
     } else if (functionId == TSDB_FUNC_APERCT) {
       *type = TSDB_DATA_TYPE_BINARY;
-      *bytes = sizeof(SHistBin) * (MAX_HISTOGRAM_BIN + 1) + sizeof(SHistogramInfo) + sizeof(SAPercentileInfo);
+      *bytes = APERCT_INTER_BUF_SIZE;
       *intermediateResBytes = *bytes;
       
       return TSDB_CODE_SUCCESS;
@@ -258,8 +265,7 @@ int32_t getResultDataInfo(int32_t dataType, int32_t dataBytes, int32_t functionI
   } else if (functionId == TSDB_FUNC_APERCT) {
     *type = TSDB_DATA_TYPE_DOUBLE;
     *bytes = sizeof(double);
-    *intermediateResBytes =
-        sizeof(SAPercentileInfo) + sizeof(SHistogramInfo) + sizeof(SHistBin) * (MAX_HISTOGRAM_BIN + 1);
+    *intermediateResBytes = APERCT_INTER_BUF_SIZE;
     return TSDB_CODE_SUCCESS;
   } else if (functionId == TSDB_FUNC_TWA) {
     *type = TSDB_DATA_TYPE_DOUBLE;
@@ -1830,28 +1836,52 @@ static void last_dist_func_second_merge(SQLFunctionCtx *pCtx) {
 /*
  * NOTE: last_row does not use the interResultBuf to keep the result
  */
-static void last_row_function(SQLFunctionCtx *pCtx) {
-  assert(pCtx->size == 1);
-  
-  char *pData = GET_INPUT_CHAR(pCtx);
-  assignVal(pCtx->aOutputBuf, pData, pCtx->inputBytes, pCtx->inputType);
-  
+static void last_row_assign(SQLFunctionCtx *pCtx, char *pData, TSKEY ts) {
   SResultInfo *pResInfo = GET_RES_INFO(pCtx);
   
+  // the rows of different blocks, or different tables of a super table, are not visited in the order of timestamp
   SLastrowInfo *pInfo = (SLastrowInfo *)pResInfo->interResultBuf;
-  pInfo->ts = pCtx->param[0].i64Key;
+  if (pInfo->hasResult == DATA_SET_FLAG && pInfo->ts >= ts) {
+    return;
+  }
+  
+  assignVal(pCtx->aOutputBuf, pData, pCtx->inputBytes, pCtx->inputType);
+  
+  pInfo->ts = ts;
   pInfo->hasResult = DATA_SET_FLAG;
   
   // set the result to final result buffer
   if (pResInfo->superTableQ) {
     SLastrowInfo *pInfo1 = (SLastrowInfo *)(pCtx->aOutputBuf + pCtx->inputBytes);
-    pInfo1->ts = pCtx->param[0].i64Key;
+    pInfo1->ts = ts;
     pInfo1->hasResult = DATA_SET_FLAG;
     
     DO_UPDATE_TAG_COLUMNS(pCtx, pInfo1->ts);
   }
   
-  SET_VAL(pCtx, pCtx->size, 1);
+  SET_VAL(pCtx, 1, 1);
+}
+
+static void last_row_function(SQLFunctionCtx *pCtx) {
+  if (pCtx->size <= 0) {
+    return;
+  }
+  
+  // the rows in data block are in ascending order, the last one is the latest row
+  int32_t index = pCtx->size - 1;
+  TSKEY   ts = (pCtx->ptsList != NULL) ? pCtx->ptsList[index] : pCtx->param[0].i64Key;
+  
+  last_row_assign(pCtx, GET_INPUT_CHAR_INDEX(pCtx, index), ts);
+}
+
+static void last_row_function_f(SQLFunctionCtx *pCtx, int32_t index) {
+  last_row_assign(pCtx, GET_INPUT_CHAR_INDEX(pCtx, index), pCtx->ptsList[index]);
+  
+  // the first qualified row in descending scan of a single table is the last row
+  SResultInfo *pResInfo = GET_RES_INFO(pCtx);
+  if (pCtx->order == TSDB_ORDER_DESC && !pResInfo->superTableQ) {
+    pResInfo->complete = true;
+  }
 }
 
 static void last_row_finalizer(SQLFunctionCtx *pCtx) {
@@ -1863,7 +1893,10 @@ static void last_row_finalizer(SQLFunctionCtx *pCtx) {
       return;
     }
   } else {
-    // do nothing
+    // no data in the table, do not generate a result
+    if (GET_RES_INFO(pCtx)->numOfRes == 0) {
+      return;
+    }
   }
   
   GET_RES_INFO(pCtx)->numOfRes = 1;
@@ -2463,14 +2496,19 @@ static void percentile_function(SQLFunctionCtx *pCtx) {
   SResultInfo *    pResInfo = GET_RES_INFO(pCtx);
   SPercentileInfo *pInfo = pResInfo->interResultBuf;
   
-  for (int32_t i = 0; i < pCtx->size; ++i) {
-    char *data = GET_INPUT_CHAR_INDEX(pCtx, i);
-    if (pCtx->hasNull && isNull(data, pCtx->inputType)) {
-      continue;
+  if (!pCtx->hasNull) {  // put the whole block at once
+    notNullElems = pCtx->size;
+    tMemBucketPut(pInfo->pMemBucket, GET_INPUT_CHAR(pCtx), pCtx->size);
+  } else {
+    for (int32_t i = 0; i < pCtx->size; ++i) {
+      char *data = GET_INPUT_CHAR_INDEX(pCtx, i);
+      if (isNull(data, pCtx->inputType)) {
+        continue;
+      }
+      
+      notNullElems += 1;
+      tMemBucketPut(pInfo->pMemBucket, data, 1);
     }
-    
-    notNullElems += 1;
-    tMemBucketPut(pInfo->pMemBucket, data, 1);
   }
   
   SET_VAL(pCtx, notNullElems, 1);
@@ -2521,6 +2559,11 @@ static SAPercentileInfo *getAPerctInfo(SQLFunctionCtx *pCtx) {
   }
 }
 
+// the t-digest is pointer free, it always follows the SAPercentileInfo in the intermediate buffer
+static FORCE_INLINE STDigest *getAPerctTDigest(SAPercentileInfo *pInfo) {
+  return (STDigest *)((char *)pInfo + sizeof(SAPercentileInfo));
+}
+
 static bool apercentile_function_setup(SQLFunctionCtx *pCtx) {
   if (!function_setup(pCtx)) {
     return false;
@@ -2528,17 +2571,37 @@ static bool apercentile_function_setup(SQLFunctionCtx *pCtx) {
   
   SAPercentileInfo *pInfo = getAPerctInfo(pCtx);
   
+  // the algorithm is the optional second parameter, the histogram is used by default
+  pInfo->algo = (pCtx->param[1].nType == TSDB_DATA_TYPE_BIGINT) ? (int32_t)pCtx->param[1].i64Key : APERCT_ALGO_DEFAULT;
+  
   char *tmp = (char *)pInfo + sizeof(SAPercentileInfo);
-  pInfo->pHisto = tHistogramCreateFrom(tmp, MAX_HISTOGRAM_BIN);
+  if (pInfo->algo == APERCT_ALGO_TDIGEST) {
+    tTDigestCreateFrom(tmp);
+  } else {
+    pInfo->pHisto = tHistogramCreateFrom(tmp, MAX_HISTOGRAM_BIN);
+  }
+  
   return true;
 }
 
+static FORCE_INLINE void apercentile_add(SAPercentileInfo *pInfo, double v) {
+  if (pInfo->algo == APERCT_ALGO_TDIGEST) {
+    tTDigestAdd(getAPerctTDigest(pInfo), v, 1);
+  } else {
+    tHistogramAdd(&pInfo->pHisto, v);
+  }
+}
+
 static void apercentile_function(SQLFunctionCtx *pCtx) {
   int32_t notNullElems = 0;
   
   SResultInfo *     pResInfo = GET_RES_INFO(pCtx);
   SAPercentileInfo *pInfo = getAPerctInfo(pCtx);
   
+  // the values of the block are fed into the t-digest in batch
+  double  vals[TDIGEST_BUFFER_SIZE];
+  int32_t numOfVals = 0;
+  
   for (int32_t i = 0; i < pCtx->size; ++i) {
     char *data = GET_INPUT_CHAR_INDEX(pCtx, i);
     if (pCtx->hasNull && isNull(data, pCtx->inputType)) {
@@ -2569,7 +2632,20 @@ static void apercentile_function(SQLFunctionCtx *pCtx) {
         break;
     }
     
-    tHistogramAdd(&pInfo->pHisto, v);
+    if (pInfo->algo != APERCT_ALGO_TDIGEST) {
+      tHistogramAdd(&pInfo->pHisto, v);
+      continue;
+    }
+    
+    vals[numOfVals++] = v;
+    if (numOfVals == TDIGEST_BUFFER_SIZE) {
+      tTDigestAddBatch(getAPerctTDigest(pInfo), vals, numOfVals);
+      numOfVals = 0;
+    }
+  }
+  
+  if (numOfVals > 0) {
+    tTDigestAddBatch(getAPerctTDigest(pInfo), vals, numOfVals);
   }
   
   if (!pCtx->hasNull) {
@@ -2614,18 +2690,44 @@ static void apercentile_function_f(SQLFunctionCtx *pCtx, int32_t index) {
       break;
   }
   
-  tHistogramAdd(&pInfo->pHisto, v);
+  apercentile_add(pInfo, v);
   
   SET_VAL(pCtx, 1, 1);
   pResInfo->hasResult = DATA_SET_FLAG;
 }
 
+/*
+ * merging the t-digest is a linear pass over the centroids of the input, no memory allocation is required
+ * and the result is kept in the intermediate buffer.
+ */
+static bool apercentile_tdigest_merge(SQLFunctionCtx *pCtx, SAPercentileInfo *pInput) {
+  STDigest *pDigest = getAPerctTDigest(pInput);
+  if (pDigest->size <= 0) {
+    return false;
+  }
+  
+  SAPercentileInfo *pOutput = getAPerctInfo(pCtx);
+  assert(pOutput->algo == APERCT_ALGO_TDIGEST);
+  
+  tTDigestMerge(getAPerctTDigest(pOutput), pDigest);
+  return true;
+}
+
 static void apercentile_func_merge(SQLFunctionCtx *pCtx) {
   SResultInfo *pResInfo = GET_RES_INFO(pCtx);
   assert(pResInfo->superTableQ);
   
   SAPercentileInfo *pInput = (SAPercentileInfo *)GET_INPUT_CHAR(pCtx);
   
+  if (pInput->algo == APERCT_ALGO_TDIGEST) {
+    if (apercentile_tdigest_merge(pCtx, pInput)) {
+      SET_VAL(pCtx, 1, 1);
+      pResInfo->hasResult = DATA_SET_FLAG;
+    }
+    
+    return;
+  }
+  
   pInput->pHisto = (SHistogramInfo*) ((char *)pInput + sizeof(SAPercentileInfo));
   pInput->pHisto->elems = (SHistBin*) ((char *)pInput->pHisto + sizeof(SHistogramInfo));
   
@@ -2658,6 +2760,16 @@ static void apercentile_func_merge(SQLFunctionCtx *pCtx) {
 static void apercentile_func_second_merge(SQLFunctionCtx *pCtx) {
   SAPercentileInfo *pInput = (SAPercentileInfo *)GET_INPUT_CHAR(pCtx);
   
+  if (pInput->algo == APERCT_ALGO_TDIGEST) {
+    if (apercentile_tdigest_merge(pCtx, pInput)) {
+      SResultInfo *pResInfo = GET_RES_INFO(pCtx);
+      pResInfo->hasResult = DATA_SET_FLAG;
+      SET_VAL(pCtx, 1, 1);
+    }
+    
+    return;
+  }
+  
   pInput->pHisto = (SHistogramInfo*) ((char *)pInput + sizeof(SAPercentileInfo));
   pInput->pHisto->elems = (SHistBin*) ((char *)pInput->pHisto + sizeof(SHistogramInfo));
   
@@ -2690,6 +2802,18 @@ static void apercentile_finalizer(SQLFunctionCtx *pCtx) {
   SResultInfo *     pResInfo = GET_RES_INFO(pCtx);
   SAPercentileInfo *pOutput = pResInfo->interResultBuf;
   
+  if (pOutput->algo == APERCT_ALGO_TDIGEST) {
+    STDigest *pDigest = getAPerctTDigest(pOutput);
+    if (pDigest->size <= 0) {
+      setNull(pCtx->aOutputBuf, pCtx->outputType, pCtx->outputBytes);
+      return;
+    }
+    
+    *(double *)pCtx->aOutputBuf = tTDigestQuantile(pDigest, v / 100);
+    doFinalizer(pCtx);
+    return;
+  }
+  
   if (pCtx->currentStage == SECONDARY_STAGE_MERGE) {
     if (pResInfo->hasResult == DATA_SET_FLAG) {  // check for null
       assert(pOutput->pHisto->numOfElems > 0);
@@ -4889,7 +5013,7 @@ SQLAggFuncElem aAggs[] = {{
                                   TSDB_FUNCSTATE_SELECTIVITY,
                               first_last_function_setup,
                               last_row_function,
-                              noop2,
+                              last_row_function_f,
                               no_next_step,
                               last_row_finalizer,
                               noop1,
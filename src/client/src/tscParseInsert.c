@@ -21,6 +21,7 @@
 #include "os.h"
 
 #include "hash.h"
+#include "tcache.h"
 #include "tscUtil.h"
 #include "tschemautil.h"
 #include "tsclient.h"
@@ -31,9 +32,14 @@
 #include "tscSubquery.h"
 #include "tstoken.h"
 #include "ttime.h"
+#include "ttimer.h"
 
 #include "tdataformat.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 enum {
   TSDB_USE_SERVER_TS = 0,
   TSDB_USE_CLI_TS = 1,
@@ -392,6 +398,273 @@ static int32_t tsCheckTimestamp(STableDataBlocks *pDataBlocks, const char *start
   return TSDB_CODE_SUCCESS;
 }
 
+/*
+ * Fast path of parsing the values in the most common forms, e.g., plain decimal integers, simple floating point
+ * numbers, true/false and quoted strings without escape characters, which are converted directly without tokenizing.
+ * Any value that is not in these forms, including the illegal ones, is left to the tokenizer, so the result and the
+ * error message are always identical to the generic path.
+ */
+#define FAST_PARSE_MAX_DIGITS 18
+#define FAST_PARSE_MAX_EXACT_MANTISSA (1ULL << 53)
+
+static const double fastParsePow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18,
+};
+
+static FORCE_INLINE bool isValueSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f'; }
+
+static FORCE_INLINE bool isValueEnd(char c) { return isValueSpace(c) || c == ',' || c == ')'; }
+
+// skip the spaces and at most one comma before the value, the same as tStrGetToken
+static FORCE_INLINE char *skipValueDelimiter(char *p) {
+  bool hasComma = false;
+  while (isValueSpace(*p) || *p == ',') {
+    if (*p == ',') {
+      if (hasComma) {
+        return NULL;
+      }
+      hasComma = true;
+    }
+    p++;
+  }
+
+  return p;
+}
+
+// return the position of the first delimiter or escape character (or the null-terminated char) of a quoted string
+static FORCE_INLINE char *findQuoteOrEscape(char *p, char delim) {
+#if defined(__SSE2__)
+  const __m128i vDelim = _mm_set1_epi8(delim);
+  const __m128i vEscape = _mm_set1_epi8('\\');
+  const __m128i vZero = _mm_setzero_si128();
+
+  // the 16 bytes loaded should not cross the page boundary, which may be beyond the end of string buffer
+  while (((uintptr_t)p & 4095u) <= 4096u - sizeof(__m128i)) {
+    __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+    __m128i match = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, vDelim), _mm_cmpeq_epi8(chunk, vEscape)),
+                                 _mm_cmpeq_epi8(chunk, vZero));
+
+    int32_t mask = _mm_movemask_epi8(match);
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+
+    p += sizeof(__m128i);
+  }
+#endif
+
+  while (*p != delim && *p != '\\' && *p != 0) {
+    p++;
+  }
+
+  return p;
+}
+
+// decimal integer without leading zero, e.g., -123, 0, 1500000000000
+static FORCE_INLINE bool fastParseInteger(char **str, int64_t *value) {
+  char *p = *str;
+  bool  neg = (*p == '-');
+  if (neg) {
+    p++;
+  }
+
+  char *start = p;
+  uint64_t v = 0;
+  while (*p >= '0' && *p <= '9') {
+    v = v * 10 + (*p - '0');
+    p++;
+  }
+
+  int32_t numOfDigits = (int32_t)(p - start);
+  if (numOfDigits == 0 || numOfDigits > FAST_PARSE_MAX_DIGITS || (*start == '0' && numOfDigits > 1) || !isValueEnd(*p)) {
+    return false;
+  }
+
+  *value = neg ? -(int64_t)v : (int64_t)v;
+  *str = p;
+  return true;
+}
+
+/*
+ * decimal number without exponent, e.g., -12.5, 3.1415. The mantissa and the power of ten are both exactly
+ * representable in double, so the result of one division is correctly rounded, the same as strtod.
+ */
+static FORCE_INLINE bool fastParseDouble(char **str, double *value) {
+  char *p = *str;
+  bool  neg = (*p == '-');
+  if (neg) {
+    p++;
+  }
+
+  char *   start = p;
+  uint64_t mantissa = 0;
+  while (*p >= '0' && *p <= '9') {
+    mantissa = mantissa * 10 + (*p - '0');
+    p++;
+  }
+
+  int32_t numOfDigits = (int32_t)(p - start);
+  int32_t numOfFraction = 0;
+  if (*p == '.') {
+    p++;
+    char *fraction = p;
+    while (*p >= '0' && *p <= '9') {
+      mantissa = mantissa * 10 + (*p - '0');
+      p++;
+    }
+
+    numOfFraction = (int32_t)(p - fraction);
+    numOfDigits += numOfFraction;
+  }
+
+  if (numOfDigits == 0 || numOfDigits > FAST_PARSE_MAX_DIGITS || mantissa > FAST_PARSE_MAX_EXACT_MANTISSA ||
+      !isValueEnd(*p)) {
+    return false;
+  }
+
+  double dv = (double)mantissa;
+  if (numOfFraction > 0) {
+    dv /= fastParsePow10[numOfFraction];
+  }
+
+  *value = neg ? -dv : dv;
+  *str = p;
+  return true;
+}
+
+static FORCE_INLINE bool fastParseString(char **str, SSchema *pSchema, char *payload) {
+  char *p = *str;
+  char  delim = *p;
+  if (delim != '\'' && delim != '"') {
+    return false;
+  }
+
+  char *start = p + 1;
+  char *end = findQuoteOrEscape(start, delim);
+
+  // escape characters or unterminated string are handled by the tokenizer
+  if (*end != delim || end[1] == delim || !isValueEnd(end[1])) {
+    return false;
+  }
+
+  int32_t len = (int32_t)(end - start);
+  if (pSchema->type == TSDB_DATA_TYPE_BINARY) {
+    if (len > pSchema->bytes) {
+      return false;
+    }
+
+    memcpy(payload, start, len);
+    if (len < pSchema->bytes) {
+      payload[len] = 0;
+    }
+  } else {
+    if (!taosMbsToUcs4(start, len, payload, pSchema->bytes)) {
+      return false;
+    }
+  }
+
+  *str = end + 1;
+  return true;
+}
+
+static bool tsParseOneColumnDataFast(SSchema *pSchema, char **str, char *payload) {
+  char *p = skipValueDelimiter(*str);
+  if (p == NULL) {
+    return false;
+  }
+
+  int64_t iv = 0;
+  double  dv = 0;
+
+  switch (pSchema->type) {
+    case TSDB_DATA_TYPE_BOOL:
+      if (strncmp(p, "true", 4) == 0 && isValueEnd(p[4])) {
+        *(uint8_t *)payload = TSDB_TRUE;
+        p += 4;
+      } else if (strncmp(p, "false", 5) == 0 && isValueEnd(p[5])) {
+        *(uint8_t *)payload = TSDB_FALSE;
+        p += 5;
+      } else {
+        return false;
+      }
+      break;
+
+    case TSDB_DATA_TYPE_TINYINT:
+      if (!fastParseInteger(&p, &iv) || iv > INT8_MAX || iv <= INT8_MIN) {
+        return false;
+      }
+      *((int8_t *)payload) = (int8_t)iv;
+      break;
+
+    case TSDB_DATA_TYPE_SMALLINT:
+      if (!fastParseInteger(&p, &iv) || iv > INT16_MAX || iv <= INT16_MIN) {
+        return false;
+      }
+      *((int16_t *)payload) = (int16_t)iv;
+      break;
+
+    case TSDB_DATA_TYPE_INT:
+      if (!fastParseInteger(&p, &iv) || iv > INT32_MAX || iv <= INT32_MIN) {
+        return false;
+      }
+      *((int32_t *)payload) = (int32_t)iv;
+      break;
+
+    case TSDB_DATA_TYPE_BIGINT:
+      if (!fastParseInteger(&p, &iv)) {
+        return false;
+      }
+      *((int64_t *)payload) = iv;
+      break;
+
+    case TSDB_DATA_TYPE_TIMESTAMP: {
+      // time expression, e.g., 1500000000000+1s, is handled by tsParseTime
+      if (!fastParseInteger(&p, &iv)) {
+        return false;
+      }
+
+      char *next = p;
+      while (isValueSpace(*next)) {
+        next++;
+      }
+
+      if (*next != ',' && *next != ')') {
+        return false;
+      }
+
+      *((int64_t *)payload) = iv;
+      break;
+    }
+
+    case TSDB_DATA_TYPE_FLOAT:
+      if (!fastParseDouble(&p, &dv) || dv > FLT_MAX || dv < -FLT_MAX) {
+        return false;
+      }
+      *((float *)payload) = (float)dv;
+      break;
+
+    case TSDB_DATA_TYPE_DOUBLE:
+      if (!fastParseDouble(&p, &dv)) {
+        return false;
+      }
+      *((double *)payload) = dv;
+      break;
+
+    case TSDB_DATA_TYPE_BINARY:
+    case TSDB_DATA_TYPE_NCHAR:
+      if (!fastParseString(&p, pSchema, payload)) {
+        return false;
+      }
+      break;
+
+    default:
+      return false;
+  }
+
+  *str = p;
+  return true;
+}
+
 int tsParseOneRowData(char **str, STableDataBlocks *pDataBlocks, SSchema schema[], SParsedDataColInfo *spd, char *error,
                       int16_t timePrec, int32_t *code, char *tmpTokenBuf) {
   int32_t index = 0;
@@ -407,6 +680,17 @@ int tsParseOneRowData(char **str, STableDataBlocks *pDataBlocks, SSchema schema[
     SSchema *pSchema = schema + colIndex;
     rowSize += pSchema->bytes;
 
+    bool isPrimaryKey = (colIndex == PRIMARYKEY_TIMESTAMP_COL_INDEX);
+    if (tsParseOneColumnDataFast(pSchema, str, start)) {
+      if (isPrimaryKey && tsCheckTimestamp(pDataBlocks, start) != TSDB_CODE_SUCCESS) {
+        tscInvalidSQLErrMsg(error, "client time/server time can not be mixed up", *str);
+        *code = TSDB_CODE_INVALID_TIME_STAMP;
+        return -1;
+      }
+
+      continue;
+    }
+
     index = 0;
     sToken = tStrGetToken(*str, &index, true, 0, NULL);
     *str += index;
@@ -455,7 +739,6 @@ int tsParseOneRowData(char **str, STableDataBlocks *pDataBlocks, SSchema schema[
       sToken.n -= 2 + cnt;
     }
 
-    bool    isPrimaryKey = (colIndex == PRIMARYKEY_TIMESTAMP_COL_INDEX);
     int32_t ret = tsParseOneColumnData(pSchema, &sToken, start, error, str, isPrimaryKey, timePrec);
     if (ret != TSDB_CODE_SUCCESS) {
       *code = TSDB_CODE_INVALID_SQL;
@@ -710,6 +993,25 @@ static int32_t doParseInsertStatement(SSqlObj *pSql, void *pTableList, char **st
   return TSDB_CODE_SUCCESS;
 }
 
+/*
+ * only the insert statements issued by taos_query/taos_query_a are buffered, the import statements, prepared
+ * statements, pipelined insertions and streams are sent directly.
+ */
+static bool tscShouldBufferInsert(SSqlObj *pSql) {
+  SSqlCmd *pCmd = &pSql->cmd;
+  if (pSql->pTscObj->pWriteBuf == NULL || pSql->pStream != NULL || pSql->pPipe != NULL ||
+      pCmd->dataSourceType != DATA_FROM_SQL_STRING) {
+    return false;
+  }
+
+  if (pSql->fp != (void(*)())tscHandleMultivnodeInsert) {
+    return false;
+  }
+
+  SQueryInfo *pQueryInfo = tscGetQueryInfoDetail(pCmd, pCmd->clauseIndex);
+  return !TSDB_QUERY_HAS_TYPE(pQueryInfo->type, TSDB_QUERY_TYPE_IMPORT);
+}
+
 static int32_t tscCheckIfCreateTable(char **sqlstr, SSqlObj *pSql) {
   int32_t   index = 0;
   SSQLToken sToken = {0};
@@ -977,6 +1279,180 @@ static int32_t validateDataSource(SSqlCmd *pCmd, int8_t type, const char *sql) {
   return TSDB_CODE_SUCCESS;
 }
 
+/*
+ * skip the parenthesized part of sql string, e.g., the values of one row or the tag values of table. The position
+ * next to the matched right parenthesis is returned, or NULL if it is not matched.
+ */
+static char *tscSkipParenthesis(char *p) {
+  assert(*p == '(');
+
+  int32_t depth = 0;
+  while (*p != 0) {
+    char c = *p++;
+    if (c == '\'' || c == '"') {
+      while (*p != 0 && *p != c) {
+        if (*p == '\\' && *(p + 1) != 0) {
+          p++;
+        }
+        p++;
+      }
+
+      if (*p == 0) {
+        return NULL;
+      }
+
+      p++;
+    } else if (c == '(') {
+      depth++;
+    } else if (c == ')' && --depth == 0) {
+      return p;
+    }
+  }
+
+  return NULL;
+}
+
+static bool tscAddPrefetchTable(SSqlObj *pSql, SSQLToken *pToken, SHashObj *pNames, SArray *pTableIds) {
+  if (validateTableName(pToken->z, pToken->n) != TSDB_CODE_SUCCESS) {
+    return false;
+  }
+
+  STableMetaInfo info = {0};
+  if (tscSetTableId(&info, pToken, pSql) != TSDB_CODE_SUCCESS) {
+    return false;
+  }
+
+  size_t len = strlen(info.name);
+  if (taosHashGet(pNames, info.name, len) != NULL) {
+    return true;
+  }
+
+  char flag = 1;
+  taosHashPut(pNames, info.name, len, &flag, sizeof(flag));
+
+  void *p = taosCacheAcquireByName(tscCacheHandle, info.name);
+  if (p != NULL) {
+    taosCacheRelease(tscCacheHandle, &p, false);
+  } else {
+    taosArrayPush(pTableIds, info.name);
+  }
+
+  return true;
+}
+
+/*
+ * Collect the tables (and the super tables in USING clauses) from str to the end of the insert statement whose metas
+ * are not cached, and retrieve them from mgmt node in one request, instead of one round trip for each of them during
+ * parsing. The scan stops at the first thing it does not understand, and leaves the error to be reported by the parser.
+ */
+static int32_t tscPrefetchTableMetas(SSqlObj *pSql, char *str) {
+  SHashObj *pNames = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false);
+  SArray *  pTableIds = taosArrayInit(16, TSDB_TABLE_ID_LEN);
+  if (pNames == NULL || pTableIds == NULL) {
+    taosHashCleanup(pNames);
+    taosArrayDestroy(pTableIds);
+    return TSDB_CODE_SUCCESS;
+  }
+
+  while (taosArrayGetSize(pTableIds) < TSDB_MULTI_METERMETA_MAX_NUM) {
+    int32_t   index = 0;
+    SSQLToken sToken = tStrGetToken(str, &index, false, 0, NULL);
+    str += index;
+
+    if (sToken.n == 0 || !tscAddPrefetchTable(pSql, &sToken, pNames, pTableIds)) {
+      break;
+    }
+
+    index = 0;
+    sToken = tStrGetToken(str, &index, false, 0, NULL);
+    str += index;
+
+    if (sToken.type == TK_USING) {
+      index = 0;
+      sToken = tStrGetToken(str, &index, false, 0, NULL);
+      str += index;
+
+      if (sToken.n == 0 || !tscAddPrefetchTable(pSql, &sToken, pNames, pTableIds)) {
+        break;
+      }
+
+      // skip the optional tag name list, the keyword TAGS and the tag values
+      while (1) {
+        index = 0;
+        sToken = tStrGetToken(str, &index, false, 0, NULL);
+        str += index;
+
+        if (sToken.type == TK_TAGS) {
+          continue;
+        } else if (sToken.type != TK_LP || (str = tscSkipParenthesis(sToken.z)) == NULL) {
+          break;
+        }
+
+        index = 0;
+        SSQLToken t = tStrGetToken(str, &index, false, 0, NULL);
+        if (t.type != TK_LP && t.type != TK_TAGS) {
+          break;
+        }
+      }
+
+      if (str == NULL) {
+        break;
+      }
+
+      index = 0;
+      sToken = tStrGetToken(str, &index, false, 0, NULL);
+      str += index;
+    }
+
+    // the column list
+    if (sToken.type == TK_LP) {
+      if ((str = tscSkipParenthesis(sToken.z)) == NULL) {
+        break;
+      }
+
+      index = 0;
+      sToken = tStrGetToken(str, &index, false, 0, NULL);
+      str += index;
+    }
+
+    if (sToken.type == TK_VALUES) {
+      while (str != NULL) {
+        index = 0;
+        sToken = tStrGetToken(str, &index, false, 0, NULL);
+        if (sToken.type != TK_LP) {
+          break;
+        }
+
+        str = tscSkipParenthesis(sToken.z);
+      }
+    } else if (sToken.type == TK_FILE) {
+      index = 0;
+      sToken = tStrGetToken(str, &index, false, 0, NULL);
+      str += index;
+    } else {
+      break;
+    }
+
+    if (str == NULL) {
+      break;
+    }
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  size_t  numOfTables = taosArrayGetSize(pTableIds);
+
+  // a single table is retrieved on demand during parsing, as before
+  if (numOfTables > 1) {
+    tscTrace("%p %d tables in insert statement are not cached, retrieve them in one request", pSql, numOfTables);
+    code = tscGetMultiTableMeta(pSql, taosArrayGet(pTableIds, 0), (int32_t)numOfTables);
+  }
+
+  taosHashCleanup(pNames);
+  taosArrayDestroy(pTableIds);
+
+  return code;
+}
+
 /**
  * usage: insert into table1 values() () table2 values()()
  *
@@ -1018,6 +1494,8 @@ int doParseInsertSql(SSqlObj *pSql, char *str) {
       code = TSDB_CODE_CLI_OUT_OF_MEMORY;
       goto _error_clean;
     }
+
+    pCmd->metaPrefetched = false;
   } else {
     assert((NULL != pCmd->curSql) && (NULL != pCmd->pTableList));
     str = pCmd->curSql;
@@ -1064,6 +1542,26 @@ int doParseInsertSql(SSqlObj *pSql, char *str) {
     }
 
     ptrdiff_t pos = pCmd->curSql - pSql->sqlstr;
+
+    /*
+     * statements whose tables are all cached are not scanned ahead. At the first table that is not cached, the metas
+     * of the rest tables are retrieved in one request, and the parse is resumed from this table in the callback.
+     */
+    if (!pCmd->metaPrefetched) {
+      void *p = taosCacheAcquireByName(tscCacheHandle, pTableMetaInfo->name);
+      if (p != NULL) {
+        taosCacheRelease(tscCacheHandle, &p, false);
+      } else {
+        pCmd->metaPrefetched = true;
+        code = tscPrefetchTableMetas(pSql, sToken.z);
+        if (code == TSDB_CODE_ACTION_IN_PROGRESS) {
+          tscTrace("%p waiting for get table metas during insert, then resume from offset: %" PRId64, pSql, pos);
+          return code;
+        }
+
+        code = TSDB_CODE_SUCCESS;  // the tables are retrieved one by one on demand if the request is not sent
+      }
+    }
     
     if ((code = tscCheckIfCreateTable(&str, pSql)) != TSDB_CODE_SUCCESS) {
       /*
@@ -1241,6 +1739,13 @@ int doParseInsertSql(SSqlObj *pSql, char *str) {
     goto _clean;
   }
 
+  // the table data blocks are coalesced into the write buffer of connection, instead of being merged and sent
+  if (pCmd->pDataBlocks->nSize > 0 && tscShouldBufferInsert(pSql)) {
+    pCmd->bufferedInsert = true;
+    code = TSDB_CODE_SUCCESS;
+    goto _clean;
+  }
+
   if (pCmd->pDataBlocks->nSize > 0) { // merge according to vgId
     if ((code = tscMergeTableDataBlocks(pSql, pCmd->pDataBlocks)) != TSDB_CODE_SUCCESS) {
       goto _error_clean;
@@ -1342,191 +1847,1091 @@ int tsParseSql(SSqlObj *pSql, bool initialParse) {
   return ret;
 }
 
-static int doPackSendDataBlock(SSqlObj *pSql, int32_t numOfRows, STableDataBlocks *pTableDataBlocks) {
-  int32_t  code = TSDB_CODE_SUCCESS;
-  SSqlCmd *pCmd = &pSql->cmd;
+#define TSC_IMPORT_MIN_CHUNK_SIZE       (4 * 1024 * 1024)
+#define TSC_IMPORT_INFLIGHT_PER_THREAD  4
+#define TSC_IMPORT_PROGRESS_INTERVAL    5000  // ms
 
-  assert(pCmd->numOfClause == 1);
-  STableMeta *pTableMeta = tscGetTableMetaInfoFromCmd(pCmd, pCmd->clauseIndex, 0)->pTableMeta;
+typedef struct SImportSupporter SImportSupporter;
 
-  SSubmitBlk *pBlocks = (SSubmitBlk *)(pTableDataBlocks->pData);
-  tsSetBlockInfo(pBlocks, pTableMeta, numOfRows);
+typedef struct SImportWorker {
+  SImportSupporter *pSupporter;
+  int32_t           index;   // the worker parses chunks index, index + numOfWorkers, ... of the file buffer
+  SArray *          pBlocks; // parsed data blocks of current chunk, waiting to be submitted
+  tsem_t            inflightSem;  // bounds the submits of the worker that are not acknowledged yet
+} SImportWorker;
 
-  if ((code = tscMergeTableDataBlocks(pSql, pCmd->pDataBlocks)) != TSDB_CODE_SUCCESS) {
-    return code;
-  }
+/*
+ * the data files are imported one by one. Each file is mapped into memory and split into chunks at line boundaries,
+ * the chunks are parsed by separated threads in parallel, but submitted one after another by chunk index, so that the
+ * rows are sent to vnode in the same order as they are in file, as the sequential import did. The turn passes to the
+ * next chunk once the submits of a chunk are sent, and each thread keeps up to TSC_IMPORT_INFLIGHT_PER_THREAD submits
+ * waiting for acknowledgement. The last finished thread moves on to the next file.
+ */
+struct SImportSupporter {
+  SSqlObj *       pSql;
+  SDataBlockList *pFileList;  // one block for each file, the file name is kept in the block
+  int32_t         fileIndex;
+  int64_t         affectedRows;
+
+  // following fields belong to the file that is being imported
+  char            path[PATH_MAX];
+  char *          pBuf;
+  size_t          len;
+  int32_t         numOfChunks;
+  int32_t         nextChunk;  // the chunk whose data blocks are to be submitted, chunks are submitted by index
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+  int32_t         numOfWorkers;
+  int32_t         numOfCompleted;
+  int32_t         code;
+  char            msg[256];
+  int64_t         numOfRows;  // rows that are accepted by vnode
+  int64_t         numOfParsedBytes;
+  int64_t         stime;
+  int64_t         lastReportTime;
+  SImportWorker * pWorkers;
+};
 
-  // the pDataBlock is different from the pTableDataBlocks
-  STableDataBlocks *pDataBlock = pCmd->pDataBlocks->pData[0];
-  if ((code = tscCopyDataBlockToPayload(pSql, pDataBlock)) != TSDB_CODE_SUCCESS) {
-    return code;
+static void tscImportNextFile(SImportSupporter *pSupporter);
+
+static char *tscMapImportFile(FILE *fp, size_t *len) {
+  fseek(fp, 0, SEEK_END);
+  long size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+
+  *len = 0;
+  if (size <= 0) {
+    return NULL;
   }
 
-  if ((code = tscProcessSql(pSql)) != TSDB_CODE_SUCCESS) {
-    return code;
+#ifdef WINDOWS
+  char *pBuf = malloc(size);
+  if (pBuf != NULL && fread(pBuf, 1, size, fp) != (size_t)size) {
+    tfree(pBuf);
+  }
+#else
+  // the file is only read, each line is copied out and converted into lower case by the worker
+  char *pBuf = mmap(NULL, size, PROT_READ, MAP_SHARED, fileno(fp), 0);
+  if (pBuf == MAP_FAILED) {
+    return NULL;
   }
 
-  return TSDB_CODE_SUCCESS;
+  madvise(pBuf, size, MADV_SEQUENTIAL);
+#endif
+
+  *len = size;
+  return pBuf;
 }
 
-static int tscInsertDataFromFile(SSqlObj *pSql, FILE *fp, char *tmpTokenBuf) {
-  size_t          readLen = 0;
-  char *          line = NULL;
-  size_t          n = 0;
-  int             len = 0;
-  int32_t         maxRows = 0;
-  SSqlCmd *       pCmd = &pSql->cmd;
-  int             numOfRows = 0;
-  int32_t         code = 0;
-  int             nrows = 0;
-  
+static void tscUnmapImportFile(char *pBuf, size_t len) {
+  if (pBuf == NULL) {
+    return;
+  }
+
+#ifdef WINDOWS
+  free(pBuf);
+#else
+  munmap(pBuf, len);
+#endif
+}
+
+static void tscSetImportError(SImportSupporter *pSupporter, int32_t code, const char *msg) {
+  pthread_mutex_lock(&pSupporter->mutex);
+
+  if (pSupporter->code == TSDB_CODE_SUCCESS) {
+    pSupporter->code = code;
+    if (msg != NULL) {
+      strncpy(pSupporter->msg, msg, tListLen(pSupporter->msg) - 1);
+    }
+  }
+
+  // wake up the workers waiting for their turn to submit
+  pthread_cond_broadcast(&pSupporter->cond);
+  pthread_mutex_unlock(&pSupporter->mutex);
+}
+
+/*
+ * chunk index starts at the line following the offset index * TSC_IMPORT_MIN_CHUNK_SIZE, a chunk may be empty if
+ * a line is longer than the chunk size
+ */
+static char *tscGetImportChunkStart(SImportSupporter *pSupporter, int32_t index) {
+  char *end = pSupporter->pBuf + pSupporter->len;
+  if (index == 0) {
+    return pSupporter->pBuf;
+  } else if (index >= pSupporter->numOfChunks) {
+    return end;
+  }
+
+  char *p = pSupporter->pBuf + (size_t)index * TSC_IMPORT_MIN_CHUNK_SIZE - 1;
+  char *eol = memchr(p, '\n', end - p);
+  return (eol == NULL) ? end : eol + 1;
+}
+
+static void tscReportImportProgress(SImportSupporter *pSupporter) {
+  int64_t now = taosGetTimestampMs();
+  int64_t last = atomic_load_64(&pSupporter->lastReportTime);
+  if (now - last < TSC_IMPORT_PROGRESS_INTERVAL ||
+      atomic_val_compare_exchange_64(&pSupporter->lastReportTime, last, now) != last) {
+    return;
+  }
+
+  int64_t numOfRows = atomic_load_64(&pSupporter->numOfRows);
+  int64_t parsed = atomic_load_64(&pSupporter->numOfParsedBytes);
+  double  elapsed = (now - pSupporter->stime) / 1000.0;
+
+  tscPrint("%p import from file %s, %.2f%% parsed, %" PRId64 " rows inserted, %.2f rows/sec", pSupporter->pSql,
+           pSupporter->path, parsed * 100.0 / pSupporter->len, numOfRows, numOfRows / elapsed);
+}
+
+static void tscImportSubmitCallback(void *param, TAOS_RES *tres, int code) {
+  SImportWorker *   pWorker = (SImportWorker *)param;
+  SImportSupporter *pSupporter = pWorker->pSupporter;
+
+  if (code < 0) {
+    tscError("%p failed to submit data imported from file %s, code:%s", pSupporter->pSql, pSupporter->path,
+             tstrerror(code));
+    tscSetImportError(pSupporter, code, NULL);
+  } else {
+    atomic_add_fetch_64(&pSupporter->numOfRows, code);
+    tscReportImportProgress(pSupporter);
+  }
+
+  // the worker may be released once the semaphore is posted
+  tsem_post(&pWorker->inflightSem);
+}
+
+/*
+ * pack the table data block into a submit message of a new insert object, the data block is released in any cases
+ */
+static int32_t tscSubmitImportBlock(SImportWorker *pWorker, STableDataBlocks *pTableDataBlock) {
+  SImportSupporter *pSupporter = pWorker->pSupporter;
+  SSqlObj *         pSql = pSupporter->pSql;
+  int32_t           numOfRows = ((SSubmitBlk *)pTableDataBlock->pData)->numOfRows;
+
+  SDataBlockList *pList = tscCreateBlockArrayList();
+  tscAppendDataBlock(pList, pTableDataBlock);
+
+  SSqlObj *pNew = createSubqueryObj(pSql, 0, tscImportSubmitCallback, pWorker, TSDB_SQL_INSERT, NULL);
+  if (pNew == NULL) {
+    tscDestroyBlockArrayList(pList);
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  int32_t code = tscMergeTableDataBlocks(pNew, pList);
+  if (code != TSDB_CODE_SUCCESS) {
+    tscDestroyBlockArrayList(pList);
+    tscFreeSqlObj(pNew);
+    return code;
+  }
+
+  code = tscCopyDataBlockToPayload(pNew, pNew->cmd.pDataBlocks->pData[0]);
+  pNew->cmd.pDataBlocks = tscDestroyBlockArrayList(pNew->cmd.pDataBlocks);
+  if (code != TSDB_CODE_SUCCESS) {
+    tscFreeSqlObj(pNew);
+    return code;
+  }
+
+  tsem_wait(&pWorker->inflightSem);
+  tscTrace("%p sub:%p submit %d rows imported from file %s", pSql, pNew, numOfRows, pSupporter->path);
+
+  // the submit callback is not invoked if the submit fails before it is sent
+  code = tscProcessSql(pNew);
+  if (code != TSDB_CODE_SUCCESS) {
+    tscFreeSqlObj(pNew);
+    tsem_post(&pWorker->inflightSem);
+  }
+
+  return code;
+}
+
+static void tscClearImportBlocks(SImportWorker *pWorker) {
+  size_t size = taosArrayGetSize(pWorker->pBlocks);
+  for (int32_t i = 0; i < size; ++i) {
+    tscDestroyDataBlock(*(STableDataBlocks **)taosArrayGet(pWorker->pBlocks, i));
+  }
+
+  pWorker->pBlocks->size = 0;
+}
+
+/*
+ * parse the lines in [start, end) of the file buffer into the data blocks of the worker
+ */
+static int32_t tscParseImportChunk(SImportWorker *pWorker, char *start, char *end, char *tmpTokenBuf, char *error) {
+  SImportSupporter *pSupporter = pWorker->pSupporter;
+  SSqlCmd *         pCmd = &pSupporter->pSql->cmd;
+
   STableMetaInfo *pTableMetaInfo = tscGetTableMetaInfoFromCmd(pCmd, pCmd->clauseIndex, 0);
   STableMeta *    pTableMeta = pTableMetaInfo->pTableMeta;
-  STableComInfo tinfo = tscGetTableInfo(pTableMeta);
-  
-  assert(pCmd->numOfClause == 1);
-  
-  int32_t rowSize = tinfo.rowSize;
+  STableComInfo   tinfo = tscGetTableInfo(pTableMeta);
+  SSchema *       pSchema = tscGetTableSchema(pTableMeta);
+
+  SParsedDataColInfo spd = {.numOfCols = tinfo.numOfColumns};
+  tscSetAssignedColumnInfo(&spd, pSchema, tinfo.numOfColumns);
+
+  char * line = NULL;
+  size_t lineSize = 0;
 
-  pCmd->pDataBlocks = tscCreateBlockArrayList();
   STableDataBlocks *pTableDataBlock = NULL;
-  int32_t           ret = tscCreateDataBlock(TSDB_PAYLOAD_SIZE, rowSize, sizeof(SSubmitBlk),
-                                   pTableMetaInfo->name, pTableMeta, &pTableDataBlock);
-  if (ret != TSDB_CODE_SUCCESS) {
-    return -1;
-  }
+  int32_t           maxRows = 0;
+  int32_t           count = 0;
+  int32_t           code = TSDB_CODE_SUCCESS;
+
+  char *p = start;
+  while (p < end && pSupporter->code == TSDB_CODE_SUCCESS) {
+    char * eol = memchr(p, '\n', end - p);
+    char * next = (eol == NULL) ? end : eol + 1;
+    size_t readLen = (eol == NULL) ? (end - p) : (eol - p);
+
+    if (readLen > 0 && p[readLen - 1] == '\r') readLen -= 1;
+    if (readLen == 0) {
+      p = next;
+      continue;
+    }
 
-  tscAppendDataBlock(pCmd->pDataBlocks, pTableDataBlock);
+    // the line is copied out to be null-terminated, the same as the line read by getline
+    if (readLen + 1 > lineSize) {
+      char *tmp = realloc(line, readLen + 1);
+      if (tmp == NULL) {
+        code = TSDB_CODE_CLI_OUT_OF_MEMORY;
+        break;
+      }
 
-  code = tscAllocateMemIfNeed(pTableDataBlock, rowSize, &maxRows);
-  if (TSDB_CODE_SUCCESS != code) return -1;
+      line = tmp;
+      lineSize = readLen + 1;
+    }
 
-  int                count = 0;
-  SParsedDataColInfo spd = {.numOfCols = tinfo.numOfColumns};
-  SSchema *          pSchema = tscGetTableSchema(pTableMeta);
+    memcpy(line, p, readLen);
+    line[readLen] = 0;
+    p = next;
 
-  tscSetAssignedColumnInfo(&spd, pSchema, tinfo.numOfColumns);
+    if (pTableDataBlock == NULL) {
+      code = tscCreateDataBlock(TSDB_PAYLOAD_SIZE, tinfo.rowSize, sizeof(SSubmitBlk), pTableMetaInfo->name,
+                                pTableMeta, &pTableDataBlock);
+      if (code != TSDB_CODE_SUCCESS) {
+        break;
+      }
 
-  while ((readLen = getline(&line, &n, fp)) != -1) {
-    // line[--readLen] = '\0';
-    if (('\r' == line[readLen - 1]) || ('\n' == line[readLen - 1])) line[--readLen] = 0;
-    if (readLen == 0) continue;  // fang, <= to ==
+      if ((code = tscAllocateMemIfNeed(pTableDataBlock, tinfo.rowSize, &maxRows)) != TSDB_CODE_SUCCESS) {
+        break;
+      }
+    }
 
     char *lineptr = line;
     strtolower(line, line);
-    
-    len = tsParseOneRowData(&lineptr, pTableDataBlock, pSchema, &spd, pCmd->payload, tinfo.precision, &code, tmpTokenBuf);
+
+    int32_t len = tsParseOneRowData(&lineptr, pTableDataBlock, pSchema, &spd, error, tinfo.precision, &code,
+                                    tmpTokenBuf);
     if (len <= 0 || pTableDataBlock->numOfParams > 0) {
-      pSql->res.code = code;
-      return (-code);
+      if (code == TSDB_CODE_SUCCESS) {
+        code = TSDB_CODE_INVALID_SQL;
+      }
+
+      break;
     }
 
     pTableDataBlock->size += len;
 
-    count++;
-    nrows++;
-    if (count >= maxRows) {
-      if ((code = doPackSendDataBlock(pSql, count, pTableDataBlock)) != TSDB_CODE_SUCCESS) {
-        return -code;
-      }
-
-      pTableDataBlock = pCmd->pDataBlocks->pData[0];
-      pTableDataBlock->size = sizeof(SSubmitBlk);
-      pTableDataBlock->rowSize = tinfo.rowSize;
+    if (++count >= maxRows) {
+      tsSetBlockInfo((SSubmitBlk *)pTableDataBlock->pData, pTableMeta, count);
+      taosArrayPush(pWorker->pBlocks, &pTableDataBlock);
 
-      numOfRows += pSql->res.numOfRows;
-      pSql->res.numOfRows = 0;
+      pTableDataBlock = NULL;
       count = 0;
     }
   }
 
-  if (count > 0) {
-    if ((code = doPackSendDataBlock(pSql, count, pTableDataBlock)) != TSDB_CODE_SUCCESS) {
-      return -code;
+  if (pTableDataBlock != NULL) {
+    if (code == TSDB_CODE_SUCCESS && count > 0) {
+      tsSetBlockInfo((SSubmitBlk *)pTableDataBlock->pData, pTableMeta, count);
+      taosArrayPush(pWorker->pBlocks, &pTableDataBlock);
+    } else {
+      tscDestroyDataBlock(pTableDataBlock);
     }
+  }
 
-    numOfRows += pSql->res.numOfRows;
-    pSql->res.numOfRows = 0;
+  tfree(line);
+  return code;
+}
+
+/*
+ * submit the data blocks of chunk index after all previous chunks have been submitted, the submits of previous chunks
+ * may be still waiting for acknowledgement
+ */
+static int32_t tscSubmitImportChunk(SImportWorker *pWorker, int32_t index) {
+  SImportSupporter *pSupporter = pWorker->pSupporter;
+
+  pthread_mutex_lock(&pSupporter->mutex);
+  while (pSupporter->nextChunk != index && pSupporter->code == TSDB_CODE_SUCCESS) {
+    pthread_cond_wait(&pSupporter->cond, &pSupporter->mutex);
+  }
+
+  int32_t code = pSupporter->code;
+  pthread_mutex_unlock(&pSupporter->mutex);
+
+  size_t size = taosArrayGetSize(pWorker->pBlocks);
+  for (int32_t i = 0; i < size; ++i) {
+    STableDataBlocks *pTableDataBlock = *(STableDataBlocks **)taosArrayGet(pWorker->pBlocks, i);
+
+    if (code == TSDB_CODE_SUCCESS) {
+      code = tscSubmitImportBlock(pWorker, pTableDataBlock);
+    } else {
+      tscDestroyDataBlock(pTableDataBlock);
+    }
   }
 
-  if (line) tfree(line);
+  pWorker->pBlocks->size = 0;
 
-  return numOfRows;
+  if (code == TSDB_CODE_SUCCESS) {
+    pthread_mutex_lock(&pSupporter->mutex);
+    pSupporter->nextChunk = index + 1;
+    pthread_cond_broadcast(&pSupporter->cond);
+    pthread_mutex_unlock(&pSupporter->mutex);
+  }
+
+  return code;
 }
 
-void tscProcessMultiVnodesInsertFromFile(SSqlObj *pSql) {
-  SSqlCmd *pCmd = &pSql->cmd;
-  if (pCmd->command != TSDB_SQL_INSERT) {
-    return;
+/*
+ * report the result of current file and release its resources, all workers have quit and no submit is in flight
+ */
+static void tscReleaseImportFile(SImportSupporter *pSupporter) {
+  SSqlObj *pSql = pSupporter->pSql;
+  int64_t  elapsed = taosGetTimestampMs() - pSupporter->stime;
+
+  if (pSupporter->code == TSDB_CODE_SUCCESS) {
+    tscPrint("%p import %" PRId64 " rows from file %s, elapsed time:%" PRId64 " ms, %.2f rows/sec", pSql,
+             pSupporter->numOfRows, pSupporter->path, elapsed,
+             (elapsed > 0) ? pSupporter->numOfRows * 1000.0 / elapsed : 0);
+  } else {
+    tscError("%p failed to import data from file %s, %" PRId64 " rows inserted, code:%s %s", pSql, pSupporter->path,
+             pSupporter->numOfRows, tstrerror(pSupporter->code), pSupporter->msg);
+
+    pSql->res.code = pSupporter->code;
+    if (pSupporter->msg[0] != 0 && pSql->cmd.payload != NULL) {
+      strncpy(pSql->cmd.payload, pSupporter->msg, pSql->cmd.allocSize - 1);
+    }
+  }
+
+  pSupporter->affectedRows += pSupporter->numOfRows;
+
+  for (int32_t i = 0; i < pSupporter->numOfWorkers; ++i) {
+    tsem_destroy(&pSupporter->pWorkers[i].inflightSem);
+    taosArrayDestroy(pSupporter->pWorkers[i].pBlocks);
   }
 
-  SQueryInfo *    pQueryInfo = tscGetQueryInfoDetail(pCmd, 0);
-  STableMetaInfo *pTableMetaInfo = tscGetMetaInfo(pQueryInfo, 0);
+  tfree(pSupporter->pWorkers);
+  pSupporter->numOfWorkers = 0;
 
-  STableDataBlocks *pDataBlock = NULL;
-  int32_t           affected_rows = 0;
+  pthread_mutex_destroy(&pSupporter->mutex);
+  pthread_cond_destroy(&pSupporter->cond);
 
-  assert(pCmd->dataSourceType == DATA_FROM_DATA_FILE && pCmd->pDataBlocks != NULL);
-  SDataBlockList *pDataBlockList = pCmd->pDataBlocks;
-  pCmd->pDataBlocks = NULL;
+  tscUnmapImportFile(pSupporter->pBuf, pSupporter->len);
+  pSupporter->pBuf = NULL;
+}
 
-  char path[PATH_MAX] = {0};
+static void tscImportFileCompleted(SImportSupporter *pSupporter) {
+  tscReleaseImportFile(pSupporter);
 
-  for (int32_t i = 0; i < pDataBlockList->nSize; ++i) {
-    pDataBlock = pDataBlockList->pData[i];
-    if (pDataBlock == NULL) {
-      continue;
+  pSupporter->fileIndex += 1;
+  tscImportNextFile(pSupporter);
+}
+
+static void *tscImportWorkerFp(void *param) {
+  SImportWorker *   pWorker = (SImportWorker *)param;
+  SImportSupporter *pSupporter = pWorker->pSupporter;
+
+  char    error[256] = {0};
+  char *  tmpTokenBuf = calloc(1, 4096);  // used for deleting Escape character: \\, \', \"
+  int32_t code = (tmpTokenBuf == NULL) ? TSDB_CODE_CLI_OUT_OF_MEMORY : TSDB_CODE_SUCCESS;
+
+  for (int32_t i = pWorker->index; i < pSupporter->numOfChunks && code == TSDB_CODE_SUCCESS;
+       i += pSupporter->numOfWorkers) {
+    char *start = tscGetImportChunkStart(pSupporter, i);
+    char *end = tscGetImportChunkStart(pSupporter, i + 1);
+
+    code = tscParseImportChunk(pWorker, start, end, tmpTokenBuf, error);
+    if (code != TSDB_CODE_SUCCESS) {
+      tscClearImportBlocks(pWorker);
+      break;
     }
 
-    if (TSDB_CODE_SUCCESS != tscAllocPayload(pCmd, TSDB_PAYLOAD_SIZE)) {
-      tscError("%p failed to malloc when insert file", pSql);
-      continue;
+    atomic_add_fetch_64(&pSupporter->numOfParsedBytes, end - start);
+    code = tscSubmitImportChunk(pWorker, i);
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    tscSetImportError(pSupporter, code, error[0] != 0 ? error : NULL);
+  }
+
+  // wait for all submits of this worker to be completed
+  for (int32_t i = 0; i < TSC_IMPORT_INFLIGHT_PER_THREAD; ++i) {
+    tsem_wait(&pWorker->inflightSem);
+  }
+
+  tfree(tmpTokenBuf);
+
+  // the supporter may be released by the last worker once this one is counted
+  int32_t numOfWorkers = pSupporter->numOfWorkers;
+  if (atomic_add_fetch_32(&pSupporter->numOfCompleted, 1) == numOfWorkers) {
+    tscImportFileCompleted(pSupporter);
+  }
+
+  return NULL;
+}
+
+static int32_t tscLaunchImportWorkers(SImportSupporter *pSupporter) {
+  int32_t numOfWorkers = tsNumOfImportThreads;
+  if (numOfWorkers <= 0) {
+    numOfWorkers = tsNumOfCores / 2;
+  }
+
+  // do not split small files
+  pSupporter->numOfChunks = (int32_t)((pSupporter->len - 1) / TSC_IMPORT_MIN_CHUNK_SIZE) + 1;
+  pSupporter->nextChunk = 0;
+
+  numOfWorkers = MIN(numOfWorkers, pSupporter->numOfChunks);
+  numOfWorkers = MAX(numOfWorkers, 1);
+
+  pthread_mutex_init(&pSupporter->mutex, NULL);
+  pthread_cond_init(&pSupporter->cond, NULL);
+
+  pSupporter->pWorkers = calloc(numOfWorkers, sizeof(SImportWorker));
+  if (pSupporter->pWorkers == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  pSupporter->numOfWorkers = numOfWorkers;
+  pSupporter->numOfCompleted = 0;
+  pSupporter->stime = taosGetTimestampMs();
+  pSupporter->lastReportTime = pSupporter->stime;
+
+  for (int32_t i = 0; i < numOfWorkers; ++i) {
+    SImportWorker *pWorker = &pSupporter->pWorkers[i];
+    pWorker->pSupporter = pSupporter;
+    pWorker->index = i;
+    tsem_init(&pWorker->inflightSem, 0, TSC_IMPORT_INFLIGHT_PER_THREAD);
+
+    pWorker->pBlocks = taosArrayInit(4, POINTER_BYTES);
+    if (pWorker->pBlocks == NULL) {
+      return TSDB_CODE_CLI_OUT_OF_MEMORY;
     }
-    pCmd->count = 1;
+  }
+
+  tscTrace("%p import data from file %s, size:%zu, chunks:%d, threads:%d", pSupporter->pSql, pSupporter->path,
+           pSupporter->len, pSupporter->numOfChunks, numOfWorkers);
+
+  // the thread ids are kept out of the supporter, which may be released by the last worker before this loop ends
+  pthread_t *threads = calloc(numOfWorkers, sizeof(pthread_t));
+  if (threads == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  pthread_attr_t thattr;
+  pthread_attr_init(&thattr);
+  pthread_attr_setdetachstate(&thattr, PTHREAD_CREATE_JOINABLE);
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  int32_t numOfThreads = 0;
+
+  for (; numOfThreads < numOfWorkers; ++numOfThreads) {
+    SImportWorker *pWorker = &pSupporter->pWorkers[numOfThreads];
+    if (pthread_create(&threads[numOfThreads], &thattr, tscImportWorkerFp, pWorker) != 0) {
+      tscError("%p failed to create import thread, reason:%s", pSupporter->pSql, strerror(errno));
+      code = TSDB_CODE_CLI_OUT_OF_MEMORY;
+      break;
+    }
+  }
+
+  pthread_attr_destroy(&thattr);
+
+  if (code == TSDB_CODE_SUCCESS) {
+    for (int32_t i = 0; i < numOfThreads; ++i) {
+      pthread_detach(threads[i]);
+    }
+  } else {
+    /*
+     * the workers that are not created never complete, so none of the created ones completes the file. Stop them
+     * and wait until they quit, the caller then releases current file.
+     */
+    tscSetImportError(pSupporter, code, NULL);
+    for (int32_t i = 0; i < numOfThreads; ++i) {
+      pthread_join(threads[i], NULL);
+    }
+  }
+
+  free(threads);
+  return code;
+}
+
+static void tscImportCompleted(SImportSupporter *pSupporter) {
+  SSqlObj *pSql = pSupporter->pSql;
+  SSqlRes *pRes = &pSql->res;
+
+  pRes->numOfRows = pSupporter->affectedRows;
+  tscTrace("%p import data from %d file(s) completed, total inserted:%" PRId64, pSql, pSupporter->pFileList->nSize,
+           pRes->numOfRows);
+
+  tscDestroyBlockArrayList(pSupporter->pFileList);
+  tfree(pSupporter);
+
+  // restore user defined fp
+  if (pSql->fp == (void(*)())tscHandleMultivnodeInsert) {
+    pSql->fp = pSql->fetchFp;
+  }
+
+  // the number of rows is passed in an int, the total one is available in the result
+  if (pSql->fp != NULL) {
+    int32_t ret = (pRes->code != TSDB_CODE_SUCCESS) ? pRes->code : (int32_t)MIN(pRes->numOfRows, INT32_MAX);
+    (*pSql->fp)(pSql->param, pSql, ret);
+  }
+}
+
+/*
+ * map current file and launch the workers to import it, the table meta is in cache already
+ */
+static bool tscImportFile(SImportSupporter *pSupporter) {
+  SSqlObj *pSql = pSupporter->pSql;
+
+  FILE *fp = fopen(pSupporter->path, "r");
+  if (fp == NULL) {
+    tscError("%p failed to open file %s to load data from file, reason:%s", pSql, pSupporter->path, strerror(errno));
+    return false;
+  }
+
+  pSupporter->pBuf = tscMapImportFile(fp, &pSupporter->len);
+  fclose(fp);
+
+  if (pSupporter->pBuf == NULL) {
+    tscTrace("%p no records in file %s", pSql, pSupporter->path);
+    return false;
+  }
+
+  pSupporter->code = TSDB_CODE_SUCCESS;
+  pSupporter->msg[0] = 0;
+  pSupporter->numOfRows = 0;
+  pSupporter->numOfParsedBytes = 0;
+
+  int32_t ret = tscLaunchImportWorkers(pSupporter);
+  if (ret != TSDB_CODE_SUCCESS) {
+    tscError("%p failed to launch import threads for file %s", pSql, pSupporter->path);
+    tscSetImportError(pSupporter, ret, NULL);
+    tscReleaseImportFile(pSupporter);
+    return false;
+  }
+
+  return true;
+}
+
+static void tscImportTableMetaCallback(void *param, TAOS_RES *tres, int code) {
+  SImportSupporter *pSupporter = (SImportSupporter *)param;
+  SSqlCmd *         pCmd = &pSupporter->pSql->cmd;
+
+  // the table meta has been put into cache, acquire it
+  if (code >= 0) {
+    STableMetaInfo *pTableMetaInfo = tscGetTableMetaInfoFromCmd(pCmd, pCmd->clauseIndex, 0);
+
+    code = tscGetTableMetaAsync(pSupporter->pSql, pTableMetaInfo, tscImportTableMetaCallback, pSupporter);
+    if (code == TSDB_CODE_ACTION_IN_PROGRESS) {
+      return;
+    }
+  }
 
-    strncpy(path, pDataBlock->filename, PATH_MAX);
+  if (code != TSDB_CODE_SUCCESS) {
+    tscError("%p get meter meta failed, code:%s, abort", pSupporter->pSql, tstrerror(code));
+  } else if (tscImportFile(pSupporter)) {
+    // the remain files are imported after current file is completed
+    return;
+  }
+
+  pSupporter->fileIndex += 1;
+  tscImportNextFile(pSupporter);
+}
 
-    FILE *fp = fopen(path, "r");
-    if (fp == NULL) {
-      tscError("%p failed to open file %s to load data from file, reason:%s", pSql, path, strerror(errno));
+static void tscImportNextFile(SImportSupporter *pSupporter) {
+  SSqlObj *pSql = pSupporter->pSql;
+  SSqlCmd *pCmd = &pSql->cmd;
+
+  STableMetaInfo *pTableMetaInfo = tscGetTableMetaInfoFromCmd(pCmd, pCmd->clauseIndex, 0);
+
+  for (; pSupporter->fileIndex < pSupporter->pFileList->nSize; ++pSupporter->fileIndex) {
+    STableDataBlocks *pDataBlock = pSupporter->pFileList->pData[pSupporter->fileIndex];
+    if (pDataBlock == NULL) {
       continue;
     }
 
+    strncpy(pSupporter->path, pDataBlock->filename, PATH_MAX);
     strncpy(pTableMetaInfo->name, pDataBlock->tableId, TSDB_TABLE_ID_LEN);
-    memset(pDataBlock->pData, 0, pDataBlock->nAllocSize);
 
-    int32_t ret = tscGetTableMeta(pSql, pTableMetaInfo);
+    // do not block the calling thread, which may be the rpc thread, when the table meta is not in cache
+    int32_t ret = tscGetTableMetaAsync(pSql, pTableMetaInfo, tscImportTableMetaCallback, pSupporter);
+    if (ret == TSDB_CODE_ACTION_IN_PROGRESS) {
+      return;
+    }
+
     if (ret != TSDB_CODE_SUCCESS) {
-      tscError("%p get meter meta failed, abort", pSql);
+      tscError("%p get meter meta failed, code:%s, abort", pSql, tstrerror(ret));
       continue;
     }
 
-    char *tmpTokenBuf = calloc(1, 4096);  // used for deleting Escape character: \\, \', \"
-    if (NULL == tmpTokenBuf) {
-      tscError("%p calloc failed", pSql);
-      continue;
+    if (tscImportFile(pSupporter)) {
+      // the remain files are imported after current file is completed
+      return;
     }
+  }
 
-    int nrows = tscInsertDataFromFile(pSql, fp, tmpTokenBuf);
-    free(tmpTokenBuf);
+  tscImportCompleted(pSupporter);
+}
 
-    pCmd->pDataBlocks = tscDestroyBlockArrayList(pCmd->pDataBlocks);
+void tscProcessMultiVnodesInsertFromFile(SSqlObj *pSql) {
+  SSqlCmd *pCmd = &pSql->cmd;
+  if (pCmd->command != TSDB_SQL_INSERT) {
+    return;
+  }
 
-    if (nrows < 0) {
-      fclose(fp);
-      tscTrace("%p no records(%d) in file %s", pSql, nrows, path);
-      continue;
+  assert(pCmd->dataSourceType == DATA_FROM_DATA_FILE && pCmd->pDataBlocks != NULL);
+  assert(pCmd->numOfClause == 1);
+
+  SImportSupporter *pSupporter = calloc(1, sizeof(SImportSupporter));
+  if (pSupporter == NULL) {
+    pSql->res.code = TSDB_CODE_CLI_OUT_OF_MEMORY;
+    tscQueueAsyncRes(pSql);
+    return;
+  }
+
+  pSupporter->pSql = pSql;
+  pSupporter->pFileList = pCmd->pDataBlocks;
+  pCmd->pDataBlocks = NULL;
+
+  tscImportNextFile(pSupporter);
+}
+
+/*
+ * The write buffer of a connection keeps one data block for each table. The data blocks of the insert statements
+ * are appended to them, and all buffered blocks are merged according to vgId and submitted by
+ * tscHandleMultivnodeInsert when the number of buffered rows reaches maxRows, the flush timer expires, or
+ * taos_flush is called.
+ */
+static void tscProcessWriteBufferTimer(void *handle, void *tmrId);
+
+static bool tscIsAppendableBlock(STableDataBlocks *pDst, STableDataBlocks *pBlock) {
+  SSubmitBlk *pDstBlk = (SSubmitBlk *)pDst->pData;
+  SSubmitBlk *pBlk = (SSubmitBlk *)pBlock->pData;
+
+  // the rows of client and server timestamp can not be mixed up in one block
+  return pDst->rowSize == pBlock->rowSize && pDstBlk->sversion == pBlk->sversion &&
+         pDst->tsSource == pBlock->tsSource && pDstBlk->numOfRows + pBlk->numOfRows <= INT16_MAX;
+}
+
+/*
+ * detach all buffered data blocks for submit, the caller should hold the lock of write buffer
+ */
+static SDataBlockList *tscDetachBufferedBlocks(SWriteBuffer *pBuf) {
+  if (pBuf->numOfRows == 0) {
+    return NULL;
+  }
+
+  SDataBlockList *pDataBlocks = tscCreateBlockArrayList();
+  void *          pTableList = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), false);
+  if (pDataBlocks == NULL || pTableList == NULL) {
+    tscDestroyBlockArrayList(pDataBlocks);
+    taosHashCleanup(pTableList);
+    return NULL;
+  }
+
+  SDataBlockList *pList = pBuf->pDataBlocks;
+  taosHashCleanup(pBuf->pTableList);
+
+  pBuf->pDataBlocks = pDataBlocks;
+  pBuf->pTableList = pTableList;
+  pBuf->numOfRows = 0;
+  pBuf->numOfFlushing += 1;
+
+  return pList;
+}
+
+static int32_t tscReserveBlockSpace(STableDataBlocks *pDst, uint32_t len) {
+  if (pDst->size + len <= pDst->nAllocSize) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  uint32_t nAllocSize = MAX(pDst->nAllocSize * 2, pDst->size + len);
+
+  char *tmp = realloc(pDst->pData, nAllocSize);
+  if (tmp == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  pDst->pData = tmp;
+  pDst->nAllocSize = nAllocSize;
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * the rows of a statement are buffered all or none. If the rows of any table can not be appended to the buffered
+ * ones, all buffered rows are detached for flush first, otherwise the space of the appended rows is reserved, so
+ * adding the rows into write buffer afterwards does not fail halfway. The caller should hold the lock of write buffer.
+ */
+static int32_t tscPrepareWriteBuffer(SWriteBuffer *pBuf, SDataBlockList *pList, SDataBlockList **pFlushList) {
+  for (int32_t i = 0; i < pList->nSize; ++i) {
+    STableDataBlocks * pBlock = pList->pData[i];
+    SSubmitBlk *       pBlk = (SSubmitBlk *)pBlock->pData;
+    STableDataBlocks **p = taosHashGet(pBuf->pTableList, (const char *)&pBlk->uid, sizeof(pBlk->uid));
+
+    if (p != NULL && !tscIsAppendableBlock(*p, pBlock)) {
+      *pFlushList = tscDetachBufferedBlocks(pBuf);
+      return (*pFlushList == NULL) ? TSDB_CODE_CLI_OUT_OF_MEMORY : TSDB_CODE_SUCCESS;
+    }
+  }
+
+  for (int32_t i = 0; i < pList->nSize; ++i) {
+    STableDataBlocks * pBlock = pList->pData[i];
+    SSubmitBlk *       pBlk = (SSubmitBlk *)pBlock->pData;
+    STableDataBlocks **p = taosHashGet(pBuf->pTableList, (const char *)&pBlk->uid, sizeof(pBlk->uid));
+
+    if (p != NULL) {
+      int32_t code = tscReserveBlockSpace(*p, pBlk->numOfRows * pBlock->rowSize);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
     }
+  }
 
-    fclose(fp);
-    affected_rows += nrows;
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * move the rows of one table into the write buffer. The data block is taken over if the table has no buffered
+ * rows, otherwise the rows are appended to the buffered data block of the table.
+ */
+static int32_t tscAddToWriteBuffer(SWriteBuffer *pBuf, SDataBlockList *pList, int32_t index) {
+  STableDataBlocks *pBlock = pList->pData[index];
+  SSubmitBlk *      pBlk = (SSubmitBlk *)pBlock->pData;
 
-    tscTrace("%p Insert data %d records from file %s", pSql, nrows, path);
+  STableDataBlocks **p = taosHashGet(pBuf->pTableList, (const char *)&pBlk->uid, sizeof(pBlk->uid));
+  if (p == NULL) {
+    taosHashPut(pBuf->pTableList, (const char *)&pBlk->uid, sizeof(pBlk->uid), (char *)&pBlock, POINTER_BYTES);
+    tscAppendDataBlock(pBuf->pDataBlocks, pBlock);
+
+    pList->pData[index] = NULL;
+    pBuf->numOfRows += pBlk->numOfRows;
+    return TSDB_CODE_SUCCESS;
+  }
+
+  STableDataBlocks *pDst = *p;
+  assert(tscIsAppendableBlock(pDst, pBlock));
+
+  uint32_t len = pBlk->numOfRows * pBlock->rowSize;
+  int32_t  code = tscReserveBlockSpace(pDst, len);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
   }
 
-  pSql->res.numOfRows = affected_rows;
+  if (pBlock->tsSource == TSDB_USE_CLI_TS) {
+    pDst->ordered = pDst->ordered && pBlock->ordered && GET_INT64_VAL(pBlk->data) > pDst->prevTS;
+    pDst->prevTS = pBlock->prevTS;
+  }
+
+  memcpy(pDst->pData + pDst->size, pBlk->data, len);
+  pDst->size += len;
+
+  SSubmitBlk *pDstBlk = (SSubmitBlk *)pDst->pData;
+  pDstBlk->numOfRows += pBlk->numOfRows;
+  pBuf->numOfRows += pBlk->numOfRows;
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static void tscWriteBufferFlushCompleted(SWriteBuffer *pBuf, int32_t code) {
+  pthread_mutex_lock(&pBuf->mutex);
+  if (code < 0 && pBuf->code == TSDB_CODE_SUCCESS) {
+    pBuf->code = code;
+  }
+
+  pBuf->numOfFlushing -= 1;
+  pthread_cond_broadcast(&pBuf->cond);
+  pthread_mutex_unlock(&pBuf->mutex);
+}
+
+static void tscWriteBufferFlushed(void *param, TAOS_RES *tres, int code) {
+  SSqlObj *     pSql = (SSqlObj *)param;
+  SWriteBuffer *pBuf = pSql->pTscObj->pWriteBuf;
+
+  if (code < 0) {
+    tscError("%p failed to flush write buffer, code:%s", pSql, tstrerror(code));
+  } else {
+    tscTrace("%p write buffer is flushed, rows:%" PRId64, pSql, pSql->res.numOfRows);
+  }
+
+  tscFreeSqlObj(pSql);
+  tscWriteBufferFlushCompleted(pBuf, code);
+}
+
+/*
+ * submit the detached data blocks with a standalone sql object, which is freed when all vnodes respond
+ */
+static void tscFlushBufferedBlocks(STscObj *pObj, SDataBlockList *pList) {
+  if (pList == NULL) {
+    return;
+  }
+
+  SSqlObj *pSql = calloc(1, sizeof(SSqlObj));
+  if (pSql == NULL) {
+    tscError("pObj:%p failed to allocate sql object to flush write buffer", pObj);
+
+    tscDestroyBlockArrayList(pList);
+    tscWriteBufferFlushCompleted(pObj->pWriteBuf, TSDB_CODE_CLI_OUT_OF_MEMORY);
+    return;
+  }
+
+  pSql->signature = pSql;
+  pSql->pTscObj = pObj;
+  pSql->maxRetry = TSDB_REPLICA_MAX_NUM;
+  pSql->sqlstr = strdup("insert buffered data");
+
+  SSqlCmd *pCmd = &pSql->cmd;
+  pCmd->command = TSDB_SQL_INSERT;
+  pCmd->pDataBlocks = pList;
+
+  SQueryInfo *pQueryInfo = NULL;
+  int32_t     code = tscAllocPayload(pCmd, TSDB_DEFAULT_PAYLOAD_SIZE);
+  if (code == TSDB_CODE_SUCCESS) {
+    code = tscGetQueryInfoDetailSafely(pCmd, 0, &pQueryInfo);
+  }
+
+  if (code == TSDB_CODE_SUCCESS && pSql->sqlstr == NULL) {
+    code = TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  if (code == TSDB_CODE_SUCCESS) {
+    TSDB_QUERY_SET_TYPE(pQueryInfo->type, TSDB_QUERY_TYPE_INSERT);
+
+    // the sub-insertions are created according to the first table
+    STableDataBlocks *pBlock = pList->pData[0];
+    STableMeta *      pTableMeta = taosCacheAcquireByData(tscCacheHandle, pBlock->pTableMeta);
+    tscAddTableMetaInfo(pQueryInfo, pBlock->tableId, pTableMeta, NULL, 0, NULL);
+
+    code = tscMergeTableDataBlocks(pSql, pList);
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    tscWriteBufferFlushed(pSql, NULL, code);
+    return;
+  }
+
+  tscTrace("%p flush write buffer of pObj:%p, vnodes:%d", pSql, pObj, pCmd->pDataBlocks->nSize);
+
+  pSql->param = pSql;
+  pSql->fetchFp = tscWriteBufferFlushed;
+  pSql->fp = (void(*)())tscHandleMultivnodeInsert;
+
+  code = tscHandleMultivnodeInsert(pSql);
+  if (code != TSDB_CODE_SUCCESS) {
+    tscWriteBufferFlushed(pSql, NULL, code);
+  }
+}
+
+void tscProcessBufferedInsert(SSqlObj *pSql) {
+  SSqlCmd *     pCmd = &pSql->cmd;
+  SSqlRes *     pRes = &pSql->res;
+  STscObj *     pObj = pSql->pTscObj;
+  SWriteBuffer *pBuf = pObj->pWriteBuf;
+
+  assert(pCmd->bufferedInsert && pBuf != NULL && pCmd->pDataBlocks != NULL);
+
+  SDataBlockList *pList = pCmd->pDataBlocks;
+  SDataBlockList *pFlushList[2] = {0};
+  int32_t         numOfRows = 0;
+  int32_t         code = TSDB_CODE_SUCCESS;
+
+  pthread_mutex_lock(&pBuf->mutex);
+
+  // nothing of the statement is buffered if it fails
+  code = tscPrepareWriteBuffer(pBuf, pList, &pFlushList[0]);
+  bool empty = (pBuf->numOfRows == 0);
+
+  for (int32_t i = 0; code == TSDB_CODE_SUCCESS && i < pList->nSize; ++i) {
+    SSubmitBlk *pBlk = (SSubmitBlk *)pList->pData[i]->pData;
+
+    numOfRows += pBlk->numOfRows;
+    code = tscAddToWriteBuffer(pBuf, pList, i);
+  }
+
+  if (pBuf->numOfRows >= pBuf->maxRows) {
+    pFlushList[1] = tscDetachBufferedBlocks(pBuf);
+  } else if (empty && pBuf->numOfRows > 0 && pBuf->flushInterval > 0 && pBuf->pTimer == NULL) {
+    // the timer keeps a reference of the write buffer until it is fired or stopped
+    atomic_add_fetch_32(&pBuf->refCount, 1);
+    pBuf->pTimer = taosTmrStart(tscProcessWriteBufferTimer, pBuf->flushInterval, pBuf, tscTmr);
+    if (pBuf->pTimer == NULL) {
+      atomic_sub_fetch_32(&pBuf->refCount, 1);
+    }
+  }
+
+  pthread_mutex_unlock(&pBuf->mutex);
+
+  for (int32_t i = 0; i < tListLen(pFlushList); ++i) {
+    tscFlushBufferedBlocks(pObj, pFlushList[i]);
+  }
 
-  // all data have been submit to vnode, release data blocks
   pCmd->pDataBlocks = tscDestroyBlockArrayList(pCmd->pDataBlocks);
-  tscDestroyBlockArrayList(pDataBlockList);
+
+  if (code != TSDB_CODE_SUCCESS) {
+    pRes->code = code;
+    tscQueueAsyncRes(pSql);
+    return;
+  }
+
+  tscTrace("%p %d rows are kept in write buffer", pSql, numOfRows);
+
+  pRes->numOfRows = numOfRows;
+  pSql->fp = pSql->fetchFp;
+  (*pSql->fp)(pSql->param, pSql, numOfRows);
+}
+
+static void tscReleaseWriteBuffer(SWriteBuffer *pBuf) {
+  if (atomic_sub_fetch_32(&pBuf->refCount, 1) > 0) {
+    return;
+  }
+
+  tscDestroyBlockArrayList(pBuf->pDataBlocks);
+  taosHashCleanup(pBuf->pTableList);
+  pthread_mutex_destroy(&pBuf->mutex);
+  pthread_cond_destroy(&pBuf->cond);
+  free(pBuf);
+}
+
+static void tscProcessWriteBufferTimer(void *handle, void *tmrId) {
+  SWriteBuffer *  pBuf = (SWriteBuffer *)handle;
+  SDataBlockList *pList = NULL;
+
+  pthread_mutex_lock(&pBuf->mutex);
+  if (pBuf->pTimer == tmrId) {
+    pBuf->pTimer = NULL;
+  }
+
+  // once closed, the connection may be released, and the buffered rows are flushed by the closing thread
+  STscObj *pObj = pBuf->pObj;
+  if (!pBuf->closed) {
+    pList = tscDetachBufferedBlocks(pBuf);
+  }
+  pthread_mutex_unlock(&pBuf->mutex);
+
+  tscFlushBufferedBlocks(pObj, pList);
+  tscReleaseWriteBuffer(pBuf);
+}
+
+int32_t tscSetWriteBuffer(STscObj *pObj, int32_t maxRows, int32_t flushInterval) {
+  if (maxRows <= 0) {
+    return tscDestroyWriteBuffer(pObj);
+  }
+
+  if (flushInterval < 0) {
+    return TSDB_CODE_INVALID_VALUE;
+  }
+
+  SWriteBuffer *pBuf = pObj->pWriteBuf;
+  if (pBuf != NULL) {
+    pthread_mutex_lock(&pBuf->mutex);
+    pBuf->maxRows = maxRows;
+    pBuf->flushInterval = flushInterval;
+    pthread_mutex_unlock(&pBuf->mutex);
+    return TSDB_CODE_SUCCESS;
+  }
+
+  pBuf = calloc(1, sizeof(SWriteBuffer));
+  if (pBuf == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  pBuf->pDataBlocks = tscCreateBlockArrayList();
+  pBuf->pTableList = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), false);
+  if (pBuf->pDataBlocks == NULL || pBuf->pTableList == NULL) {
+    tscDestroyBlockArrayList(pBuf->pDataBlocks);
+    taosHashCleanup(pBuf->pTableList);
+    free(pBuf);
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  pBuf->pObj = pObj;
+  pBuf->refCount = 1;
+  pBuf->maxRows = maxRows;
+  pBuf->flushInterval = flushInterval;
+  pthread_mutex_init(&pBuf->mutex, NULL);
+  pthread_cond_init(&pBuf->cond, NULL);
+
+  pObj->pWriteBuf = pBuf;
+  tscTrace("pObj:%p write buffer is enabled, maxRows:%d, flushInterval:%dms", pObj, maxRows, flushInterval);
+
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * submit all buffered rows and wait for the completion of all flushes in progress, the first error since the
+ * last call is returned.
+ */
+int32_t tscFlushWriteBuffer(STscObj *pObj) {
+  SWriteBuffer *pBuf = pObj->pWriteBuf;
+  if (pBuf == NULL) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  pthread_mutex_lock(&pBuf->mutex);
+  SDataBlockList *pList = tscDetachBufferedBlocks(pBuf);
+  int32_t         numOfRows = pBuf->numOfRows;
+  pthread_mutex_unlock(&pBuf->mutex);
+
+  tscFlushBufferedBlocks(pObj, pList);
+
+  pthread_mutex_lock(&pBuf->mutex);
+  while (pBuf->numOfFlushing > 0) {
+    pthread_cond_wait(&pBuf->cond, &pBuf->mutex);
+  }
+
+  int32_t code = pBuf->code;
+  pBuf->code = TSDB_CODE_SUCCESS;
+  pthread_mutex_unlock(&pBuf->mutex);
+
+  // failed to detach the buffered rows due to out of memory
+  if (code == TSDB_CODE_SUCCESS && numOfRows > 0) {
+    code = TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  return code;
+}
+
+int32_t tscDestroyWriteBuffer(STscObj *pObj) {
+  SWriteBuffer *pBuf = pObj->pWriteBuf;
+  if (pBuf == NULL) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  /*
+   * the timer callback may be running, it leaves the buffer alone once it is closed. The reference of the timer is
+   * released here only if it is stopped before fired.
+   */
+  pthread_mutex_lock(&pBuf->mutex);
+  pBuf->closed = true;
+
+  bool stopped = (pBuf->pTimer != NULL) && taosTmrStop(pBuf->pTimer);
+  if (stopped) {
+    pBuf->pTimer = NULL;
+  }
+  pthread_mutex_unlock(&pBuf->mutex);
+
+  if (stopped) {
+    tscReleaseWriteBuffer(pBuf);
+  }
+
+  // the flushes launched by the timer before closed are waited here
+  int32_t code = tscFlushWriteBuffer(pObj);
+
+  pObj->pWriteBuf = NULL;
+  if (pBuf->numOfRows > 0) {
+    tscError("pObj:%p %d buffered rows are discarded", pObj, pBuf->numOfRows);
+  }
+
+  tscReleaseWriteBuffer(pBuf);
+
+  tscTrace("pObj:%p write buffer is disabled", pObj);
+  return code;
 }
@@ -20,9 +20,13 @@
 #include "taosmsg.h"
 #include "tstrbuild.h"
 #include "tscLog.h"
+#include "tschemautil.h"
+#include "ttokendef.h"
+#include "hash.h"
 
 int tsParseInsertSql(SSqlObj *pSql);
 int taos_query_imp(STscObj* pObj, SSqlObj* pSql);
+int validateTableName(char *tblName, int len);
 
 ////////////////////////////////////////////////////////////////////////////////
 // functions for normal statement preparation
@@ -42,15 +46,20 @@ typedef struct SNormalStmt {
   tVariant*        params;
 } SNormalStmt;
 
-//typedef struct SInsertStmt {
-//
-//} SInsertStmt;
+typedef struct SInsertStmt {
+  uint32_t  batchDataSize;  // size of the rows generated by one set of parameters
+  int32_t   rowsPerBatch;   // number of rows generated by one set of parameters
+  char*     tplData;        // rows generated during preparation, template for the tables set by taos_stmt_set_tbname
+  SHashObj* pTableBlocks;   // uid -> STableDataBlocks*, bound data of the tables that have been switched out
+  int8_t    rspReceived;    // the submit callback is invoked, and rspSem is or is about to be posted
+} SInsertStmt;
 
 typedef struct STscStmt {
   bool isInsert;
   STscObj* taos;
   SSqlObj* pSql;
   SNormalStmt normal;
+  SInsertStmt insert;
 } STscStmt;
 
 
@@ -375,6 +384,203 @@ static int insertStmtBindParam(STscStmt* stmt, TAOS_BIND* bind) {
   return TSDB_CODE_SUCCESS;
 }
 
+static FORCE_INLINE bool isMultiBindNull(TAOS_MULTI_BIND* bind, int32_t row) {
+  return (bind->is_null != NULL) && (bind->is_null[row >> 3u] & (1u << (row & 7u)));
+}
+
+/*
+ * bind one column of all rows, the type is checked only once for all rows, and the values are copied into
+ * the submit block directly. The rows generated by each set of parameters are batchDataSize bytes apart.
+ */
+static int doBindBatchParam(char* data, uint32_t batchDataSize, SParamInfo* param, TAOS_MULTI_BIND* bind) {
+  if (bind->buffer_type != param->type) {
+    return TSDB_CODE_INVALID_VALUE;
+  }
+
+  short size = 0;
+  switch(param->type) {
+    case TSDB_DATA_TYPE_BOOL:
+    case TSDB_DATA_TYPE_TINYINT:
+      size = 1;
+      break;
+
+    case TSDB_DATA_TYPE_SMALLINT:
+      size = 2;
+      break;
+
+    case TSDB_DATA_TYPE_INT:
+    case TSDB_DATA_TYPE_FLOAT:
+      size = 4;
+      break;
+
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_DOUBLE:
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      size = 8;
+      break;
+
+    case TSDB_DATA_TYPE_BINARY:
+      if (bind->length == NULL) {
+        return TSDB_CODE_INVALID_VALUE;
+      }
+
+      for (int32_t i = 0; i < bind->num; ++i) {
+        char* dst = data + batchDataSize * i + param->offset;
+        if (isMultiBindNull(bind, i)) {
+          setNull(dst, param->type, param->bytes);
+          continue;
+        }
+
+        int32_t len = bind->length[i];
+        if (len > param->bytes) {
+          return TSDB_CODE_INVALID_VALUE;
+        }
+
+        memcpy(dst, (char*)bind->buffer + bind->buffer_length * i, len);
+        if (len < param->bytes) {
+          dst[len] = 0;
+        }
+      }
+      return TSDB_CODE_SUCCESS;
+
+    case TSDB_DATA_TYPE_NCHAR:
+      if (bind->length == NULL) {
+        return TSDB_CODE_INVALID_VALUE;
+      }
+
+      for (int32_t i = 0; i < bind->num; ++i) {
+        char* dst = data + batchDataSize * i + param->offset;
+        if (isMultiBindNull(bind, i)) {
+          setNull(dst, param->type, param->bytes);
+          continue;
+        }
+
+        if (!taosMbsToUcs4((char*)bind->buffer + bind->buffer_length * i, bind->length[i], dst, param->bytes)) {
+          return TSDB_CODE_INVALID_VALUE;
+        }
+      }
+      return TSDB_CODE_SUCCESS;
+
+    default:
+      assert(false);
+      return TSDB_CODE_INVALID_VALUE;
+  }
+
+  size_t step = (bind->buffer_length > 0) ? bind->buffer_length : (size_t)size;
+  const char* src = bind->buffer;
+  char* dst = data + param->offset;
+
+  if (bind->is_null == NULL) {
+    for (int32_t i = 0; i < bind->num; ++i, src += step, dst += batchDataSize) {
+      memcpy(dst, src, size);
+    }
+  } else {
+    for (int32_t i = 0; i < bind->num; ++i, src += step, dst += batchDataSize) {
+      if (isMultiBindNull(bind, i)) {
+        setNull(dst, param->type, param->bytes);
+      } else {
+        memcpy(dst, src, size);
+      }
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static int insertStmtBindParamBatch(STscStmt* stmt, TAOS_MULTI_BIND* bind) {
+  SSqlCmd* pCmd = &stmt->pSql->cmd;
+
+  int32_t num = (pCmd->numOfParams > 0) ? bind[0].num : 0;
+  if (num <= 0) {
+    return TSDB_CODE_INVALID_VALUE;
+  }
+
+  for (int32_t i = 1; i < pCmd->numOfParams; ++i) {
+    if (bind[i].num != num) {
+      tscTrace("param %d: number of rows mismatch, %d, expected:%d", i, bind[i].num, num);
+      return TSDB_CODE_INVALID_VALUE;
+    }
+  }
+
+  // the parameters that have been bound but not added are added as one batch implicitly
+  if ((pCmd->batchSize % 2) == 1) {
+    ++pCmd->batchSize;
+  }
+
+  int32_t binded = pCmd->batchSize / 2;
+  int32_t alloced = (binded > 0) ? binded : 1;
+
+  for (int32_t i = 0; i < pCmd->pDataBlocks->nSize; ++i) {
+    STableDataBlocks* pBlock = pCmd->pDataBlocks->pData[i];
+    uint32_t          totalDataSize = pBlock->size - sizeof(SSubmitBlk);
+    uint32_t          dataSize = totalDataSize / alloced;
+    assert(dataSize * alloced == totalDataSize);
+
+    uint32_t needed = sizeof(SSubmitBlk) + dataSize * (binded + num);
+    if (needed > pBlock->nAllocSize) {
+      const double factor = 1.5;
+      void* tmp = realloc(pBlock->pData, (uint32_t)(needed * factor));
+      if (tmp == NULL) {
+        return TSDB_CODE_CLI_OUT_OF_MEMORY;
+      }
+      pBlock->pData = (char*)tmp;
+      pBlock->nAllocSize = (uint32_t)(needed * factor);
+    }
+
+    char* data = pBlock->pData + sizeof(SSubmitBlk) + dataSize * binded;
+
+    // the columns that are not parameters keep the values of the first batch
+    uint32_t paramBytes = 0;
+    for (uint32_t j = 0; j < pBlock->numOfParams; ++j) {
+      paramBytes += pBlock->params[j].bytes;
+    }
+
+    if (paramBytes < dataSize) {
+      for (int32_t k = (binded == 0) ? 1 : 0; k < num; ++k) {
+        memcpy(data + dataSize * k, pBlock->pData + sizeof(SSubmitBlk), dataSize);
+      }
+    }
+
+    for (uint32_t j = 0; j < pBlock->numOfParams; ++j) {
+      SParamInfo* param = pBlock->params + j;
+      int code = doBindBatchParam(data, dataSize, param, bind + param->idx);
+      if (code != TSDB_CODE_SUCCESS) {
+        tscTrace("param %d: type mismatch or invalid", param->idx);
+        return code;
+      }
+    }
+  }
+
+  // all data blocks are bound successfully, update the block size, number of rows and the order flag
+  for (int32_t i = 0; i < pCmd->pDataBlocks->nSize; ++i) {
+    STableDataBlocks* pBlock = pCmd->pDataBlocks->pData[i];
+    SSubmitBlk*       pSubmit = (SSubmitBlk*)pBlock->pData;
+
+    uint32_t dataSize = (pBlock->size - sizeof(SSubmitBlk)) / alloced;
+    int32_t  rowsPerBatch = pSubmit->numOfRows / alloced;
+
+    pBlock->size = sizeof(SSubmitBlk) + dataSize * (binded + num);
+    pSubmit->numOfRows = rowsPerBatch * (binded + num);
+
+    if (pBlock->ordered) {
+      int32_t start = (binded > 0) ? (rowsPerBatch * binded - 1) : 0;
+      TSKEY   prev = *(TSKEY*)(pSubmit->data + pBlock->rowSize * start);
+
+      for (int32_t k = start + 1; k < pSubmit->numOfRows; ++k) {
+        TSKEY key = *(TSKEY*)(pSubmit->data + pBlock->rowSize * k);
+        if (key <= prev) {
+          pBlock->ordered = false;
+          break;
+        }
+        prev = key;
+      }
+    }
+  }
+
+  pCmd->batchSize = (binded + num) * 2;
+  return TSDB_CODE_SUCCESS;
+}
+
 static int insertStmtAddBatch(STscStmt* stmt) {
   SSqlCmd* pCmd = &stmt->pSql->cmd;
   if ((pCmd->batchSize % 2) == 1) {
@@ -388,7 +594,225 @@ static int insertStmtPrepare(STscStmt* stmt) {
   pSql->cmd.numOfParams = 0;
   pSql->cmd.batchSize = 0;
 
-  return tsParseInsertSql(pSql);
+  int code = tsParseInsertSql(pSql);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  // keep the rows of single table statement as the template for other tables
+  SDataBlockList* pList = pSql->cmd.pDataBlocks;
+  if (pList != NULL && pList->nSize == 1) {
+    STableDataBlocks* pBlock = pList->pData[0];
+    SInsertStmt*      insert = &stmt->insert;
+
+    insert->batchDataSize = pBlock->size - sizeof(SSubmitBlk);
+    insert->rowsPerBatch = ((SSubmitBlk*)pBlock->pData)->numOfRows;
+    insert->tplData = malloc(insert->batchDataSize);
+    if (insert->tplData == NULL) {
+      return TSDB_CODE_CLI_OUT_OF_MEMORY;
+    }
+
+    memcpy(insert->tplData, pBlock->pData + sizeof(SSubmitBlk), insert->batchDataSize);
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static void insertStmtDestroyTableBlocks(SInsertStmt* insert) {
+  if (insert->pTableBlocks == NULL) {
+    return;
+  }
+
+  SHashMutableIterator* pIter = taosHashCreateIter(insert->pTableBlocks);
+  while (taosHashIterNext(pIter)) {
+    STableDataBlocks** p = taosHashIterGet(pIter);
+    tscDestroyDataBlock(*p);
+  }
+
+  taosHashDestroyIter(pIter);
+  taosHashCleanup(insert->pTableBlocks);
+  insert->pTableBlocks = NULL;
+}
+
+/*
+ * move the data block of current table out of the submit list, the bound rows are kept until
+ * the table is set again or the statement is executed.
+ */
+static int insertStmtParkCurrentTable(STscStmt* stmt) {
+  SSqlCmd*     pCmd = &stmt->pSql->cmd;
+  SInsertStmt* insert = &stmt->insert;
+
+  if ((pCmd->batchSize % 2) == 1) {
+    ++pCmd->batchSize;
+  }
+
+  STableDataBlocks* pBlock = pCmd->pDataBlocks->pData[0];
+  pCmd->pDataBlocks->pData[0] = NULL;
+  pCmd->pDataBlocks->nSize = 0;
+
+  if (pCmd->batchSize == 0) {  // nothing is bound for this table yet
+    tscDestroyDataBlock(pBlock);
+    return TSDB_CODE_SUCCESS;
+  }
+
+  if (insert->pTableBlocks == NULL) {
+    insert->pTableBlocks = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), false);
+    if (insert->pTableBlocks == NULL) {
+      tscDestroyDataBlock(pBlock);
+      return TSDB_CODE_CLI_OUT_OF_MEMORY;
+    }
+  }
+
+  uint64_t uid = pBlock->pTableMeta->uid;
+  taosHashPut(insert->pTableBlocks, (const char*)&uid, sizeof(uid), &pBlock, POINTER_BYTES);
+  pCmd->batchSize = 0;
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static int insertStmtCreateTableBlock(STscStmt* stmt, STableMetaInfo* pTableMetaInfo, STableDataBlocks** pBlock) {
+  SInsertStmt* insert = &stmt->insert;
+  STableMeta*  pTableMeta = pTableMetaInfo->pTableMeta;
+  STableDataBlocks* pTpl = stmt->pSql->cmd.pDataBlocks->pData[0];
+
+  size_t initialSize = sizeof(SSubmitBlk) + insert->batchDataSize;
+  if (initialSize < TSDB_DEFAULT_PAYLOAD_SIZE) {
+    initialSize = TSDB_DEFAULT_PAYLOAD_SIZE;
+  }
+
+  STableDataBlocks* pNew = NULL;
+  int32_t code = tscCreateDataBlock(initialSize, pTpl->rowSize, sizeof(SSubmitBlk), pTableMetaInfo->name, pTableMeta,
+                                    &pNew);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  pNew->params = malloc(sizeof(SParamInfo) * pTpl->numOfParams);
+  if (pNew->params == NULL) {
+    tscDestroyDataBlock(pNew);
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  memcpy(pNew->params, pTpl->params, sizeof(SParamInfo) * pTpl->numOfParams);
+  pNew->numOfParams = pTpl->numOfParams;
+  pNew->numOfAllocedParams = pTpl->numOfParams;
+
+  memcpy(pNew->pData + sizeof(SSubmitBlk), insert->tplData, insert->batchDataSize);
+  pNew->size = sizeof(SSubmitBlk) + insert->batchDataSize;
+
+  SSubmitBlk* pSubmit = (SSubmitBlk*)pNew->pData;
+  pSubmit->tid = pTableMeta->sid;
+  pSubmit->uid = pTableMeta->uid;
+  pSubmit->sversion = pTableMeta->sversion;
+  pSubmit->numOfRows = insert->rowsPerBatch;
+
+  pNew->vgId = pTableMeta->vgroupInfo.vgId;
+  pNew->numOfTables = 1;
+
+  *pBlock = pNew;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int insertStmtSetTableName(STscStmt* stmt, const char* name) {
+  SSqlObj*     pSql = stmt->pSql;
+  SSqlCmd*     pCmd = &pSql->cmd;
+  SInsertStmt* insert = &stmt->insert;
+
+  // only the statement with one table and without table name in sql string can switch table
+  if (insert->tplData == NULL || pCmd->pDataBlocks == NULL || pCmd->pDataBlocks->nSize != 1) {
+    return TSDB_CODE_OPS_NOT_SUPPORT;
+  }
+
+  char tableName[TSDB_TABLE_ID_LEN] = {0};
+  size_t len = strlen(name);
+  if (len == 0 || len >= tListLen(tableName)) {
+    return TSDB_CODE_INVALID_TABLE;
+  }
+
+  strtolower(tableName, name);
+  if (validateTableName(tableName, (int)len) != TSDB_CODE_SUCCESS) {
+    return TSDB_CODE_INVALID_TABLE;
+  }
+
+  STableMetaInfo*   pTableMetaInfo = tscGetTableMetaInfoFromCmd(pCmd, pCmd->clauseIndex, 0);
+  STableDataBlocks* pCur = pCmd->pDataBlocks->pData[0];
+
+  // the new table is resolved and checked aside, a rejected name leaves the statement bound to the current table
+  STableMetaInfo newInfo = {0};
+
+  SSQLToken token = {.z = tableName, .n = (uint32_t)len, .type = TK_ID};
+  int32_t code = tscSetTableId(&newInfo, &token, pSql);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  if (strncmp(newInfo.name, pCur->tableId, tListLen(pCur->tableId)) == 0) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  code = tscGetTableMetaSync(pSql, &newInfo);
+  if (code != TSDB_CODE_SUCCESS) {
+    goto _error;
+  }
+
+  if (UTIL_TABLE_IS_SUPERTABLE(&newInfo)) {
+    code = TSDB_CODE_INVALID_TABLE_TYPE;
+    goto _error;
+  }
+
+  // the schema of the new table must be identical to the prepared one, e.g., tables of the same super table
+  STableComInfo tinfo = tscGetTableInfo(newInfo.pTableMeta);
+  STableComInfo tplInfo = tscGetTableInfo(pCur->pTableMeta);
+  if (tinfo.numOfColumns != tplInfo.numOfColumns || tinfo.rowSize != tplInfo.rowSize) {
+    code = TSDB_CODE_INVALID_TABLE;
+    goto _error;
+  }
+
+  SSchema* pSchema = tscGetTableSchema(newInfo.pTableMeta);
+  SSchema* pTplSchema = tscGetTableSchema(pCur->pTableMeta);
+  for (int32_t i = 0; i < tinfo.numOfColumns; ++i) {
+    if (pSchema[i].type != pTplSchema[i].type || pSchema[i].bytes != pTplSchema[i].bytes) {
+      code = TSDB_CODE_INVALID_TABLE;
+      goto _error;
+    }
+  }
+
+  STableDataBlocks* pBlock = NULL;
+  int32_t           binded = 0;
+  uint64_t          uid = newInfo.pTableMeta->uid;
+
+  if (insert->pTableBlocks != NULL) {
+    STableDataBlocks** p = taosHashGet(insert->pTableBlocks, (const char*)&uid, sizeof(uid));
+    if (p != NULL) {
+      pBlock = *p;
+      binded = (pBlock->size - sizeof(SSubmitBlk)) / insert->batchDataSize;
+      taosHashRemove(insert->pTableBlocks, (const char*)&uid, sizeof(uid));
+    }
+  }
+
+  if (pBlock == NULL) {
+    code = insertStmtCreateTableBlock(stmt, &newInfo, &pBlock);
+    if (code != TSDB_CODE_SUCCESS) {
+      goto _error;
+    }
+  }
+
+  // all checks passed, now the statement is bound to the new table
+  tscClearMeterMetaInfo(pTableMetaInfo, false);
+  strncpy(pTableMetaInfo->name, newInfo.name, tListLen(pTableMetaInfo->name));
+  pTableMetaInfo->pTableMeta = newInfo.pTableMeta;
+
+  code = insertStmtParkCurrentTable(stmt);
+  pCmd->pDataBlocks->pData[0] = pBlock;
+  pCmd->pDataBlocks->nSize = 1;
+
+  // the rows bound before the table was switched out are kept, new rows are appended after them
+  pCmd->batchSize = binded * 2;
+  return code;
+
+_error:
+  tscClearMeterMetaInfo(&newInfo, false);
+  return code;
 }
 
 static int insertStmtReset(STscStmt* pStmt) {
@@ -406,14 +830,61 @@ static int insertStmtReset(STscStmt* pStmt) {
     }
   }
   pCmd->batchSize = 0;
+  insertStmtDestroyTableBlocks(&pStmt->insert);
   
   STableMetaInfo* pTableMetaInfo = tscGetTableMetaInfoFromCmd(pCmd, pCmd->clauseIndex, 0);
   pTableMetaInfo->vgroupIndex = 0;
   return TSDB_CODE_SUCCESS;
 }
 
+// put the data blocks of all tables set by taos_stmt_set_tbname into the submit list
+static int insertStmtCollectTableBlocks(STscStmt* stmt) {
+  SSqlCmd*     pCmd = &stmt->pSql->cmd;
+  SInsertStmt* insert = &stmt->insert;
+
+  int code = insertStmtParkCurrentTable(stmt);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  SHashMutableIterator* pIter = taosHashCreateIter(insert->pTableBlocks);
+  while (taosHashIterNext(pIter)) {
+    STableDataBlocks** p = taosHashIterGet(pIter);
+    tscAppendDataBlock(pCmd->pDataBlocks, *p);
+  }
+
+  taosHashDestroyIter(pIter);
+  taosHashCleanup(insert->pTableBlocks);
+  insert->pTableBlocks = NULL;
+
+  pCmd->batchSize = (pCmd->pDataBlocks->nSize > 0) ? 2 : 0;
+  return TSDB_CODE_SUCCESS;
+}
+
+static void insertStmtRspCallback(void* param, TAOS_RES* tres, int code) {
+  STscStmt* stmt = (STscStmt*)param;
+  SSqlObj*  pSql = stmt->pSql;
+
+  // set before the result code, so an error code seen by insertStmtExecute tells if the semaphore is to be posted
+  atomic_store_8(&stmt->insert.rspReceived, 1);
+
+  // valid error code is less than 0
+  if (code < 0) {
+    pSql->res.code = code;
+  }
+
+  tsem_post(&pSql->rspSem);
+}
+
 static int insertStmtExecute(STscStmt* stmt) {
   SSqlCmd* pCmd = &stmt->pSql->cmd;
+  if (stmt->insert.pTableBlocks != NULL) {
+    int code = insertStmtCollectTableBlocks(stmt);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+  }
+
   if (pCmd->batchSize == 0) {
     return TSDB_CODE_INVALID_VALUE;
   }
@@ -451,7 +922,19 @@ static int insertStmtExecute(STscStmt* stmt) {
   
   pRes->qhandle = 0;
 
+  // the submit is sent asynchronously, wait for the responses of all vnodes
+  pSql->fp = insertStmtRspCallback;
+  pSql->param = stmt;
+  stmt->insert.rspReceived = 0;
+
+  /*
+   * an error may be set by the callback, or by tscDoQuery itself without invoking the callback. The semaphore is
+   * consumed in the former case, otherwise the next execution would return before its own response.
+   */
   tscDoQuery(pSql);
+  if (pRes->code == TSDB_CODE_SUCCESS || atomic_load_8(&stmt->insert.rspReceived)) {
+    tsem_wait(&pSql->rspSem);
+  }
 
   // tscTrace("%p SQL result:%d, %s pObj:%p", pSql, pRes->code, taos_errstr(taos), pObj);
   if (pRes->code != TSDB_CODE_SUCCESS) {
@@ -490,6 +973,7 @@ TAOS_STMT* taos_stmt_init(TAOS* taos) {
   tsem_init(&pSql->rspSem, 0, 0);
   pSql->signature = pSql;
   pSql->pTscObj = pObj;
+  pSql->pStmt = pStmt;
 
   pStmt->pSql = pSql;
   return pStmt;
@@ -531,6 +1015,9 @@ int taos_stmt_close(TAOS_STMT* stmt) {
     }
     free(normal->parts);
     free(normal->sql);
+  } else {
+    insertStmtDestroyTableBlocks(&pStmt->insert);
+    free(pStmt->insert.tplData);
   }
 
   tscFreeSqlObj(pStmt->pSql);
@@ -546,6 +1033,22 @@ int taos_stmt_bind_param(TAOS_STMT* stmt, TAOS_BIND* bind) {
   return normalStmtBindParam(pStmt, bind);
 }
 
+int taos_stmt_bind_param_batch(TAOS_STMT* stmt, TAOS_MULTI_BIND* bind) {
+  STscStmt* pStmt = (STscStmt*)stmt;
+  if (pStmt->isInsert) {
+    return insertStmtBindParamBatch(pStmt, bind);
+  }
+  return TSDB_CODE_OPS_NOT_SUPPORT;
+}
+
+int taos_stmt_set_tbname(TAOS_STMT* stmt, const char* name) {
+  STscStmt* pStmt = (STscStmt*)stmt;
+  if (pStmt->isInsert) {
+    return insertStmtSetTableName(pStmt, name);
+  }
+  return TSDB_CODE_OPS_NOT_SUPPORT;
+}
+
 int taos_stmt_add_batch(TAOS_STMT* stmt) {
   STscStmt* pStmt = (STscStmt*)stmt;
   if (pStmt->isInsert) {
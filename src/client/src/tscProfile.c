@@ -54,6 +54,7 @@ void tscAddIntoSqlList(SSqlObj *pSql) {
   if (pObj->sqlList) pObj->sqlList->prev = pSql;
   pObj->sqlList = pSql;
   pSql->queryId = queryId++;
+  pObj->hbVersion++;
 
   pthread_mutex_unlock(&pObj->mutex);
 
@@ -121,6 +122,7 @@ void tscRemoveFromSqlList(SSqlObj *pSql) {
     pObj->sqlList = pSql->next;
 
   if (pSql->next) pSql->next->prev = pSql->prev;
+  pObj->hbVersion++;
 
   pthread_mutex_unlock(&pObj->mutex);
 
@@ -159,6 +161,7 @@ void tscAddIntoStreamList(SSqlStream *pStream) {
   if (pObj->streamList) pObj->streamList->prev = pStream;
   pObj->streamList = pStream;
   pStream->streamId = streamId++;
+  pObj->hbVersion++;
 
   pthread_mutex_unlock(&pObj->mutex);
 
@@ -178,6 +181,7 @@ void tscRemoveFromStreamList(SSqlStream *pStream, SSqlObj *pSqlObj) {
     pObj->streamList = pStream->next;
 
   if (pStream->next) pStream->next->prev = pStream->prev;
+  pObj->hbVersion++;
 
   pthread_mutex_unlock(&pObj->mutex);
 
@@ -212,7 +216,8 @@ char *tscBuildQueryStreamDesc(char *pMsg, STscObj *pObj) {
   SQqueryList *pQList = (SQqueryList *)pMsg;
   char *  pMax = pMsg + TSDB_PAYLOAD_SIZE - 256;
 
-  SQueryDesc *pQdesc = pQList->qdesc;
+  // the descriptions follow the list in message, the pointer in the list is not used
+  SQueryDesc *pQdesc = (SQueryDesc *)(pMsg + sizeof(SQqueryList));
   pQList->numOfQueries = 0;
 
   // We extract the lock to tscBuildHeartBeatMsg function.
@@ -244,7 +249,7 @@ char *tscBuildQueryStreamDesc(char *pMsg, STscObj *pObj) {
   }
 
   SStreamList *pSList = (SStreamList *)pMsg;
-  SStreamDesc *pSdesc = pSList->sdesc;
+  SStreamDesc *pSdesc = (SStreamDesc *)(pMsg + sizeof(SStreamList));
   pSList->numOfStreams = 0;
 
   pMsg += sizeof(SStreamList);
@@ -1497,6 +1497,7 @@ int32_t addExprAndResultField(SQueryInfo* pQueryInfo, int32_t colIndex, tSQLExpr
   const char* msg4 = "invalid table name";
   const char* msg5 = "parameter is out of range [0, 100]";
   const char* msg6 = "function applied to tags not allowed";
+  const char* msg7 = "invalid algorithm for apercentile, 'default' or 't-digest' is expected";
 
   switch (optr) {
     case TK_COUNT: {
@@ -1772,8 +1773,10 @@ int32_t addExprAndResultField(SQueryInfo* pQueryInfo, int32_t colIndex, tSQLExpr
     case TK_BOTTOM:
     case TK_PERCENTILE:
     case TK_APERCENTILE: {
-      // 1. valid the number of parameters
-      if (pItem->pNode->pParam == NULL || pItem->pNode->pParam->nExpr != 2) {
+      // 1. valid the number of parameters, apercentile accepts the name of algorithm as the optional third parameter
+      int32_t maxParams = (optr == TK_APERCENTILE) ? 3 : 2;
+      if (pItem->pNode->pParam == NULL || pItem->pNode->pParam->nExpr < 2 ||
+          pItem->pNode->pParam->nExpr > maxParams) {
         /* no parameters or more than one parameter for function */
         return invalidSqlErrMsg(pQueryInfo->msg, msg2);
       }
@@ -1836,8 +1839,26 @@ int32_t addExprAndResultField(SQueryInfo* pQueryInfo, int32_t colIndex, tSQLExpr
           return TSDB_CODE_INVALID_SQL;
         }
 
+        int64_t algo = APERCT_ALGO_DEFAULT;
+        if (pItem->pNode->pParam->nExpr == 3) {
+          tVariant* pAlgo = &pParamElem[2].pNode->val;
+          if (pParamElem[2].pNode->nSQLOptr == TK_ID || pAlgo->nType != TSDB_DATA_TYPE_BINARY) {
+            return invalidSqlErrMsg(pQueryInfo->msg, msg2);
+          }
+
+          if (strncasecmp(pAlgo->pz, "t-digest", pAlgo->nLen) == 0 && pAlgo->nLen == strlen("t-digest")) {
+            algo = APERCT_ALGO_TDIGEST;
+          } else if (strncasecmp(pAlgo->pz, "default", pAlgo->nLen) != 0 || pAlgo->nLen != strlen("default")) {
+            return invalidSqlErrMsg(pQueryInfo->msg, msg7);
+          }
+        }
+
         pExpr = tscSqlExprAppend(pQueryInfo, functionId, &index, resultType, resultSize, resultSize);
         addExprParams(pExpr, val, TSDB_DATA_TYPE_DOUBLE, sizeof(double), 0);
+
+        if (algo != APERCT_ALGO_DEFAULT) {
+          addExprParams(pExpr, (char*)&algo, TSDB_DATA_TYPE_BIGINT, sizeof(int64_t), 0);
+        }
       } else {
         tVariantDump(pVariant, val, TSDB_DATA_TYPE_BIGINT);
 
@@ -2174,7 +2195,7 @@ int32_t setShowInfo(SSqlObj* pSql, struct SSqlInfo* pInfo) {
         return invalidSqlErrMsg(tscGetErrorMsgPayload(pCmd), msg6);
       }
 
-      if (pCmd->payloadLen > TSDB_TABLE_NAME_LEN) {
+      if (pPattern->n > TSDB_TABLE_NAME_LEN) {
         return invalidSqlErrMsg(tscGetErrorMsgPayload(pCmd), msg2);
       }
     }
@@ -5848,7 +5869,7 @@ int32_t exprTreeFromSqlExpr(tExprNode **pExpr, tSQLExpr* pSqlExpr, SArray* pExpr
   }
   
   if (pSqlExpr->pLeft == NULL) {
-    if (pSqlExpr->nSQLOptr >= TK_TINYINT && pSqlExpr->nSQLOptr <= TK_DOUBLE) {
+    if (pSqlExpr->nSQLOptr >= TK_BOOL && pSqlExpr->nSQLOptr <= TK_STRING) {  // string value in tag filters
       *pExpr = calloc(1, sizeof(tExprNode));
       (*pExpr)->nodeType = TSQL_NODE_VALUE;
       (*pExpr)->pVal = calloc(1, sizeof(tVariant));
@@ -15,12 +15,14 @@
 
 #include "tscSecondaryMerge.h"
 #include "os.h"
+#include "tglobal.h"
 #include "tlosertree.h"
 #include "tscUtil.h"
 #include "tschemautil.h"
 #include "tsclient.h"
 #include "tutil.h"
 #include "tscLog.h"
+#include "ttime.h"
 
 typedef struct SCompareParam {
   SLocalDataSource **pLocalData;
@@ -55,6 +57,251 @@ int32_t treeComparator(const void *pLeft, const void *pRight, void *param) {
   }
 }
 
+typedef struct SMergeWorker {
+  SLocalDataSource **pDataSrc;
+  int32_t            numOfSrc;
+  tOrderDescriptor * pDesc;
+  int32_t            groupOrderType;
+  tExtMemBuffer *    pOutput;  // merged result of all the data sources
+  int32_t            code;
+  bool               launched;  // merged in a separated thread
+  pthread_t          thread;
+} SMergeWorker;
+
+/*
+ * merge a subset of the sorted data sources into one sorted run with a private loser tree,
+ * the data sources of different workers can be loaded concurrently
+ */
+static void *tscMergeDataSourceImpl(void *param) {
+  SMergeWorker * pWorker = (SMergeWorker *)param;
+  tExtMemBuffer *pOutput = pWorker->pOutput;
+  int32_t        capacity = pWorker->pDataSrc[0]->pMemBuffer->numOfElemsPerPage;
+
+  SCompareParam cparam = {
+      .pLocalData = pWorker->pDataSrc,
+      .pDesc = pWorker->pDesc,
+      .numOfElems = capacity,
+      .groupOrderType = pWorker->groupOrderType,
+  };
+
+  SLoserTreeInfo *pTree = NULL;
+  tFilePage *     pPage = (tFilePage *)calloc(1, pOutput->pageSize);
+  if (pPage == NULL || tLoserTreeCreate(&pTree, pWorker->numOfSrc, &cparam, treeComparator) != TSDB_CODE_SUCCESS) {
+    pWorker->code = TSDB_CODE_CLI_OUT_OF_MEMORY;
+    tfree(pPage);
+    return NULL;
+  }
+
+  int32_t numOfCompleted = 0;
+  while (numOfCompleted < pWorker->numOfSrc) {
+    int32_t           index = pTree->pNode[0].index;
+    SLocalDataSource *pSrc = pWorker->pDataSrc[index];
+
+    tColModelAppend(pOutput->pColumnModel, pPage, pSrc->filePage.data, pSrc->rowIdx, 1, capacity);
+    if (pPage->numOfElems == pOutput->numOfElemsPerPage) {
+      if (tExtMemBufferPut(pOutput, pPage->data, pPage->numOfElems) < 0) {
+        pWorker->code = TSDB_CODE_CLI_NO_DISKSPACE;
+        break;
+      }
+
+      pPage->numOfElems = 0;
+    }
+
+    if (++pSrc->rowIdx >= pSrc->filePage.numOfElems) {
+      tFlushoutInfo *pInfo = &pSrc->pMemBuffer->fileMeta.flushoutData.pFlushoutInfo[pSrc->flushoutIdx];
+
+      pSrc->rowIdx = 0;
+      pSrc->pageId += 1;
+
+      if (pSrc->pageId >= pInfo->numOfPages) {
+        pSrc->rowIdx = -1;
+        pSrc->pageId = -1;
+        numOfCompleted += 1;
+      } else if (!tExtMemBufferLoadData(pSrc->pMemBuffer, &pSrc->filePage, pSrc->flushoutIdx, pSrc->pageId)) {
+        pWorker->code = TSDB_CODE_CLI_NO_DISKSPACE;
+        break;
+      }
+    }
+
+    tLoserTreeAdjust(pTree, index + pWorker->numOfSrc);
+  }
+
+  if (pWorker->code == TSDB_CODE_SUCCESS && pPage->numOfElems > 0) {
+    tColModelCompact(pOutput->pColumnModel, pPage, pOutput->numOfElemsPerPage);
+    if (tExtMemBufferPut(pOutput, pPage->data, pPage->numOfElems) < 0) {
+      pWorker->code = TSDB_CODE_CLI_NO_DISKSPACE;
+    }
+  }
+
+  if (pWorker->code == TSDB_CODE_SUCCESS && !tExtMemBufferFlush(pOutput)) {
+    pWorker->code = TSDB_CODE_CLI_NO_DISKSPACE;
+  }
+
+  tfree(pTree);
+  tfree(pPage);
+  return NULL;
+}
+
+/*
+ * With hundreds of sorted runs from vnodes, the single loser tree of the final merge stage becomes the bottleneck.
+ * The runs are split into several partitions, and each partition is merged into one run by a separated thread, so
+ * that the final merge only works on a few runs.
+ *
+ * The merge buffers and data sources are always owned by the reducer, so they are released by tscDestroyLocalReducer
+ * whatever the result is.
+ */
+static int32_t tscMergeDataSourceInParallel(SLocalReducer *pReducer, int32_t groupOrderType, void *pSqlObjAddr) {
+  int32_t numOfThreads = pReducer->numOfBuffer / TSC_MERGE_MIN_SOURCES_PER_THREAD;
+  numOfThreads = MIN(numOfThreads, MIN(tsNumOfCores, TSC_MERGE_MAX_THREADS));
+  if (numOfThreads < 2) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  pReducer->pMergeBuffer = (tExtMemBuffer **)calloc(numOfThreads, POINTER_BYTES);
+  if (pReducer->pMergeBuffer == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  SMergeWorker *pWorkers = (SMergeWorker *)calloc(numOfThreads, sizeof(SMergeWorker));
+  if (pWorkers == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  int64_t st = taosGetTimestampUs();
+
+  tExtMemBuffer *pFirst = pReducer->pLocalDataSrc[0]->pMemBuffer;
+  int32_t        start = 0;
+
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    SMergeWorker *pWorker = &pWorkers[i];
+    int32_t       end = (int32_t)((int64_t)pReducer->numOfBuffer * (i + 1) / numOfThreads);
+
+    pWorker->pDataSrc = &pReducer->pLocalDataSrc[start];
+    pWorker->numOfSrc = end - start;
+    pWorker->pDesc = pReducer->pDesc;
+    pWorker->groupOrderType = groupOrderType;
+
+    pWorker->pOutput = createExtMemBuffer(pFirst->inMemCapacity * pFirst->pageSize, pFirst->nElemSize,
+                                          pReducer->pDesc->pColumnModel);
+    if (pWorker->pOutput == NULL) {
+      tfree(pWorkers);
+      return TSDB_CODE_CLI_OUT_OF_MEMORY;
+    }
+
+    pWorker->pOutput->flushModel = SINGLE_APPEND_MODEL;
+    pWorker->pOutput->compressed = true;
+
+    pReducer->pMergeBuffer[pReducer->numOfMergeBuffer++] = pWorker->pOutput;
+    start = end;
+  }
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+  // the last partition is merged in current thread
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    SMergeWorker *pWorker = &pWorkers[i];
+    if (i < numOfThreads - 1 && pthread_create(&pWorker->thread, &attr, tscMergeDataSourceImpl, pWorker) == 0) {
+      pWorker->launched = true;
+    } else {
+      tscMergeDataSourceImpl(pWorker);
+    }
+  }
+
+  pthread_attr_destroy(&attr);
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    if (pWorkers[i].launched) {
+      pthread_join(pWorkers[i].thread, NULL);
+    }
+
+    if (pWorkers[i].code != TSDB_CODE_SUCCESS) {
+      code = pWorkers[i].code;
+    }
+  }
+
+  tfree(pWorkers);
+  if (code != TSDB_CODE_SUCCESS) {
+    tscError("%p failed to merge data sources in parallel, code:%d", pSqlObjAddr, code);
+    return code;
+  }
+
+  // replace the original data sources with the merged runs
+  int32_t numOfSrc = pReducer->numOfBuffer;
+  for (int32_t i = 0; i < numOfSrc; ++i) {
+    tfree(pReducer->pLocalDataSrc[i]);
+  }
+
+  pReducer->numOfBuffer = 0;
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    tExtMemBuffer *pOutput = pReducer->pMergeBuffer[i];
+    if (pOutput->numOfTotalElems == 0) {
+      continue;
+    }
+
+    SLocalDataSource *pDS = (SLocalDataSource *)calloc(1, sizeof(SLocalDataSource) + pOutput->pageSize);
+    if (pDS == NULL) {
+      return TSDB_CODE_CLI_OUT_OF_MEMORY;
+    }
+
+    pDS->pMemBuffer = pOutput;
+    pDS->flushoutIdx = 0;
+    pDS->pageId = 0;
+    pDS->rowIdx = 0;
+
+    pReducer->pLocalDataSrc[pReducer->numOfBuffer++] = pDS;
+    if (!tExtMemBufferLoadData(pOutput, &pDS->filePage, 0, 0)) {
+      return TSDB_CODE_CLI_NO_DISKSPACE;
+    }
+  }
+
+  tscTrace("%p %d data sources are merged into %d by %d threads, elapsed time:%" PRId64 " us", pSqlObjAddr, numOfSrc,
+           pReducer->numOfBuffer, numOfThreads, taosGetTimestampUs() - st);
+
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * the pre-merge is postponed to the first local reduce, which is invoked by the thread that fetches the results, so
+ * that the rpc thread that receives the last sub-query result is not blocked by the merge.
+ */
+static int32_t tscPreMergeDataSources(SSqlObj *pSql, SLocalReducer *pReducer) {
+  SQueryInfo *pQueryInfo = tscGetQueryInfoDetail(&pSql->cmd, pSql->cmd.clauseIndex);
+
+  pReducer->needPreMerge = false;
+  int32_t code = tscMergeDataSourceInParallel(pReducer, pQueryInfo->groupbyExpr.orderType, pSql);
+  if (code != TSDB_CODE_SUCCESS || pReducer->numOfMergeBuffer == 0) {
+    return code;
+  }
+
+  // rebuild the loser tree on the merged runs, the compare parameter is kept
+  SCompareParam *param = pReducer->pLoserTree->param;
+  tfree(pReducer->pLoserTree);
+
+  code = tLoserTreeCreate(&pReducer->pLoserTree, pReducer->numOfBuffer, param, treeComparator);
+  if (pReducer->pLoserTree == NULL) {
+    tfree(param);
+  }
+
+  return code;
+}
+
+static void tscDestroyUnusedReducer(SLocalReducer *pReducer, SColumnModel *finalmodel) {
+  for (int32_t i = 0; i < pReducer->numOfBuffer; ++i) {
+    tfree(pReducer->pLocalDataSrc[i]);
+  }
+
+  if (pReducer->pLoserTree != NULL) {
+    tfree(pReducer->pLoserTree->param);
+    tfree(pReducer->pLoserTree);
+  }
+
+  tscLocalReducerEnvDestroy(pReducer->pExtMemBuffer, pReducer->pDesc, finalmodel, pReducer->numOfVnode);
+  free(pReducer);
+}
+
 static void tscInitSqlContext(SSqlCmd *pCmd, SSqlRes *pRes, SLocalReducer *pReducer, tOrderDescriptor *pDesc) {
   /*
    * the fields and offset attributes in pCmd and pModel may be different due to
@@ -203,6 +450,7 @@ void tscCreateLocalReducer(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrd
       SLocalDataSource *pDS = (SLocalDataSource *)malloc(sizeof(SLocalDataSource) + pMemBuffer[0]->pageSize);
       if (pDS == NULL) {
         tscError("%p failed to create merge structure", pSqlObjAddr);
+        tscDestroyUnusedReducer(pReducer, finalmodel);
         pRes->code = TSDB_CODE_CLI_OUT_OF_MEMORY;
         return;
       }
@@ -235,22 +483,37 @@ void tscCreateLocalReducer(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrd
     }
   }
   assert(idx >= pReducer->numOfBuffer);
+  pReducer->numOfBuffer = idx;
+
   if (idx == 0) {
+    tscDestroyUnusedReducer(pReducer, finalmodel);
     return;
   }
 
-  pReducer->numOfBuffer = idx;
+  SQueryInfo *pQueryInfo = tscGetQueryInfoDetail(pCmd, pCmd->clauseIndex);
+
+  // queries with limit clause are not pre-merged, since only a few results are required in the final merge
+  pReducer->needPreMerge = (pQueryInfo->limit.limit < 0 && pQueryInfo->clauseLimit < 0);
 
   SCompareParam *param = malloc(sizeof(SCompareParam));
+  if (param == NULL) {
+    tscDestroyUnusedReducer(pReducer, finalmodel);
+    pRes->code = TSDB_CODE_CLI_OUT_OF_MEMORY;
+    return;
+  }
+
   param->pLocalData = pReducer->pLocalDataSrc;
   param->pDesc = pReducer->pDesc;
   param->numOfElems = pReducer->pLocalDataSrc[0]->pMemBuffer->numOfElemsPerPage;
-  SQueryInfo *pQueryInfo = tscGetQueryInfoDetail(pCmd, pCmd->clauseIndex);
-
   param->groupOrderType = pQueryInfo->groupbyExpr.orderType;
 
   pRes->code = tLoserTreeCreate(&pReducer->pLoserTree, pReducer->numOfBuffer, param, treeComparator);
   if (pReducer->pLoserTree == NULL || pRes->code != 0) {
+    if (pReducer->pLoserTree == NULL) {
+      tfree(param);
+    }
+
+    tscDestroyUnusedReducer(pReducer, finalmodel);
     return;
   }
 
@@ -298,7 +561,9 @@ void tscCreateLocalReducer(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrd
     tfree(pReducer->pFinalRes);
     tfree(pReducer->pBufForInterpo);
     tfree(pReducer->prevRowOfInput);
+    tfree(pReducer->pCtx);
 
+    tscDestroyUnusedReducer(pReducer, finalmodel);
     pRes->code = TSDB_CODE_CLI_OUT_OF_MEMORY;
     return;
   }
@@ -502,6 +767,12 @@ void tscDestroyLocalReducer(SSqlObj *pSql) {
 
     tscLocalReducerEnvDestroy(pLocalReducer->pExtMemBuffer, pLocalReducer->pDesc, pLocalReducer->resColModel,
                               pLocalReducer->numOfVnode);
+    for (int32_t i = 0; i < pLocalReducer->numOfMergeBuffer; ++i) {
+      destoryExtMemBuffer(pLocalReducer->pMergeBuffer[i]);
+    }
+
+    tfree(pLocalReducer->pMergeBuffer);
+
     for (int32_t i = 0; i < pLocalReducer->numOfBuffer; ++i) {
       tfree(pLocalReducer->pLocalDataSrc[i]);
     }
@@ -609,7 +880,9 @@ int32_t tscLocalReducerEnvCreate(SSqlObj *pSql, tExtMemBuffer ***pMemBuffer, tOr
   SQueryInfo *    pQueryInfo = tscGetQueryInfoDetail(pCmd, pCmd->clauseIndex);
   STableMetaInfo *pTableMetaInfo = tscGetMetaInfo(pQueryInfo, 0);
 
-  (*pMemBuffer) = (tExtMemBuffer **)malloc(POINTER_BYTES * 1);
+  size_t numOfSubs = pTableMetaInfo->vgroupList->numOfVgroups;
+
+  (*pMemBuffer) = (tExtMemBuffer **)calloc(numOfSubs, POINTER_BYTES);
   if (*pMemBuffer == NULL) {
     tscError("%p failed to allocate memory", pSql);
     pRes->code = TSDB_CODE_CLI_OUT_OF_MEMORY;
@@ -642,10 +915,10 @@ int32_t tscLocalReducerEnvCreate(SSqlObj *pSql, tExtMemBuffer ***pMemBuffer, tOr
   
   pModel = createColumnModel(pSchema, size, capacity);
 
-  size_t numOfSubs = pTableMetaInfo->vgroupList->numOfVgroups;
   for (int32_t i = 0; i < numOfSubs; ++i) {
     (*pMemBuffer)[i] = createExtMemBuffer(nBufferSizes, rlen, pModel);
     (*pMemBuffer)[i]->flushModel = MULTIPLE_APPEND_MODEL;
+    (*pMemBuffer)[i]->compressed = true;
   }
 
   if (createOrderDescriptor(pOrderDesc, pCmd, pModel) != TSDB_CODE_SUCCESS) {
@@ -1045,6 +1318,11 @@ static void doExecuteSecondaryMerge(SSqlCmd *pCmd, SLocalReducer *pLocalReducer,
 
     tVariantAssign(&pCtx->param[0], &pExpr->param[0]);
 
+    // the algorithm of apercentile decides the layout of the intermediate result
+    if (pExpr->functionId == TSDB_FUNC_APERCT && pExpr->numOfParams > 1) {
+      tVariantAssign(&pCtx->param[1], &pExpr->param[1]);
+    }
+
     // tags/tags_dummy function, the tag field of SQLFunctionCtx is from the input buffer
     int32_t functionId = pExpr->functionId;
     if (functionId == TSDB_FUNC_TAG_DUMMY || functionId == TSDB_FUNC_TAG || functionId == TSDB_FUNC_TS_DUMMY) {
@@ -1440,6 +1718,15 @@ int32_t tscDoLocalreduce(SSqlObj *pSql) {
     return TSDB_CODE_SUCCESS;
   }
 
+  if (pLocalReducer->needPreMerge) {
+    int32_t code = tscPreMergeDataSources(pSql, pLocalReducer);
+    if (code != TSDB_CODE_SUCCESS) {
+      tscError("%p failed to pre-merge data sources, code:%d", pSql, code);
+      pLocalReducer->status = TSC_LOCALREDUCE_READY;
+      return code;
+    }
+  }
+
   tFilePage *tmpBuffer = pLocalReducer->pTempBuffer;
 
   if (doHandleLastRemainData(pSql)) {
@@ -29,6 +29,7 @@
 #include "tscLog.h"
 
 #define TSC_MGMT_VNODE 999
+#define TSC_HB_FULL_ROUNDS 10  // counters of running queries and streams are refreshed once every so many heartbeats
 
 SRpcIpSet  tscMgmtIpSet;
 SRpcIpSet  tscDnodeIpSet;
@@ -133,6 +134,9 @@ void tscProcessHeartBeatRsp(void *param, TAOS_RES *tres, int code) {
     SRpcIpSet *      pIpList = &pRsp->ipList;
     tscSetMgmtIpList(pIpList);
 
+    // the lists carried by the heartbeat are known by mnode now
+    pObj->hbAckedVersion = pObj->hbSentVersion;
+
     if (pRsp->killConnection) {
       tscKillConnection(pObj);
     } else {
@@ -143,7 +147,19 @@ void tscProcessHeartBeatRsp(void *param, TAOS_RES *tres, int code) {
     tscTrace("heart beat failed, code:%d", code);
   }
 
-  taosTmrReset(tscProcessActivityTimer, tsShellActivityTimer * 500, pObj, tscTmr, &pObj->pTimer);
+  /*
+   * an idle connection has nothing to report or to kill, its heartbeat only keeps the connection alive, so the
+   * interval is doubled, but kept below the idle time of mnode, otherwise the connection is closed and built again
+   */
+  int32_t minDelay = tsShellActivityTimer * 500;
+  int32_t maxDelay = tsShellActivityTimer * 750;
+
+  pthread_mutex_lock(&pObj->mutex);
+  bool idle = (code == 0 && pObj->sqlList == NULL && pObj->streamList == NULL && pObj->hbVersion == pObj->hbAckedVersion);
+  pthread_mutex_unlock(&pObj->mutex);
+
+  pObj->hbDelay = idle ? MIN(MAX(pObj->hbDelay * 2, minDelay), maxDelay) : minDelay;
+  taosTmrReset(tscProcessActivityTimer, pObj->hbDelay, pObj, tscTmr, &pObj->pTimer);
 }
 
 void tscProcessActivityTimer(void *handle, void *tmrId) {
@@ -390,6 +406,7 @@ int doProcessSql(SSqlObj *pSql) {
       pCmd->command == TSDB_SQL_CONNECT ||
       pCmd->command == TSDB_SQL_HB ||
       pCmd->command == TSDB_SQL_META ||
+      pCmd->command == TSDB_SQL_MULTI_META ||
       pCmd->command == TSDB_SQL_STABLEVGROUP) {
     tscBuildMsg[pCmd->command](pSql, NULL);
   }
@@ -678,19 +695,34 @@ int tscBuildQueryMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
     pQueryMsg->window.ekey = htobe64(pQueryInfo->window.skey);
   }
 
+  int64_t  limit = pQueryInfo->limit.limit;
+  int64_t  offset = pQueryInfo->limit.offset;
+  uint16_t queryType = pQueryInfo->type;
+
+  /*
+   * the global order of projection query on super table is restored at the client side, so each table only needs to
+   * provide its first offset+limit rows, instead of all qualified rows.
+   */
+  if (tscOrderedProjectionQueryOnSTable(pQueryInfo, 0) && pQueryInfo->clauseLimit > 0 &&
+      !QUERY_IS_JOIN_QUERY(pQueryInfo->type)) {
+    limit = pQueryInfo->clauseLimit + pQueryInfo->prjOffset;
+    offset = 0;
+    TSDB_QUERY_SET_TYPE(queryType, TSDB_QUERY_TYPE_TABLE_LIMIT);
+  }
+
   pQueryMsg->numOfTables    = htonl(numOfTables);
   pQueryMsg->order          = htons(pQueryInfo->order.order);
   pQueryMsg->orderColId     = htons(pQueryInfo->order.orderColId);
   pQueryMsg->interpoType    = htons(pQueryInfo->interpoType);
-  pQueryMsg->limit          = htobe64(pQueryInfo->limit.limit);
-  pQueryMsg->offset         = htobe64(pQueryInfo->limit.offset);
+  pQueryMsg->limit          = htobe64(limit);
+  pQueryMsg->offset         = htobe64(offset);
   pQueryMsg->numOfCols      = htons(taosArrayGetSize(pQueryInfo->colList));
   pQueryMsg->intervalTime   = htobe64(pQueryInfo->intervalTime);
   pQueryMsg->slidingTime    = htobe64(pQueryInfo->slidingTime);
   pQueryMsg->slidingTimeUnit = pQueryInfo->slidingTimeUnit;
   pQueryMsg->numOfGroupCols = htons(pQueryInfo->groupbyExpr.numOfGroupCols);
 
-  pQueryMsg->queryType = htons(pQueryInfo->type);
+  pQueryMsg->queryType = htons(queryType);
   
   size_t numOfOutput = tscSqlExprNumOfExprs(pQueryInfo);
   pQueryMsg->numOfOutput = htons(numOfOutput);
@@ -1151,7 +1183,7 @@ int32_t tscBuildShowMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
     pShowMsg->payloadLen = htons(pIpAddr->n);
   }
 
-  pCmd->payloadLen = sizeof(SCMShowMsg) + pShowMsg->payloadLen;
+  pCmd->payloadLen = sizeof(SCMShowMsg) + htons(pShowMsg->payloadLen);
   return TSDB_CODE_SUCCESS;
 }
 
@@ -1531,34 +1563,18 @@ int tscBuildTableMetaMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
 
 /**
  *  multi table meta req pkg format:
- *  | SMgmtHead | SCMMultiTableInfoMsg | tableId0 | tableId1 | tableId2 | ......
- *      no used         4B
+ *  | SCMMultiTableInfoMsg | tableId0 | tableId1 | tableId2 | ......
+ *            4B              TSDB_TABLE_ID_LEN for each table id
+ *
+ *  the table ids are already placed in the payload, with the room of SCMMultiTableInfoMsg reserved ahead.
  **/
 int tscBuildMultiMeterMetaMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
   SSqlCmd *pCmd = &pSql->cmd;
 
-  // copy payload content to temp buff
-  char *tmpData = 0;
-  if (pCmd->payloadLen > 0) {
-    tmpData = calloc(1, pCmd->payloadLen + 1);
-    if (NULL == tmpData) return -1;
-    memcpy(tmpData, pCmd->payload, pCmd->payloadLen);
-  }
-
-  // fill head info
-  SMgmtHead *pMgmt = (SMgmtHead *)(pCmd->payload + tsRpcHeadSize);
-  memset(pMgmt->db, 0, TSDB_TABLE_ID_LEN);  // server don't need the db
-
-  SCMMultiTableInfoMsg *pInfoMsg = (SCMMultiTableInfoMsg *)(pCmd->payload + tsRpcHeadSize + sizeof(SMgmtHead));
+  SCMMultiTableInfoMsg *pInfoMsg = (SCMMultiTableInfoMsg *)pCmd->payload;
   pInfoMsg->numOfTables = htonl((int32_t)pCmd->count);
 
-  if (pCmd->payloadLen > 0) {
-    memcpy(pInfoMsg->tableIds, tmpData, pCmd->payloadLen);
-  }
-
-  tfree(tmpData);
-
-  pCmd->payloadLen += sizeof(SMgmtHead) + sizeof(SCMMultiTableInfoMsg);
+  pCmd->payloadLen = sizeof(SCMMultiTableInfoMsg) + pCmd->count * TSDB_TABLE_ID_LEN;
   pCmd->msgType = TSDB_MSG_TYPE_CM_TABLES_META;
 
   assert(pCmd->payloadLen + minMsgSize() <= pCmd->allocSize);
@@ -1759,7 +1775,7 @@ int tscEstimateHeartBeatMsgLength(SSqlObj *pSql) {
   STscObj *pObj = pSql->pTscObj;
 
   size += tsRpcHeadSize + sizeof(SMgmtHead);
-  size += sizeof(SQqueryList);
+  size += sizeof(SCMHeartBeatMsg);
 
   SSqlObj *tpSql = pObj->sqlList;
   while (tpSql) {
@@ -1801,7 +1817,22 @@ int tscBuildHeartBeatMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
   strcpy(pMgmt->db, pObj->db);
   pMsg += sizeof(SMgmtHead);
 
-  pMsg = tscBuildQueryStreamDesc(pMsg, pObj);
+  // lists are only carried when they changed since the last acked heartbeat, or the counters of running
+  // queries and streams are due for a refresh
+  bool unchanged = (pObj->hbVersion == pObj->hbAckedVersion);
+  bool hasList = (pObj->sqlList != NULL || pObj->streamList != NULL);
+  if (unchanged && hasList && ++pObj->hbRounds >= TSC_HB_FULL_ROUNDS) unchanged = false;
+  if (!unchanged) pObj->hbRounds = 0;
+
+  SCMHeartBeatMsg *pHeartBeat = (SCMHeartBeatMsg *)pMsg;
+  pHeartBeat->version = htonl(pObj->hbVersion);
+  pHeartBeat->unchanged = unchanged;
+  pObj->hbSentVersion = pObj->hbVersion;
+  pMsg = (char *)&pHeartBeat->qlist;
+
+  if (!unchanged) {
+    pMsg = tscBuildQueryStreamDesc(pMsg, pObj);
+  }
   pthread_mutex_unlock(&pObj->mutex);
 
   msgLen = pMsg - pStart;
@@ -1812,16 +1843,13 @@ int tscBuildHeartBeatMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
   return msgLen;
 }
 
-int tscProcessTableMetaRsp(SSqlObj *pSql) {
-  STableMetaMsg *pMetaMsg = (STableMetaMsg *)pSql->res.pRsp;
-
+static int32_t tscDecodeTableMetaMsg(STableMetaMsg *pMetaMsg) {
   pMetaMsg->sid = htonl(pMetaMsg->sid);
   pMetaMsg->sversion = htons(pMetaMsg->sversion);
   
   pMetaMsg->vgroup.vgId = htonl(pMetaMsg->vgroup.vgId);
   
   pMetaMsg->uid = htobe64(pMetaMsg->uid);
-  pMetaMsg->contLen = htons(pMetaMsg->contLen);
   pMetaMsg->numOfColumns = htons(pMetaMsg->numOfColumns);
 
   if (pMetaMsg->sid < 0 || pMetaMsg->vgroup.numOfIps < 0) {
@@ -1857,6 +1885,18 @@ int tscProcessTableMetaRsp(SSqlObj *pSql) {
     pSchema++;
   }
 
+  return TSDB_CODE_SUCCESS;
+}
+
+int tscProcessTableMetaRsp(SSqlObj *pSql) {
+  STableMetaMsg *pMetaMsg = (STableMetaMsg *)pSql->res.pRsp;
+  pMetaMsg->contLen = htons(pMetaMsg->contLen);
+
+  int32_t code = tscDecodeTableMetaMsg(pMetaMsg);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
   size_t size = 0;
   STableMeta* pTableMeta = tscCreateTableMetaFromMsg(pMetaMsg, &size);
 
@@ -1890,110 +1930,58 @@ int tscProcessTableMetaRsp(SSqlObj *pSql) {
 
 /**
  *  multi table meta rsp pkg format:
- *  | STaosRsp | ieType | SCMMultiTableInfoMsg | SMeterMeta0 | SSchema0 | SMeterMeta1 | SSchema1 | SMeterMeta2 | SSchema2
- *  |...... 1B        1B            4B
+ *  | SMultiTableMeta | STableMetaMsg0 | SSchema0 | STableMetaMsg1 | SSchema1 | ......
+ *
+ *  the tables that do not exist are absent in the rsp, and the retrieved metas are put into the cache, so the
+ *  routines that wait for them will find them there.
  **/
 int tscProcessMultiMeterMetaRsp(SSqlObj *pSql) {
-#if 0
-  char *rsp = pSql->res.pRsp;
+  SSqlRes *pRes = &pSql->res;
 
-  ieType = *rsp;
-  if (ieType != TSDB_IE_TYPE_META) {
-    tscError("invalid ie type:%d", ieType);
-    pSql->res.code = TSDB_CODE_INVALID_IE;
-    pSql->res.numOfTotal = 0;
-    return TSDB_CODE_OTHERS;
+  SMultiTableMeta *pMultiMeta = (SMultiTableMeta *)pRes->pRsp;
+  if (pRes->rspLen < sizeof(SMultiTableMeta)) {
+    tscError("%p invalid multi-metermeta rsp, len:%d", pSql, pRes->rspLen);
+    return TSDB_CODE_INVALID_VALUE;
   }
 
-  rsp++;
+  pMultiMeta->numOfTables = htonl(pMultiMeta->numOfTables);
+  pMultiMeta->contLen = htonl(pMultiMeta->contLen);
+
+  char *pMsg = pMultiMeta->metas;
+  char *pEnd = pRes->pRsp + MIN(pMultiMeta->contLen, pRes->rspLen);
+
+  int32_t i = 0;
+  for (; i < pMultiMeta->numOfTables; ++i) {
+    STableMetaMsg *pMetaMsg = (STableMetaMsg *)pMsg;
+    if (pMsg + sizeof(STableMetaMsg) > pEnd) {
+      break;
+    }
 
-  SCMMultiTableInfoMsg *pInfo = (SCMMultiTableInfoMsg *)rsp;
-  totalNum = htonl(pInfo->numOfTables);
-  rsp += sizeof(SCMMultiTableInfoMsg);
+    pMetaMsg->contLen = htons(pMetaMsg->contLen);
+    if (pMetaMsg->contLen < sizeof(STableMetaMsg) || pMsg + pMetaMsg->contLen > pEnd) {
+      break;
+    }
 
-  for (i = 0; i < totalNum; i++) {
-    SMultiTableMeta *pMultiMeta = (SMultiTableMeta *)rsp;
-    STableMeta *     pMeta = pMultiMeta->metas;
+    pMsg += pMetaMsg->contLen;
 
-    pMeta->sid = htonl(pMeta->sid);
-    pMeta->sversion = htons(pMeta->sversion);
-    pMeta->vgId = htonl(pMeta->vgId);
-    pMeta->uid = htobe64(pMeta->uid);
+    if (tscDecodeTableMetaMsg(pMetaMsg) != TSDB_CODE_SUCCESS) {
+      continue;
+    }
 
-    if (pMeta->sid <= 0 || pMeta->vgId < 0) {
-      tscError("invalid meter vgId:%d, sid%d", pMeta->vgId, pMeta->sid);
-      pSql->res.code = TSDB_CODE_INVALID_VALUE;
-      pSql->res.numOfTotal = i;
-      return TSDB_CODE_OTHERS;
+    size_t      size = 0;
+    STableMeta *pTableMeta = tscCreateTableMetaFromMsg(pMetaMsg, &size);
+    if (pTableMeta == NULL) {
+      return TSDB_CODE_CLI_OUT_OF_MEMORY;
     }
 
-    //    pMeta->numOfColumns = htons(pMeta->numOfColumns);
-    //
-    //    if (pMeta->numOfTags > TSDB_MAX_TAGS || pMeta->numOfTags < 0) {
-    //      tscError("invalid tag value count:%d", pMeta->numOfTags);
-    //      pSql->res.code = TSDB_CODE_INVALID_VALUE;
-    //      pSql->res.numOfTotal = i;
-    //      return TSDB_CODE_OTHERS;
-    //    }
-    //
-    //    if (pMeta->numOfTags > TSDB_MAX_TAGS || pMeta->numOfTags < 0) {
-    //      tscError("invalid numOfTags:%d", pMeta->numOfTags);
-    //      pSql->res.code = TSDB_CODE_INVALID_VALUE;
-    //      pSql->res.numOfTotal = i;
-    //      return TSDB_CODE_OTHERS;
-    //    }
-    //
-    //    if (pMeta->numOfColumns > TSDB_MAX_COLUMNS || pMeta->numOfColumns < 0) {
-    //      tscError("invalid numOfColumns:%d", pMeta->numOfColumns);
-    //      pSql->res.code = TSDB_CODE_INVALID_VALUE;
-    //      pSql->res.numOfTotal = i;
-    //      return TSDB_CODE_OTHERS;
-    //    }
-    //
-    //    for (int j = 0; j < TSDB_REPLICA_MAX_NUM; ++j) {
-    //      pMeta->vpeerDesc[j].vnode = htonl(pMeta->vpeerDesc[j].vnode);
-    //    }
-    //
-    //    pMeta->rowSize = 0;
-    //    rsp += sizeof(SMultiTableMeta);
-    //    pSchema = (SSchema *)rsp;
-    //
-    //    int32_t numOfTotalCols = pMeta->numOfColumns + pMeta->numOfTags;
-    //    for (int j = 0; j < numOfTotalCols; ++j) {
-    //      pSchema->bytes = htons(pSchema->bytes);
-    //      pSchema->colId = htons(pSchema->colId);
-    //
-    //      // ignore the tags length
-    //      if (j < pMeta->numOfColumns) {
-    //        pMeta->rowSize += pSchema->bytes;
-    //      }
-    //      pSchema++;
-    //    }
-    //
-    //    rsp += numOfTotalCols * sizeof(SSchema);
-    //
-    //    int32_t  tagLen = 0;
-    //    SSchema *pTagsSchema = tscGetTableTagSchema(pMeta);
-    //
-    //    if (pMeta->tableType == TSDB_CHILD_TABLE) {
-    //      for (int32_t j = 0; j < pMeta->numOfTags; ++j) {
-    //        tagLen += pTagsSchema[j].bytes;
-    //      }
-    //    }
-    //
-    //    rsp += tagLen;
-    //    int32_t size = (int32_t)(rsp - ((char *)pMeta));  // Consistent with STableMeta in cache
-    //
-    //    pMeta->index = 0;
-    //    (void)taosCachePut(tscCacheHandle, pMeta->tableId, (char *)pMeta, size, tsMeterMetaKeepTimer);
-    //  }
-  }
-  
-  pSql->res.code = TSDB_CODE_SUCCESS;
-  pSql->res.numOfTotal = i;
-  tscTrace("%p load multi-metermeta resp complete num:%d", pSql, pSql->res.numOfTotal);
-#endif
-  
+    void *p = taosCachePut(tscCacheHandle, pMetaMsg->tableId, pTableMeta, size, tsMeterMetaKeepTimer);
+    taosCacheRelease(tscCacheHandle, &p, false);
+    free(pTableMeta);
+  }
+
+  pRes->numOfTotal = i;
+  tscTrace("%p load multi-metermeta resp complete num:%d", pSql, pRes->numOfTotal);
+
   return TSDB_CODE_SUCCESS;
 }
 
@@ -2367,8 +2355,9 @@ int tscProcessRetrieveRspFromLocal(SSqlObj *pSql) {
 }
 
 void tscTableMetaCallBack(void *param, TAOS_RES *res, int code);
+void tscMultiTableMetaCallBack(void *param, TAOS_RES *res, int code);
 
-static int32_t getTableMetaFromMgmt(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo) {
+static int32_t doGetTableMetaFromMgmt(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo, void (*fp)(), void *param) {
   SSqlObj *pNew = calloc(1, sizeof(SSqlObj));
   if (NULL == pNew) {
     tscError("%p malloc failed for new sqlobj to get table meta", pSql);
@@ -2399,8 +2388,8 @@ static int32_t getTableMetaFromMgmt(SSqlObj *pSql, STableMetaInfo *pTableMetaInf
   memcpy(pNew->cmd.payload, pSql->cmd.payload, TSDB_DEFAULT_PAYLOAD_SIZE);  // tag information if table does not exists.
   tscTrace("%p new pSqlObj:%p to get tableMeta", pSql, pNew);
 
-  pNew->fp = tscTableMetaCallBack;
-  pNew->param = pSql;
+  pNew->fp = fp;
+  pNew->param = param;
 
   int32_t code = tscProcessSql(pNew);
   if (code == TSDB_CODE_SUCCESS) {
@@ -2410,7 +2399,94 @@ static int32_t getTableMetaFromMgmt(SSqlObj *pSql, STableMetaInfo *pTableMetaInf
   return code;
 }
 
-int32_t tscGetTableMeta(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo) {
+static int32_t getTableMetaFromMgmt(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo) {
+  return doGetTableMetaFromMgmt(pSql, pTableMetaInfo, tscTableMetaCallBack, pSql);
+}
+
+static int32_t doGetMultiTableMeta(SSqlObj *pSql, const char *tableIds, int32_t numOfTables, void (*fp)(),
+                                   void *param) {
+  assert(numOfTables > 0 && numOfTables <= TSDB_MULTI_METERMETA_MAX_NUM);
+
+  SSqlObj *pNew = calloc(1, sizeof(SSqlObj));
+  if (NULL == pNew) {
+    tscError("%p malloc failed for new sqlobj to get multi table meta", pSql);
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  pNew->pTscObj = pSql->pTscObj;
+  pNew->signature = pNew;
+  pNew->cmd.command = TSDB_SQL_MULTI_META;
+
+  tscAddSubqueryInfo(&pNew->cmd);
+
+  SQueryInfo *pNewQueryInfo = NULL;
+  tscGetQueryInfoDetailSafely(&pNew->cmd, 0, &pNewQueryInfo);
+
+  int32_t size = sizeof(SCMMultiTableInfoMsg) + numOfTables * TSDB_TABLE_ID_LEN + TSDB_DEFAULT_PAYLOAD_SIZE;
+  if (TSDB_CODE_SUCCESS != tscAllocPayload(&pNew->cmd, size)) {
+    tscError("%p malloc failed for payload to get multi table meta", pSql);
+    free(pNew);
+
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  // the first table is kept in the meta info for the trace of sqlobj
+  STableMetaInfo *pNewMeterMetaInfo = tscAddEmptyMetaInfo(pNewQueryInfo);
+  strncpy(pNewMeterMetaInfo->name, tableIds, tListLen(pNewMeterMetaInfo->name));
+
+  SCMMultiTableInfoMsg *pInfoMsg = (SCMMultiTableInfoMsg *)pNew->cmd.payload;
+  memcpy(pInfoMsg->tableIds, tableIds, numOfTables * TSDB_TABLE_ID_LEN);
+  pNew->cmd.count = numOfTables;
+
+  tscTrace("%p new pSqlObj:%p to get meta of %d tables", pSql, pNew, numOfTables);
+
+  pNew->fp = fp;
+  pNew->param = param;
+
+  int32_t code = tscProcessSql(pNew);
+  if (code == TSDB_CODE_SUCCESS) {
+    code = TSDB_CODE_ACTION_IN_PROGRESS;
+  }
+
+  return code;
+}
+
+int tscGetMultiTableMeta(SSqlObj *pSql, const char *tableIds, int32_t numOfTables) {
+  return doGetMultiTableMeta(pSql, tableIds, numOfTables, tscMultiTableMetaCallBack, pSql);
+}
+
+static void tscRenewTableMetaCallBack(void *param, TAOS_RES *res, int code) {
+  if (code != TSDB_CODE_SUCCESS) {
+    tscTrace("failed to renew table meta in background, code:%s", tstrerror(code));
+  }
+}
+
+/*
+ * the meta that is about to expire is renewed by a request in background, which puts the new one into cache when it
+ * responds, while the current query goes on with the cached one, so the queries of hot tables never wait for mgmt node.
+ */
+static void tscRenewTableMetaInBackground(SSqlObj *pSql, const char *name) {
+  char tableId[TSDB_TABLE_ID_LEN] = {0};
+  strncpy(tableId, name, tListLen(tableId) - 1);
+
+  int32_t code = doGetMultiTableMeta(pSql, tableId, 1, tscRenewTableMetaCallBack, NULL);
+  tscTrace("%p renew table meta of %s in background, code:%s", pSql, tableId, tstrerror(code));
+}
+
+typedef struct SSyncMetaSupporter {
+  tsem_t  rspSem;
+  int32_t code;
+} SSyncMetaSupporter;
+
+static void syncTableMetaCallBack(void *param, TAOS_RES *tres, int code) {
+  SSyncMetaSupporter *pSupporter = (SSyncMetaSupporter *)param;
+
+  // the value of code is the number of rows if it is not less than 0
+  pSupporter->code = (code < 0) ? code : TSDB_CODE_SUCCESS;
+  tsem_post(&pSupporter->rspSem);
+}
+
+static int32_t tscGetTableMetaFromCache(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo) {
   assert(strlen(pTableMetaInfo->name) != 0);
 
   // If this STableMetaInfo owns a table meta, release it first
@@ -2424,12 +2500,64 @@ int32_t tscGetTableMeta(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo) {
     tscTrace("%p retrieve table Meta from cache, the number of columns:%d, numOfTags:%d, %p", pSql, tinfo.numOfColumns,
              tinfo.numOfTags, pTableMetaInfo->pTableMeta);
 
+    if (taosCacheNeedRenew(tscCacheHandle, pTableMetaInfo->pTableMeta)) {
+      tscRenewTableMetaInBackground(pSql, pTableMetaInfo->name);
+    }
+
     return TSDB_CODE_SUCCESS;
   }
-  
+
+  return TSDB_CODE_INVALID_TABLE;
+}
+
+int32_t tscGetTableMeta(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo) {
+  if (tscGetTableMetaFromCache(pSql, pTableMetaInfo) == TSDB_CODE_SUCCESS) {
+    return TSDB_CODE_SUCCESS;
+  }
+
   return getTableMetaFromMgmt(pSql, pTableMetaInfo);
 }
 
+/*
+ * Retrieve the table meta and block the calling thread until the mgmt node responds if it is not in cache yet.
+ * Only for the routines that can not resume from the async callback, e.g., taos_stmt_set_tbname.
+ */
+int32_t tscGetTableMetaSync(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo) {
+  int32_t code = tscGetTableMetaFromCache(pSql, pTableMetaInfo);
+  if (code == TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  SSyncMetaSupporter supporter = {.code = TSDB_CODE_SUCCESS};
+  tsem_init(&supporter.rspSem, 0, 0);
+
+  code = doGetTableMetaFromMgmt(pSql, pTableMetaInfo, syncTableMetaCallBack, &supporter);
+  if (code == TSDB_CODE_ACTION_IN_PROGRESS) {
+    tsem_wait(&supporter.rspSem);
+    code = supporter.code;
+  }
+
+  tsem_destroy(&supporter.rspSem);
+
+  if (code == TSDB_CODE_SUCCESS) {
+    code = tscGetTableMetaFromCache(pSql, pTableMetaInfo);
+  }
+
+  return code;
+}
+
+/*
+ * Retrieve the table meta, fp is invoked with param once the mgmt node responds if it is not in cache yet, and
+ * TSDB_CODE_ACTION_IN_PROGRESS is returned. The meta is put into cache by then, retrieve it again in fp.
+ */
+int32_t tscGetTableMetaAsync(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo, void (*fp)(), void *param) {
+  if (tscGetTableMetaFromCache(pSql, pTableMetaInfo) == TSDB_CODE_SUCCESS) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  return doGetTableMetaFromMgmt(pSql, pTableMetaInfo, fp, param);
+}
+
 int tscGetMeterMetaEx(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo, bool createIfNotExists) {
   pSql->cmd.autoCreated = createIfNotExists;
   return tscGetTableMeta(pSql, pTableMetaInfo);
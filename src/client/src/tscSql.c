@@ -225,6 +225,11 @@ void taos_close(TAOS *taos) {
   if (pObj == NULL) return;
   if (pObj->signature != pObj) return;
 
+  int32_t code = tscDestroyWriteBuffer(pObj);
+  if (code != TSDB_CODE_SUCCESS) {
+    tscError("pObj:%p failed to flush write buffer before close, code:%s", pObj, tstrerror(code));
+  }
+
   if (pObj->pHb != NULL) {
     tscSetFreeHeatBeat(pObj);
   } else {
@@ -303,6 +308,26 @@ int taos_query(TAOS *taos, const char *sqlstr) {
   return pSql->res.code;
 }
 
+int taos_set_write_buffer(TAOS *taos, int maxRows, int flushInterval) {
+  STscObj *pObj = (STscObj *)taos;
+  if (pObj == NULL || pObj->signature != pObj) {
+    terrno = TSDB_CODE_DISCONNECTED;
+    return TSDB_CODE_DISCONNECTED;
+  }
+
+  return tscSetWriteBuffer(pObj, maxRows, flushInterval);
+}
+
+int taos_flush(TAOS *taos) {
+  STscObj *pObj = (STscObj *)taos;
+  if (pObj == NULL || pObj->signature != pObj) {
+    terrno = TSDB_CODE_DISCONNECTED;
+    return TSDB_CODE_DISCONNECTED;
+  }
+
+  return tscFlushWriteBuffer(pObj);
+}
+
 TAOS_RES *taos_use_result(TAOS *taos) {
   STscObj *pObj = (STscObj *)taos;
   if (pObj == NULL || pObj->signature != pObj) {
@@ -1108,14 +1133,14 @@ static int tscParseTblNameList(SSqlObj *pSql, const char *tblNameList, int32_t t
 
   STableMetaInfo *pTableMetaInfo = tscAddEmptyMetaInfo(pQueryInfo);
 
-  if ((code = tscAllocPayload(pCmd, tblListLen + 16)) != TSDB_CODE_SUCCESS) {
+  if ((code = tscAllocPayload(pCmd, TSDB_DEFAULT_PAYLOAD_SIZE)) != TSDB_CODE_SUCCESS) {
     return code;
   }
 
+  // table ids are kept in the slots of TSDB_TABLE_ID_LEN bytes, following the SCMMultiTableInfoMsg
   char *nextStr;
   char  tblName[TSDB_TABLE_ID_LEN];
-  int   payloadLen = 0;
-  char *pMsg = pCmd->payload;
+  int   payloadLen = sizeof(SCMMultiTableInfoMsg);
   while (1) {
     nextStr = strchr(str, ',');
     if (nextStr == NULL) {
@@ -1151,8 +1176,8 @@ static int tscParseTblNameList(SSqlObj *pSql, const char *tblNameList, int32_t t
       return code;
     }
 
-    if (payloadLen + strlen(pTableMetaInfo->name) + 128 >= pCmd->allocSize) {
-      char *pNewMem = realloc(pCmd->payload, pCmd->allocSize + tblListLen);
+    if (payloadLen + TSDB_TABLE_ID_LEN + tsRpcHeadSize + 128 >= pCmd->allocSize) {
+      char *pNewMem = realloc(pCmd->payload, pCmd->allocSize * 2);
       if (pNewMem == NULL) {
         code = TSDB_CODE_CLI_OUT_OF_MEMORY;
         sprintf(pCmd->payload, "failed to allocate memory");
@@ -1160,16 +1185,14 @@ static int tscParseTblNameList(SSqlObj *pSql, const char *tblNameList, int32_t t
       }
 
       pCmd->payload = pNewMem;
-      pCmd->allocSize = pCmd->allocSize + tblListLen;
-      pMsg = pCmd->payload;
+      pCmd->allocSize = pCmd->allocSize * 2;
     }
 
-    payloadLen += sprintf(pMsg + payloadLen, "%s,", pTableMetaInfo->name);
+    strncpy(pCmd->payload + payloadLen, pTableMetaInfo->name, TSDB_TABLE_ID_LEN);
+    payloadLen += TSDB_TABLE_ID_LEN;
   }
 
-  *(pMsg + payloadLen) = '\0';
-  pCmd->payloadLen = payloadLen + 1;
-
+  pCmd->payloadLen = payloadLen;
   return TSDB_CODE_SUCCESS;
 }
 
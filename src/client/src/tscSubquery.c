@@ -22,6 +22,7 @@
 typedef struct SInsertSupporter {
   SSubqueryState* pState;
   SSqlObj*  pSql;
+  int32_t   vgId;
 } SInsertSupporter;
 
 static void freeSubqueryObj(SSqlObj* pSql);
@@ -1497,9 +1498,18 @@ static void multiVnodeInsertMerge(void* param, TAOS_RES* tres, int numOfRows) {
   SSubqueryState* pState = pSupporter->pState;
   int32_t total = pState->numOfTotal;
   
-  // increase the total inserted rows
+  // one more submit can be sent to this vnode in pipelined insertion
+  if (pParentObj->pPipe != NULL) {
+    tscReleaseInsertWindow(pParentObj->pPipe, pSupporter->vgId);
+  }
+  
+  tfree(pSupporter);
+  
+  // increase the total inserted rows, or keep the first error of all sub-insertions
   if (numOfRows > 0) {
     pParentObj->res.numOfRows += numOfRows;
+  } else if (numOfRows < 0) {
+    atomic_val_compare_exchange_32(&pParentObj->res.code, TSDB_CODE_SUCCESS, numOfRows);
   }
   
   int32_t completed = atomic_add_fetch_32(&pState->numOfCompleted, 1);
@@ -1510,7 +1520,6 @@ static void multiVnodeInsertMerge(void* param, TAOS_RES* tres, int numOfRows) {
   tscTrace("%p Async insertion completed, total inserted:%d", pParentObj, pParentObj->res.numOfRows);
   
   tfree(pState);
-  tfree(pSupporter);
   
   // release data block data
   pParentCmd->pDataBlocks = tscDestroyBlockArrayList(pParentCmd->pDataBlocks);
@@ -1519,7 +1528,8 @@ static void multiVnodeInsertMerge(void* param, TAOS_RES* tres, int numOfRows) {
   pParentObj->fp = pParentObj->fetchFp;
   
   // all data has been sent to vnode, call user function
-  (*pParentObj->fp)(pParentObj->param, tres, numOfRows);
+  int32_t code = pParentObj->res.code;
+  (*pParentObj->fp)(pParentObj->param, tres, (code != TSDB_CODE_SUCCESS) ? code : numOfRows);
 }
 
 int32_t tscHandleMultivnodeInsert(SSqlObj *pSql) {
@@ -1544,6 +1554,7 @@ int32_t tscHandleMultivnodeInsert(SSqlObj *pSql) {
     SInsertSupporter* pSupporter = calloc(1, sizeof(SInsertSupporter));
     pSupporter->pSql = pSql;
     pSupporter->pState = pState;
+    pSupporter->vgId = pDataBlocks->pData[i]->vgId;
     
     SSqlObj *pNew = createSubqueryObj(pSql, 0, multiVnodeInsertMerge, pSupporter, TSDB_SQL_INSERT, NULL);
     if (pNew == NULL) {
@@ -1561,7 +1572,14 @@ int32_t tscHandleMultivnodeInsert(SSqlObj *pSql) {
     return pRes->code;  // free all allocated resource
   }
   
-  for (int32_t j = 0; j < pSql->numOfSubs; ++j) {
+  /*
+   * pSql may be released once the last sub-insertion is completed, so keep the required values in local variables.
+   * In pipelined insertion, the submit is not sent until there is a free slot in the window of the vnode.
+   */
+  int32_t      numOfSubs = pSql->numOfSubs;
+  SInsertPipe *pPipe = pSql->pPipe;
+  
+  for (int32_t j = 0; j < numOfSubs; ++j) {
     SSqlObj *pSub = pSql->pSubs[j];
     int32_t code = tscCopyDataBlockToPayload(pSub, pDataBlocks->pData[j]);
     
@@ -1570,6 +1588,10 @@ int32_t tscHandleMultivnodeInsert(SSqlObj *pSql) {
                pDataBlocks->nSize, code);
     }
     
+    if (pPipe != NULL) {
+      tscAcquireInsertWindow(pPipe, pDataBlocks->pData[j]->vgId);
+    }
+    
     tscTrace("%p sub:%p launch sub insert, orderOfSub:%d", pSql, pSub, j);
     tscProcessSql(pSub);
   }
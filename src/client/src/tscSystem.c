@@ -195,6 +195,7 @@ void taos_init_imp() {
 
   if (tscCacheHandle == NULL) {
     tscCacheHandle = taosCacheInit(tscTmr, refreshTime);
+    taosCacheSetMaxSize(tscCacheHandle, (int64_t)tsMaxMetaCacheSize * 1024 * 1024);
   }
 
   tscTrace("client is initialized successfully");
@@ -332,6 +332,9 @@ void tscResetSqlCmdObj(SSqlCmd* pCmd) {
   pCmd->curSql    = NULL;
   pCmd->msgType   = 0;
   pCmd->parseFinished = 0;
+  pCmd->dataSourceType = 0;
+  pCmd->bufferedInsert = false;
+  pCmd->metaPrefetched = false;
   
   taosHashCleanup(pCmd->pTableList);
   pCmd->pTableList= NULL;
@@ -373,6 +376,7 @@ void tscFreeSqlResult(SSqlObj* pSql) {
   pSql->res.row = 0;
   pSql->res.numOfRows = 0;
   pSql->res.numOfTotal = 0;
+  pSql->res.numOfTotalInCurrentClause = 0;
 
   pSql->res.numOfGroups = 0;
   tfree(pSql->res.pGroupRec);
@@ -1491,7 +1495,7 @@ bool tscShouldBeFreed(SSqlObj* pSql) {
   }
 
   STscObj* pTscObj = pSql->pTscObj;
-  if (pSql->pStream != NULL || pTscObj->pHb == pSql || pTscObj->pSql == pSql) {
+  if (pSql->pStream != NULL || pSql->pStmt != NULL || pTscObj->pHb == pSql || pTscObj->pSql == pSql) {
     return false;
   }
 
@@ -1898,6 +1902,12 @@ void tscDoQuery(SSqlObj* pSql) {
   
   pSql->res.code = TSDB_CODE_SUCCESS;
   
+  // the submit of pipelined insertion is launched in the thread of taos_pipe_insert
+  if (pSql->pPipe != NULL) {
+    tscProcessPipeInsert(pSql);
+    return;
+  }
+
   if (pCmd->command > TSDB_SQL_LOCAL) {
     tscProcessLocalCmd(pSql);
   } else {
@@ -1907,6 +1917,8 @@ void tscDoQuery(SSqlObj* pSql) {
 
     if (pCmd->dataSourceType == DATA_FROM_DATA_FILE) {
       tscProcessMultiVnodesInsertFromFile(pSql);
+    } else if (pCmd->bufferedInsert) {
+      tscProcessBufferedInsert(pSql);
     } else {
       // pSql may be released in this function if it is a async insertion.
       tscProcessSql(pSql);
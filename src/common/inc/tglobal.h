@@ -67,6 +67,7 @@ extern int tsVnodePeerHBTimer;
 extern int tsMgmtPeerHBTimer;
 extern int tsMeterMetaKeepTimer;
 extern int tsMetricMetaKeepTimer;
+extern int tsMaxMetaCacheSize;
 
 extern float tsNumOfThreadsPerCore;
 extern float tsRatioOfQueryThreads;
@@ -110,6 +111,7 @@ extern int tsBalanceMonitorInterval;
 extern int tsBalanceStartInterval;
 extern int tsBalancePolicy;
 extern int tsOfflineThreshold;
+extern int tsSdbSnapshotInterval;
 extern int tsMgmtEqualVnodeNum;
 
 extern int tsEnableHttpModule;
@@ -117,7 +119,9 @@ extern int tsEnableMonitorModule;
 extern int tsRestRowLimit;
 extern int tsCompressMsgSize;
 extern int tsMaxSQLStringLen;
+extern int tsNumOfImportThreads;
 extern int tsMaxNumOfOrderedResults;
+extern int tsQueryBufferSize;
 
 extern char tsSocketType[4];
 
@@ -24,6 +24,7 @@
 #include "ttimer.h"
 #include "tbalance.h"
 #include "tglobal.h"
+#include "tsystem.h"
 #include "vnode.h"
 #include "mnode.h"
 #include "dnode.h"
@@ -33,6 +34,7 @@
 #include "dnodeMgmt.h"
 
 #define MPEER_CONTENT_LEN 2000
+#define TSDB_STATUS_FULL_ROUNDS 10  // a full status msg is sent at least once every so many status msgs
 
 static void   dnodeUpdateMnodeInfos(SDMMnodeInfos *pMnodes);
 static bool   dnodeReadMnodeInfos();
@@ -43,12 +45,17 @@ static void   dnodeSaveDnodeCfg();
 static void   dnodeProcessRspFromMnode(SRpcMsg *pMsg);
 static void   dnodeProcessStatusRsp(SRpcMsg *pMsg);
 static void   dnodeSendStatusMsg(void *handle, void *tmrId);
+static void   dnodeStartStatusTimer(bool changed);
 static void (*tsDnodeProcessMgmtRspFp[TSDB_MSG_TYPE_MAX])(SRpcMsg *);
 
 static void    *tsDnodeMClientRpc = NULL;
 static void    *tsDnodeTmr = NULL;
 static void    *tsStatusTimer = NULL;
 static uint32_t tsRebootTime;
+static int32_t  tsStatusDelay;       // ms, doubles while status msgs carry no changed vnodes
+static int32_t  tsStatusRounds = 0;  // status msgs sent since the last full one
+static bool     tsStatusFull = true; // the next status msg carries all vnodes
+static bool     tsStatusChanged;     // the partial status msg in flight carries changed vnodes
 
 static SRpcIpSet     tsMnodeIpSet  = {0};
 static SDMMnodeInfos tsMnodeInfos = {0};
@@ -76,6 +83,8 @@ int32_t dnodeInitMClient() {
   dnodeReadDnodeCfg();
   tsRebootTime = taosGetTimestampSec();
 
+  tsStatusDelay = tsStatusInterval * 1000;
+
   tsDnodeTmr = taosTmrInit(100, 200, 60000, "DND-DM");
   if (tsDnodeTmr == NULL) {
     dError("failed to init dnode timer");
@@ -159,10 +168,26 @@ static void dnodeProcessRspFromMnode(SRpcMsg *pMsg) {
   rpcFreeCont(pMsg->pCont);
 }
 
+/*
+ * while nothing changes in the vnodes the status msg is only a keep-alive, the interval is doubled,
+ * but kept below the idle time of mnode, otherwise the connection is closed and built again for each msg
+ */
+static void dnodeStartStatusTimer(bool changed) {
+  int32_t maxDelay = MAX(tsStatusInterval * 1000, tsShellActivityTimer * 750);
+  if (changed) {
+    tsStatusDelay = tsStatusInterval * 1000;
+  } else {
+    tsStatusDelay = MIN(tsStatusDelay * 2, maxDelay);
+  }
+
+  taosTmrReset(dnodeSendStatusMsg, tsStatusDelay, NULL, tsDnodeTmr, &tsStatusTimer);
+}
+
 static void dnodeProcessStatusRsp(SRpcMsg *pMsg) {
   if (pMsg->code != TSDB_CODE_SUCCESS) {
     dError("status rsp is received, error:%s", tstrerror(pMsg->code));
-    taosTmrReset(dnodeSendStatusMsg, tsStatusInterval * 1000, NULL, tsDnodeTmr, &tsStatusTimer);
+    tsStatusFull = true;
+    dnodeStartStatusTimer(true);
     return;
   }
 
@@ -170,10 +195,18 @@ static void dnodeProcessStatusRsp(SRpcMsg *pMsg) {
   SDMMnodeInfos *pMnodes = &pStatusRsp->mnodes;
   if (pMnodes->nodeNum <= 0) {
     dError("status msg is invalid, num of ips is %d", pMnodes->nodeNum);
-    taosTmrReset(dnodeSendStatusMsg, tsStatusInterval * 1000, NULL, tsDnodeTmr, &tsStatusTimer);
+    tsStatusFull = true;
+    dnodeStartStatusTimer(true);
     return;
   }
 
+  // loads in the msg are accepted by mnode, the next status msg only carries vnodes changed since then
+  vnodeAckStatusMsg();
+  if (pStatusRsp->needFullStatus) {
+    dTrace("mnode asks for a full status msg");
+    tsStatusFull = true;
+  }
+
   SDMDnodeCfg *pCfg = &pStatusRsp->dnodeCfg;
   pCfg->numOfVnodes  = htonl(pCfg->numOfVnodes);
   pCfg->moduleStatus = htonl(pCfg->moduleStatus);
@@ -195,7 +228,7 @@ static void dnodeProcessStatusRsp(SRpcMsg *pMsg) {
   dnodeProcessModuleStatus(pCfg->moduleStatus);
   dnodeUpdateDnodeCfg(pCfg);
   dnodeUpdateMnodeInfos(pMnodes);
-  taosTmrReset(dnodeSendStatusMsg, tsStatusInterval * 1000, NULL, tsDnodeTmr, &tsStatusTimer);
+  dnodeStartStatusTimer(tsStatusChanged || tsStatusFull);
 }
 
 static void dnodeUpdateMnodeInfos(SDMMnodeInfos *pMnodes) {
@@ -386,7 +419,7 @@ static void dnodeSendStatusMsg(void *handle, void *tmrId) {
   }
 
   if (tsStatusTimer == NULL) {
-    taosTmrReset(dnodeSendStatusMsg, tsStatusInterval * 1000, NULL, tsDnodeTmr, &tsStatusTimer);
+    dnodeStartStatusTimer(true);
     dError("failed to start status timer");
     return;
   }
@@ -394,11 +427,13 @@ static void dnodeSendStatusMsg(void *handle, void *tmrId) {
   int32_t contLen = sizeof(SDMStatusMsg) + TSDB_MAX_VNODES * sizeof(SVnodeLoad);
   SDMStatusMsg *pStatus = rpcMallocCont(contLen);
   if (pStatus == NULL) {
-    taosTmrReset(dnodeSendStatusMsg, tsStatusInterval * 1000, NULL, tsDnodeTmr, &tsStatusTimer);
+    dnodeStartStatusTimer(true);
     dError("failed to malloc status message");
     return;
   }
 
+  taosGetDisk();
+
   //strcpy(pStatus->dnodeName, tsDnodeName);
   pStatus->version          = htonl(tsVersion);
   pStatus->dnodeId          = htonl(tsDnodeCfg.dnodeId);
@@ -408,9 +443,16 @@ static void dnodeSendStatusMsg(void *handle, void *tmrId) {
   pStatus->numOfTotalVnodes = htons((uint16_t) tsNumOfTotalVnodes);
   pStatus->numOfCores       = htons((uint16_t) tsNumOfCores);
   pStatus->diskAvailable    = tsAvailDataDirGB;
+  pStatus->diskTotal        = tsTotalDataDirGB;
   pStatus->alternativeRole  = (uint8_t) tsAlternativeRole;
-  
+
+  if (++tsStatusRounds >= TSDB_STATUS_FULL_ROUNDS) tsStatusFull = true;
+  if (tsStatusFull) tsStatusRounds = 0;
+  pStatus->fullStatus = tsStatusFull;
+  tsStatusFull = false;
+
   vnodeBuildStatusMsg(pStatus);
+  tsStatusChanged = (!pStatus->fullStatus && pStatus->openVnodes > 0);
   contLen = sizeof(SDMStatusMsg) + pStatus->openVnodes * sizeof(SVnodeLoad);
   pStatus->openVnodes = htons(pStatus->openVnodes);
   
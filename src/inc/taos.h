@@ -28,6 +28,7 @@ typedef void    TAOS_RES;
 typedef void    TAOS_SUB;
 typedef void    TAOS_STREAM;
 typedef void    TAOS_STMT;
+typedef void    TAOS_PIPE;
 
 // Data type definition
 #define TSDB_DATA_TYPE_NULL       0     // 1 bytes
@@ -80,15 +81,50 @@ typedef struct TAOS_BIND {
   int *          error;        // unused
 } TAOS_BIND;
 
+/*
+ * column-wise parameters for batch binding, one TAOS_MULTI_BIND for each parameter,
+ * all of them describe the same number of rows.
+ */
+typedef struct TAOS_MULTI_BIND {
+  int            buffer_type;
+  void *         buffer;         // values of all rows, stored consecutively
+  unsigned long  buffer_length;  // size of each element in buffer, in bytes
+  int32_t *      length;         // actual length of each binary/nchar value, ignored for other types
+  unsigned char *is_null;        // null bitmap, the value of row i is null if bit (i % 8) of is_null[i / 8] is set
+  int            num;            // number of rows
+} TAOS_MULTI_BIND;
+
 TAOS_STMT *taos_stmt_init(TAOS *taos);
 int        taos_stmt_prepare(TAOS_STMT *stmt, const char *sql, unsigned long length);
 int        taos_stmt_bind_param(TAOS_STMT *stmt, TAOS_BIND *bind);
+int        taos_stmt_bind_param_batch(TAOS_STMT *stmt, TAOS_MULTI_BIND *bind);
+int        taos_stmt_set_tbname(TAOS_STMT *stmt, const char *name);
 int        taos_stmt_add_batch(TAOS_STMT *stmt);
 int        taos_stmt_execute(TAOS_STMT *stmt);
 TAOS_RES * taos_stmt_use_result(TAOS_STMT *stmt);
 int        taos_stmt_close(TAOS_STMT *stmt);
 
 DLL_EXPORT int taos_query(TAOS *taos, const char *sql);
+
+/*
+ * keep the rows of insert statements in client and submit them in batch, when the number of buffered rows reaches
+ * maxRows, flushInterval milliseconds elapse after the first buffered row (0: never), or taos_flush is called.
+ * Buffered rows are invisible to queries until flushed, and the errors of background flushes are returned by
+ * taos_flush. maxRows <= 0 flushes the buffered rows and disables the write buffer.
+ */
+DLL_EXPORT int taos_set_write_buffer(TAOS *taos, int maxRows, int flushInterval);
+DLL_EXPORT int taos_flush(TAOS *taos);
+
+/*
+ * pipelined insertion: each statement is parsed in the caller thread and submitted without waiting for the previous
+ * ones, at most `window` submits are outstanding for each vnode. taos_pipe_insert blocks while the window of a vnode
+ * involved is full, and fp is called with the number of affected rows or the error code once all vnodes of the
+ * statement respond. taos_pipe_insert should not be called within fp.
+ */
+DLL_EXPORT TAOS_PIPE *taos_open_pipe(TAOS *taos, int window, void (*fp)(void *param, TAOS_RES *, int code));
+DLL_EXPORT int        taos_pipe_insert(TAOS_PIPE *tpipe, const char *sql, void *param);
+DLL_EXPORT void       taos_close_pipe(TAOS_PIPE *tpipe);
+
 DLL_EXPORT TAOS_RES *taos_use_result(TAOS *taos);
 DLL_EXPORT TAOS_ROW taos_fetch_row(TAOS_RES *res);
 DLL_EXPORT int taos_result_precision(TAOS_RES *res);  // get the time precision of result
@@ -506,11 +506,12 @@ typedef struct {
   int32_t vgId;
   int64_t totalStorage;
   int64_t compStorage;
-  int64_t pointsWritten;
-  uint8_t status;
-  uint8_t role;
-  uint8_t replica;
-  uint8_t reserved[5];
+  int64_t  pointsWritten;
+  uint8_t  status;
+  uint8_t  role;
+  uint8_t  replica;
+  uint32_t queryTime;  // accumulated query execution time in ms, wraps around
+  uint8_t  reserved[1];
 } SVnodeLoad;
 
 typedef struct {
@@ -592,13 +593,17 @@ typedef struct {
   uint16_t   numOfCores;
   float      diskAvailable;  // GB
   uint8_t    alternativeRole;
-  uint8_t    reserve[15];
+  float      diskTotal;      // GB
+  uint8_t    fullStatus;     // 1: all open vnodes are in load, 0: only the ones changed since the last acked status
+  uint8_t    reserve[10];
   SVnodeLoad load[];
 } SDMStatusMsg;
 
 typedef struct {
   SDMMnodeInfos    mnodes;
   SDMDnodeCfg      dnodeCfg;
+  uint8_t          needFullStatus;  // mnode has no vnode state of the dnode, the next status msg shall be full
+  uint8_t          reserved[7];
   SDMVgroupAccess  vgAccess[];
 } SDMStatusRsp;
 
@@ -642,7 +647,7 @@ typedef struct {
 
 typedef struct {
   int32_t numOfTables;
-  char    tableIds[];
+  char    tableIds[];  // TSDB_TABLE_ID_LEN bytes for each table id
 } SCMMultiTableInfoMsg;
 
 typedef struct SCMSTableVgroupMsg {
@@ -726,9 +731,9 @@ typedef struct STableMetaMsg {
 } STableMetaMsg;
 
 typedef struct SMultiTableMeta {
-  int32_t       numOfTables;
-  int32_t       contLen;
-  STableMetaMsg metas[];
+  int32_t numOfTables;
+  int32_t contLen;
+  char    metas[];  // STableMetaMsg of each table, the length of which is given by its contLen
 } SMultiTableMeta;
 
 typedef struct {
@@ -802,6 +807,9 @@ typedef struct {
 } SStreamList;
 
 typedef struct {
+  uint32_t    version;    // changes whenever a query or stream is added to or removed from the connection
+  int8_t      unchanged;  // lists are left out, they are the same as in the last acked heartbeat
+  int8_t      reserved[3];
   SQqueryList qlist;
   SStreamList slist;
 } SCMHeartBeatMsg;
@@ -28,6 +28,7 @@ void    balanceCleanUp();
 void    balanceNotify();
 void    balanceReset();
 int32_t balanceAllocVnodes(struct SVgObj *pVgroup);
+float   balanceGetDnodeScore(struct SDnodeObj *pDnode);
 int32_t balanceDropDnode(struct SDnodeObj *pDnode);
 
 #ifdef __cplusplus
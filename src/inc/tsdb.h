@@ -192,6 +192,18 @@ typedef void *TsdbPosT;
  */
 TsdbQueryHandleT *tsdbQueryTables(TsdbRepoT *tsdb, STsdbQueryCond *pCond, STableGroupInfo *groupInfo);
 
+/**
+ * Get the data block iterator for the last row query. Each block contains only the latest row of a table, which is
+ * served from the last row cache of tables without scanning any data block. Only the table with the newest last row
+ * is returned for each group, and the time window in the query condition is not applied.
+ *
+ * @param tsdb       tsdb handle
+ * @param pCond      query condition, the columns to retrieve
+ * @param groupList  table group list
+ * @return
+ */
+TsdbQueryHandleT *tsdbQueryLastRow(TsdbRepoT *tsdb, STsdbQueryCond *pCond, STableGroupInfo *groupList);
+
 /**
  * move to next block
  * @param pQueryHandle
@@ -59,6 +59,8 @@ typedef struct SDnodeObj {
   int16_t    cpuAvgUsage;      // calc from sys.cpu
   int16_t    memoryAvgUsage;   // calc from sys.mem
   int16_t    bandwidthUsage;   // calc from sys.band
+  float      ingestRate;       // points per second, calc in balance function
+  float      queryLoad;        // cores busy with queries, calc in balance function
 } SDnodeObj;
 
 typedef struct SMnodeObj {
@@ -71,8 +73,9 @@ typedef struct SMnodeObj {
   SDnodeObj *pDnode;
 } SMnodeObj;
 
+// the table id is allocated together with the table object, right behind it
 typedef struct {
-  char   tableId[TSDB_TABLE_ID_LEN + 1];
+  char * tableId;
   int8_t type;
 } STableObj;
 
@@ -83,7 +86,7 @@ typedef struct SSuperTableObj {
   int32_t    sversion;
   int32_t    numOfColumns;
   int32_t    numOfTags;
-  int8_t     reserved[15];
+  int8_t     reserved[3];
   int8_t     updateEnd[1];
   int32_t    refCount;
   int32_t    numOfTables;
@@ -101,11 +104,10 @@ typedef struct {
   int32_t    numOfColumns; //used by normal table
   int32_t    sid;
   int32_t    vgId;
-  char       superTableId[TSDB_TABLE_ID_LEN + 1];
   int32_t    sqlLen;
-  int8_t     reserved[1]; 
-  int8_t     updateEnd[1];
   int16_t    nextColId;    //used by normal table
+  int8_t     reserved[1];
+  int8_t     updateEnd[1];
   int32_t    refCount;
   char*      sql;          //used by normal table
   SSchema*   schema;       //used by normal table
@@ -138,6 +140,10 @@ typedef struct SVgObj {
   int64_t        totalStorage;
   int64_t        compStorage;
   int64_t        pointsWritten;
+  uint32_t       queryTime;    // ms, wraps around
+  int64_t        loadTime;     // when pointsWritten and queryTime are reported, ms
+  float          ingestRate;   // points per second, smoothed
+  float          queryLoad;    // cores busy with queries, smoothed
   void *         idPool;
   SChildTableObj **tableList;
 } SVgObj;
@@ -213,6 +219,8 @@ typedef struct {
   int32_t  rowSize;
   int32_t  numOfRows;
   int32_t  numOfReads;
+  int32_t  vgId;     // cursor of show tables, the vgroup being visited
+  int32_t  sid;      // and the next sid in it
   int16_t  offset[TSDB_MAX_COLUMNS];
   int16_t  bytes[TSDB_MAX_COLUMNS];
   void *   signature;
@@ -35,7 +35,8 @@ typedef enum {
 typedef enum {
   SDB_KEY_STRING, 
   SDB_KEY_INT,
-  SDB_KEY_AUTO
+  SDB_KEY_AUTO,
+  SDB_KEY_VAR_STRING  // the row starts with a pointer to its key string
 } ESdbKey;
 
 typedef enum {
@@ -69,6 +70,7 @@ typedef struct {
 
 int32_t sdbInit();
 void    sdbCleanUp();
+void    sdbStopSnapshot();
 void *  sdbOpenTable(SSdbTableDesc *desc);
 void    sdbCloseTable(void *handle);
 bool    sdbIsMaster();
@@ -80,9 +82,11 @@ int32_t sdbUpdateRow(SSdbOper *pOper);
 
 void    *sdbGetRow(void *handle, void *key);
 void    *sdbFetchRow(void *handle, void *pNode, void **ppRow);
+void    *sdbGetRowFromSlot(void *handle, void **ppSlot);
 void     sdbIncRef(void *thandle, void *pRow);
 void     sdbDecRef(void *thandle, void *pRow);
 int64_t  sdbGetNumOfRows(void *handle);
+int32_t  sdbGetIndexNodeSize(void *handle);
 int32_t  sdbGetId(void *handle);
 uint64_t sdbGetVersion();
 
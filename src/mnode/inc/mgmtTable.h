@@ -29,6 +29,7 @@ void        mgmtIncTableRef(void *pTable);
 void        mgmtDecTableRef(void *pTable);
 void        mgmtDropAllChildTables(SDbObj *pDropDb);
 void        mgmtDropAllSuperTables(SDbObj *pDropDb);
+int64_t     mgmtGetVgroupTablesMemSize(SVgObj *pVgroup);
 
 #ifdef __cplusplus
 }
@@ -16,50 +16,201 @@
 #define _DEFAULT_SOURCE
 #include "os.h"
 #include "trpc.h"
+#include "ttimer.h"
+#include "tglobal.h"
 #include "tbalance.h"
 #include "mgmtDef.h"
 #include "mgmtLog.h"
 #include "mgmtMnode.h"
+#include "mgmtSdb.h"
 #include "mgmtDnode.h"
 #include "mgmtVgroup.h"
 
 #ifndef _SYNC
 
-int32_t balanceInit() { return TSDB_CODE_SUCCESS; }
-void    balanceCleanUp() {}
-void    balanceNotify() {}
-void    balanceReset() {}
+/*
+ * weights of the load signals in the score of a dnode, each signal is normalized into [0, 1].
+ * vnodes are placed on the dnode with the lowest score, and new tables go to the vgroups on it
+ */
+#define BALANCE_VNODE_WEIGHT  0.25f
+#define BALANCE_INGEST_WEIGHT 0.35f
+#define BALANCE_QUERY_WEIGHT  0.25f
+#define BALANCE_DISK_WEIGHT   0.15f
 
-int32_t balanceAllocVnodes(SVgObj *pVgroup) {
+// below this ingest rate of the cluster, points per second, the share of writes is not taken as load
+#define BALANCE_IDLE_INGEST_RATE 1000.0f
+
+extern void *tsMgmtTmr;
+
+static void *          tsBalanceTimer = NULL;
+static float           tsBalanceIngestRate = 0;  // points per second of the whole cluster
+static pthread_mutex_t tsBalanceMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static bool balanceCheckDnodeAvailable(SDnodeObj *pDnode) {
+  if (pDnode->status == TAOS_DN_STATUS_OFFLINE || pDnode->status == TAOS_DN_STATUS_DROPPING) return false;
+  return pDnode->totalVnodes > 0 && pDnode->openVnodes < pDnode->totalVnodes;
+}
+
+static float balanceCalcDnodeScore(SDnodeObj *pDnode) {
+  float vnodeUsage = (pDnode->totalVnodes > 0) ? (float)pDnode->openVnodes / pDnode->totalVnodes : 1.0f;
+  if (tsBalancePolicy == 0) return vnodeUsage;
+
+  float totalIngestRate = MAX(tsBalanceIngestRate, BALANCE_IDLE_INGEST_RATE);
+  float ingestShare = pDnode->ingestRate / totalIngestRate;
+  float queryUsage = (pDnode->numOfCores > 0) ? pDnode->queryLoad / pDnode->numOfCores : 0;
+  float diskUsage = pDnode->diskAvgUsage / 100.0f;
+  if (queryUsage > 1) queryUsage = 1;
+
+  return BALANCE_VNODE_WEIGHT * vnodeUsage + BALANCE_INGEST_WEIGHT * ingestShare +
+         BALANCE_QUERY_WEIGHT * queryUsage + BALANCE_DISK_WEIGHT * diskUsage;
+}
+
+/*
+ * sum up the load of vgroups onto dnodes, every replica takes the writes while only
+ * the master serves queries, then score the dnodes with the load
+ */
+static void balanceUpdateScores() {
   void *     pNode = NULL;
   SDnodeObj *pDnode = NULL;
-  SDnodeObj *pSelDnode = NULL;
-  float      vnodeUsage = 1.0;
+  SVgObj *   pVgroup = NULL;
+  float      ingestRate = 0;
+
+  pthread_mutex_lock(&tsBalanceMutex);
 
   while (1) {
     pNode = mgmtGetNextDnode(pNode, &pDnode);
     if (pDnode == NULL) break;
+    pDnode->ingestRate = 0;
+    pDnode->queryLoad = 0;
+    mgmtDecDnodeRef(pDnode);
+  }
 
-    if (pDnode->totalVnodes > 0 && pDnode->openVnodes < pDnode->totalVnodes) {
-      float usage = (float)pDnode->openVnodes / pDnode->totalVnodes;
-      if (usage <= vnodeUsage) {
-        pSelDnode = pDnode;
-        vnodeUsage = usage;
-      }
+  pNode = NULL;
+  while (1) {
+    pNode = mgmtGetNextVgroup(pNode, &pVgroup);
+    if (pVgroup == NULL) break;
+
+    for (int32_t i = 0; i < pVgroup->numOfVnodes; ++i) {
+      pDnode = pVgroup->vnodeGid[i].pDnode;
+      if (pDnode == NULL) continue;
+      pDnode->ingestRate += pVgroup->ingestRate;
+      if (i == pVgroup->inUse) pDnode->queryLoad += pVgroup->queryLoad;
     }
+    ingestRate += pVgroup->ingestRate;
+    mgmtDecVgroupRef(pVgroup);
+  }
+
+  tsBalanceIngestRate = ingestRate;
+
+  pNode = NULL;
+  while (1) {
+    pNode = mgmtGetNextDnode(pNode, &pDnode);
+    if (pDnode == NULL) break;
+
+    pDnode->score = balanceCalcDnodeScore(pDnode);
+    mTrace("dnode:%d, score:%.3f openVnodes:%d totalVnodes:%d ingestRate:%.1f queryLoad:%.3f diskUsage:%d",
+           pDnode->dnodeId, pDnode->score, pDnode->openVnodes, pDnode->totalVnodes, pDnode->ingestRate,
+           pDnode->queryLoad, pDnode->diskAvgUsage);
     mgmtDecDnodeRef(pDnode);
   }
 
-  if (pSelDnode == NULL) {
-    mError("failed to alloc vnode to vgroup");
-    return TSDB_CODE_NO_ENOUGH_DNODES;
+  pthread_mutex_unlock(&tsBalanceMutex);
+}
+
+static void balanceMonitorLoad(void *param, void *tmrId) {
+  if (sdbIsMaster()) {
+    balanceUpdateScores();
   }
 
-  pVgroup->vnodeGid[0].dnodeId = pSelDnode->dnodeId;
-  pVgroup->vnodeGid[0].pDnode = pSelDnode;
+  taosTmrReset(balanceMonitorLoad, tsBalanceMonitorInterval * 1000, NULL, tsMgmtTmr, &tsBalanceTimer);
+}
 
-  mTrace("dnode:%d, alloc one vnode to vgroup, openVnodes:%d", pSelDnode->dnodeId, pSelDnode->openVnodes);
+int32_t balanceInit() {
+  taosTmrReset(balanceMonitorLoad, tsBalanceMonitorInterval * 1000, NULL, tsMgmtTmr, &tsBalanceTimer);
   return TSDB_CODE_SUCCESS;
 }
 
-#endif 
+void balanceCleanUp() {
+  if (tsBalanceTimer != NULL) {
+    taosTmrStopA(&tsBalanceTimer);
+    tsBalanceTimer = NULL;
+  }
+}
+
+void balanceNotify() {
+  balanceUpdateScores();
+}
+
+// the load history may belong to another master, measure it from scratch
+void balanceReset() {
+  void *  pNode = NULL;
+  SVgObj *pVgroup = NULL;
+
+  while (1) {
+    pNode = mgmtGetNextVgroup(pNode, &pVgroup);
+    if (pVgroup == NULL) break;
+    mgmtResetVgroupLoad(pVgroup);
+    mgmtDecVgroupRef(pVgroup);
+  }
+
+  balanceUpdateScores();
+}
+
+// the load fields of dnodes are rebuilt under the mutex, so they are read under it as well
+float balanceGetDnodeScore(SDnodeObj *pDnode) {
+  pthread_mutex_lock(&tsBalanceMutex);
+  float score = pDnode->score;
+  pthread_mutex_unlock(&tsBalanceMutex);
+
+  return score;
+}
+
+int32_t balanceAllocVnodes(SVgObj *pVgroup) {
+  int32_t code = TSDB_CODE_SUCCESS;
+
+  pthread_mutex_lock(&tsBalanceMutex);
+
+  for (int32_t i = 0; i < pVgroup->numOfVnodes; ++i) {
+    void *     pNode = NULL;
+    SDnodeObj *pDnode = NULL;
+    SDnodeObj *pSelDnode = NULL;
+    float      minScore = 0;
+
+    while (1) {
+      pNode = mgmtGetNextDnode(pNode, &pDnode);
+      if (pDnode == NULL) break;
+
+      bool selected = false;
+      for (int32_t j = 0; j < i; ++j) {
+        if (pVgroup->vnodeGid[j].pDnode == pDnode) selected = true;
+      }
+
+      if (!selected && balanceCheckDnodeAvailable(pDnode)) {
+        // the score is calculated again, since vnodes may be created after the last update
+        float score = balanceCalcDnodeScore(pDnode);
+        if (pSelDnode == NULL || score < minScore) {
+          pSelDnode = pDnode;
+          minScore = score;
+        }
+      }
+      mgmtDecDnodeRef(pDnode);
+    }
+
+    if (pSelDnode == NULL) {
+      mError("failed to alloc vnode:%d to vgroup, replica:%d", i, pVgroup->numOfVnodes);
+      code = TSDB_CODE_NO_ENOUGH_DNODES;
+      break;
+    }
+
+    pVgroup->vnodeGid[i].dnodeId = pSelDnode->dnodeId;
+    pVgroup->vnodeGid[i].pDnode = pSelDnode;
+
+    mTrace("dnode:%d, alloc one vnode to vgroup, openVnodes:%d score:%.3f", pSelDnode->dnodeId,
+           pSelDnode->openVnodes, minScore);
+  }
+
+  pthread_mutex_unlock(&tsBalanceMutex);
+  return code;
+}
+
+#endif
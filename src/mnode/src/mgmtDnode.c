@@ -328,6 +328,7 @@ void mgmtProcessDnodeStatusMsg(SRpcMsg *rpcMsg) {
   pDnode->lastReboot       = pStatus->lastReboot;
   pDnode->numOfCores       = pStatus->numOfCores;
   pDnode->diskAvailable    = pStatus->diskAvailable;
+  pDnode->diskAvgUsage     = (pStatus->diskTotal > 0) ? (int16_t)(100 * (1 - pStatus->diskAvailable / pStatus->diskTotal)) : 0;
   pDnode->alternativeRole  = pStatus->alternativeRole;
   pDnode->totalVnodes      = pStatus->numOfTotalVnodes; 
   pDnode->moduleStatus     = pStatus->moduleStatus;
@@ -339,6 +340,8 @@ void mgmtProcessDnodeStatusMsg(SRpcMsg *rpcMsg) {
     //mTrace("dnode:%d, status received, access times %d", pDnode->dnodeId, pDnode->lastAccess);
   }
  
+  // a partial status only lists the vnodes changed since the last ack, so a vnode whose vgroup was dropped while the
+  // dnode was away is found in its next full one, which is the first status after a restart or a failed status
   int32_t openVnodes = htons(pStatus->openVnodes);
   for (int32_t j = 0; j < openVnodes; ++j) {
     SVnodeLoad *pVload = &pStatus->load[j];
@@ -355,9 +358,12 @@ void mgmtProcessDnodeStatusMsg(SRpcMsg *rpcMsg) {
     }
   }
 
+  // a partial status only carries the vnodes changed since the last ack, mnode needs one full status to start from
+  bool needFullStatus = false;
   if (pDnode->status == TAOS_DN_STATUS_OFFLINE) {
     mTrace("dnode:%d, from offline to online", pDnode->dnodeId);
     pDnode->status = TAOS_DN_STATUS_READY;
+    needFullStatus = (pStatus->fullStatus == 0);
     balanceNotify();
   }
 
@@ -375,6 +381,7 @@ void mgmtProcessDnodeStatusMsg(SRpcMsg *rpcMsg) {
   pRsp->dnodeCfg.dnodeId = htonl(pDnode->dnodeId);
   pRsp->dnodeCfg.moduleStatus = htonl((int32_t)pDnode->isMgmt);
   pRsp->dnodeCfg.numOfVnodes = 0;
+  pRsp->needFullStatus = needFullStatus;
   
   contLen = sizeof(SDMStatusRsp);
 
@@ -143,6 +143,7 @@ int32_t mgmtInitSystem() {
 
 void mgmtCleanUpSystem() {
   mPrint("starting to clean up mgmt");
+  sdbStopSnapshot();
   grantCleanUp();
   mgmtCleanupMnodes();
   balanceCleanUp();
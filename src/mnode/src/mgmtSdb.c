@@ -23,6 +23,8 @@
 #include "twal.h"
 #include "tsync.h"
 #include "tglobal.h"
+#include "tchecksum.h"
+#include "ttime.h"
 #include "hashint.h"
 #include "hashstr.h"
 #include "dnode.h"
@@ -52,6 +54,10 @@ typedef struct _SSdbTable {
   int32_t   refCountPos;
   int32_t   autoIndex;
   int64_t   numOfRows;
+  int64_t   changes;      // number of changes applied to the hash
+  int64_t   snapChanges;  // value of changes when the table was written into the snapshot
+  int32_t   snapId;       // id of the snapshot file holding this table, 0 means none
+  int32_t   indexRows;    // number of rows the index is created for
   void *    iHandle;
   int32_t (*insertFp)(SSdbOper *pDesc);
   int32_t (*deleteFp)(SSdbOper *pOper);
@@ -60,7 +66,7 @@ typedef struct _SSdbTable {
   int32_t (*encodeFp)(SSdbOper *pOper);
   int32_t (*destroyFp)(SSdbOper *pOper);
   int32_t (*restoredFp)();
-  pthread_mutex_t mutex;
+  pthread_rwlock_t rwLock;  // guards the index, lookups from the read workers share it
 } SSdbTable;
 
 typedef struct {
@@ -74,21 +80,56 @@ typedef struct {
   int32_t    code;
   int32_t    numOfTables;
   SSdbTable *tableList[SDB_TABLE_MAX];
+  int32_t    pending;      // changes written into wal but not applied to the hash yet
+  pthread_cond_t idle;     // signaled when the pending changes drop to zero
+  int32_t    snapId;       // id of the latest committed snapshot
+  int64_t    snapVersion;  // version of the latest committed snapshot
+  bool       snapRenew;    // the previous snapshot is committed, so the older wal can be removed
+  bool       snapStop;
+  pthread_t  snapThread;
   pthread_mutex_t mutex;
 } SSdbObject;
 
+#define SDB_SNAP_SIGNATURE 0xFAFBFCFD
+#define SDB_SNAP_DIR       "snap"
+#define SDB_SNAP_MANIFEST  "manifest"
+
+// head of the snapshot file of a table, rows follow as [int32_t len][encoded row]
+typedef struct {
+  uint32_t signature;
+  int32_t  tableId;
+  int32_t  snapId;
+  int32_t  autoIndex;
+  int64_t  version;
+  int64_t  numOfRows;
+  int64_t  size;       // bytes of the rows
+  uint32_t rowsCksum;  // checksum of the rows
+  TSCKSUM  cksum;
+} SSdbSnapHead;
+
+// written to a temporary file and renamed, the rename commits the snapshot
+typedef struct {
+  uint32_t signature;
+  int32_t  snapId;
+  int64_t  version;
+  int32_t  tableSnapId[SDB_TABLE_MAX];  // snapshot file of each table, 0 means none
+  int32_t  reserved;
+  TSCKSUM  cksum;
+} SSdbSnapManifest;
+
 typedef struct {
   int32_t rowSize;
   void *  row;
 } SSdbRow;
 
 static SSdbObject tsSdbObj = {0};
-static void *(*sdbInitIndexFp[])(int32_t maxRows, int32_t dataSize) = {sdbOpenStrHash, sdbOpenIntHash, sdbOpenIntHash};
-static void *(*sdbAddIndexFp[])(void *handle, void *key, void *data) = {sdbAddStrHash, sdbAddIntHash, sdbAddIntHash};
-static void  (*sdbDeleteIndexFp[])(void *handle, void *key) = {sdbDeleteStrHash, sdbDeleteIntHash, sdbDeleteIntHash};
-static void *(*sdbGetIndexFp[])(void *handle, void *key) = {sdbGetStrHashData, sdbGetIntHashData, sdbGetIntHashData};
-static void  (*sdbCleanUpIndexFp[])(void *handle) = {sdbCloseStrHash, sdbCloseIntHash, sdbCloseIntHash};
-static void *(*sdbFetchRowFp[])(void *handle, void *ptr, void **ppRow) = {sdbFetchStrHashData, sdbFetchIntHashData, sdbFetchIntHashData};
+static void *(*sdbInitIndexFp[])(int32_t maxRows, int32_t dataSize) = {sdbOpenStrHash, sdbOpenIntHash, sdbOpenIntHash, sdbOpenStrHash};
+static void *(*sdbAddIndexFp[])(void *handle, void *key, void *data) = {sdbAddStrHash, sdbAddIntHash, sdbAddIntHash, sdbAddStrHash};
+static void  (*sdbDeleteIndexFp[])(void *handle, void *key) = {sdbDeleteStrHash, sdbDeleteIntHash, sdbDeleteIntHash, sdbDeleteStrHash};
+static void *(*sdbGetIndexFp[])(void *handle, void *key) = {sdbGetStrHashData, sdbGetIntHashData, sdbGetIntHashData, sdbGetStrHashData};
+static void  (*sdbCleanUpIndexFp[])(void *handle) = {sdbCloseStrHash, sdbCloseIntHash, sdbCloseIntHash, sdbCloseStrHash};
+static void *(*sdbFetchRowFp[])(void *handle, void *ptr, void **ppRow) = {sdbFetchStrHashData, sdbFetchIntHashData, sdbFetchIntHashData, sdbFetchStrHashData};
+static int   (*sdbIndexNodeSizeFp[])(void *handle) = {sdbGetStrHashNodeSize, sdbGetIntHashNodeSize, sdbGetIntHashNodeSize, sdbGetStrHashNodeSize};
 static int sdbWrite(void *param, void *data, int type);
 
 int32_t sdbGetId(void *handle) {
@@ -99,6 +140,11 @@ int64_t sdbGetNumOfRows(void *handle) {
   return ((SSdbTable *)handle)->numOfRows;
 }
 
+int32_t sdbGetIndexNodeSize(void *handle) {
+  SSdbTable *pTable = handle;
+  return (*sdbIndexNodeSizeFp[pTable->keyType])(pTable->iHandle);
+}
+
 uint64_t sdbGetVersion() {
   return tsSdbObj.version;
 }
@@ -119,24 +165,435 @@ static char *sdbGetActionStr(int32_t action) {
   return "invalid";
 }
 
-static char *sdbGetkeyStr(SSdbTable *pTable, void *row) {
+static char *sdbGetkeyStr(SSdbTable *pTable, void *key) {
   static char str[16];
   switch (pTable->keyType) {
     case SDB_KEY_STRING:
-      return (char *)row;
+    case SDB_KEY_VAR_STRING:
+      return (char *)key;
     case SDB_KEY_INT:
     case SDB_KEY_AUTO:
-      sprintf(str, "%d", *(int32_t *)row);
+      sprintf(str, "%d", *(int32_t *)key);
       return str;
     default:
       return "invalid";
   }
 }
 
+// the row holds its key in place, or points to it for SDB_KEY_VAR_STRING
+static void *sdbGetObjKey(SSdbTable *pTable, void *row) {
+  if (pTable->keyType == SDB_KEY_VAR_STRING) {
+    return *(char **)row;
+  }
+  return row;
+}
+
+static char *sdbGetRowStr(SSdbTable *pTable, void *row) {
+  return sdbGetkeyStr(pTable, sdbGetObjKey(pTable, row));
+}
+
 static void *sdbGetTableFromId(int32_t tableId) {
   return tsSdbObj.tableList[tableId];
 }
 
+static void sdbGetSnapshotFileName(char *name, char *fileName) {
+  sprintf(name, "%s/%s/%s", tsMnodeDir, SDB_SNAP_DIR, fileName);
+}
+
+static void sdbGetSnapshotTableFileName(char *name, SSdbTable *pTable, int32_t snapId) {
+  char fileName[TSDB_FILENAME_LEN];
+  sprintf(fileName, "%s.%d", pTable->tableName, snapId);
+  sdbGetSnapshotFileName(name, fileName);
+}
+
+static int32_t sdbCheckSnapshotRows(FILE *fp, SSdbSnapHead *pHead, char *buf, int32_t bufSize) {
+  TSCKSUM cksum = 0;
+  int64_t left = pHead->size;
+
+  while (left > 0) {
+    int32_t len = (int32_t)MIN(left, bufSize);
+    if (fread(buf, 1, len, fp) != len) return -1;
+    cksum = taosCalcChecksum(cksum, (uint8_t *)buf, len);
+    left -= len;
+  }
+
+  if (fgetc(fp) != EOF || cksum != pHead->rowsCksum) return -1;
+  return fseek(fp, sizeof(SSdbSnapHead), SEEK_SET);
+}
+
+static int32_t sdbLoadSnapshotTable(SSdbTable *pTable, int32_t snapId, int64_t version) {
+  char name[TSDB_FILENAME_LEN * 2];
+  sdbGetSnapshotTableFileName(name, pTable, snapId);
+
+  FILE *fp = fopen(name, "rb");
+  if (fp == NULL) {
+    sdbError("table:%s, failed to open snapshot file:%s(%s)", pTable->tableName, name, strerror(errno));
+    return -1;
+  }
+
+  int32_t      bufSize = MAX(pTable->maxRowSize, 65536);
+  char *       buf = malloc(bufSize);
+  SSdbSnapHead head = {0};
+  int32_t      code = -1;
+
+  if (buf == NULL) goto _over;
+
+  // the whole file is verified before any row is decoded
+  if (fread(&head, sizeof(SSdbSnapHead), 1, fp) != 1 || !taosCheckChecksumWhole((uint8_t *)&head, sizeof(SSdbSnapHead)) ||
+      head.signature != SDB_SNAP_SIGNATURE || head.tableId != pTable->tableId || head.snapId != snapId ||
+      head.version > version || sdbCheckSnapshotRows(fp, &head, buf, bufSize) != 0) {
+    sdbError("table:%s, snapshot file:%s is corrupted", pTable->tableName, name);
+    goto _over;
+  }
+
+  // size the index by the number of rows, then insert the rows without going through the wal
+  if ((pTable->keyType == SDB_KEY_STRING || pTable->keyType == SDB_KEY_VAR_STRING) && pTable->numOfRows == 0 &&
+      head.numOfRows > pTable->indexRows && head.numOfRows < INT32_MAX) {
+    (*sdbCleanUpIndexFp[pTable->keyType])(pTable->iHandle);
+    pTable->indexRows = (int32_t)head.numOfRows;
+    pTable->iHandle = (*sdbInitIndexFp[pTable->keyType])(pTable->indexRows, sizeof(SSdbRow));
+    if (pTable->iHandle == NULL) goto _over;
+  }
+
+  int64_t numOfRows = 0;
+  for (; numOfRows < head.numOfRows; ++numOfRows) {
+    int32_t len = 0;
+    if (fread(&len, sizeof(int32_t), 1, fp) != 1 || len <= 0 || len > pTable->maxRowSize) break;
+    if (fread(buf, len, 1, fp) != 1) break;
+
+    SSdbOper oper = {.table = pTable, .rowSize = len, .rowData = buf};
+    if ((*pTable->decodeFp)(&oper) != TSDB_CODE_SUCCESS) break;
+
+    SSdbRow rowMeta = {.rowSize = oper.rowSize, .row = oper.pObj};
+    (*sdbAddIndexFp[pTable->keyType])(pTable->iHandle, sdbGetObjKey(pTable, oper.pObj), &rowMeta);
+    sdbIncRef(pTable, oper.pObj);
+    pTable->numOfRows++;
+    pTable->changes++;
+    (*pTable->insertFp)(&oper);
+  }
+
+  if (numOfRows != head.numOfRows) {
+    sdbError("table:%s, failed to load row:%" PRId64 " from snapshot file:%s", pTable->tableName, numOfRows, name);
+    goto _over;
+  }
+
+  pTable->autoIndex = MAX(pTable->autoIndex, head.autoIndex);
+  pTable->snapId = snapId;
+  pTable->snapChanges = pTable->changes;
+  code = 0;
+
+  sdbTrace("table:%s, is loaded from snapshot:%d, numOfRows:%" PRId64 " version:%" PRId64, pTable->tableName, snapId,
+           head.numOfRows, head.version);
+
+_over:
+  free(buf);
+  fclose(fp);
+  return code;
+}
+
+static int32_t sdbLoadSnapshot() {
+  char name[TSDB_FILENAME_LEN * 2];
+  sdbGetSnapshotFileName(name, SDB_SNAP_MANIFEST);
+
+  FILE *fp = fopen(name, "rb");
+  if (fp == NULL) {
+    sdbTrace("no sdb snapshot in %s, restore from wal only", tsMnodeDir);
+    return 0;
+  }
+
+  SSdbSnapManifest manifest = {0};
+  int32_t          ret = fread(&manifest, sizeof(SSdbSnapManifest), 1, fp);
+  fclose(fp);
+
+  if (ret != 1 || !taosCheckChecksumWhole((uint8_t *)&manifest, sizeof(SSdbSnapManifest)) ||
+      manifest.signature != SDB_SNAP_SIGNATURE) {
+    sdbError("sdb snapshot manifest:%s is corrupted", name);
+    return -1;
+  }
+
+  for (int32_t tableId = 0; tableId < SDB_TABLE_MAX; ++tableId) {
+    SSdbTable *pTable = sdbGetTableFromId(tableId);
+    if (pTable == NULL || manifest.tableSnapId[tableId] == 0) continue;
+    if (sdbLoadSnapshotTable(pTable, manifest.tableSnapId[tableId], manifest.version) != 0) return -1;
+  }
+
+  // records in wal not newer than the snapshot are skipped by sdbWrite
+  tsSdbObj.version = manifest.version;
+  tsSdbObj.snapVersion = manifest.version;
+  tsSdbObj.snapId = manifest.snapId;
+
+  sdbPrint("sdb snapshot:%d is loaded, version:%" PRId64, manifest.snapId, manifest.version);
+  return 0;
+}
+
+// rows collected into the snapshot with their refs held, they are encoded after the sdb mutex is released
+typedef struct {
+  SSdbSnapHead head;
+  int64_t      changes;
+  void **      rows;
+} SSdbSnapTable;
+
+static int32_t sdbCollectSnapshotRows(SSdbTable *pTable, SSdbSnapTable *pSnap) {
+  pSnap->rows = malloc(sizeof(void *) * MAX(pTable->numOfRows, 1));
+  if (pSnap->rows == NULL) return -1;
+
+  // no change is in flight, rows can be fetched without the table lock
+  void *pNode = NULL;
+  while (pSnap->head.numOfRows < pTable->numOfRows) {
+    SSdbRow *pMeta = NULL;
+    pNode = (*sdbFetchRowFp[pTable->keyType])(pTable->iHandle, pNode, (void **)&pMeta);
+    if (pMeta == NULL) break;
+
+    sdbIncRef(pTable, pMeta->row);
+    pSnap->rows[pSnap->head.numOfRows++] = pMeta->row;
+  }
+
+  return 0;
+}
+
+static void sdbReleaseSnapshotRows(SSdbTable *pTable, SSdbSnapTable *pSnap) {
+  for (int64_t i = 0; i < pSnap->head.numOfRows; ++i) {
+    sdbDecRef(pTable, pSnap->rows[i]);
+  }
+
+  tfree(pSnap->rows);
+}
+
+/*
+ * a row changed after it is collected has a version newer than the snapshot, the change is replayed from wal over
+ * the snapshot during restore, so the row encoded here may be newer than the snapshot version
+ */
+static FILE *sdbWriteSnapshotTable(SSdbTable *pTable, SSdbSnapTable *pSnap, char *buf) {
+  char name[TSDB_FILENAME_LEN * 2];
+  sdbGetSnapshotTableFileName(name, pTable, pSnap->head.snapId);
+
+  FILE *fp = fopen(name, "wb");
+  if (fp == NULL) {
+    sdbError("table:%s, failed to create snapshot file:%s(%s)", pTable->tableName, name, strerror(errno));
+    return NULL;
+  }
+
+  SSdbSnapHead head = pSnap->head;
+  if (fwrite(&head, sizeof(SSdbSnapHead), 1, fp) != 1) goto _err;
+
+  for (int64_t i = 0; i < head.numOfRows; ++i) {
+    SSdbOper oper = {.table = pTable, .pObj = pSnap->rows[i], .rowData = buf};
+    (*pTable->encodeFp)(&oper);
+
+    int32_t len = oper.rowSize;
+    head.rowsCksum = taosCalcChecksum(head.rowsCksum, (uint8_t *)&len, sizeof(int32_t));
+    head.rowsCksum = taosCalcChecksum(head.rowsCksum, (uint8_t *)buf, len);
+    if (fwrite(&len, sizeof(int32_t), 1, fp) != 1 || fwrite(buf, len, 1, fp) != 1) goto _err;
+
+    head.size += sizeof(int32_t) + len;
+  }
+
+  taosCalcChecksumAppend(0, (uint8_t *)&head, sizeof(SSdbSnapHead));
+  if (fseek(fp, 0, SEEK_SET) != 0 || fwrite(&head, sizeof(SSdbSnapHead), 1, fp) != 1) goto _err;
+
+  sdbTrace("table:%s, is written into snapshot:%d, numOfRows:%" PRId64, pTable->tableName, head.snapId, head.numOfRows);
+  return fp;
+
+_err:
+  sdbError("table:%s, failed to write snapshot file:%s(%s)", pTable->tableName, name, strerror(errno));
+  fclose(fp);
+  remove(name);
+  return NULL;
+}
+
+static int32_t sdbSyncSnapshotFile(FILE *fp) {
+  int32_t code = 0;
+  if (fflush(fp) != 0 || fsync(fileno(fp)) != 0) code = -1;
+  if (fclose(fp) != 0) code = -1;
+  return code;
+}
+
+static int32_t sdbCommitSnapshot(SSdbSnapManifest *pManifest) {
+  char name[TSDB_FILENAME_LEN * 2];
+  char tname[TSDB_FILENAME_LEN * 3];
+  sdbGetSnapshotFileName(name, SDB_SNAP_MANIFEST);
+  sprintf(tname, "%s.t", name);
+
+  taosCalcChecksumAppend(0, (uint8_t *)pManifest, sizeof(SSdbSnapManifest));
+
+  FILE *fp = fopen(tname, "wb");
+  if (fp == NULL) return -1;
+
+  int32_t code = (fwrite(pManifest, sizeof(SSdbSnapManifest), 1, fp) == 1) ? 0 : -1;
+  if (sdbSyncSnapshotFile(fp) != 0) code = -1;
+  if (code == 0) code = rename(tname, name);
+
+  if (code == 0) {
+    char dirName[TSDB_FILENAME_LEN * 2];
+    sprintf(dirName, "%s/%s", tsMnodeDir, SDB_SNAP_DIR);
+    int32_t dfd = open(dirName, O_RDONLY);
+    if (dfd >= 0) {
+      fsync(dfd);
+      close(dfd);
+    }
+  } else {
+    remove(tname);
+  }
+
+  return code;
+}
+
+static void sdbRemoveUnusedSnapshotFiles() {
+  char dirName[TSDB_FILENAME_LEN * 2];
+  sprintf(dirName, "%s/%s", tsMnodeDir, SDB_SNAP_DIR);
+
+  DIR *dir = opendir(dirName);
+  if (dir == NULL) return;
+
+  struct dirent *ent;
+  while ((ent = readdir(dir)) != NULL) {
+    if (ent->d_name[0] == '.' || strcmp(ent->d_name, SDB_SNAP_MANIFEST) == 0) continue;
+
+    bool inUse = false;
+    for (int32_t tableId = 0; tableId < SDB_TABLE_MAX; ++tableId) {
+      SSdbTable *pTable = sdbGetTableFromId(tableId);
+      if (pTable == NULL || pTable->snapId == 0) continue;
+
+      char fileName[TSDB_FILENAME_LEN];
+      sprintf(fileName, "%s.%d", pTable->tableName, pTable->snapId);
+      if (strcmp(ent->d_name, fileName) == 0) {
+        inUse = true;
+        break;
+      }
+    }
+
+    if (!inUse) {
+      char name[TSDB_FILENAME_LEN * 3];
+      sdbGetSnapshotFileName(name, ent->d_name);
+      remove(name);
+    }
+  }
+
+  closedir(dir);
+}
+
+static int32_t sdbSaveSnapshot() {
+  char dirName[TSDB_FILENAME_LEN * 2];
+  sprintf(dirName, "%s/%s", tsMnodeDir, SDB_SNAP_DIR);
+  if (access(dirName, F_OK) != 0 && mkdir(dirName, 0755) != 0) {
+    sdbError("failed to create sdb snapshot dir:%s(%s)", dirName, strerror(errno));
+    return -1;
+  }
+
+  int32_t maxRowSize = 0;
+  for (int32_t tableId = 0; tableId < SDB_TABLE_MAX; ++tableId) {
+    SSdbTable *pTable = sdbGetTableFromId(tableId);
+    if (pTable != NULL) maxRowSize = MAX(maxRowSize, pTable->maxRowSize);
+  }
+
+  char *buf = malloc(maxRowSize);
+  if (buf == NULL) return -1;
+
+  // wait until no change is in flight, so that the tables match the version
+  pthread_mutex_lock(&tsSdbObj.mutex);
+  while (tsSdbObj.pending > 0) {
+    pthread_cond_wait(&tsSdbObj.idle, &tsSdbObj.mutex);
+  }
+
+  SSdbSnapManifest manifest = {.signature = SDB_SNAP_SIGNATURE, .snapId = tsSdbObj.snapId + 1, .version = tsSdbObj.version};
+  SSdbSnapTable    snaps[SDB_TABLE_MAX] = {{{0}}};
+  FILE *           files[SDB_TABLE_MAX] = {0};
+  bool             changed = (manifest.version != tsSdbObj.snapVersion);
+  int32_t          code = 0;
+
+  // only the row lists of the tables changed since the last snapshot are copied under the mutex
+  for (int32_t tableId = 0; tableId < SDB_TABLE_MAX; ++tableId) {
+    SSdbTable *pTable = sdbGetTableFromId(tableId);
+    if (pTable == NULL) continue;
+
+    manifest.tableSnapId[tableId] = pTable->snapId;
+    if (pTable->snapId != 0 && pTable->changes == pTable->snapChanges) continue;
+
+    changed = true;
+    SSdbSnapTable *pSnap = &snaps[tableId];
+    pSnap->head = (SSdbSnapHead){.signature = SDB_SNAP_SIGNATURE, .tableId = pTable->tableId,
+                                 .snapId = manifest.snapId, .autoIndex = pTable->autoIndex, .version = manifest.version};
+    pSnap->changes = pTable->changes;
+    if (sdbCollectSnapshotRows(pTable, pSnap) != 0) {
+      code = -1;
+      break;
+    }
+  }
+
+  // records in the older wal file are covered by the previous snapshot, it is removed by renew
+  if (code == 0 && changed && tsSdbObj.snapRenew) {
+    walRenew(tsSdbObj.wal);
+  }
+  pthread_mutex_unlock(&tsSdbObj.mutex);
+
+  for (int32_t tableId = 0; tableId < SDB_TABLE_MAX; ++tableId) {
+    SSdbTable *pTable = sdbGetTableFromId(tableId);
+    if (pTable == NULL || snaps[tableId].rows == NULL) continue;
+
+    if (code == 0) {
+      files[tableId] = sdbWriteSnapshotTable(pTable, &snaps[tableId], buf);
+      if (files[tableId] == NULL) code = -1;
+      manifest.tableSnapId[tableId] = manifest.snapId;
+    }
+
+    sdbReleaseSnapshotRows(pTable, &snaps[tableId]);
+  }
+  free(buf);
+
+  if (!changed) return 0;
+
+  for (int32_t tableId = 0; tableId < SDB_TABLE_MAX; ++tableId) {
+    if (files[tableId] != NULL && sdbSyncSnapshotFile(files[tableId]) != 0) code = -1;
+  }
+
+  if (code == 0) code = sdbCommitSnapshot(&manifest);
+
+  if (code != 0) {
+    sdbError("failed to save sdb snapshot:%d, version:%" PRId64, manifest.snapId, manifest.version);
+    tsSdbObj.snapRenew = false;
+    return -1;
+  }
+
+  for (int32_t tableId = 0; tableId < SDB_TABLE_MAX; ++tableId) {
+    SSdbTable *pTable = sdbGetTableFromId(tableId);
+    if (pTable == NULL || manifest.tableSnapId[tableId] != manifest.snapId) continue;
+    pTable->snapId = manifest.snapId;
+    pTable->snapChanges = snaps[tableId].changes;
+  }
+
+  tsSdbObj.snapId = manifest.snapId;
+  tsSdbObj.snapVersion = manifest.version;
+  tsSdbObj.snapRenew = true;
+  sdbRemoveUnusedSnapshotFiles();
+
+  sdbPrint("sdb snapshot:%d is saved, version:%" PRId64, manifest.snapId, manifest.version);
+  return 0;
+}
+
+static void *sdbSnapshotThread(void *param) {
+  int64_t lastTime = taosGetTimestampMs();
+
+  while (!tsSdbObj.snapStop) {
+    taosMsleep(100);
+
+    int64_t now = taosGetTimestampMs();
+    if (now - lastTime < (int64_t)tsSdbSnapshotInterval * 1000) continue;
+
+    lastTime = now;
+    sdbSaveSnapshot();
+  }
+
+  return NULL;
+}
+
+void sdbStopSnapshot() {
+  if (tsSdbObj.status != SDB_STATUS_SERVING || tsSdbSnapshotInterval <= 0) return;
+
+  tsSdbObj.snapStop = true;
+  pthread_join(tsSdbObj.snapThread, NULL);
+  sdbSaveSnapshot();
+}
+
 static int32_t sdbInitWal() {
   SWalCfg walCfg = {.commitLog = 2, .wals = 2, .keep = 1};
   tsSdbObj.wal = walOpen(tsMnodeDir, &walCfg);
@@ -145,6 +602,11 @@ static int32_t sdbInitWal() {
     return -1;
   }
 
+  if (sdbLoadSnapshot() != 0) {
+    sdbError("failed to load sdb snapshot in %s", tsMnodeDir);
+    return -1;
+  }
+
   sdbTrace("open sdb wal for restore");
   walRestore(tsSdbObj.wal, NULL, sdbWrite);
   return 0;
@@ -299,6 +761,7 @@ void sdbUpdateSync() {
 
 int32_t sdbInit() {
   pthread_mutex_init(&tsSdbObj.mutex, NULL);
+  pthread_cond_init(&tsSdbObj.idle, NULL);
   sem_init(&tsSdbObj.sem, 0, 0);
 
   if (sdbInitWal() != 0) {
@@ -314,6 +777,18 @@ int32_t sdbInit() {
   sdbUpdateSync();
 
   tsSdbObj.status = SDB_STATUS_SERVING;
+
+  if (tsSdbSnapshotInterval > 0) {
+    pthread_attr_t thAttr;
+    pthread_attr_init(&thAttr);
+    pthread_attr_setdetachstate(&thAttr, PTHREAD_CREATE_JOINABLE);
+    if (pthread_create(&tsSdbObj.snapThread, &thAttr, sdbSnapshotThread, NULL) != 0) {
+      sdbError("failed to create sdb snapshot thread(%s)", strerror(errno));
+      tsSdbSnapshotInterval = 0;
+    }
+    pthread_attr_destroy(&thAttr);
+  }
+
   return TSDB_CODE_SUCCESS;
 }
 
@@ -325,6 +800,7 @@ void sdbCleanUp() {
   walClose(tsSdbObj.wal);
   sem_destroy(&tsSdbObj.sem);
   pthread_mutex_destroy(&tsSdbObj.mutex);
+  pthread_cond_destroy(&tsSdbObj.idle);
   memset(&tsSdbObj, 0, sizeof(tsSdbObj));
 }
 
@@ -334,7 +810,7 @@ void sdbIncRef(void *handle, void *pRow) {
     int32_t *  pRefCount = (int32_t *)(pRow + pTable->refCountPos);
     atomic_add_fetch_32(pRefCount, 1);
     if (0 && strcmp(pTable->tableName, "accounts") == 0) {
-      sdbTrace("table:%s, add ref to record:%s:%s:%d", pTable->tableName, pTable->tableName, sdbGetkeyStr(pTable, pRow),
+      sdbTrace("table:%s, add ref to record:%s:%s:%d", pTable->tableName, pTable->tableName, sdbGetRowStr(pTable, pRow),
                *pRefCount);
     }
   }
@@ -346,13 +822,13 @@ void sdbDecRef(void *handle, void *pRow) {
     int32_t *  pRefCount = (int32_t *)(pRow + pTable->refCountPos);
     int32_t    refCount = atomic_sub_fetch_32(pRefCount, 1);
     if (0 && strcmp(pTable->tableName, "accounts") == 0) {
-      sdbTrace("table:%s, def ref of record:%s:%s:%d", pTable->tableName, pTable->tableName, sdbGetkeyStr(pTable, pRow),
+      sdbTrace("table:%s, def ref of record:%s:%s:%d", pTable->tableName, pTable->tableName, sdbGetRowStr(pTable, pRow),
                *pRefCount);
     }
     int8_t *updateEnd = pRow + pTable->refCountPos - 1;
     if (refCount <= 0 && *updateEnd) {
       sdbTrace("table:%s, record:%s:%s:%d is destroyed", pTable->tableName, pTable->tableName,
-               sdbGetkeyStr(pTable, pRow), *pRefCount);
+               sdbGetRowStr(pTable, pRow), *pRefCount);
       SSdbOper oper = {.pObj = pRow};
       (*pTable->destroyFp)(&oper);
     }
@@ -376,10 +852,10 @@ void *sdbGetRow(void *handle, void *key) {
 
   if (handle == NULL) return NULL;
 
-  pthread_mutex_lock(&pTable->mutex);
+  pthread_rwlock_rdlock(&pTable->rwLock);
   pMeta = (*sdbGetIndexFp[pTable->keyType])(pTable->iHandle, key);
   if (pMeta) sdbIncRef(pTable, pMeta->row);
-  pthread_mutex_unlock(&pTable->mutex);
+  pthread_rwlock_unlock(&pTable->rwLock);
 
   if (pMeta == NULL) {
     return NULL;
@@ -388,15 +864,34 @@ void *sdbGetRow(void *handle, void *key) {
   return pMeta->row;
 }
 
+/*
+ * the owner of the slot clears it in deleteFp, before the row leaves the index under the write lock and
+ * loses its last ref, so a row still found in the slot under the read lock can safely be referenced
+ */
+void *sdbGetRowFromSlot(void *handle, void **ppSlot) {
+  SSdbTable *pTable = (SSdbTable *)handle;
+  void *     pRow;
+
+  if (handle == NULL) return NULL;
+
+  pthread_rwlock_rdlock(&pTable->rwLock);
+  pRow = *ppSlot;
+  if (pRow) sdbIncRef(pTable, pRow);
+  pthread_rwlock_unlock(&pTable->rwLock);
+
+  return pRow;
+}
+
 static int32_t sdbInsertHash(SSdbTable *pTable, SSdbOper *pOper) {
   SSdbRow rowMeta;
   rowMeta.rowSize = pOper->rowSize;
   rowMeta.row = pOper->pObj;
 
-  pthread_mutex_lock(&pTable->mutex);
-  (*sdbAddIndexFp[pTable->keyType])(pTable->iHandle, pOper->pObj, &rowMeta);
+  pthread_rwlock_wrlock(&pTable->rwLock);
+  (*sdbAddIndexFp[pTable->keyType])(pTable->iHandle, sdbGetObjKey(pTable, pOper->pObj), &rowMeta);
   sdbIncRef(pTable, pOper->pObj);
   pTable->numOfRows++;
+  pTable->changes++;
 
   if (pTable->keyType == SDB_KEY_AUTO) {
     pTable->autoIndex = MAX(pTable->autoIndex, *((uint32_t *)pOper->pObj));
@@ -404,10 +899,10 @@ static int32_t sdbInsertHash(SSdbTable *pTable, SSdbOper *pOper) {
     pTable->autoIndex++;
   }
 
-  pthread_mutex_unlock(&pTable->mutex);
+  pthread_rwlock_unlock(&pTable->rwLock);
 
   sdbTrace("table:%s, insert record:%s to hash, numOfRows:%d version:%" PRIu64, pTable->tableName,
-           sdbGetkeyStr(pTable, pOper->pObj), pTable->numOfRows, sdbGetVersion());
+           sdbGetRowStr(pTable, pOper->pObj), pTable->numOfRows, sdbGetVersion());
 
   (*pTable->insertFp)(pOper);
   return TSDB_CODE_SUCCESS;
@@ -416,13 +911,14 @@ static int32_t sdbInsertHash(SSdbTable *pTable, SSdbOper *pOper) {
 static int32_t sdbDeleteHash(SSdbTable *pTable, SSdbOper *pOper) {
   (*pTable->deleteFp)(pOper);
   
-  pthread_mutex_lock(&pTable->mutex);
-  (*sdbDeleteIndexFp[pTable->keyType])(pTable->iHandle, pOper->pObj);
+  pthread_rwlock_wrlock(&pTable->rwLock);
+  (*sdbDeleteIndexFp[pTable->keyType])(pTable->iHandle, sdbGetObjKey(pTable, pOper->pObj));
   pTable->numOfRows--;
-  pthread_mutex_unlock(&pTable->mutex);
+  pTable->changes++;
+  pthread_rwlock_unlock(&pTable->rwLock);
 
   sdbTrace("table:%s, delete record:%s from hash, numOfRows:%d version:%" PRIu64, pTable->tableName,
-           sdbGetkeyStr(pTable, pOper->pObj), pTable->numOfRows, sdbGetVersion());
+           sdbGetRowStr(pTable, pOper->pObj), pTable->numOfRows, sdbGetVersion());
 
   int8_t *updateEnd = pOper->pObj + pTable->refCountPos - 1;
   *updateEnd = 1;
@@ -433,12 +929,28 @@ static int32_t sdbDeleteHash(SSdbTable *pTable, SSdbOper *pOper) {
 
 static int32_t sdbUpdateHash(SSdbTable *pTable, SSdbOper *pOper) {
   sdbTrace("table:%s, update record:%s in hash, numOfRows:%d version:%" PRIu64, pTable->tableName,
-           sdbGetkeyStr(pTable, pOper->pObj), pTable->numOfRows, sdbGetVersion());
+           sdbGetRowStr(pTable, pOper->pObj), pTable->numOfRows, sdbGetVersion());
 
   (*pTable->updateFp)(pOper);
+  atomic_add_fetch_64(&pTable->changes, 1);
   return TSDB_CODE_SUCCESS;
 }
 
+// changes not written into wal are counted as pending as well, so a snapshot never sees half of them
+static void sdbBeginLocalChange() {
+  pthread_mutex_lock(&tsSdbObj.mutex);
+  tsSdbObj.pending++;
+  pthread_mutex_unlock(&tsSdbObj.mutex);
+}
+
+static void sdbEndChange() {
+  pthread_mutex_lock(&tsSdbObj.mutex);
+  if (--tsSdbObj.pending == 0) {
+    pthread_cond_broadcast(&tsSdbObj.idle);
+  }
+  pthread_mutex_unlock(&tsSdbObj.mutex);
+}
+
 static int sdbWrite(void *param, void *data, int type) {
   SWalHead *pHead = data;
   int32_t   tableId = pHead->msgType / 10;
@@ -476,6 +988,7 @@ static int sdbWrite(void *param, void *data, int type) {
   walFsync(tsSdbObj.wal);
 
   sdbForwardToPeer(pHead);
+  tsSdbObj.pending++;
   pthread_mutex_unlock(&tsSdbObj.mutex);
 
   // from app, oper is created
@@ -489,40 +1002,43 @@ static int sdbWrite(void *param, void *data, int type) {
   if (action == SDB_ACTION_INSERT) {
     SSdbOper oper = {.rowSize = pHead->len, .rowData = pHead->cont, .table = pTable};
     code = (*pTable->decodeFp)(&oper);
-    return sdbInsertHash(pTable, &oper);
+    code = sdbInsertHash(pTable, &oper);
   } else if (action == SDB_ACTION_DELETE) {
     SSdbRow *rowMeta = sdbGetRowMeta(pTable, pHead->cont);
     assert(rowMeta != NULL && rowMeta->row != NULL);
     SSdbOper oper = {.table = pTable, .pObj = rowMeta->row};
-    return sdbDeleteHash(pTable, &oper);
+    code = sdbDeleteHash(pTable, &oper);
   } else if (action == SDB_ACTION_UPDATE) {
     SSdbRow *rowMeta = sdbGetRowMeta(pTable, pHead->cont);
     assert(rowMeta != NULL && rowMeta->row != NULL);
     SSdbOper oper = {.rowSize = pHead->len, .rowData = pHead->cont, .table = pTable};
     code = (*pTable->decodeFp)(&oper);
-    return sdbUpdateHash(pTable, &oper);
-  } else { return TSDB_CODE_INVALID_MSG_TYPE; }
+    code = sdbUpdateHash(pTable, &oper);
+  } else { code = TSDB_CODE_INVALID_MSG_TYPE; }
+
+  sdbEndChange();
+  return code;
 }
 
 int32_t sdbInsertRow(SSdbOper *pOper) {
   SSdbTable *pTable = (SSdbTable *)pOper->table;
   if (pTable == NULL) return -1;
 
-  if (sdbGetRow(pTable, pOper->pObj)) {
-    sdbError("table:%s, failed to insert record:%s, already exist", pTable->tableName, sdbGetkeyStr(pTable, pOper->pObj));
+  if (sdbGetRow(pTable, sdbGetObjKey(pTable, pOper->pObj))) {
+    sdbError("table:%s, failed to insert record:%s, already exist", pTable->tableName, sdbGetRowStr(pTable, pOper->pObj));
     sdbDecRef(pTable, pOper->pObj);
     return TSDB_CODE_ALREADY_THERE;
   }
 
   if (pTable->keyType == SDB_KEY_AUTO) {
-    pthread_mutex_lock(&pTable->mutex);
+    pthread_rwlock_wrlock(&pTable->rwLock);
     *((uint32_t *)pOper->pObj) = ++pTable->autoIndex;
 
     // let vgId increase from 2
     if (pTable->autoIndex == 1 && strcmp(pTable->tableName, "vgroups") == 0) {
       *((uint32_t *)pOper->pObj) = ++pTable->autoIndex;
     }
-    pthread_mutex_unlock(&pTable->mutex);
+    pthread_rwlock_unlock(&pTable->rwLock);
   }
 
   if (pOper->type == SDB_OPER_GLOBAL) {
@@ -539,16 +1055,20 @@ int32_t sdbInsertRow(SSdbOper *pOper) {
     int32_t code = sdbWrite(pOper, pHead, pHead->msgType);
     taosFreeQitem(pHead);
     if (code < 0) return code;
+  } else {
+    sdbBeginLocalChange();
   }
 
-  return sdbInsertHash(pTable, pOper);
+  int32_t code = sdbInsertHash(pTable, pOper);
+  sdbEndChange();
+  return code;
 }
 
 int32_t sdbDeleteRow(SSdbOper *pOper) {
   SSdbTable *pTable = (SSdbTable *)pOper->table;
   if (pTable == NULL) return -1;
 
-  SSdbRow *pMeta = sdbGetRowMeta(pTable, pOper->pObj);
+  SSdbRow *pMeta = sdbGetRowMeta(pTable, sdbGetObjKey(pTable, pOper->pObj));
   if (pMeta == NULL) {
     sdbTrace("table:%s, record is not there, delete failed", pTable->tableName);
     return -1;
@@ -561,7 +1081,8 @@ int32_t sdbDeleteRow(SSdbOper *pOper) {
     int32_t rowSize = 0;
     switch (pTable->keyType) {
       case SDB_KEY_STRING:
-        rowSize = strlen((char *)pOper->pObj) + 1;
+      case SDB_KEY_VAR_STRING:
+        rowSize = strlen((char *)sdbGetObjKey(pTable, pOper->pObj)) + 1;
         break;
       case SDB_KEY_INT:
       case SDB_KEY_AUTO:
@@ -576,21 +1097,25 @@ int32_t sdbDeleteRow(SSdbOper *pOper) {
     pHead->version = 0;
     pHead->len = rowSize;
     pHead->msgType = pTable->tableId * 10 + SDB_ACTION_DELETE;
-    memcpy(pHead->cont, pOper->pObj, rowSize);
+    memcpy(pHead->cont, sdbGetObjKey(pTable, pOper->pObj), rowSize);
 
     int32_t code = sdbWrite(pOper, pHead, pHead->msgType);
     taosFreeQitem(pHead);
     if (code < 0) return code;
+  } else {
+    sdbBeginLocalChange();
   }
 
-  return sdbDeleteHash(pTable, pOper);
+  int32_t code = sdbDeleteHash(pTable, pOper);
+  sdbEndChange();
+  return code;
 }
 
 int32_t sdbUpdateRow(SSdbOper *pOper) {
   SSdbTable *pTable = (SSdbTable *)pOper->table;
   if (pTable == NULL) return -1;
 
-  SSdbRow *pMeta = sdbGetRowMeta(pTable, pOper->pObj);
+  SSdbRow *pMeta = sdbGetRowMeta(pTable, sdbGetObjKey(pTable, pOper->pObj));
   if (pMeta == NULL) {
     sdbTrace("table:%s, record is not there, delete failed", pTable->tableName);
     return -1;
@@ -612,9 +1137,13 @@ int32_t sdbUpdateRow(SSdbOper *pOper) {
     int32_t code = sdbWrite(pOper, pHead, pHead->msgType);
     taosFreeQitem(pHead);
     if (code < 0) return code;
-  } 
-  
-  return sdbUpdateHash(pTable, pOper);
+  } else {
+    sdbBeginLocalChange();
+  }
+
+  int32_t code = sdbUpdateHash(pTable, pOper);
+  sdbEndChange();
+  return code;
 }
 
 void *sdbFetchRow(void *handle, void *pNode, void **ppRow) {
@@ -624,12 +1153,15 @@ void *sdbFetchRow(void *handle, void *pNode, void **ppRow) {
   *ppRow = NULL;
   if (pTable == NULL) return NULL;
 
+  pthread_rwlock_rdlock(&pTable->rwLock);
   pNode = (*sdbFetchRowFp[pTable->keyType])(pTable->iHandle, pNode, (void **)&pMeta);
-  if (pMeta == NULL) return NULL;
-
-  *ppRow = pMeta->row;
-  sdbIncRef(handle, pMeta->row);
+  if (pMeta != NULL) {
+    *ppRow = pMeta->row;
+    sdbIncRef(handle, pMeta->row);
+  }
+  pthread_rwlock_unlock(&pTable->rwLock);
 
+  if (pMeta == NULL) return NULL;
   return pNode;
 }
 
@@ -653,10 +1185,19 @@ void *sdbOpenTable(SSdbTableDesc *pDesc) {
   pTable->restoredFp   = pDesc->restoredFp;
   
   if (sdbInitIndexFp[pTable->keyType] != NULL) {
-    pTable->iHandle = (*sdbInitIndexFp[pTable->keyType])(pTable->maxRowSize, sizeof(SSdbRow));
+    pTable->indexRows = pTable->maxRowSize;
+    pTable->iHandle = (*sdbInitIndexFp[pTable->keyType])(pTable->indexRows, sizeof(SSdbRow));
   }
 
-  pthread_mutex_init(&pTable->mutex, NULL);
+  // a steady stream of lookups from the read workers must not starve the index writes, no thread takes the read
+  // lock twice, so a waiting writer can be preferred without deadlocking a reader
+  pthread_rwlockattr_t attr;
+  pthread_rwlockattr_init(&attr);
+#if defined(LINUX)
+  pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+  pthread_rwlock_init(&pTable->rwLock, &attr);
+  pthread_rwlockattr_destroy(&attr);
 
   tsSdbObj.numOfTables++;
   tsSdbObj.tableList[pTable->tableId] = pTable;
@@ -688,7 +1229,7 @@ void sdbCloseTable(void *handle) {
     (*sdbCleanUpIndexFp[pTable->keyType])(pTable->iHandle);
   }
 
-  pthread_mutex_destroy(&pTable->mutex);
+  pthread_rwlock_destroy(&pTable->rwLock);
   
   sdbTrace("table:%s, is closed, numOfTables:%d", pTable->tableName, tsSdbObj.numOfTables);
   free(pTable);
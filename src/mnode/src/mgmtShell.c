@@ -42,6 +42,7 @@ typedef int32_t (*SShowRetrieveFp)(SShowObj *pShow, char *data, int32_t rows, vo
 
 static int  mgmtShellRetriveAuth(char *user, char *spi, char *encrypt, char *secret, char *ckey);
 static bool mgmtCheckMsgReadOnly(SQueuedMsg *pMsg);
+static bool mgmtCheckMsgShow(SQueuedMsg *pMsg);
 static void mgmtProcessMsgFromShell(SRpcMsg *pMsg);
 static void mgmtProcessUnSupportMsg(SRpcMsg *rpcMsg);
 static void mgmtProcessShowMsg(SQueuedMsg *queuedMsg);
@@ -53,6 +54,8 @@ static void mgmtProcessUseMsg(SQueuedMsg *queuedMsg);
 extern void *tsMgmtTmr;
 static void *tsMgmtShellRpc = NULL;
 static void *tsMgmtTranQhandle = NULL;
+static void *tsMgmtShowQhandle = NULL;
+static void *tsMgmtReadQhandle = NULL;
 static void (*tsMgmtProcessShellMsgFp[TSDB_MSG_TYPE_MAX])(SQueuedMsg *) = {0};
 static SShowMetaFp     tsMgmtShowMetaFp[TSDB_MGMT_TABLE_MAX]     = {0};
 static SShowRetrieveFp tsMgmtShowRetrieveFp[TSDB_MGMT_TABLE_MAX] = {0};
@@ -71,6 +74,16 @@ int32_t mgmtInitShell() {
     numOfThreads = 1;
   }
 
+  // show and retrieve may walk millions of rows, keep them off the rpc threads
+  tsMgmtShowQhandle = taosInitScheduler(tsMaxShellConns, numOfThreads, "mnodeS");
+
+  // reads only look up sdb rows, they run concurrently while writes stay serialized in mnodeT
+  int32_t numOfReadThreads = tsNumOfCores * tsNumOfThreadsPerCore / 2.0;
+  if (numOfReadThreads < 1) {
+    numOfReadThreads = 1;
+  }
+  tsMgmtReadQhandle = taosInitScheduler(tsMaxShellConns, numOfReadThreads, "mnodeR");
+
   SRpcInit rpcInit = {0};
   rpcInit.localIp      = tsAnyIp ? "0.0.0.0" : tsPrivateIp;
   rpcInit.localPort    = tsMnodeShellPort;
@@ -98,6 +111,16 @@ void mgmtCleanUpShell() {
     tsMgmtTranQhandle = NULL;
   }
 
+  if (tsMgmtShowQhandle) {
+    taosCleanUpScheduler(tsMgmtShowQhandle);
+    tsMgmtShowQhandle = NULL;
+  }
+
+  if (tsMgmtReadQhandle) {
+    taosCleanUpScheduler(tsMgmtReadQhandle);
+    tsMgmtReadQhandle = NULL;
+  }
+
   if (tsMgmtShellRpc) {
     rpcClose(tsMgmtShellRpc);
     tsMgmtShellRpc = NULL;
@@ -130,6 +153,20 @@ void mgmtAddToShellQueue(SQueuedMsg *queuedMsg) {
   taosScheduleTask(tsMgmtTranQhandle, &schedMsg);
 }
 
+static void mgmtAddToShowQueue(SQueuedMsg *queuedMsg) {
+  SSchedMsg schedMsg;
+  schedMsg.msg = queuedMsg;
+  schedMsg.fp  = mgmtProcessTranRequest;
+  taosScheduleTask(tsMgmtShowQhandle, &schedMsg);
+}
+
+static void mgmtAddToReadQueue(SQueuedMsg *queuedMsg) {
+  SSchedMsg schedMsg;
+  schedMsg.msg = queuedMsg;
+  schedMsg.fp  = mgmtProcessTranRequest;
+  taosScheduleTask(tsMgmtReadQhandle, &schedMsg);
+}
+
 static void mgmtDoDealyedAddToShellQueue(void *param, void *tmrId) {
   mgmtAddToShellQueue(param);
 }
@@ -181,9 +218,10 @@ static void mgmtProcessMsgFromShell(SRpcMsg *rpcMsg) {
     return;
   }
   
-  if (mgmtCheckMsgReadOnly(pMsg)) {
-    (*tsMgmtProcessShellMsgFp[rpcMsg->msgType])(pMsg);
-    mgmtFreeQueuedMsg(pMsg);
+  if (mgmtCheckMsgShow(pMsg)) {
+    mgmtAddToShowQueue(pMsg);
+  } else if (mgmtCheckMsgReadOnly(pMsg)) {
+    mgmtAddToReadQueue(pMsg);
   } else {
     if (!pMsg->pUser->writeAuth) {
       mgmtSendSimpleResp(pMsg->thandle, TSDB_CODE_NO_RIGHTS);
@@ -236,7 +274,7 @@ static void mgmtProcessShowMsg(SQueuedMsg *pMsg) {
     return;
   }
 
-  SShowObj *pShow = (SShowObj *) calloc(1, sizeof(SShowObj) + htons(pShowMsg->payloadLen));
+  SShowObj *pShow = (SShowObj *) calloc(1, sizeof(SShowObj) + htons(pShowMsg->payloadLen) + 1);
   pShow->signature  = pShow;
   pShow->type       = pShowMsg->type;
   pShow->payloadLen = htons(pShowMsg->payloadLen);
@@ -337,6 +375,14 @@ static void mgmtProcessRetrieveMsg(SQueuedMsg *pMsg) {
 }
 
 static void mgmtProcessHeartBeatMsg(SQueuedMsg *pMsg) {
+  // query and stream lists are left out by the client while they are the same as in the last acked heartbeat
+  if (pMsg->contLen >= sizeof(SMgmtHead) + sizeof(SCMHeartBeatMsg) - sizeof(SQqueryList) - sizeof(SStreamList)) {
+    SCMHeartBeatMsg *pHBMsg = (SCMHeartBeatMsg *)((char *)pMsg->pCont + sizeof(SMgmtHead));
+    if (!pHBMsg->unchanged) {
+      mTrace("heartbeat is received, lists are changed, version:%u", htonl(pHBMsg->version));
+    }
+  }
+
   SCMHeartBeatRsp *pHBRsp = (SCMHeartBeatRsp *) rpcMallocCont(sizeof(SCMHeartBeatRsp));
   if (pHBRsp == NULL) {
     mgmtSendSimpleResp(pMsg->thandle, TSDB_CODE_SERV_OUT_OF_MEMORY);
@@ -485,13 +531,18 @@ static bool mgmtCheckMsgReadOnly(SQueuedMsg *pMsg) {
 
   if (pMsg->msgType == TSDB_MSG_TYPE_CM_STABLE_VGROUP || pMsg->msgType == TSDB_MSG_TYPE_RETRIEVE       ||
       pMsg->msgType == TSDB_MSG_TYPE_CM_SHOW          || pMsg->msgType == TSDB_MSG_TYPE_CM_TABLES_META ||
-      pMsg->msgType == TSDB_MSG_TYPE_CM_CONNECT) {
+      pMsg->msgType == TSDB_MSG_TYPE_CM_CONNECT       || pMsg->msgType == TSDB_MSG_TYPE_CM_HEARTBEAT   ||
+      pMsg->msgType == TSDB_MSG_TYPE_CM_USE_DB) {
     return true;
   }
 
   return false;
 }
 
+static bool mgmtCheckMsgShow(SQueuedMsg *pMsg) {
+  return pMsg->msgType == TSDB_MSG_TYPE_CM_SHOW || pMsg->msgType == TSDB_MSG_TYPE_RETRIEVE;
+}
+
 static void mgmtProcessUnSupportMsg(SRpcMsg *rpcMsg) {
   mError("%s is not processed in mnode shell", taosMsg[rpcMsg->msgType]);
   SRpcMsg rpcRsp = {
@@ -41,6 +41,34 @@
 #include "mgmtVgroup.h"
 #include "tcompare.h"
 
+// the persisted rows keep the fixed-size table id, the objects in memory only hold the exact-size name
+typedef struct {
+  char     tableId[TSDB_TABLE_ID_LEN + 1];
+  int8_t   type;
+  uint64_t uid;
+  int64_t  createdTime;
+  int32_t  sversion;
+  int32_t  numOfColumns;
+  int32_t  sid;
+  int32_t  vgId;
+  char     superTableId[TSDB_TABLE_ID_LEN + 1];
+  int32_t  sqlLen;
+  int8_t   reserved[1];
+  int8_t   updateEnd[1];
+} SChildTableRow;
+
+typedef struct {
+  char     tableId[TSDB_TABLE_ID_LEN + 1];
+  int8_t   type;
+  uint64_t uid;
+  int64_t  createdTime;
+  int32_t  sversion;
+  int32_t  numOfColumns;
+  int32_t  numOfTags;
+  int8_t   reserved[15];
+  int8_t   updateEnd[1];
+} SSuperTableRow;
+
 void *  tsChildTableSdb;
 void *  tsSuperTableSdb;
 static int32_t tsChildTableUpdateSize;
@@ -78,6 +106,16 @@ static void mgmtGetChildTableMeta(SQueuedMsg *pMsg);
 static void mgmtProcessAlterTableMsg(SQueuedMsg *queueMsg);
 static void mgmtProcessAlterTableRsp(SRpcMsg *rpcMsg);
 
+static SChildTableObj *mgmtAllocChildTable(char *tableId) {
+  int32_t len = strlen(tableId) + 1;
+  SChildTableObj *pTable = calloc(1, sizeof(SChildTableObj) + len);
+  if (pTable == NULL) return NULL;
+
+  pTable->info.tableId = (char *)(pTable + 1);
+  memcpy(pTable->info.tableId, tableId, len);
+  return pTable;
+}
+
 static void mgmtDestroyChildTable(SChildTableObj *pTable) {
   tfree(pTable->schema);
   tfree(pTable->sql);
@@ -114,10 +152,12 @@ static int32_t mgmtChildTableActionInsert(SSdbOper *pOper) {
   mgmtDecAcctRef(pAcct);
 
   if (pTable->info.type == TSDB_CHILD_TABLE) {
-    pTable->superTable = mgmtGetSuperTable(pTable->superTableId);
-    mgmtAddTableIntoStable(pTable->superTable, pTable);
-    grantAdd(TSDB_GRANT_TIMESERIES, pTable->superTable->numOfColumns - 1);
-    pAcct->acctInfo.numOfTimeSeries += (pTable->superTable->numOfColumns - 1);
+    if (pTable->superTable != NULL) {
+      mgmtIncTableRef(pTable->superTable);
+      mgmtAddTableIntoStable(pTable->superTable, pTable);
+      grantAdd(TSDB_GRANT_TIMESERIES, pTable->superTable->numOfColumns - 1);
+      pAcct->acctInfo.numOfTimeSeries += (pTable->superTable->numOfColumns - 1);
+    }
   } else {
     grantAdd(TSDB_GRANT_TIMESERIES, pTable->numOfColumns - 1);
     pAcct->acctInfo.numOfTimeSeries += (pTable->numOfColumns - 1);
@@ -156,10 +196,12 @@ static int32_t mgmtChildTableActionDelete(SSdbOper *pOper) {
   mgmtDecAcctRef(pAcct);
 
   if (pTable->info.type == TSDB_CHILD_TABLE) {
-    grantRestore(TSDB_GRANT_TIMESERIES, pTable->superTable->numOfColumns - 1);
-    pAcct->acctInfo.numOfTimeSeries -= (pTable->superTable->numOfColumns - 1);
-    mgmtRemoveTableFromStable(pTable->superTable, pTable);
-    mgmtDecTableRef(pTable->superTable);
+    if (pTable->superTable != NULL) {
+      grantRestore(TSDB_GRANT_TIMESERIES, pTable->superTable->numOfColumns - 1);
+      pAcct->acctInfo.numOfTimeSeries -= (pTable->superTable->numOfColumns - 1);
+      mgmtRemoveTableFromStable(pTable->superTable, pTable);
+      mgmtDecTableRef(pTable->superTable);
+    }
   } else {
     grantRestore(TSDB_GRANT_TIMESERIES, pTable->numOfColumns - 1);
     pAcct->acctInfo.numOfTimeSeries -= (pTable->numOfColumns - 1);
@@ -176,7 +218,13 @@ static int32_t mgmtChildTableActionUpdate(SSdbOper *pOper) {
   if (pTable != pNew) {
     void *oldSql = pTable->sql;
     void *oldSchema = pTable->schema;
-    memcpy(pTable, pNew, pOper->rowSize);
+    pTable->uid = pNew->uid;
+    pTable->createdTime = pNew->createdTime;
+    pTable->sversion = pNew->sversion;
+    pTable->numOfColumns = pNew->numOfColumns;
+    pTable->sid = pNew->sid;
+    pTable->vgId = pNew->vgId;
+    pTable->sqlLen = pNew->sqlLen;
     pTable->sql = pNew->sql;
     pTable->schema = pNew->schema;
     free(pNew);
@@ -188,19 +236,32 @@ static int32_t mgmtChildTableActionUpdate(SSdbOper *pOper) {
 }
 
 static int32_t mgmtChildTableActionEncode(SSdbOper *pOper) {
-  const int32_t maxRowSize = sizeof(SChildTableObj) + sizeof(SSchema) * TSDB_MAX_COLUMNS;
+  const int32_t maxRowSize = sizeof(SChildTableRow) + sizeof(SSchema) * TSDB_MAX_COLUMNS;
   SChildTableObj *pTable = pOper->pObj;
   assert(pTable != NULL && pOper->rowData != NULL);
 
+  SChildTableRow *pRow = pOper->rowData;
+  memset(pRow, 0, tsChildTableUpdateSize);
+  strncpy(pRow->tableId, pTable->info.tableId, TSDB_TABLE_ID_LEN);
+  pRow->type = pTable->info.type;
+  pRow->uid = pTable->uid;
+  pRow->createdTime = pTable->createdTime;
+  pRow->sversion = pTable->sversion;
+  pRow->numOfColumns = pTable->numOfColumns;
+  pRow->sid = pTable->sid;
+  pRow->vgId = pTable->vgId;
+  pRow->sqlLen = pTable->sqlLen;
+
   if (pTable->info.type == TSDB_CHILD_TABLE) {
-    memcpy(pOper->rowData, pTable, tsChildTableUpdateSize);
+    if (pTable->superTable != NULL) {
+      strncpy(pRow->superTableId, pTable->superTable->info.tableId, TSDB_TABLE_ID_LEN);
+    }
     pOper->rowSize = tsChildTableUpdateSize;
   } else {
     int32_t schemaSize = pTable->numOfColumns * sizeof(SSchema);
-    if (maxRowSize < tsChildTableUpdateSize + schemaSize) {
+    if (maxRowSize < tsChildTableUpdateSize + schemaSize + pTable->sqlLen) {
       return TSDB_CODE_INVALID_MSG_LEN;
     }
-    memcpy(pOper->rowData, pTable, tsChildTableUpdateSize);
     memcpy(pOper->rowData + tsChildTableUpdateSize, pTable->schema, schemaSize);
     memcpy(pOper->rowData + tsChildTableUpdateSize + schemaSize, pTable->sql, pTable->sqlLen);
     pOper->rowSize = tsChildTableUpdateSize + schemaSize + pTable->sqlLen;
@@ -211,14 +272,29 @@ static int32_t mgmtChildTableActionEncode(SSdbOper *pOper) {
 
 static int32_t mgmtChildTableActionDecode(SSdbOper *pOper) {
   assert(pOper->rowData != NULL);
-  SChildTableObj *pTable = calloc(1, sizeof(SChildTableObj));
+  SChildTableRow *pRow = pOper->rowData;
+  pRow->tableId[TSDB_TABLE_ID_LEN] = 0;
+  pRow->superTableId[TSDB_TABLE_ID_LEN] = 0;
+
+  SChildTableObj *pTable = mgmtAllocChildTable(pRow->tableId);
   if (pTable == NULL) {
     return TSDB_CODE_SERV_OUT_OF_MEMORY;
   }
 
-  memcpy(pTable, pOper->rowData, tsChildTableUpdateSize);
+  pTable->info.type = pRow->type;
+  pTable->uid = pRow->uid;
+  pTable->createdTime = pRow->createdTime;
+  pTable->sversion = pRow->sversion;
+  pTable->numOfColumns = pRow->numOfColumns;
+  pTable->sid = pRow->sid;
+  pTable->vgId = pRow->vgId;
+  pTable->sqlLen = pRow->sqlLen;
 
-  if (pTable->info.type != TSDB_CHILD_TABLE) {
+  if (pTable->info.type == TSDB_CHILD_TABLE) {
+    // the reference is taken when the row is inserted
+    pTable->superTable = mgmtGetSuperTable(pRow->superTableId);
+    mgmtDecTableRef(pTable->superTable);
+  } else {
     int32_t schemaSize = pTable->numOfColumns * sizeof(SSchema);
     pTable->schema = (SSchema *)malloc(schemaSize);
     if (pTable->schema == NULL) {
@@ -303,9 +379,8 @@ static int32_t mgmtChildTableActionRestored() {
     }
 
     if (pTable->info.type == TSDB_CHILD_TABLE) {
-      SSuperTableObj *pSuperTable = mgmtGetSuperTable(pTable->superTableId);
-      if (pSuperTable == NULL) {
-        mError("ctable:%s, stable:%s not exist", pTable->info.tableId, pTable->superTableId);
+      if (pTable->superTable == NULL) {
+        mError("ctable:%s, stable not exist", pTable->info.tableId);
         pTable->vgId = 0;
         SSdbOper desc = {0};
         desc.type = SDB_OPER_LOCAL;
@@ -315,7 +390,6 @@ static int32_t mgmtChildTableActionRestored() {
         pNode = pLastNode;
         continue;
       }
-      mgmtDecTableRef(pSuperTable);
     }
   }
 
@@ -324,15 +398,16 @@ static int32_t mgmtChildTableActionRestored() {
 
 static int32_t mgmtInitChildTables() {
   SChildTableObj tObj;
-  tsChildTableUpdateSize = (int8_t *)tObj.updateEnd - (int8_t *)&tObj;
+  SChildTableRow tRow;
+  tsChildTableUpdateSize = (int8_t *)tRow.updateEnd - (int8_t *)&tRow;
 
   SSdbTableDesc tableDesc = {
     .tableId      = SDB_TABLE_CTABLE,
     .tableName    = "ctables",
     .hashSessions = tsMaxTables,
-    .maxRowSize   = sizeof(SChildTableObj) + sizeof(SSchema) * TSDB_MAX_COLUMNS,
+    .maxRowSize   = sizeof(SChildTableRow) + sizeof(SSchema) * TSDB_MAX_COLUMNS,
     .refCountPos  = (int8_t *)(&tObj.refCount) - (int8_t *)&tObj,
-    .keyType      = SDB_KEY_STRING,
+    .keyType      = SDB_KEY_VAR_STRING,
     .insertFp     = mgmtChildTableActionInsert,
     .deleteFp     = mgmtChildTableActionDelete,
     .updateFp     = mgmtChildTableActionUpdate,
@@ -387,6 +462,16 @@ static void mgmtRemoveTableFromStable(SSuperTableObj *pStable, SChildTableObj *p
   pStable->numOfTables--;
 }
 
+static SSuperTableObj *mgmtAllocSuperTable(char *tableId) {
+  int32_t len = strlen(tableId) + 1;
+  SSuperTableObj *pStable = calloc(1, sizeof(SSuperTableObj) + len);
+  if (pStable == NULL) return NULL;
+
+  pStable->info.tableId = (char *)(pStable + 1);
+  memcpy(pStable->info.tableId, tableId, len);
+  return pStable;
+}
+
 static void mgmtDestroySuperTable(SSuperTableObj *pStable) {
   tfree(pStable->schema);
   tfree(pStable->vgList)
@@ -426,10 +511,14 @@ static int32_t mgmtSuperTableActionUpdate(SSdbOper *pOper) {
   SSuperTableObj *pTable = mgmtGetSuperTable(pNew->info.tableId);
   if (pTable != pNew) {
     void *oldSchema = pTable->schema;
-    memcpy(pTable, pNew, pOper->rowSize);
+    pTable->uid = pNew->uid;
+    pTable->createdTime = pNew->createdTime;
+    pTable->sversion = pNew->sversion;
+    pTable->numOfColumns = pNew->numOfColumns;
+    pTable->numOfTags = pNew->numOfTags;
     pTable->schema = pNew->schema;
-    free(pNew);
     free(pNew->vgList);
+    free(pNew);
     free(oldSchema);
   }
 
@@ -437,7 +526,7 @@ static int32_t mgmtSuperTableActionUpdate(SSdbOper *pOper) {
 }
 
 static int32_t mgmtSuperTableActionEncode(SSdbOper *pOper) {
-  const int32_t maxRowSize = sizeof(SChildTableObj) + sizeof(SSchema) * TSDB_MAX_COLUMNS;
+  const int32_t maxRowSize = sizeof(SSuperTableRow) + sizeof(SSchema) * TSDB_MAX_COLUMNS;
 
   SSuperTableObj *pStable = pOper->pObj;
   assert(pOper->pObj != NULL && pOper->rowData != NULL);
@@ -448,7 +537,15 @@ static int32_t mgmtSuperTableActionEncode(SSdbOper *pOper) {
     return TSDB_CODE_INVALID_MSG_LEN;
   }
 
-  memcpy(pOper->rowData, pStable, tsSuperTableUpdateSize);
+  SSuperTableRow *pRow = pOper->rowData;
+  memset(pRow, 0, tsSuperTableUpdateSize);
+  strncpy(pRow->tableId, pStable->info.tableId, TSDB_TABLE_ID_LEN);
+  pRow->type = pStable->info.type;
+  pRow->uid = pStable->uid;
+  pRow->createdTime = pStable->createdTime;
+  pRow->sversion = pStable->sversion;
+  pRow->numOfColumns = pStable->numOfColumns;
+  pRow->numOfTags = pStable->numOfTags;
   memcpy(pOper->rowData + tsSuperTableUpdateSize, pStable->schema, schemaSize);
   pOper->rowSize = tsSuperTableUpdateSize + schemaSize;
 
@@ -458,10 +555,18 @@ static int32_t mgmtSuperTableActionEncode(SSdbOper *pOper) {
 static int32_t mgmtSuperTableActionDecode(SSdbOper *pOper) {
   assert(pOper->rowData != NULL);
 
-  SSuperTableObj *pStable = (SSuperTableObj *) calloc(1, sizeof(SSuperTableObj));
+  SSuperTableRow *pRow = pOper->rowData;
+  pRow->tableId[TSDB_TABLE_ID_LEN] = 0;
+
+  SSuperTableObj *pStable = mgmtAllocSuperTable(pRow->tableId);
   if (pStable == NULL) return TSDB_CODE_SERV_OUT_OF_MEMORY;
 
-  memcpy(pStable, pOper->rowData, tsSuperTableUpdateSize);
+  pStable->info.type = pRow->type;
+  pStable->uid = pRow->uid;
+  pStable->createdTime = pRow->createdTime;
+  pStable->sversion = pRow->sversion;
+  pStable->numOfColumns = pRow->numOfColumns;
+  pStable->numOfTags = pRow->numOfTags;
 
   int32_t schemaSize = sizeof(SSchema) * (pStable->numOfColumns + pStable->numOfTags);
   pStable->schema = malloc(schemaSize);
@@ -482,7 +587,8 @@ static int32_t mgmtSuperTableActionRestored() {
 
 static int32_t mgmtInitSuperTables() {
   SSuperTableObj tObj;
-  tsSuperTableUpdateSize = (int8_t *)tObj.updateEnd - (int8_t *)&tObj;
+  SSuperTableRow tRow;
+  tsSuperTableUpdateSize = (int8_t *)tRow.updateEnd - (int8_t *)&tRow;
 
   SSdbTableDesc tableDesc = {
     .tableId      = SDB_TABLE_STABLE,
@@ -490,7 +596,7 @@ static int32_t mgmtInitSuperTables() {
     .hashSessions = TSDB_MAX_SUPER_TABLES,
     .maxRowSize   = tsSuperTableUpdateSize + sizeof(SSchema) * TSDB_MAX_COLUMNS,
     .refCountPos  = (int8_t *)(&tObj.refCount) - (int8_t *)&tObj,
-    .keyType      = SDB_KEY_STRING,
+    .keyType      = SDB_KEY_VAR_STRING,
     .insertFp     = mgmtSuperTableActionInsert,
     .deleteFp     = mgmtSuperTableActionDelete,
     .updateFp     = mgmtSuperTableActionUpdate,
@@ -699,14 +805,13 @@ static void mgmtProcessTableMetaMsg(SQueuedMsg *pMsg) {
 
 static void mgmtProcessCreateSuperTableMsg(SQueuedMsg *pMsg) {
   SCMCreateTableMsg *pCreate = pMsg->pCont;
-  SSuperTableObj *pStable = (SSuperTableObj *)calloc(1, sizeof(SSuperTableObj));
+  SSuperTableObj *pStable = mgmtAllocSuperTable(pCreate->tableId);
   if (pStable == NULL) {
     mError("table:%s, failed to create, no enough memory", pCreate->tableId);
     mgmtSendSimpleResp(pMsg->thandle, TSDB_CODE_SERV_OUT_OF_MEMORY);
     return;
   }
 
-  strcpy(pStable->info.tableId, pCreate->tableId);
   pStable->info.type    = TSDB_SUPER_TABLE;
   pStable->createdTime  = taosGetTimestampMs();
   pStable->uid          = (((uint64_t) pStable->createdTime) << 16) + (sdbGetVersion() & ((1ul << 16) - 1ul));
@@ -1062,6 +1167,7 @@ int32_t mgmtRetrieveShowSuperTables(SShowObj *pShow, char *data, int32_t rows, v
     pShow->pNode = sdbFetchRow(tsSuperTableSdb, pShow->pNode, (void **) &pTable);
     if (pTable == NULL) break;
     if (strncmp(pTable->info.tableId, prefix, prefixLen)) {
+      mgmtDecTableRef(pTable);
       continue;
     }
 
@@ -1069,8 +1175,10 @@ int32_t mgmtRetrieveShowSuperTables(SShowObj *pShow, char *data, int32_t rows, v
     mgmtExtractTableName(pTable->info.tableId, stableName);
 
     if (pShow->payloadLen > 0 &&
-        patternMatch(pShow->payload, stableName, TSDB_TABLE_NAME_LEN, &info) != TSDB_PATTERN_MATCH)
+        patternMatch(pShow->payload, stableName, TSDB_TABLE_NAME_LEN, &info) != TSDB_PATTERN_MATCH) {
+      mgmtDecTableRef(pTable);
       continue;
+    }
 
     cols = 0;
 
@@ -1148,9 +1256,8 @@ static int32_t mgmtSetSchemaFromSuperTable(SSchema *pSchema, SSuperTableObj *pTa
   return (pTable->numOfColumns + pTable->numOfTags) * sizeof(SSchema);
 }
 
-static void mgmtGetSuperTableMeta(SQueuedMsg *pMsg) {
+static void mgmtDoGetSuperTableMeta(SQueuedMsg *pMsg, STableMetaMsg *pMeta) {
   SSuperTableObj *pTable = (SSuperTableObj *)pMsg->pTable;
-  STableMetaMsg *pMeta   = rpcMallocCont(sizeof(STableMetaMsg) + sizeof(SSchema) * TSDB_MAX_COLUMNS);
   pMeta->uid          = htobe64(pTable->uid);
   pMeta->sversion     = htons(pTable->sversion);
   pMeta->precision    = pMsg->pDb->cfg.precision;
@@ -1160,6 +1267,18 @@ static void mgmtGetSuperTableMeta(SQueuedMsg *pMsg) {
   pMeta->contLen      = sizeof(STableMetaMsg) + mgmtSetSchemaFromSuperTable(pMeta->schema, pTable);
   strncpy(pMeta->tableId, pTable->info.tableId, TSDB_TABLE_ID_LEN);
 
+  mTrace("stable:%s, uid:%" PRIu64 " table meta is retrieved", pTable->info.tableId, pTable->uid);
+}
+
+static void mgmtGetSuperTableMeta(SQueuedMsg *pMsg) {
+  STableMetaMsg *pMeta = rpcMallocCont(sizeof(STableMetaMsg) + sizeof(SSchema) * TSDB_MAX_COLUMNS);
+  if (pMeta == NULL) {
+    mgmtSendSimpleResp(pMsg->thandle, TSDB_CODE_SERV_OUT_OF_MEMORY);
+    return;
+  }
+
+  mgmtDoGetSuperTableMeta(pMsg, pMeta);
+
   SRpcMsg rpcRsp = {
     .handle = pMsg->thandle, 
     .pCont = pMeta, 
@@ -1167,8 +1286,6 @@ static void mgmtGetSuperTableMeta(SQueuedMsg *pMsg) {
   };
   pMeta->contLen = htons(pMeta->contLen);
   rpcSendResponse(&rpcRsp);
-
-  mTrace("stable:%%s, uid:%" PRIu64 " table meta is retrieved", pTable->info.tableId, pTable->uid);
 }
 
 static void mgmtProcessSuperTableVgroupMsg(SQueuedMsg *pMsg) {
@@ -1287,7 +1404,7 @@ static void *mgmtBuildCreateChildTableMsg(SCMCreateTableMsg *pMsg, SChildTableOb
 }
 
 static SChildTableObj* mgmtDoCreateChildTable(SCMCreateTableMsg *pCreate, SVgObj *pVgroup, int32_t tid) {
-  SChildTableObj *pTable = (SChildTableObj *) calloc(1, sizeof(SChildTableObj));
+  SChildTableObj *pTable = mgmtAllocChildTable(pCreate->tableId);
   if (pTable == NULL) {
     mError("table:%s, failed to alloc memory", pCreate->tableId);
     terrno = TSDB_CODE_SERV_OUT_OF_MEMORY;
@@ -1300,7 +1417,6 @@ static SChildTableObj* mgmtDoCreateChildTable(SCMCreateTableMsg *pCreate, SVgObj
     pTable->info.type = TSDB_NORMAL_TABLE;
   }
 
-  strcpy(pTable->info.tableId, pCreate->tableId);  
   pTable->createdTime = taosGetTimestampMs();
   pTable->sid         = tid;
   pTable->vgId        = pVgroup->vgId;
@@ -1316,7 +1432,6 @@ static SChildTableObj* mgmtDoCreateChildTable(SCMCreateTableMsg *pCreate, SVgObj
     }
     mgmtDecTableRef(pSuperTable);
 
-    strcpy(pTable->superTableId, pSuperTable->info.tableId);
     pTable->uid         = (((uint64_t) pTable->vgId) << 40) + ((((uint64_t) pTable->sid) & ((1ul << 24) - 1ul)) << 16) +
                           (sdbGetVersion() & ((1ul << 16) - 1ul));
     pTable->superTable  = pSuperTable;
@@ -1583,7 +1698,7 @@ static int32_t mgmtDoGetChildTableMeta(SQueuedMsg *pMsg, STableMetaMsg *pMeta) {
   pMeta->sid       = htonl(pTable->sid);
   pMeta->precision = pDb->cfg.precision;
   pMeta->tableType = pTable->info.type;
-  strncpy(pMeta->tableId, pTable->info.tableId, tListLen(pTable->info.tableId));
+  strncpy(pMeta->tableId, pTable->info.tableId, TSDB_TABLE_ID_LEN);
 
   if (pTable->info.type == TSDB_CHILD_TABLE) {
     pMeta->sversion     = htons(pTable->superTable->sversion);
@@ -1704,6 +1819,29 @@ void mgmtDropAllChildTables(SDbObj *pDropDb) {
   mPrint("db:%s, all child tables:%d is dropped from sdb", pDropDb->name, numOfTables);
 }
 
+// bytes the mnode spends on the tables of a vgroup: the sid slots, the objects with their names,
+// the index nodes and the schemas and sqls of normal tables
+int64_t mgmtGetVgroupTablesMemSize(SVgObj *pVgroup) {
+  if (pVgroup->tableList == NULL) return 0;
+
+  int32_t maxTables = taosIdPoolMaxSize(pVgroup->idPool);
+  int32_t nodeSize = sdbGetIndexNodeSize(tsChildTableSdb);
+  int64_t size = (int64_t)(maxTables + 1) * sizeof(SChildTableObj *);
+
+  for (int32_t sid = 0; sid <= maxTables; ++sid) {
+    SChildTableObj *pTable = sdbGetRowFromSlot(tsChildTableSdb, (void **)&pVgroup->tableList[sid]);
+    if (pTable == NULL) continue;
+
+    size += sizeof(SChildTableObj) + strlen(pTable->info.tableId) + 1 + nodeSize;
+    if (pTable->info.type != TSDB_CHILD_TABLE) {
+      size += pTable->numOfColumns * sizeof(SSchema) + pTable->sqlLen;
+    }
+    mgmtDecTableRef(pTable);
+  }
+
+  return size;
+}
+
 static void mgmtDropAllChildTablesInStable(SSuperTableObj *pStable) {
   void *pNode = NULL;
   void *pLastNode = NULL;
@@ -1741,8 +1879,7 @@ static SChildTableObj* mgmtGetTableByPos(uint32_t dnodeId, int32_t vnode, int32_
     return NULL;
   }
 
-  SChildTableObj *pTable = pVgroup->tableList[sid];
-  mgmtIncTableRef((STableObj *)pTable);
+  SChildTableObj *pTable = sdbGetRowFromSlot(tsChildTableSdb, (void **)&pVgroup->tableList[sid]);
   mgmtDecVgroupRef(pVgroup);
   return pTable;
 }
@@ -1879,54 +2016,99 @@ static void mgmtProcessAlterTableRsp(SRpcMsg *rpcMsg) {
   mTrace("alter table rsp received, handle:%p code:%d", rpcMsg->handle, rpcMsg->code);
 }
 
+/*
+ * retrieve the metas of a batch of tables in one message, so the client resolves all tables of one statement in one
+ * round trip. The tables that do not exist are skipped, and the client falls back to get them one by one, e.g., to
+ * create them on demand.
+ */
 static void mgmtProcessMultiTableMetaMsg(SQueuedMsg *pMsg) {
   SCMMultiTableInfoMsg *pInfo = pMsg->pCont;
   pInfo->numOfTables = htonl(pInfo->numOfTables);
 
-  int32_t totalMallocLen = 4*1024*1024; // first malloc 4 MB, subsequent reallocation as twice
+  if (pInfo->numOfTables <= 0 || pInfo->numOfTables > TSDB_MULTI_METERMETA_MAX_NUM ||
+      pMsg->contLen < sizeof(SCMMultiTableInfoMsg) + pInfo->numOfTables * TSDB_TABLE_ID_LEN) {
+    mError("invalid multi table meta msg, numOfTables:%d contLen:%d", pInfo->numOfTables, pMsg->contLen);
+    mgmtSendSimpleResp(pMsg->thandle, TSDB_CODE_INVALID_MSG_LEN);
+    return;
+  }
+
+  const int32_t maxMetaLen = sizeof(STableMetaMsg) + sizeof(SSchema) * TSDB_MAX_COLUMNS;
+
+  int32_t totalMallocLen = sizeof(SMultiTableMeta) + maxMetaLen * MIN(pInfo->numOfTables, 64);
   SMultiTableMeta *pMultiMeta = rpcMallocCont(totalMallocLen);
   if (pMultiMeta == NULL) {
     mgmtSendSimpleResp(pMsg->thandle, TSDB_CODE_SERV_OUT_OF_MEMORY);
     return;
   }
 
-  pMultiMeta->contLen = sizeof(SMultiTableMeta);
-  pMultiMeta->numOfTables = 0;
+  int32_t contLen = sizeof(SMultiTableMeta);
+  int32_t numOfTables = 0;
 
-  for (int t = 0; t < pInfo->numOfTables; ++t) {
-    char *tableId = (char*)(pInfo->tableIds + t * TSDB_TABLE_ID_LEN);
-    SChildTableObj *pTable = mgmtGetChildTable(tableId);
-    if (pTable == NULL) continue;
+  for (int32_t t = 0; t < pInfo->numOfTables; ++t) {
+    char tableId[TSDB_TABLE_ID_LEN + 1] = {0};
+    strncpy(tableId, pInfo->tableIds + t * TSDB_TABLE_ID_LEN, TSDB_TABLE_ID_LEN);
 
-    SDbObj *pDb = mgmtGetDbByTableId(tableId);
-    if (pDb == NULL) continue;
-
-    int availLen = totalMallocLen - pMultiMeta->contLen;
-    if (availLen <= sizeof(STableMetaMsg) + sizeof(SSchema) * TSDB_MAX_COLUMNS) {
-      //TODO realloc
-      //totalMallocLen *= 2;
-      //pMultiMeta = rpcReMalloc(pMultiMeta, totalMallocLen);
-      //if (pMultiMeta == NULL) {
-      ///  rpcSendResponse(ahandle, TSDB_CODE_SERV_OUT_OF_MEMORY, NULL, 0);
-      //  return TSDB_CODE_SERV_OUT_OF_MEMORY;
-      //} else {
-      //  t--;
-      //  continue;
-      //}
+    pMsg->pTable = mgmtGetTable(tableId);
+    if (pMsg->pTable == NULL) {
+      continue;
+    }
+
+    pMsg->pDb = mgmtGetDbByTableId(tableId);
+    if (pMsg->pDb == NULL || pMsg->pDb->status != TSDB_DB_STATUS_READY) {
+      goto _next;
+    }
+
+    if (totalMallocLen - contLen < maxMetaLen) {
+      totalMallocLen *= 2;
+      SMultiTableMeta *pNew = rpcReallocCont(pMultiMeta, totalMallocLen);
+      if (pNew == NULL) {
+        mError("failed to get multi table meta, no enough memory, %d tables retrieved", numOfTables);
+        goto _next;
+      }
+
+      pMultiMeta = pNew;
+    }
+
+    STableMetaMsg *pMeta = (STableMetaMsg *)((char *)pMultiMeta + contLen);
+    memset(pMeta, 0, sizeof(STableMetaMsg));
+
+    int32_t code = TSDB_CODE_SUCCESS;
+    if (pMsg->pTable->type == TSDB_SUPER_TABLE) {
+      mgmtDoGetSuperTableMeta(pMsg, pMeta);
+    } else {
+      code = mgmtDoGetChildTableMeta(pMsg, pMeta);
     }
 
-    STableMetaMsg *pMeta = (STableMetaMsg *)(pMultiMeta->metas + pMultiMeta->contLen);
-    int32_t code = mgmtDoGetChildTableMeta(pMsg, pMeta);
     if (code == TSDB_CODE_SUCCESS) {
-      pMultiMeta->numOfTables ++;
-      pMultiMeta->contLen += pMeta->contLen;
+      contLen += pMeta->contLen;
+      pMeta->contLen = htons(pMeta->contLen);
+      numOfTables++;
+    }
+
+  _next:
+    mgmtDecTableRef(pMsg->pTable);
+    pMsg->pTable = NULL;
+
+    if (pMsg->pDb) {
+      mgmtDecDbRef(pMsg->pDb);
+      pMsg->pDb = NULL;
+    }
+
+    if (pMsg->pVgroup) {
+      mgmtDecVgroupRef(pMsg->pVgroup);
+      pMsg->pVgroup = NULL;
     }
   }
 
+  mTrace("meta of %d tables are retrieved, %d tables requested", numOfTables, pInfo->numOfTables);
+
+  pMultiMeta->numOfTables = htonl(numOfTables);
+  pMultiMeta->contLen = htonl(contLen);
+
   SRpcMsg rpcRsp = {0};
   rpcRsp.handle = pMsg->thandle;
   rpcRsp.pCont = pMultiMeta;
-  rpcRsp.contLen = pMultiMeta->contLen;
+  rpcRsp.contLen = contLen;
   rpcSendResponse(&rpcRsp);
 }
 
@@ -1984,68 +2166,121 @@ static void mgmtVacuumResult(char *data, int32_t numOfCols, int32_t rows, int32_
   }
 }
 
+// vgroups are visited in the order of their ids, so the cursor survives vgroups being moved or dropped
+// the vgroup of db with the smallest id not below vgId, it is referenced through the sdb so a dropped one is not reached
+static SVgObj *mgmtGetNextVgroupOfDb(SDbObj *pDb, int32_t vgId) {
+  SVgObj *pNext = NULL;
+  SVgObj *pVgroup = NULL;
+  void *  pNode = NULL;
+
+  while (1) {
+    pNode = mgmtGetNextVgroup(pNode, &pVgroup);
+    if (pVgroup == NULL) break;
+
+    if (pVgroup->pDb == pDb && pVgroup->vgId >= vgId && (pNext == NULL || pVgroup->vgId < pNext->vgId)) {
+      mgmtDecVgroupRef(pNext);
+      pNext = pVgroup;
+    } else {
+      mgmtDecVgroupRef(pVgroup);
+    }
+  }
+
+  return pNext;
+}
+
 static int32_t mgmtRetrieveShowTables(SShowObj *pShow, char *data, int32_t rows, void *pConn) {
   SDbObj *pDb = mgmtGetDb(pShow->db);
   if (pDb == NULL) return 0;
 
   int32_t numOfRows  = 0;
-  SChildTableObj *pTable = NULL;
+  bool    allVisited = false;
   SPatternCompareInfo info = PATTERN_COMPARE_INFO_INITIALIZER;
 
-  char prefix[64] = {0};
-  strcpy(prefix, pDb->name);
-  strcat(prefix, TS_PATH_DELIMITER);
-  int32_t prefixLen = strlen(prefix);
+  // the literal head of the pattern rejects most names cheaply, 'prefix%' needs no more than that
+  int32_t patternPrefixLen = 0;
+  bool    prefixOnly = false;
+  if (pShow->payloadLen > 0) {
+    patternPrefixLen = strcspn(pShow->payload, "%_");
+    prefixOnly = (pShow->payload[patternPrefixLen] == info.matchAll && pShow->payload[patternPrefixLen + 1] == 0);
+  }
 
+  // walk the tables of the db only, the vgroups one by one and the sid slots of each of them
   while (numOfRows < rows) {
-    pShow->pNode = sdbFetchRow(tsChildTableSdb, pShow->pNode, (void **) &pTable);
-    if (pTable == NULL) break;
+    SVgObj *pVgroup = mgmtGetNextVgroupOfDb(pDb, pShow->vgId);
+    if (pVgroup == NULL) {
+      allVisited = true;
+      break;
+    }
 
-    // not belong to current db
-    if (strncmp(pTable->info.tableId, prefix, prefixLen)) {
-      continue;
+    if (pVgroup->vgId != pShow->vgId) {
+      pShow->vgId = pVgroup->vgId;
+      pShow->sid = 0;
     }
 
-    char tableName[TSDB_TABLE_NAME_LEN] = {0};
-    
-    // pattern compare for table name
-    mgmtExtractTableName(pTable->info.tableId, tableName);
+    int32_t maxSid = (pVgroup->tableList == NULL) ? -1 : taosIdPoolMaxSize(pVgroup->idPool);
 
-    if (pShow->payloadLen > 0 &&
-        patternMatch(pShow->payload, tableName, TSDB_TABLE_NAME_LEN, &info) != TSDB_PATTERN_MATCH) {
-      continue;
-    }
+    while (numOfRows < rows && pShow->sid <= maxSid) {
+      SChildTableObj *pTable = sdbGetRowFromSlot(tsChildTableSdb, (void **)&pVgroup->tableList[pShow->sid++]);
+      if (pTable == NULL) continue;
 
-    int32_t cols = 0;
+      char tableName[TSDB_TABLE_NAME_LEN] = {0};
 
-    char *pWrite = data + pShow->offset[cols] * rows + pShow->bytes[cols] * numOfRows;
-    strncpy(pWrite, tableName, TSDB_TABLE_NAME_LEN);
-    cols++;
+      // pattern compare for table name
+      mgmtExtractTableName(pTable->info.tableId, tableName);
 
-    pWrite = data + pShow->offset[cols] * rows + pShow->bytes[cols] * numOfRows;
-    *(int64_t *) pWrite = pTable->createdTime;
-    cols++;
+      if (pShow->payloadLen > 0) {
+        if (strncasecmp(tableName, pShow->payload, patternPrefixLen) != 0 ||
+            (!prefixOnly && patternMatch(pShow->payload, tableName, TSDB_TABLE_NAME_LEN, &info) != TSDB_PATTERN_MATCH)) {
+          mgmtDecTableRef(pTable);
+          continue;
+        }
+      }
 
-    pWrite = data + pShow->offset[cols] * rows + pShow->bytes[cols] * numOfRows;
-    if (pTable->info.type == TSDB_CHILD_TABLE) {
-      *(int16_t *)pWrite = pTable->superTable->numOfColumns;
-    } else {
-      *(int16_t *)pWrite = pTable->numOfColumns;
-    }
+      int32_t cols = 0;
 
-    cols++;
+      char *pWrite = data + pShow->offset[cols] * rows + pShow->bytes[cols] * numOfRows;
+      strncpy(pWrite, tableName, TSDB_TABLE_NAME_LEN);
+      cols++;
 
-    pWrite = data + pShow->offset[cols] * rows + pShow->bytes[cols] * numOfRows;
-    if (pTable->info.type == TSDB_CHILD_TABLE) {
-      mgmtExtractTableName(pTable->superTableId, pWrite);
+      pWrite = data + pShow->offset[cols] * rows + pShow->bytes[cols] * numOfRows;
+      *(int64_t *) pWrite = pTable->createdTime;
+      cols++;
+
+      pWrite = data + pShow->offset[cols] * rows + pShow->bytes[cols] * numOfRows;
+      if (pTable->info.type == TSDB_CHILD_TABLE) {
+        *(int16_t *)pWrite = pTable->superTable->numOfColumns;
+      } else {
+        *(int16_t *)pWrite = pTable->numOfColumns;
+      }
+
+      cols++;
+
+      pWrite = data + pShow->offset[cols] * rows + pShow->bytes[cols] * numOfRows;
+      if (pTable->info.type == TSDB_CHILD_TABLE) {
+        mgmtExtractTableName(pTable->superTable->info.tableId, pWrite);
+      }
+      cols++;
+
+      numOfRows++;
+      mgmtDecTableRef(pTable);
     }
-    cols++;
 
-    numOfRows++;
-    mgmtDecTableRef(pTable);
+    // all slots of this vgroup are visited, the next retrieve starts from the following one
+    if (pShow->sid > maxSid) {
+      pShow->vgId++;
+      pShow->sid = 0;
+    }
+
+    mgmtDecVgroupRef(pVgroup);
   }
 
   pShow->numOfReads += numOfRows;
+
+  // all vgroups are visited, a pattern may have left fewer rows than the tables in db
+  if (allVisited) {
+    pShow->numOfRows = pShow->numOfReads;
+  }
+
   const int32_t NUM_OF_COLUMNS = 4;
 
   mgmtVacuumResult(data, NUM_OF_COLUMNS, numOfRows, rows, pShow);
@@ -71,8 +71,9 @@ static int32_t mgmtVgroupActionInsert(SSdbOper *pOper) {
   pVgroup->prev = NULL;
   pVgroup->next = NULL;
 
-  int32_t size = sizeof(SChildTableObj *) * pDb->cfg.maxSessions;
-  pVgroup->tableList = calloc(pDb->cfg.maxSessions, sizeof(SChildTableObj *));
+  // sids are allocated from 1 to maxSessions
+  int32_t size = sizeof(SChildTableObj *) * (pDb->cfg.maxSessions + 1);
+  pVgroup->tableList = calloc(pDb->cfg.maxSessions + 1, sizeof(SChildTableObj *));
   if (pVgroup->tableList == NULL) {
     mError("vgroup:%d, failed to malloc(size:%d) for the tableList of vgroups", pVgroup->vgId, size);
     return -1;
@@ -149,8 +150,11 @@ static int32_t mgmtVgroupActionUpdate(SSdbOper *pOper) {
     if (pDb->cfg.maxSessions != oldTables) {
       mPrint("vgroup:%d tables change from %d to %d", pVgroup->vgId, oldTables, pDb->cfg.maxSessions);
       taosUpdateIdPool(pVgroup->idPool, pDb->cfg.maxSessions);
-      int32_t size = sizeof(SChildTableObj *) * pDb->cfg.maxSessions;
+      int32_t size = sizeof(SChildTableObj *) * (pDb->cfg.maxSessions + 1);
       pVgroup->tableList = (SChildTableObj **)realloc(pVgroup->tableList, size);
+      if (pDb->cfg.maxSessions > oldTables) {
+        memset(pVgroup->tableList + oldTables + 1, 0, sizeof(SChildTableObj *) * (pDb->cfg.maxSessions - oldTables));
+      }
     }
   }
 
@@ -245,6 +249,39 @@ void mgmtUpdateVgroup(SVgObj *pVgroup) {
   mgmtSendCreateVgroupMsg(pVgroup, NULL);
 }
 
+/*
+ * the vnode reports counters accumulated since it was opened, the rates are derived from
+ * the difference of two reports and smoothed, so a single burst does not move vgroups around
+ */
+static void mgmtUpdateVgroupLoad(SVgObj *pVgroup, int64_t pointsWritten, uint32_t queryTime) {
+  const float alpha = 0.3f;
+  int64_t     now = taosGetTimestampMs();
+
+  // the query time wraps around, the unsigned delta is right across the wrap, a reset counter yields a huge one
+  uint32_t queryDelta = queryTime - pVgroup->queryTime;
+
+  if (pVgroup->loadTime > 0 && now > pVgroup->loadTime && pointsWritten >= pVgroup->pointsWritten &&
+      queryDelta <= INT32_MAX) {
+    float seconds = (now - pVgroup->loadTime) / 1000.0f;
+    float ingestRate = (pointsWritten - pVgroup->pointsWritten) / seconds;
+    float queryLoad = queryDelta / (seconds * 1000.0f);
+
+    pVgroup->ingestRate = alpha * ingestRate + (1 - alpha) * pVgroup->ingestRate;
+    pVgroup->queryLoad = alpha * queryLoad + (1 - alpha) * pVgroup->queryLoad;
+  }
+
+  // counters restart from zero if the vnode is reopened, the next report is measured against this one
+  pVgroup->pointsWritten = pointsWritten;
+  pVgroup->queryTime = queryTime;
+  pVgroup->loadTime = now;
+}
+
+void mgmtResetVgroupLoad(SVgObj *pVgroup) {
+  pVgroup->loadTime = 0;
+  pVgroup->ingestRate = 0;
+  pVgroup->queryLoad = 0;
+}
+
 void mgmtUpdateVgroupStatus(SVgObj *pVgroup, SDnodeObj *pDnode, SVnodeLoad *pVload) {
   bool dnodeExist = false;
   for (int32_t i = 0; i < pVgroup->numOfVnodes; ++i) {
@@ -269,7 +306,7 @@ void mgmtUpdateVgroupStatus(SVgObj *pVgroup, SDnodeObj *pDnode, SVnodeLoad *pVlo
   if (pVload->role == TAOS_SYNC_ROLE_MASTER) {
     pVgroup->totalStorage = htobe64(pVload->totalStorage);
     pVgroup->compStorage = htobe64(pVload->compStorage);
-    pVgroup->pointsWritten = htobe64(pVload->pointsWritten);
+    mgmtUpdateVgroupLoad(pVgroup, htobe64(pVload->pointsWritten), htonl(pVload->queryTime));
   }
 
   if (pVload->replica != pVgroup->numOfVnodes) {
@@ -279,8 +316,26 @@ void mgmtUpdateVgroupStatus(SVgObj *pVgroup, SDnodeObj *pDnode, SVnodeLoad *pVlo
   }
 }
 
+/*
+ * new tables go to the vgroup with free sessions whose master sits on the least loaded dnode,
+ * so the write load of new tables moves away from dnodes that are already hot
+ */
 SVgObj *mgmtGetAvailableVgroup(SDbObj *pDb) {
-  return pDb->pHead;
+  SVgObj *pSelVgroup = NULL;
+  float   minScore = 0;
+
+  for (SVgObj *pVgroup = pDb->pHead; pVgroup != NULL; pVgroup = pVgroup->next) {
+    if (taosIdPoolNumOfUsed(pVgroup->idPool) >= taosIdPoolMaxSize(pVgroup->idPool)) continue;
+
+    SDnodeObj *pDnode = pVgroup->vnodeGid[pVgroup->inUse].pDnode;
+    float      score = (pDnode != NULL) ? balanceGetDnodeScore(pDnode) : 0;
+    if (pSelVgroup == NULL || score < minScore) {
+      pSelVgroup = pVgroup;
+      minScore = score;
+    }
+  }
+
+  return pSelVgroup;
 }
 
 void *mgmtGetNextVgroup(void *pNode, SVgObj **pVgroup) { 
@@ -413,6 +468,12 @@ int32_t mgmtGetVgroupMeta(STableMetaMsg *pMeta, SShowObj *pShow, void *pConn) {
     cols++;
   }
 
+  pShow->bytes[cols] = 8;
+  pSchema[cols].type = TSDB_DATA_TYPE_BIGINT;
+  strcpy(pSchema[cols].name, "meta memory");
+  pSchema[cols].bytes = htons(pShow->bytes[cols]);
+  cols++;
+
   pMeta->numOfColumns = htons(cols);
   pShow->numOfColumns = cols;
 
@@ -495,6 +556,10 @@ int32_t mgmtRetrieveVgroups(SShowObj *pShow, char *data, int32_t rows, void *pCo
       }
     }
 
+    pWrite = data + pShow->offset[cols] * rows + pShow->bytes[cols] * numOfRows;
+    *(int64_t *) pWrite = mgmtGetVgroupTablesMemSize(pVgroup);
+    cols++;
+
     numOfRows++;
   }
 
@@ -511,8 +576,9 @@ void mgmtAddTableIntoVgroup(SVgObj *pVgroup, SChildTableObj *pTable) {
     pVgroup->numOfTables++;
   }
   
+  // a full vgroup is kept behind the ones with free sessions, it is still linked in the db
   if (pVgroup->numOfTables >= pVgroup->pDb->cfg.maxSessions)
-    mgmtAddVgroupIntoDbTail(pVgroup);
+    mgmtMoveVgroupToTail(pVgroup);
 }
 
 void mgmtRemoveTableFromVgroup(SVgObj *pVgroup, SChildTableObj *pTable) {
@@ -522,8 +588,8 @@ void mgmtRemoveTableFromVgroup(SVgObj *pVgroup, SChildTableObj *pTable) {
     pVgroup->numOfTables--;
   }
 
-  if (pVgroup->numOfTables >= pVgroup->pDb->cfg.maxSessions)
-    mgmtAddVgroupIntoDbTail(pVgroup);
+  if (pVgroup->numOfTables == pVgroup->pDb->cfg.maxSessions - 1)
+    mgmtMoveVgroupToHead(pVgroup);
 }
 
 SMDCreateVnodeMsg *mgmtBuildCreateVnodeMsg(SVgObj *pVgroup) {
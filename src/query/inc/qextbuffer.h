@@ -32,6 +32,7 @@ extern "C" {
 #define MIN_BUFFER_SIZE (1 << 19)
 #define MAX_TMPFILE_PATH_LENGTH PATH_MAX
 #define INITIAL_ALLOCATION_BUFFER_SIZE 64
+#define EXT_BUFFER_READ_AHEAD_PAGES 8
 
 typedef enum EXT_BUFFER_FLUSH_MODEL {
   /*
@@ -65,6 +66,8 @@ typedef struct SExtFileInfo {
   uint32_t      pageSize;
   uint32_t      numOfElemsInFile;
   tFlushoutData flushoutData;
+  uint32_t      nOffsetAllocSize;  // number of allocated page offset entries
+  int64_t *     pPageOffset;       // file offset of each page, only used for compressed pages
 } SExtFileInfo;
 
 typedef struct tFilePage {
@@ -116,6 +119,9 @@ typedef struct tExtMemBuffer {
   FILE *    file;
   SExtFileInfo fileMeta;
 
+  bool      compressed;  // pages are compressed before being flushed to disk
+  char *    pCompBuf;    // buffer for the compressed page
+
   SColumnModel *         pColumnModel;
   EXT_BUFFER_FLUSH_MODEL flushModel;
 } tExtMemBuffer;
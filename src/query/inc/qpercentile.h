@@ -16,6 +16,10 @@
 #ifndef TDENGINE_QPERCENTILE_H
 #define TDENGINE_QPERCENTILE_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #include "qextbuffer.h"
 
 typedef struct MinMaxEntry {
@@ -58,6 +62,14 @@ typedef struct tMemBucket {
   
   MinMaxEntry nRange;
   
+  /*
+   * values are kept in this typed buffer and the percentile is found by selection, until the total size exceeds
+   * nTotalBufferSize, then all values are moved into the buckets that can be flushed to disk.
+   */
+  bool    inMemMode;
+  int32_t inMemCapacity;
+  char *  pInMemBuf;
+  
   void (*HashFunc)(struct tMemBucket *pBucket, void *value, int16_t *segIdx, int16_t *slotIdx);
 } tMemBucket;
 
@@ -74,4 +86,8 @@ void tBucketIntHash(tMemBucket *pBucket, void *value, int16_t *segIdx, int16_t *
 
 void tBucketDoubleHash(tMemBucket *pBucket, void *value, int16_t *segIdx, int16_t *slotIdx);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif  // TDENGINE_QPERCENTILE_H
@@ -23,38 +23,56 @@ extern "C" {
 #include "os.h"
 #include "qextbuffer.h"
 
+#define RESULT_BUF_MIN_INMEM_PAGES 4
+
 typedef struct SIDList {
   uint32_t alloc;
   int32_t  size;
   int32_t* pData;
 } SIDList;
 
+typedef struct SPageInfo {
+  int32_t    pinned;  // number of users holding this page, a pinned page is never spilled to disk
+  bool       onDisk;  // the page has been written into the temp file at least once
+  int32_t    prev;    // previous page id in the lru list, -1 for the head
+  int32_t    next;    // next page id in the lru list, -1 for the tail
+  tFilePage* pData;   // page content, NULL if the page is not resident in memory
+} SPageInfo;
+
 typedef struct SDiskbasedResultBuf {
-  int32_t  numOfRowsPerPage;
-  int32_t  numOfPages;
-  int64_t  totalBufSize;
-  int32_t  fd;                  // data file fd
-  int32_t  allocateId;          // allocated page id
-  int32_t  incStep;             // minimum allocated pages
-  char*    pBuf;                // mmap buffer pointer
-  char*    path;                // file path
-  
+  int32_t    numOfRowsPerPage;
+  int32_t    numOfPages;        // number of allocated page info slots
+  int64_t    totalBufSize;
+  int32_t    fd;                // temp file fd, created when the first page is spilled
+  int32_t    allocateId;        // allocated page id
+  int32_t    inMemPages;        // maximum number of pages kept in memory
+  int32_t    numOfInMemPages;   // number of pages resident in memory
+  int32_t    lruHead;           // most recently used resident page
+  int32_t    lruTail;           // least recently used resident page
+  SPageInfo* pageInfo;          // for each page id, the page info
+  char*      path;              // file path
+  int64_t    numOfSpills;       // number of pages written into the temp file
+  int64_t    numOfLoads;        // number of pages read back from the temp file
+
   uint32_t numOfAllocGroupIds;  // number of allocated id list
   void*    idsTable;            // id hash table
   SIDList* list;                // for each id, there is a page id list
 } SDiskbasedResultBuf;
 
 /**
- * create disk-based result buffer
+ * create disk-based result buffer, pages are kept in memory until the in-memory buffer size is exceeded, and then
+ * the least recently used pages that are not pinned are spilled into a temp file
  * @param pResultBuf
- * @param size
+ * @param size          initial number of pages
  * @param rowSize
+ * @param inMemBufSize  maximum size of pages kept in memory, in bytes
  * @return
  */
-int32_t createDiskbasedResultBuffer(SDiskbasedResultBuf** pResultBuf, int32_t size, int32_t rowSize);
+int32_t createDiskbasedResultBuffer(SDiskbasedResultBuf** pResultBuf, int32_t size, int32_t rowSize,
+                                    int64_t inMemBufSize);
 
 /**
- *
+ * allocate a new page for the group, the returned page is pinned until releaseResBufPage is called
  * @param pResultBuf
  * @param groupId
  * @param pageId
@@ -78,13 +96,22 @@ int32_t getNumOfRowsPerPage(SDiskbasedResultBuf* pResultBuf);
 SIDList getDataBufPagesIdList(SDiskbasedResultBuf* pResultBuf, int32_t groupId);
 
 /**
- * get the specified buffer page by id
+ * get the specified buffer page by id, the page is loaded from the temp file if it has been spilled, and it is
+ * pinned until releaseResBufPage is called. A released page stays in memory until at least
+ * RESULT_BUF_MIN_INMEM_PAGES - 1 other pages have been accessed.
  * @param pResultBuf
  * @param id
  * @return
  */
 tFilePage* getResultBufferPageById(SDiskbasedResultBuf* pResultBuf, int32_t id);
 
+/**
+ * unpin the page, so it can be spilled to disk when the in-memory buffer is exhausted
+ * @param pResultBuf
+ * @param id
+ */
+void releaseResBufPage(SDiskbasedResultBuf* pResultBuf, int32_t id);
+
 /**
  * get the total buffer size in the format of disk file
  * @param pResultBuf
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_QTDIGEST_H
+#define TDENGINE_QTDIGEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define TDIGEST_COMPRESSION   100
+#define TDIGEST_MAX_CENTROIDS 128  // the k1 scale function keeps at most ~compression centroids
+#define TDIGEST_BUFFER_SIZE   372  // centroids and buffered points fit in 500 slots, the same as MAX_HISTOGRAM_BIN
+
+typedef struct SCentroid {
+  double  mean;
+  int64_t weight;
+} SCentroid;
+
+/*
+ * the merging t-digest has no internal pointers, so the whole structure can be copied as the intermediate result
+ * between vnodes and client. The first numOfCentroids elements are the sorted centroids, followed by the points
+ * that are buffered and not yet merged into centroids.
+ */
+typedef struct STDigest {
+  double    min;
+  double    max;
+  int64_t   size;  // total weight, including the buffered points
+  int32_t   numOfCentroids;
+  int32_t   numOfBuffered;
+  SCentroid centroids[TDIGEST_MAX_CENTROIDS + TDIGEST_BUFFER_SIZE];
+} STDigest;
+
+STDigest* tTDigestCreateFrom(void* pBuf);
+
+void   tTDigestAdd(STDigest* pDigest, double val, int64_t weight);
+void   tTDigestAddBatch(STDigest* pDigest, const double* vals, int32_t num);
+void   tTDigestCompress(STDigest* pDigest);
+void   tTDigestMerge(STDigest* pDigest, const STDigest* pOther);
+double tTDigestQuantile(STDigest* pDigest, double q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_QTDIGEST_H
@@ -83,6 +83,13 @@ typedef struct SWindowResInfo {
   int64_t        threshold;  // threshold to pausing query and return closed results.
 } SWindowResInfo;
 
+// the rows of one tumbling window in a data block
+typedef struct SWindowRowRange {
+  TSKEY   skey;
+  int32_t start;
+  int32_t rows;
+} SWindowRowRange;
+
 typedef struct SColumnFilterElem {
   int16_t           bytes;  // column length
   __filter_func_t   fp;
@@ -157,9 +164,13 @@ typedef struct SQueryRuntimeEnv {
   STSCursor          cur;
   SQueryCostSummary  summary;
   bool               stableQuery;  // super table query or not
+  bool               tableLimit;   // limit is applied to each table, the global limit is done at the client side
+  int64_t            numOfTableRes;  // number of results generated by the table in process
+  bool               fusedIntervalAgg;  // aggregate all time windows of a block in one pass
   void*              pQueryHandle;
   void*              pSecQueryHandle; // another thread for
   SDiskbasedResultBuf* pResultBuf;  // query result buffer based on blocked-wised disk file
+  int32_t            outputPageId;  // page of the current output window, pinned while the functions write into it
 } SQueryRuntimeEnv;
 
 typedef struct SQInfo {
@@ -36,7 +36,13 @@ bool isWindowResClosed(SWindowResInfo *pWindowResInfo, int32_t slot);
 
 void createQueryResultInfo(SQuery *pQuery, SWindowResult *pResultRow, bool isSTableQuery, SPosInfo *posInfo);
 
-char *getPosInResultPage(SQueryRuntimeEnv *pRuntimeEnv, int32_t columnIndex, SWindowResult *pResult);
+tFilePage *getWindowResPage(SQueryRuntimeEnv *pRuntimeEnv, SWindowResult *pResult);
+char      *getPosInResultPage(SQueryRuntimeEnv *pRuntimeEnv, int32_t columnIndex, SWindowResult *pResult,
+                              tFilePage *page);
+
+int32_t splitIntoTumblingWindows(TSKEY *primaryKeyCol, int32_t pos, int32_t numOfRows, STimeWindow *pFirstWin,
+                                 int64_t intervalTime, TSKEY ekey, SWindowRowRange *pRange);
+void    computeWindowStatis(SQLFunctionCtx *pCtx, SWindowRowRange *pRange, int32_t numOfWins, SDataStatis *pStatis);
 
 __filter_func_t *getRangeFilterFuncArray(int32_t type);
 __filter_func_t *getValueFilterFuncArray(int32_t type);
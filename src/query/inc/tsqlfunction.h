@@ -100,6 +100,10 @@ extern "C" {
 #define MAX_RETRIEVE_ROWS_IN_INTERVAL_QUERY 10000000
 #define TOP_BOTTOM_QUERY_LIMIT 100
 
+// the algorithm of apercentile, denoted by the optional third parameter
+#define APERCT_ALGO_DEFAULT 0  // adaptive histogram
+#define APERCT_ALGO_TDIGEST 1  // merging t-digest
+
 enum {
   MASTER_SCAN           = 0x0u,
   SUPPLEMENTARY_SCAN    = 0x1u,
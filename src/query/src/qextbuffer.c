@@ -18,6 +18,7 @@
 #include "taos.h"
 #include "taosdef.h"
 #include "taosmsg.h"
+#include "tscompression.h"
 #include "tsqlfunction.h"
 #include "ttime.h"
 #include "tutil.h"
@@ -69,6 +70,9 @@ void* destoryExtMemBuffer(tExtMemBuffer *pMemBuffer) {
     tfree(pFileMeta->flushoutData.pFlushoutInfo);
   }
 
+  tfree(pFileMeta->pPageOffset);
+  tfree(pMemBuffer->pCompBuf);
+
   // release all in-memory buffer pages
   tFilePagesItem *pFilePages = pMemBuffer->pHead;
   while (pFilePages != NULL) {
@@ -112,6 +116,56 @@ static bool allocFlushoutInfoEntries(SExtFileInfo *pFileMeta) {
   return true;
 }
 
+/*
+ * record the file offset of each compressed page, the offset of page i is pPageOffset[i], and
+ * pPageOffset[nFileSize] is the end of last page.
+ */
+static bool tExtMemBufferAddPageOffset(SExtFileInfo *pFileMeta, int32_t len) {
+  if (pFileMeta->nFileSize + 2 > pFileMeta->nOffsetAllocSize) {
+    uint32_t size = (pFileMeta->nOffsetAllocSize == 0) ? INITIAL_ALLOCATION_BUFFER_SIZE : pFileMeta->nOffsetAllocSize << 1;
+
+    int64_t *tmp = (int64_t *)realloc(pFileMeta->pPageOffset, sizeof(int64_t) * size);
+    if (tmp == NULL) {
+      uError("out of memory!\n");
+      return false;
+    }
+
+    pFileMeta->pPageOffset = tmp;
+    pFileMeta->nOffsetAllocSize = size;
+  }
+
+  if (pFileMeta->nFileSize == 0) {
+    pFileMeta->pPageOffset[0] = 0;
+  }
+
+  pFileMeta->pPageOffset[pFileMeta->nFileSize + 1] = pFileMeta->pPageOffset[pFileMeta->nFileSize] + len;
+  return true;
+}
+
+static size_t tExtMemBufferWritePage(tExtMemBuffer *pMemBuffer, tFilePage *pPage) {
+  if (!pMemBuffer->compressed) {
+    return fwrite((char *)pPage, pMemBuffer->pageSize, 1, pMemBuffer->file);
+  }
+
+  if (pMemBuffer->pCompBuf == NULL) {
+    pMemBuffer->pCompBuf = malloc(pMemBuffer->pageSize + 1);
+    if (pMemBuffer->pCompBuf == NULL) {
+      return 0;
+    }
+  }
+
+  // the unused tail of the page is zero-filled, and mostly compressed away
+  int32_t len = tsCompressString((char *)pPage, pMemBuffer->pageSize, 1, pMemBuffer->pCompBuf, pMemBuffer->pageSize + 1,
+                                 ONE_STAGE_COMP, NULL, 0);
+
+  size_t ret = fwrite(pMemBuffer->pCompBuf, len, 1, pMemBuffer->file);
+  if (ret > 0 && !tExtMemBufferAddPageOffset(&pMemBuffer->fileMeta, len)) {
+    return 0;
+  }
+
+  return ret;
+}
+
 static bool tExtMemBufferAlloc(tExtMemBuffer *pMemBuffer) {
   /*
    * the in-mem buffer is full.
@@ -265,15 +319,26 @@ bool tExtMemBufferFlush(tExtMemBuffer *pMemBuffer) {
   
   tFilePagesItem *first = pMemBuffer->pHead;
 
+  // pages are always appended to the end of file, while the file pointer may be moved by readers
+  fseek(pMemBuffer->file, 0, SEEK_END);
+
+  /*
+   * a page is counted only after it is written and its offset is recorded. The pages following a failed one are not
+   * written, since their page ids would not match their positions in file.
+   */
+  int32_t numOfPages = 0;
   while (first != NULL) {
-    size_t retVal = fwrite((char *)&(first->item), pMemBuffer->pageSize, 1, pMemBuffer->file);
-    if (retVal <= 0) {  // failed to write to buffer, may be not enough space
-      ret = false;
+    if (ret) {
+      size_t retVal = tExtMemBufferWritePage(pMemBuffer, &first->item);
+      if (retVal <= 0) {  // failed to write to buffer, may be not enough space
+        ret = false;
+      } else {
+        pMemBuffer->fileMeta.numOfElemsInFile += first->item.numOfElems;
+        pMemBuffer->fileMeta.nFileSize += 1;
+        numOfPages += 1;
+      }
     }
 
-    pMemBuffer->fileMeta.numOfElemsInFile += first->item.numOfElems;
-    pMemBuffer->fileMeta.nFileSize += 1;
-
     tFilePagesItem *ptmp = first;
     first = first->pNext;
 
@@ -282,6 +347,8 @@ bool tExtMemBufferFlush(tExtMemBuffer *pMemBuffer) {
 
   fflush(pMemBuffer->file);  // flush to disk
 
+  // only the written pages are recorded in the flush out info
+  pMemBuffer->numOfInMemPages = numOfPages;
   tExtMemBufferUpdateFlushoutInfo(pMemBuffer);
 
   pMemBuffer->numOfElemsInBuffer = 0;
@@ -316,26 +383,69 @@ void tExtMemBufferClear(tExtMemBuffer *pMemBuffer) {
 
   tExtMemBufferClearFlushoutInfo(pMemBuffer);
 
-  // reset the write pointer to the header
+  // discard the flushed pages and reset the write pointer to the header
   if (pMemBuffer->file != NULL) {
+    fflush(pMemBuffer->file);
+    if (ftruncate(fileno(pMemBuffer->file), 0) != 0) {
+      uError("failed to truncate file:%s, reason:%s", pMemBuffer->path, strerror(errno));
+    }
+
     fseek(pMemBuffer->file, 0, SEEK_SET);
   }
 }
 
+static int64_t tExtMemBufferGetPageOffset(tExtMemBuffer *pMemBuffer, int32_t pageId) {
+  if (pMemBuffer->compressed) {
+    return pMemBuffer->fileMeta.pPageOffset[pageId];
+  } else {
+    return (int64_t)pageId * pMemBuffer->pageSize;
+  }
+}
+
 bool tExtMemBufferLoadData(tExtMemBuffer *pMemBuffer, tFilePage *pFilePage, int32_t flushoutId, int32_t pageIdx) {
-  if (flushoutId < 0 || flushoutId > pMemBuffer->fileMeta.flushoutData.nLength) {
+  if (flushoutId < 0 || flushoutId >= pMemBuffer->fileMeta.flushoutData.nLength) {
     return false;
   }
 
   tFlushoutInfo *pInfo = &(pMemBuffer->fileMeta.flushoutData.pFlushoutInfo[flushoutId]);
-  if (pageIdx > (int32_t)pInfo->numOfPages) {
+  if (pageIdx < 0 || pageIdx >= (int32_t)pInfo->numOfPages) {
+    return false;
+  }
+
+  int32_t fd = fileno(pMemBuffer->file);
+  int32_t pageId = pInfo->startPageId + pageIdx;
+
+#ifdef POSIX_FADV_WILLNEED
+  // hint the kernel to prefetch the following pages of current flush out group
+  if (pageIdx % EXT_BUFFER_READ_AHEAD_PAGES == 0 && pageIdx + 1 < (int32_t)pInfo->numOfPages) {
+    int32_t last = MIN(pageId + EXT_BUFFER_READ_AHEAD_PAGES, pInfo->startPageId + pInfo->numOfPages);
+    int64_t start = tExtMemBufferGetPageOffset(pMemBuffer, pageId + 1);
+    posix_fadvise(fd, start, tExtMemBufferGetPageOffset(pMemBuffer, last) - start, POSIX_FADV_WILLNEED);
+  }
+#endif
+
+  // pread does not change the file pointer, so that different pages can be loaded concurrently
+  if (!pMemBuffer->compressed) {
+    ssize_t ret = pread(fd, pFilePage, pMemBuffer->pageSize, (int64_t)pageId * pMemBuffer->pageSize);
+    return (ret == pMemBuffer->pageSize);
+  }
+
+  int64_t offset = pMemBuffer->fileMeta.pPageOffset[pageId];
+  int32_t len = (int32_t)(pMemBuffer->fileMeta.pPageOffset[pageId + 1] - offset);
+
+  char *pCompBuf = malloc(len);
+  if (pCompBuf == NULL) {
     return false;
   }
 
-  size_t ret = fseek(pMemBuffer->file, (pInfo->startPageId + pageIdx) * pMemBuffer->pageSize, SEEK_SET);
-  ret = fread(pFilePage, pMemBuffer->pageSize, 1, pMemBuffer->file);
+  bool ret = (pread(fd, pCompBuf, len, offset) == len);
+  if (ret) {
+    ret = (tsDecompressString(pCompBuf, len, 1, (char *)pFilePage, pMemBuffer->pageSize, ONE_STAGE_COMP, NULL, 0) ==
+           pMemBuffer->pageSize);
+  }
 
-  return (ret > 0);
+  free(pCompBuf);
+  return ret;
 }
 
 bool tExtMemBufferIsAllDataInMem(tExtMemBuffer *pMemBuffer) { return (pMemBuffer->fileMeta.nFileSize == 0); }
@@ -626,8 +736,8 @@ static UNUSED_FUNC void tRowModelDisplay(tOrderDescriptor *pDescriptor, int32_t
 
 static int32_t qsort_call = 0;
 
-void tColDataQSort(tOrderDescriptor *pDescriptor, int32_t numOfRows, int32_t start, int32_t end, char *data,
-                   int32_t orderType) {
+static void columnDataQSort(tOrderDescriptor *pDescriptor, int32_t numOfRows, int32_t start, int32_t end, char *data,
+                            int32_t orderType) {
   // short array sort, incur another sort procedure instead of quick sort process
   __col_compar_fn_t compareFn = (orderType == TSDB_ORDER_ASC) ? compare_sa : compare_sd;
 
@@ -729,11 +839,359 @@ void tColDataQSort(tOrderDescriptor *pDescriptor, int32_t numOfRows, int32_t sta
   }
 
   if (leftx > start) {
-    tColDataQSort(pDescriptor, numOfRows, start, leftx, data, orderType);
+    columnDataQSort(pDescriptor, numOfRows, start, leftx, data, orderType);
   }
 
   if (rightx < end) {
-    tColDataQSort(pDescriptor, numOfRows, rightx, end, data, orderType);
+    columnDataQSort(pDescriptor, numOfRows, rightx, end, data, orderType);
+  }
+}
+
+static FORCE_INLINE void encodeBigEndian(uint8_t *dst, uint64_t val, int32_t bytes) {
+  for (int32_t i = bytes - 1; i >= 0; --i) {
+    dst[i] = (uint8_t)(val & 0xFF);
+    val >>= 8;
+  }
+}
+
+/*
+ * encode one column value into the normalized sort key, of which the memcmp order is identical to the order of
+ * columnValueAscendingComparator/primaryKeyComparator
+ */
+static void encodeSortKeyField(uint8_t *dst, char *val, int32_t type, int32_t bytes, bool reversed) {
+  switch (type) {
+    case TSDB_DATA_TYPE_BOOL:
+    case TSDB_DATA_TYPE_TINYINT:
+      dst[0] = ((uint8_t) * (int8_t *)val) ^ 0x80u;
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      encodeBigEndian(dst, ((uint16_t) * (int16_t *)val) ^ 0x8000u, sizeof(int16_t));
+      break;
+    case TSDB_DATA_TYPE_INT:
+      encodeBigEndian(dst, ((uint32_t) * (int32_t *)val) ^ 0x80000000u, sizeof(int32_t));
+      break;
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      encodeBigEndian(dst, ((uint64_t) * (int64_t *)val) ^ 0x8000000000000000ull, sizeof(int64_t));
+      break;
+    case TSDB_DATA_TYPE_FLOAT: {
+      /*
+       * the comparator treats -0.0 as 0.0 and NaN as larger than any value, so -0.0 is encoded as 0.0 and all NaNs
+       * as the positive quiet NaN. Negative values have all bits flipped, positive values only the sign bit.
+       */
+      float    f = GET_FLOAT_VAL(val);
+      uint32_t v = 0x7FC00000u;
+      if (!isnan(f)) {
+        f = (f == 0) ? 0.0f : f;
+        memcpy(&v, &f, sizeof(uint32_t));
+      }
+
+      v = (v & 0x80000000u) ? ~v : (v | 0x80000000u);
+      encodeBigEndian(dst, v, sizeof(uint32_t));
+      break;
+    }
+    case TSDB_DATA_TYPE_DOUBLE: {
+      double   d = GET_DOUBLE_VAL(val);
+      uint64_t v = 0x7FF8000000000000ull;
+      if (!isnan(d)) {
+        d = (d == 0) ? 0.0 : d;
+        memcpy(&v, &d, sizeof(uint64_t));
+      }
+
+      v = (v & 0x8000000000000000ull) ? ~v : (v | 0x8000000000000000ull);
+      encodeBigEndian(dst, v, sizeof(uint64_t));
+      break;
+    }
+    case TSDB_DATA_TYPE_BINARY: {
+      // bytes after the null-terminator are ignored by strncmp, so pad them with zero
+      int32_t len = (int32_t)strnlen(val, bytes);
+      memcpy(dst, val, len);
+      memset(dst + len, 0, bytes - len);
+      break;
+    }
+    case TSDB_DATA_TYPE_NCHAR: {
+      int32_t i = 0;
+      for (; i < bytes / TSDB_NCHAR_SIZE; ++i) {
+        uint32_t c = 0;
+        memcpy(&c, val + i * TSDB_NCHAR_SIZE, TSDB_NCHAR_SIZE);
+        if (c == 0) {
+          break;
+        }
+
+        encodeBigEndian(dst + i * TSDB_NCHAR_SIZE, c, TSDB_NCHAR_SIZE);
+      }
+
+      memset(dst + i * TSDB_NCHAR_SIZE, 0, bytes - i * TSDB_NCHAR_SIZE);
+      break;
+    }
+    default:
+      memset(dst, 0, bytes);
+  }
+
+  if (reversed) {
+    for (int32_t i = 0; i < bytes; ++i) {
+      dst[i] = ~dst[i];
+    }
+  }
+}
+
+static int32_t getSortKeySize(tOrderDescriptor *pDescriptor) {
+  int32_t size = 0;
+  for (int32_t i = 0; i < pDescriptor->orderIdx.numOfCols; ++i) {
+    int32_t colIdx = pDescriptor->orderIdx.pData[i];
+    size += pDescriptor->pColumnModel->pFields[colIdx].field.bytes;
+  }
+
+  return size;
+}
+
+static void encodeSortKey(tOrderDescriptor *pDescriptor, int32_t numOfRows, int32_t rowId, char *data,
+                          int32_t orderType, uint8_t *dst) {
+  SColumnModel *pModel = pDescriptor->pColumnModel;
+
+  for (int32_t i = 0; i < pDescriptor->orderIdx.numOfCols; ++i) {
+    int32_t  colIdx = pDescriptor->orderIdx.pData[i];
+    SSchema *pSchema = &pModel->pFields[colIdx].field;
+
+    // the timestamp column follows the tsOrder of descriptor, see compare_a/compare_d
+    bool reversed = (pSchema->type == TSDB_DATA_TYPE_TIMESTAMP)
+                        ? (colIdx == 0 && pDescriptor->tsOrder == TSDB_ORDER_DESC)
+                        : (orderType == TSDB_ORDER_DESC);
+
+    char *val = COLMODEL_GET_VAL(data, pModel, numOfRows, rowId, colIdx);
+    encodeSortKeyField(dst, val, pSchema->type, pSchema->bytes, reversed);
+    dst += pSchema->bytes;
+  }
+}
+
+/*
+ * LSD radix sort for keys no longer than 8 bytes, one byte per pass. The histograms of all passes are generated in
+ * one scan, and the pass is skipped if all keys share the same byte.
+ */
+static bool radixSortKeys(uint64_t *keys, int32_t *index, int32_t num, int32_t keySize) {
+  uint64_t *keyBuf = malloc(sizeof(uint64_t) * num);
+  int32_t * indexBuf = malloc(sizeof(int32_t) * num);
+  int32_t(*count)[256] = calloc(keySize, sizeof(int32_t) * 256);
+
+  if (keyBuf == NULL || indexBuf == NULL || count == NULL) {
+    tfree(keyBuf);
+    tfree(indexBuf);
+    tfree(count);
+    return false;
+  }
+
+  for (int32_t i = 0; i < num; ++i) {
+    for (int32_t p = 0; p < keySize; ++p) {
+      count[p][(keys[i] >> (p << 3)) & 0xFF] += 1;
+    }
+  }
+
+  uint64_t *src = keys, *dst = keyBuf;
+  int32_t * srcIndex = index, *dstIndex = indexBuf;
+
+  for (int32_t p = 0; p < keySize; ++p) {
+    int32_t *c = count[p];
+    if (c[(src[0] >> (p << 3)) & 0xFF] == num) {
+      continue;
+    }
+
+    int32_t offset = 0;
+    for (int32_t j = 0; j < 256; ++j) {
+      int32_t t = c[j];
+      c[j] = offset;
+      offset += t;
+    }
+
+    for (int32_t i = 0; i < num; ++i) {
+      int32_t pos = c[(src[i] >> (p << 3)) & 0xFF]++;
+      dst[pos] = src[i];
+      dstIndex[pos] = srcIndex[i];
+    }
+
+    SWAP(src, dst, uint64_t *);
+    SWAP(srcIndex, dstIndex, int32_t *);
+  }
+
+  if (srcIndex != index) {
+    memcpy(index, srcIndex, sizeof(int32_t) * num);
+  }
+
+  free(keyBuf);
+  free(indexBuf);
+  free(count);
+  return true;
+}
+
+#define SORT_KEY_RUN_LENGTH 16
+
+static FORCE_INLINE int32_t compareSortKey(uint8_t *keys, int32_t keySize, int32_t left, int32_t right) {
+  return memcmp(keys + (size_t)left * keySize, keys + (size_t)right * keySize, keySize);
+}
+
+/*
+ * bottom-up merge sort on the index of keys longer than 8 bytes, short runs are sorted by insertion sort first
+ */
+static bool mergeSortKeys(uint8_t *keys, int32_t keySize, int32_t *index, int32_t num) {
+  int32_t *buf = malloc(sizeof(int32_t) * num);
+  if (buf == NULL) {
+    return false;
+  }
+
+  for (int32_t s = 0; s < num; s += SORT_KEY_RUN_LENGTH) {
+    int32_t e = MIN(s + SORT_KEY_RUN_LENGTH, num);
+    for (int32_t i = s + 1; i < e; ++i) {
+      int32_t v = index[i];
+      int32_t j = i - 1;
+      while (j >= s && compareSortKey(keys, keySize, index[j], v) > 0) {
+        index[j + 1] = index[j];
+        j -= 1;
+      }
+      index[j + 1] = v;
+    }
+  }
+
+  int32_t *src = index, *dst = buf;
+  for (int32_t width = SORT_KEY_RUN_LENGTH; width < num; width <<= 1) {
+    for (int32_t s = 0; s < num; s += (width << 1)) {
+      int32_t mid = MIN(s + width, num), e = MIN(s + (width << 1), num);
+      int32_t i = s, j = mid, k = s;
+
+      while (i < mid && j < e) {
+        dst[k++] = (compareSortKey(keys, keySize, src[j], src[i]) < 0) ? src[j++] : src[i++];
+      }
+
+      while (i < mid) {
+        dst[k++] = src[i++];
+      }
+
+      while (j < e) {
+        dst[k++] = src[j++];
+      }
+    }
+
+    SWAP(src, dst, int32_t *);
+  }
+
+  if (src != index) {
+    memcpy(index, src, sizeof(int32_t) * num);
+  }
+
+  free(buf);
+  return true;
+}
+
+/*
+ * move the rows of each column into the sorted position, index[i] is the original position (relative to start) of
+ * the i-th row in the sorted result
+ */
+static bool applySortedIndex(SColumnModel *pModel, int32_t numOfRows, int32_t start, int32_t num, char *data,
+                             int32_t *index) {
+  int32_t maxBytes = 0;
+  for (int32_t i = 0; i < pModel->numOfCols; ++i) {
+    maxBytes = MAX(maxBytes, pModel->pFields[i].field.bytes);
+  }
+
+  char *buf = malloc((size_t)maxBytes * num);
+  if (buf == NULL) {
+    return false;
+  }
+
+  for (int32_t i = 0; i < pModel->numOfCols; ++i) {
+    int32_t bytes = pModel->pFields[i].field.bytes;
+    char *  src = COLMODEL_GET_VAL(data, pModel, numOfRows, start, i);
+
+    switch (bytes) {
+      case sizeof(int64_t):
+        for (int32_t j = 0; j < num; ++j) {
+          ((int64_t *)buf)[j] = ((int64_t *)src)[index[j]];
+        }
+        break;
+      case sizeof(int32_t):
+        for (int32_t j = 0; j < num; ++j) {
+          ((int32_t *)buf)[j] = ((int32_t *)src)[index[j]];
+        }
+        break;
+      default:
+        for (int32_t j = 0; j < num; ++j) {
+          memcpy(buf + (size_t)j * bytes, src + (size_t)index[j] * bytes, bytes);
+        }
+    }
+
+    memcpy(src, buf, (size_t)bytes * num);
+  }
+
+  free(buf);
+  return true;
+}
+
+static bool sortByNormalizedKey(tOrderDescriptor *pDescriptor, int32_t numOfRows, int32_t start, int32_t end,
+                                char *data, int32_t orderType) {
+  int32_t num = end - start + 1;
+  int32_t keySize = getSortKeySize(pDescriptor);
+
+  int32_t *index = malloc(sizeof(int32_t) * num);
+  if (index == NULL) {
+    return false;
+  }
+
+  for (int32_t i = 0; i < num; ++i) {
+    index[i] = i;
+  }
+
+  bool ret = false;
+  if (keySize <= sizeof(uint64_t)) {
+    uint64_t *keys = malloc(sizeof(uint64_t) * num);
+    if (keys != NULL) {
+      uint8_t k[sizeof(uint64_t)] = {0};
+      for (int32_t i = 0; i < num; ++i) {
+        encodeSortKey(pDescriptor, numOfRows, start + i, data, orderType, k);
+
+        uint64_t v = 0;
+        for (int32_t j = 0; j < keySize; ++j) {
+          v = (v << 8) | k[j];
+        }
+        keys[i] = v;
+      }
+
+      ret = radixSortKeys(keys, index, num, keySize);
+      free(keys);
+    }
+  } else {
+    uint8_t *keys = malloc((size_t)keySize * num);
+    if (keys != NULL) {
+      for (int32_t i = 0; i < num; ++i) {
+        encodeSortKey(pDescriptor, numOfRows, start + i, data, orderType, keys + (size_t)i * keySize);
+      }
+
+      ret = mergeSortKeys(keys, keySize, index, num);
+      free(keys);
+    }
+  }
+
+  if (ret) {
+    ret = applySortedIndex(pDescriptor->pColumnModel, numOfRows, start, num, data, index);
+  }
+
+  free(index);
+  return ret;
+}
+
+/*
+ * the order-by columns are encoded into normalized binary keys first, so the sort procedure does not need to
+ * resolve the column type during each comparison. The rows are moved only once after the sort is completed.
+ * If the memory is not available, the in-place quick sort is used instead.
+ */
+void tColDataQSort(tOrderDescriptor *pDescriptor, int32_t numOfRows, int32_t start, int32_t end, char *data,
+                   int32_t orderType) {
+  if (end - start + 1 <= 8) {
+    __col_compar_fn_t compareFn = (orderType == TSDB_ORDER_ASC) ? compare_sa : compare_sd;
+    tColDataInsertSort(pDescriptor, numOfRows, start, end, data, compareFn);
+    return;
+  }
+
+  if (!sortByNormalizedKey(pDescriptor, numOfRows, start, end, data, orderType)) {
+    uError("failed to allocate memory for normalized sort keys, rows:%d, use quick sort instead", end - start + 1);
+    columnDataQSort(pDescriptor, numOfRows, start, end, data, orderType);
   }
 }
 
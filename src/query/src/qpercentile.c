@@ -67,7 +67,6 @@ static tFilePage *loadIntoBucketFromDisk(tMemBucket *pMemBucket, int32_t segIdx,
         assert(pPage->numOfElems > 0);
         
         tColModelAppend(pDesc->pColumnModel, buffer, pPage->data, 0, pPage->numOfElems, pPage->numOfElems);
-        printf("id: %d  count: %" PRIu64 "\n", j, buffer->numOfElems);
       }
     }
     tfree(pPage);
@@ -249,6 +248,9 @@ tMemBucket *tMemBucketCreate(int32_t totalSlots, int32_t nBufferSize, int16_t nE
   pBucket->pageSize = DEFAULT_PAGE_SIZE;
 
   pBucket->numOfElems = 0;
+  pBucket->inMemMode = true;
+  pBucket->inMemCapacity = 0;
+  pBucket->pInMemBuf = NULL;
   pBucket->numOfSegs = pBucket->nTotalSlots / pBucket->nSlotsOfSeg;
 
   pBucket->nTotalBufferSize = nBufferSize;
@@ -345,6 +347,7 @@ void tMemBucketDestroy(tMemBucket *pBucket) {
   }
 
   tfree(pBucket->pSegs);
+  tfree(pBucket->pInMemBuf);
   tfree(pBucket);
 }
 
@@ -481,7 +484,7 @@ void tMemBucketUpdateBoundingBox(MinMaxEntry *r, char *data, int32_t dataType) {
  * in memory bucket, we only accept the simple data consecutive put in a row/column
  * no column-model in this case.
  */
-void tMemBucketPut(tMemBucket *pBucket, void *data, int32_t numOfRows) {
+static void tMemBucketPutImpl(tMemBucket *pBucket, void *data, int32_t numOfRows) {
   pBucket->numOfElems += numOfRows;
   int16_t segIdx = 0, slotIdx = 0;
 
@@ -577,6 +580,57 @@ void tMemBucketPut(tMemBucket *pBucket, void *data, int32_t numOfRows) {
   }
 }
 
+static void moveInMemDataIntoBuckets(tMemBucket *pBucket) {
+  int32_t num = pBucket->numOfElems;
+  uTrace("MemBucket:%p,%d elems exceed in-memory buffer size:%d, move into buckets", pBucket, num,
+         pBucket->nTotalBufferSize);
+
+  pBucket->inMemMode = false;
+  pBucket->numOfElems = 0;
+
+  if (num > 0) {
+    tMemBucketPutImpl(pBucket, pBucket->pInMemBuf, num);
+  }
+
+  tfree(pBucket->pInMemBuf);
+  pBucket->inMemCapacity = 0;
+}
+
+void tMemBucketPut(tMemBucket *pBucket, void *data, int32_t numOfRows) {
+  if (pBucket->inMemMode) {
+    int32_t num = pBucket->numOfElems + numOfRows;
+
+    if (num <= pBucket->maxElemsCapacity) {
+      if (num > pBucket->inMemCapacity) {
+        int32_t newCapacity = MAX(pBucket->inMemCapacity << 1, 1024);
+        while (newCapacity < num) {
+          newCapacity <<= 1;
+        }
+
+        newCapacity = MIN(newCapacity, pBucket->maxElemsCapacity);
+
+        char *tmp = realloc(pBucket->pInMemBuf, (size_t)newCapacity * pBucket->nElemSize);
+        if (tmp == NULL) {
+          moveInMemDataIntoBuckets(pBucket);
+          tMemBucketPutImpl(pBucket, data, numOfRows);
+          return;
+        }
+
+        pBucket->pInMemBuf = tmp;
+        pBucket->inMemCapacity = newCapacity;
+      }
+
+      memcpy(pBucket->pInMemBuf + pBucket->numOfElems * pBucket->nElemSize, data, numOfRows * pBucket->nElemSize);
+      pBucket->numOfElems = num;
+      return;
+    }
+
+    moveInMemDataIntoBuckets(pBucket);
+  }
+
+  tMemBucketPutImpl(pBucket, data, numOfRows);
+}
+
 void releaseBucket(tMemBucket *pMemBucket, int32_t segIdx, int32_t slotIdx) {
   if (segIdx < 0 || segIdx > pMemBucket->numOfSegs || slotIdx < 0) {
     return;
@@ -881,7 +935,7 @@ double getPercentileImpl(tMemBucket *pMemBucket, int32_t count, double fraction)
           for (uint32_t jx = 0; jx < pFlushInfo->numOfPages; ++jx) {
             ret = fread(pPage, pMemBuffer->pageSize, 1, pMemBuffer->file);
             UNUSED(ret);
-            tMemBucketPut(pMemBucket, pPage->data, pPage->numOfElems);
+            tMemBucketPutImpl(pMemBucket, pPage->data, pPage->numOfElems);
           }
 
           fclose(pMemBuffer->file);
@@ -901,11 +955,109 @@ double getPercentileImpl(tMemBucket *pMemBucket, int32_t count, double fraction)
   return 0;
 }
 
+/*
+ * introselect: quickselect with median-of-three pivot, and the remaining range is sorted when the recursion
+ * depth exceeds 2*log2(n) to bound the worst case. After that, the k-th smallest value is at position k, and
+ * all values after it are not smaller than it.
+ */
+#define DEFINE_PERCENTILE_SELECT(_name, _type)                                                    \
+  static int32_t _name##Compar(const void *p1, const void *p2) {                                  \
+    _type v1 = *(const _type *)p1;                                                                \
+    _type v2 = *(const _type *)p2;                                                                \
+    return (v1 == v2) ? 0 : ((v1 < v2) ? -1 : 1);                                                 \
+  }                                                                                               \
+                                                                                                  \
+  static double _name(void *data, int32_t num, int32_t k, double fraction) {                      \
+    _type * a = (_type *)data;                                                                    \
+    int32_t lo = 0, hi = num - 1;                                                                 \
+    int32_t depth = 2 * (int32_t)log2(num);                                                       \
+                                                                                                  \
+    while (hi > lo) {                                                                             \
+      if (depth-- <= 0) {                                                                         \
+        qsort(&a[lo], hi - lo + 1, sizeof(_type), _name##Compar);                                 \
+        break;                                                                                    \
+      }                                                                                           \
+                                                                                                  \
+      int32_t mid = lo + ((hi - lo) >> 1);                                                        \
+      if (a[mid] < a[lo]) SWAP(a[mid], a[lo], _type);                                             \
+      if (a[hi] < a[lo]) SWAP(a[hi], a[lo], _type);                                               \
+      if (a[hi] < a[mid]) SWAP(a[hi], a[mid], _type);                                             \
+                                                                                                  \
+      _type   pivot = a[mid];                                                                     \
+      int32_t i = lo, j = hi;                                                                     \
+      while (i <= j) {                                                                            \
+        while (a[i] < pivot) i++;                                                                 \
+        while (a[j] > pivot) j--;                                                                 \
+        if (i <= j) {                                                                             \
+          SWAP(a[i], a[j], _type);                                                                \
+          i++;                                                                                    \
+          j--;                                                                                    \
+        }                                                                                         \
+      }                                                                                           \
+                                                                                                  \
+      if (k <= j) {                                                                               \
+        hi = j;                                                                                   \
+      } else if (k >= i) {                                                                        \
+        lo = i;                                                                                   \
+      } else {                                                                                    \
+        break; /* values between j and i are identical to the pivot */                            \
+      }                                                                                           \
+    }                                                                                             \
+                                                                                                  \
+    if (fraction == 0 || k == num - 1) {                                                          \
+      return (double)a[k];                                                                        \
+    }                                                                                             \
+                                                                                                  \
+    _type next = a[k + 1];                                                                        \
+    for (int32_t x = k + 2; x < num; ++x) {                                                       \
+      if (a[x] < next) next = a[x];                                                               \
+    }                                                                                             \
+                                                                                                  \
+    return (1 - fraction) * a[k] + fraction * next;                                               \
+  }
+
+DEFINE_PERCENTILE_SELECT(tinyintSelect, int8_t)
+DEFINE_PERCENTILE_SELECT(smallintSelect, int16_t)
+DEFINE_PERCENTILE_SELECT(intSelect, int32_t)
+DEFINE_PERCENTILE_SELECT(bigintSelect, int64_t)
+DEFINE_PERCENTILE_SELECT(floatSelect, float)
+DEFINE_PERCENTILE_SELECT(doubleSelect, double)
+
+static double getPercentileInMem(tMemBucket *pMemBucket, double percent) {
+  int32_t num = pMemBucket->numOfElems;
+
+  double  percentVal = (fabs(percent) * (num - 1)) / ((double)100.0);
+  int32_t orderIdx = MIN((int32_t)percentVal, num - 1);
+  double  fraction = percentVal - orderIdx;
+
+  char *data = pMemBucket->pInMemBuf;
+  switch (pMemBucket->dataType) {
+    case TSDB_DATA_TYPE_TINYINT:
+      return tinyintSelect(data, num, orderIdx, fraction);
+    case TSDB_DATA_TYPE_SMALLINT:
+      return smallintSelect(data, num, orderIdx, fraction);
+    case TSDB_DATA_TYPE_INT:
+      return intSelect(data, num, orderIdx, fraction);
+    case TSDB_DATA_TYPE_BIGINT:
+      return bigintSelect(data, num, orderIdx, fraction);
+    case TSDB_DATA_TYPE_FLOAT:
+      return floatSelect(data, num, orderIdx, fraction);
+    case TSDB_DATA_TYPE_DOUBLE:
+      return doubleSelect(data, num, orderIdx, fraction);
+    default:
+      return 0.0;
+  }
+}
+
 double getPercentile(tMemBucket *pMemBucket, double percent) {
   if (pMemBucket->numOfElems == 0) {
     return 0.0;
   }
 
+  if (pMemBucket->inMemMode) {
+    return getPercentileInMem(pMemBucket, percent);
+  }
+
   if (pMemBucket->numOfElems == 1) {  // return the only element
     return findOnlyResult(pMemBucket);
   }
@@ -7,89 +7,226 @@
 
 #define DEFAULT_INTERN_BUF_SIZE 16384L
 
-int32_t createDiskbasedResultBuffer(SDiskbasedResultBuf** pResultBuf, int32_t size, int32_t rowSize) {
+int32_t createDiskbasedResultBuffer(SDiskbasedResultBuf** pResultBuf, int32_t size, int32_t rowSize,
+                                    int64_t inMemBufSize) {
   SDiskbasedResultBuf* pResBuf = calloc(1, sizeof(SDiskbasedResultBuf));
+  if (pResBuf == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
   pResBuf->numOfRowsPerPage = (DEFAULT_INTERN_BUF_SIZE - sizeof(tFilePage)) / rowSize;
   pResBuf->numOfPages = size;
 
   pResBuf->totalBufSize = pResBuf->numOfPages * DEFAULT_INTERN_BUF_SIZE;
-  pResBuf->incStep = 4;
+  pResBuf->fd = -1;
+  pResBuf->lruHead = -1;
+  pResBuf->lruTail = -1;
+
+  pResBuf->inMemPages = inMemBufSize / DEFAULT_INTERN_BUF_SIZE;
+  if (pResBuf->inMemPages < RESULT_BUF_MIN_INMEM_PAGES) {
+    pResBuf->inMemPages = RESULT_BUF_MIN_INMEM_PAGES;
+  }
+
+  pResBuf->pageInfo = calloc(size, sizeof(SPageInfo));
 
   // init id hash table
   pResBuf->idsTable = taosHashInit(size, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), false);
   pResBuf->list = calloc(size, sizeof(SIDList));
   pResBuf->numOfAllocGroupIds = size;
 
+  if (pResBuf->pageInfo == NULL || pResBuf->idsTable == NULL || pResBuf->list == NULL) {
+    destroyResultBuf(pResBuf);
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  qTrace("create result buffer, %d pages, at most %d pages in memory", pResBuf->numOfPages, pResBuf->inMemPages);
+  *pResultBuf = pResBuf;
+  return TSDB_CODE_SUCCESS;
+}
+
+static void lruRemovePage(SDiskbasedResultBuf* pResultBuf, int32_t id) {
+  SPageInfo* pInfo = &pResultBuf->pageInfo[id];
+
+  if (pInfo->prev >= 0) {
+    pResultBuf->pageInfo[pInfo->prev].next = pInfo->next;
+  } else {
+    pResultBuf->lruHead = pInfo->next;
+  }
+
+  if (pInfo->next >= 0) {
+    pResultBuf->pageInfo[pInfo->next].prev = pInfo->prev;
+  } else {
+    pResultBuf->lruTail = pInfo->prev;
+  }
+
+  pInfo->prev = -1;
+  pInfo->next = -1;
+}
+
+static void lruAddPage(SDiskbasedResultBuf* pResultBuf, int32_t id) {
+  SPageInfo* pInfo = &pResultBuf->pageInfo[id];
+
+  pInfo->prev = -1;
+  pInfo->next = pResultBuf->lruHead;
+
+  if (pResultBuf->lruHead >= 0) {
+    pResultBuf->pageInfo[pResultBuf->lruHead].prev = id;
+  } else {
+    pResultBuf->lruTail = id;
+  }
+
+  pResultBuf->lruHead = id;
+}
+
+static int32_t createTmpFile(SDiskbasedResultBuf* pResultBuf) {
   char path[4096] = {0};
   getTmpfilePath("tsdb_q_buf", path);
-  pResBuf->path = strdup(path);
+  pResultBuf->path = strdup(path);
 
-  pResBuf->fd = open(pResBuf->path, O_CREAT | O_RDWR, 0666);
-  
-  memset(path, 0, tListLen(path));
+  pResultBuf->fd = open(pResultBuf->path, O_CREAT | O_RDWR | O_TRUNC, 0666);
+  if (!FD_VALID(pResultBuf->fd)) {
+    qError("failed to create tmp file: %s on disk. %s", pResultBuf->path, strerror(errno));
+    return TSDB_CODE_SERV_NO_DISKSPACE;
+  }
 
-  if (!FD_VALID(pResBuf->fd)) {
-    qError("failed to create tmp file: %s on disk. %s", pResBuf->path, strerror(errno));
-    return TSDB_CODE_CLI_NO_DISKSPACE;
+  qTrace("create tmp file for output result, %s, in-memory pages:%d", pResultBuf->path, pResultBuf->inMemPages);
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t spillPage(SDiskbasedResultBuf* pResultBuf, int32_t id) {
+  // the temp file is created only when the in-memory pages are exhausted
+  if (!FD_VALID(pResultBuf->fd) && createTmpFile(pResultBuf) != TSDB_CODE_SUCCESS) {
+    return TSDB_CODE_SERV_NO_DISKSPACE;
   }
 
-  int32_t ret = ftruncate(pResBuf->fd, pResBuf->numOfPages * DEFAULT_INTERN_BUF_SIZE);
-  if (ret != TSDB_CODE_SUCCESS) {
-    qError("failed to create tmp file: %s on disk. %s", pResBuf->path, strerror(errno));
-    return TSDB_CODE_CLI_NO_DISKSPACE;
+  SPageInfo* pInfo = &pResultBuf->pageInfo[id];
+  if (pwrite(pResultBuf->fd, pInfo->pData, DEFAULT_INTERN_BUF_SIZE, (off_t)id * DEFAULT_INTERN_BUF_SIZE) !=
+      DEFAULT_INTERN_BUF_SIZE) {
+    qError("failed to write page:%d into tmp file: %s. %s", id, pResultBuf->path, strerror(errno));
+    return TSDB_CODE_SERV_NO_DISKSPACE;
   }
 
-  pResBuf->pBuf = mmap(NULL, pResBuf->totalBufSize, PROT_READ | PROT_WRITE, MAP_SHARED, pResBuf->fd, 0);
-  if (pResBuf->pBuf == MAP_FAILED) {
-    qError("QInfo:%p failed to map temp file: %s. %s", pResBuf->path, strerror(errno));
-    return TSDB_CODE_CLI_OUT_OF_MEMORY; // todo change error code
+  pInfo->onDisk = true;
+  pResultBuf->numOfSpills += 1;
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * get a page buffer for a page that will become resident. If the in-memory pages are exhausted, the least recently
+ * used page that is not pinned is written into the temp file and its buffer is reused. If all resident pages are
+ * pinned, the in-memory buffer size is exceeded rather than failing the query.
+ */
+static tFilePage* allocPageBuf(SDiskbasedResultBuf* pResultBuf) {
+  if (pResultBuf->numOfInMemPages < pResultBuf->inMemPages) {
+    tFilePage* page = malloc(DEFAULT_INTERN_BUF_SIZE);
+    if (page != NULL) {
+      pResultBuf->numOfInMemPages += 1;
+    }
+
+    return page;
   }
 
-  qTrace("create tmp file for output result, %s, " PRId64 "bytes", pResBuf->path, pResBuf->totalBufSize);
-  *pResultBuf = pResBuf;
+  int32_t victim = pResultBuf->lruTail;
+  while (victim >= 0 && pResultBuf->pageInfo[victim].pinned > 0) {
+    victim = pResultBuf->pageInfo[victim].prev;
+  }
+
+  if (victim < 0) {
+    qTrace("all %d in-memory pages are pinned, exceed the in-memory buffer size", pResultBuf->numOfInMemPages);
+
+    tFilePage* page = malloc(DEFAULT_INTERN_BUF_SIZE);
+    if (page != NULL) {
+      pResultBuf->numOfInMemPages += 1;
+    }
+
+    return page;
+  }
+
+  if (spillPage(pResultBuf, victim) != TSDB_CODE_SUCCESS) {
+    return NULL;
+  }
+
+  SPageInfo* pInfo = &pResultBuf->pageInfo[victim];
+  lruRemovePage(pResultBuf, victim);
+
+  tFilePage* page = pInfo->pData;
+  pInfo->pData = NULL;
+  return page;
+}
+
+static int32_t loadPage(SDiskbasedResultBuf* pResultBuf, int32_t id) {
+  SPageInfo* pInfo = &pResultBuf->pageInfo[id];
+  assert(pInfo->pData == NULL && pInfo->onDisk);
+
+  tFilePage* page = allocPageBuf(pResultBuf);
+  if (page == NULL) {
+    return TSDB_CODE_SERV_OUT_OF_MEMORY;
+  }
+
+  if (pread(pResultBuf->fd, page, DEFAULT_INTERN_BUF_SIZE, (off_t)id * DEFAULT_INTERN_BUF_SIZE) !=
+      DEFAULT_INTERN_BUF_SIZE) {
+    qError("failed to read page:%d from tmp file: %s. %s", id, pResultBuf->path, strerror(errno));
+
+    free(page);
+    pResultBuf->numOfInMemPages -= 1;
+    return TSDB_CODE_SERV_NO_DISKSPACE;
+  }
+
+  pInfo->pData = page;
+  pResultBuf->numOfLoads += 1;
   return TSDB_CODE_SUCCESS;
 }
 
 tFilePage* getResultBufferPageById(SDiskbasedResultBuf* pResultBuf, int32_t id) {
-  assert(id < pResultBuf->numOfPages && id >= 0);
+  assert(id < pResultBuf->allocateId && id >= 0);
 
-  return (tFilePage*)(pResultBuf->pBuf + DEFAULT_INTERN_BUF_SIZE * id);
+  SPageInfo* pInfo = &pResultBuf->pageInfo[id];
+  if (pInfo->pData == NULL) {
+    if (loadPage(pResultBuf, id) != TSDB_CODE_SUCCESS) {
+      return NULL;
+    }
+  } else {
+    lruRemovePage(pResultBuf, id);
+  }
+
+  lruAddPage(pResultBuf, id);
+  pInfo->pinned += 1;
+
+  return pInfo->pData;
 }
 
-int32_t getNumOfResultBufGroupId(SDiskbasedResultBuf* pResultBuf) { return taosHashGetSize(pResultBuf->idsTable); }
+void releaseResBufPage(SDiskbasedResultBuf* pResultBuf, int32_t id) {
+  assert(id < pResultBuf->allocateId && id >= 0);
 
-int32_t getResBufSize(SDiskbasedResultBuf* pResultBuf) { return pResultBuf->totalBufSize; }
+  SPageInfo* pInfo = &pResultBuf->pageInfo[id];
+  assert(pInfo->pinned > 0 && pInfo->pData != NULL);
 
-static int32_t extendDiskFileSize(SDiskbasedResultBuf* pResultBuf, int32_t numOfPages) {
-  assert(pResultBuf->numOfPages * DEFAULT_INTERN_BUF_SIZE == pResultBuf->totalBufSize);
+  pInfo->pinned -= 1;
+}
+
+int32_t getNumOfResultBufGroupId(SDiskbasedResultBuf* pResultBuf) { return taosHashGetSize(pResultBuf->idsTable); }
 
-  int32_t ret = munmap(pResultBuf->pBuf, pResultBuf->totalBufSize);
-  pResultBuf->numOfPages += numOfPages;
+int32_t getResBufSize(SDiskbasedResultBuf* pResultBuf) { return pResultBuf->totalBufSize; }
 
-  /*
-   * disk-based output buffer is exhausted, try to extend the disk-based buffer, the available disk space may
-   * be insufficient
-   */
-  ret = ftruncate(pResultBuf->fd, pResultBuf->numOfPages * DEFAULT_INTERN_BUF_SIZE);
-  if (ret != 0) {
-    //    dError("QInfo:%p failed to create intermediate result output file:%s. %s", pQInfo, pSupporter->extBufFile,
-    //           strerror(errno));
-    return -TSDB_CODE_SERV_NO_DISKSPACE;
+static int32_t extendPageInfo(SDiskbasedResultBuf* pResultBuf) {
+  // only the page info is extended, the page content is allocated on demand
+  int32_t    num = pResultBuf->numOfPages << 1u;
+  SPageInfo* p = realloc(pResultBuf->pageInfo, sizeof(SPageInfo) * num);
+  if (p == NULL) {
+    return TSDB_CODE_SERV_OUT_OF_MEMORY;
   }
 
-  pResultBuf->totalBufSize = pResultBuf->numOfPages * DEFAULT_INTERN_BUF_SIZE;
-  pResultBuf->pBuf = mmap(NULL, pResultBuf->totalBufSize, PROT_READ | PROT_WRITE, MAP_SHARED, pResultBuf->fd, 0);
+  memset(&p[pResultBuf->numOfPages], 0, sizeof(SPageInfo) * (num - pResultBuf->numOfPages));
 
-  if (pResultBuf->pBuf == MAP_FAILED) {
-    //    dError("QInfo:%p failed to map temp file: %s. %s", pQInfo, pSupporter->extBufFile, strerror(errno));
-    return -TSDB_CODE_SERV_OUT_OF_MEMORY;
-  }
+  pResultBuf->pageInfo = p;
+  pResultBuf->numOfPages = num;
+  pResultBuf->totalBufSize = pResultBuf->numOfPages * DEFAULT_INTERN_BUF_SIZE;
 
   return TSDB_CODE_SUCCESS;
 }
 
 static bool noMoreAvailablePages(SDiskbasedResultBuf* pResultBuf) {
-  return (pResultBuf->allocateId == pResultBuf->numOfPages - 1);
+  return (pResultBuf->allocateId == pResultBuf->numOfPages);
 }
 
 static int32_t getGroupIndex(SDiskbasedResultBuf* pResultBuf, int32_t groupId) {
@@ -160,20 +297,28 @@ static void registerPageId(SDiskbasedResultBuf* pResultBuf, int32_t groupId, int
 
 tFilePage* getNewDataBuf(SDiskbasedResultBuf* pResultBuf, int32_t groupId, int32_t* pageId) {
   if (noMoreAvailablePages(pResultBuf)) {
-    if (extendDiskFileSize(pResultBuf, pResultBuf->incStep) != TSDB_CODE_SUCCESS) {
+    if (extendPageInfo(pResultBuf) != TSDB_CODE_SUCCESS) {
       return NULL;
     }
   }
 
+  tFilePage* page = allocPageBuf(pResultBuf);
+  if (page == NULL) {
+    return NULL;
+  }
+
   // register new id in this group
   *pageId = (pResultBuf->allocateId++);
   registerPageId(pResultBuf, groupId, *pageId);
 
-  tFilePage* page = getResultBufferPageById(pResultBuf, *pageId);
-  
   // clear memory for the new page
   memset(page, 0, DEFAULT_INTERN_BUF_SIZE);
-  
+
+  SPageInfo* pInfo = &pResultBuf->pageInfo[*pageId];
+  pInfo->pData = page;
+  pInfo->pinned = 1;
+  lruAddPage(pResultBuf, *pageId);
+
   return page;
 }
 
@@ -196,17 +341,30 @@ void destroyResultBuf(SDiskbasedResultBuf* pResultBuf) {
 
   if (FD_VALID(pResultBuf->fd)) {
     close(pResultBuf->fd);
+    unlink(pResultBuf->path);
+
+    qTrace("disk-based output buffer closed, %d pages, %d in memory, spilled:%" PRId64 ", loaded:%" PRId64 ", file:%s",
+           pResultBuf->allocateId, pResultBuf->numOfInMemPages, pResultBuf->numOfSpills, pResultBuf->numOfLoads,
+           pResultBuf->path);
+  } else {
+    qTrace("in-memory output buffer closed, %d pages", pResultBuf->allocateId);
   }
 
-  qTrace("disk-based output buffer closed, %" PRId64 " bytes, file:%s", pResultBuf->totalBufSize, pResultBuf->path);
-  munmap(pResultBuf->pBuf, pResultBuf->totalBufSize);
-  unlink(pResultBuf->path);
-  
   tfree(pResultBuf->path);
 
-  for (int32_t i = 0; i < pResultBuf->numOfAllocGroupIds; ++i) {
-    SIDList* pList = &pResultBuf->list[i];
-    tfree(pList->pData);
+  if (pResultBuf->pageInfo != NULL) {
+    for (int32_t i = 0; i < pResultBuf->allocateId; ++i) {
+      tfree(pResultBuf->pageInfo[i].pData);
+    }
+  }
+
+  tfree(pResultBuf->pageInfo);
+
+  if (pResultBuf->list != NULL) {
+    for (int32_t i = 0; i < pResultBuf->numOfAllocGroupIds; ++i) {
+      SIDList* pList = &pResultBuf->list[i];
+      tfree(pList->pData);
+    }
   }
 
   tfree(pResultBuf->list);
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+
+#include "qtdigest.h"
+
+/**
+ * implement the merging t-digest based on the paper:
+ * Ted Dunning, Otmar Ertl. Computing Extremely Accurate Quantiles Using t-Digests, 2019
+ * https://arxiv.org/abs/1902.04023
+ *
+ * the values are appended to a buffer and merged into the centroids in batch when the buffer is full, so the cost
+ * of each value is amortized to a sort of the buffer and a linear scan of the centroids.
+ */
+
+// k1 scale function, k(q) = compression / (2 * PI) * asin(2q - 1)
+static double scaleToK(double q) { return TDIGEST_COMPRESSION / (2 * M_PI) * asin(2 * q - 1); }
+
+static double scaleToQ(double k) {
+  if (k >= TDIGEST_COMPRESSION / 4.0) {
+    return 1;
+  }
+
+  return (sin(k * 2 * M_PI / TDIGEST_COMPRESSION) + 1) / 2;
+}
+
+static int32_t centroidCompare(const void* p1, const void* p2) {
+  double m1 = ((const SCentroid*)p1)->mean;
+  double m2 = ((const SCentroid*)p2)->mean;
+
+  if (m1 == m2) {
+    return 0;
+  }
+
+  return (m1 < m2) ? -1 : 1;
+}
+
+STDigest* tTDigestCreateFrom(void* pBuf) {
+  STDigest* pDigest = (STDigest*)pBuf;
+  memset(pDigest, 0, sizeof(STDigest));
+
+  pDigest->min = DBL_MAX;
+  pDigest->max = -DBL_MAX;
+  return pDigest;
+}
+
+void tTDigestCompress(STDigest* pDigest) {
+  if (pDigest->numOfBuffered == 0) {
+    return;
+  }
+
+  SCentroid* pBuffered = &pDigest->centroids[pDigest->numOfCentroids];
+  qsort(pBuffered, pDigest->numOfBuffered, sizeof(SCentroid), centroidCompare);
+
+  // merge the sorted centroids and the sorted buffer, and combine the neighbours as long as the
+  // combined centroid still covers no more than one unit of k
+  SCentroid merged[TDIGEST_MAX_CENTROIDS + TDIGEST_BUFFER_SIZE];
+
+  int32_t i = 0, j = 0, num = 0;
+  double  total = (double)pDigest->size;
+  int64_t weightSoFar = 0;
+  double  limit = scaleToQ(scaleToK(0) + 1) * total;
+
+  while (i < pDigest->numOfCentroids || j < pDigest->numOfBuffered) {
+    SCentroid* pNext = NULL;
+    if (j >= pDigest->numOfBuffered ||
+        (i < pDigest->numOfCentroids && pDigest->centroids[i].mean <= pBuffered[j].mean)) {
+      pNext = &pDigest->centroids[i++];
+    } else {
+      pNext = &pBuffered[j++];
+    }
+
+    if (num == 0) {
+      merged[num++] = *pNext;
+      continue;
+    }
+
+    SCentroid* pLast = &merged[num - 1];
+    if (weightSoFar + pLast->weight + pNext->weight <= limit || num == TDIGEST_MAX_CENTROIDS) {
+      pLast->weight += pNext->weight;
+      pLast->mean += (pNext->mean - pLast->mean) * pNext->weight / pLast->weight;
+    } else {
+      weightSoFar += pLast->weight;
+      limit = scaleToQ(scaleToK(weightSoFar / total) + 1) * total;
+      merged[num++] = *pNext;
+    }
+  }
+
+  memcpy(pDigest->centroids, merged, sizeof(SCentroid) * num);
+  pDigest->numOfCentroids = num;
+  pDigest->numOfBuffered = 0;
+}
+
+void tTDigestAdd(STDigest* pDigest, double val, int64_t weight) {
+  if (weight <= 0) {
+    return;
+  }
+
+  if (pDigest->numOfBuffered >= TDIGEST_BUFFER_SIZE) {
+    tTDigestCompress(pDigest);
+  }
+
+  SCentroid* pEntry = &pDigest->centroids[pDigest->numOfCentroids + pDigest->numOfBuffered];
+  pEntry->mean = val;
+  pEntry->weight = weight;
+
+  pDigest->numOfBuffered += 1;
+  pDigest->size += weight;
+
+  if (val < pDigest->min) {
+    pDigest->min = val;
+  }
+
+  if (val > pDigest->max) {
+    pDigest->max = val;
+  }
+}
+
+// the values of a data block are copied into the free slots of the buffer in batch, with the weight of 1
+void tTDigestAddBatch(STDigest* pDigest, const double* vals, int32_t num) {
+  int32_t i = 0;
+  while (i < num) {
+    if (pDigest->numOfBuffered >= TDIGEST_BUFFER_SIZE) {
+      tTDigestCompress(pDigest);
+    }
+
+    int32_t    n = MIN(num - i, TDIGEST_BUFFER_SIZE - pDigest->numOfBuffered);
+    SCentroid* pEntry = &pDigest->centroids[pDigest->numOfCentroids + pDigest->numOfBuffered];
+    for (int32_t j = 0; j < n; ++j, ++i) {
+      pEntry[j].mean = vals[i];
+      pEntry[j].weight = 1;
+
+      if (vals[i] < pDigest->min) {
+        pDigest->min = vals[i];
+      }
+
+      if (vals[i] > pDigest->max) {
+        pDigest->max = vals[i];
+      }
+    }
+
+    pDigest->numOfBuffered += n;
+    pDigest->size += n;
+  }
+}
+
+void tTDigestMerge(STDigest* pDigest, const STDigest* pOther) {
+  if (pOther->size <= 0) {
+    return;
+  }
+
+  // both the centroids and the buffered points of the other digest are weighted points for this one
+  int32_t num = pOther->numOfCentroids + pOther->numOfBuffered;
+  for (int32_t i = 0; i < num; ++i) {
+    tTDigestAdd(pDigest, pOther->centroids[i].mean, pOther->centroids[i].weight);
+  }
+
+  // the min/max of the other digest may be covered by centroids
+  if (pOther->min < pDigest->min) {
+    pDigest->min = pOther->min;
+  }
+
+  if (pOther->max > pDigest->max) {
+    pDigest->max = pOther->max;
+  }
+}
+
+/*
+ * the mean of each centroid is regarded as the value at the middle of its weight, and the values between two
+ * adjacent centroids are interpolated linearly. min and max are used at both ends.
+ */
+double tTDigestQuantile(STDigest* pDigest, double q) {
+  tTDigestCompress(pDigest);
+
+  if (pDigest->numOfCentroids == 0) {
+    return NAN;
+  }
+
+  if (q <= 0) {
+    return pDigest->min;
+  }
+
+  if (q >= 1) {
+    return pDigest->max;
+  }
+
+  if (pDigest->numOfCentroids == 1) {
+    return pDigest->centroids[0].mean;
+  }
+
+  SCentroid* c = pDigest->centroids;
+  int32_t    n = pDigest->numOfCentroids;
+  double     index = q * pDigest->size;
+
+  if (index < c[0].weight / 2.0) {
+    return pDigest->min + (c[0].mean - pDigest->min) * index / (c[0].weight / 2.0);
+  }
+
+  double weightSoFar = c[0].weight / 2.0;
+  for (int32_t i = 0; i < n - 1; ++i) {
+    double delta = (c[i].weight + c[i + 1].weight) / 2.0;
+    if (weightSoFar + delta > index) {
+      return c[i].mean + (c[i + 1].mean - c[i].mean) * (index - weightSoFar) / delta;
+    }
+
+    weightSoFar += delta;
+  }
+
+  double right = c[n - 1].weight / 2.0;
+  if (index >= weightSoFar + right) {
+    return pDigest->max;
+  }
+
+  return c[n - 1].mean + (pDigest->max - c[n - 1].mean) * (index - weightSoFar) / right;
+}
@@ -23,6 +23,7 @@
 #include "queryLog.h"
 #include "queryUtil.h"
 #include "taosmsg.h"
+#include "tglobal.h"
 #include "tlosertree.h"
 #include "tscompression.h"
 #include "tsdbMain.h"  //todo use TableId instead of STable object
@@ -102,7 +103,7 @@ static void setQueryStatus(SQuery *pQuery, int8_t status);
 bool        isIntervalQuery(SQuery *pQuery) { return pQuery->intervalTime > 0; }
 
 static int32_t mergeIntoGroupResultImpl(SQInfo *pQInfo, SArray *group);
-static void    setWindowResOutputBuf(SQueryRuntimeEnv *pRuntimeEnv, SWindowResult *pResult);
+static int32_t setWindowResOutputBuf(SQueryRuntimeEnv *pRuntimeEnv, SWindowResult *pResult);
 
 static void resetMergeResultBuf(SQuery *pQuery, SQLFunctionCtx *pCtx, SResultInfo *pResultInfo);
 static bool functionNeedToExecute(SQueryRuntimeEnv *pRuntimeEnv, SQLFunctionCtx *pCtx, int32_t functionId);
@@ -529,7 +530,9 @@ static int32_t addNewWindowResultBuf(SWindowResult *pWindowRes, SDiskbasedResult
     pageId = getLastPageId(&list);
     pData = getResultBufferPageById(pResultBuf, pageId);
 
-    if (pData->numOfElems >= numOfRowsPerPage) {
+    if (pData != NULL && pData->numOfElems >= numOfRowsPerPage) {
+      releaseResBufPage(pResultBuf, pageId);
+
       pData = getNewDataBuf(pResultBuf, sid, &pageId);
       if (pData != NULL) {
         assert(pData->numOfElems == 0);  // number of elements must be 0 for new allocated buffer
@@ -547,6 +550,7 @@ static int32_t addNewWindowResultBuf(SWindowResult *pWindowRes, SDiskbasedResult
     pWindowRes->pos.rowId = pData->numOfElems++;
   }
 
+  releaseResBufPage(pResultBuf, pageId);
   return 0;
 }
 
@@ -571,9 +575,11 @@ static int32_t setWindowOutputBufByKey(SQueryRuntimeEnv *pRuntimeEnv, SWindowRes
   // set time window for current result
   pWindowRes->window = *win;
 
-  setWindowResOutputBuf(pRuntimeEnv, pWindowRes);
-  initCtxOutputBuf(pRuntimeEnv);
+  if (setWindowResOutputBuf(pRuntimeEnv, pWindowRes) != TSDB_CODE_SUCCESS) {
+    return -1;
+  }
 
+  initCtxOutputBuf(pRuntimeEnv);
   return TSDB_CODE_SUCCESS;
 }
 
@@ -869,6 +875,171 @@ char *getDataBlocks(SQueryRuntimeEnv *pRuntimeEnv, SArithmeticSupport *sas, int3
   return dataBlock;
 }
 
+/*
+ * The fused interval aggregation applies to the interval query with tumbling windows, of which all functions can
+ * be computed from the pre-aggregated statistics (count/sum/avg/min/max) or only output the window/tag info.
+ */
+static bool isFusedIntervalAggQuery(SQueryRuntimeEnv *pRuntimeEnv) {
+  SQuery *pQuery = pRuntimeEnv->pQuery;
+
+  if (!isIntervalQuery(pQuery) || pQuery->slidingTime != pQuery->intervalTime || pRuntimeEnv->pTSBuf != NULL) {
+    return false;
+  }
+
+  for (int32_t k = 0; k < pQuery->numOfOutput; ++k) {
+    int32_t functionId = pQuery->pSelectExpr[k].pBase.functionId;
+    int16_t type = pRuntimeEnv->pCtx[k].inputType;
+
+    switch (functionId) {
+      case TSDB_FUNC_TS:
+      case TSDB_FUNC_TS_DUMMY:
+      case TSDB_FUNC_TAG_DUMMY:
+      case TSDB_FUNC_TAG:
+      case TSDB_FUNC_COUNT:
+        break;
+      case TSDB_FUNC_SUM:
+      case TSDB_FUNC_AVG:
+      case TSDB_FUNC_MIN:
+      case TSDB_FUNC_MAX:
+        if (type < TSDB_DATA_TYPE_TINYINT || type > TSDB_DATA_TYPE_DOUBLE) {
+          return false;
+        }
+        break;
+      default:
+        return false;
+    }
+  }
+
+  return true;
+}
+
+static FORCE_INLINE bool isStatisRequired(int32_t functionId) {
+  return functionId == TSDB_FUNC_COUNT || functionId == TSDB_FUNC_SUM || functionId == TSDB_FUNC_AVG ||
+         functionId == TSDB_FUNC_MIN || functionId == TSDB_FUNC_MAX;
+}
+
+/*
+ * The window boundaries are computed arithmetically with one pass over the timestamp column, then all windows of
+ * the block are aggregated column by column into the per-window statistics, and the functions of each window are
+ * invoked only once with the pre-aggregated values, instead of searching the window end and scanning the rows of
+ * each window separately.
+ *
+ * return false if the block is not qualified, and the generic path is used.
+ */
+static bool fusedIntervalApplyFunctions(SQueryRuntimeEnv *pRuntimeEnv, SDataBlockInfo *pDataBlockInfo,
+                                        SWindowResInfo *pWindowResInfo, TSKEY *primaryKeyCol) {
+  SQuery *        pQuery = pRuntimeEnv->pQuery;
+  SQLFunctionCtx *pCtx = pRuntimeEnv->pCtx;
+
+  if (!QUERY_IS_ASC_QUERY(pQuery) || !IS_MASTER_SCAN(pRuntimeEnv) || primaryKeyCol == NULL) {
+    return false;
+  }
+
+  for (int32_t k = 0; k < pQuery->numOfOutput; ++k) {
+    if (isStatisRequired(pQuery->pSelectExpr[k].pBase.functionId) && pCtx[k].aInputElemBuf == NULL) {
+      return false;
+    }
+  }
+
+  int32_t pos = pQuery->pos;
+  int32_t numOfRows = pDataBlockInfo->rows;
+  assert(pos >= 0 && pos < numOfRows);
+
+  SWindowRowRange *pRange = malloc(sizeof(SWindowRowRange) * (numOfRows - pos));
+  SDataStatis *    pStatis = malloc(sizeof(SDataStatis) * (numOfRows - pos) * pQuery->numOfOutput);
+  if (pRange == NULL || pStatis == NULL) {
+    tfree(pRange);
+    tfree(pStatis);
+    return false;
+  }
+
+  // 1. split the rows into time windows, the first window comes from the previous block
+  STimeWindow win = getActiveTimeWindow(pWindowResInfo, primaryKeyCol[pos], pQuery);
+  int32_t     numOfWins = splitIntoTumblingWindows(primaryKeyCol, pos, numOfRows, &win, pQuery->intervalTime,
+                                                   pQuery->window.ekey, pRange);
+
+  // 2. compute the statistics of all windows, column by column
+  for (int32_t k = 0; k < pQuery->numOfOutput; ++k) {
+    SSqlFuncMsg *pBase = &pQuery->pSelectExpr[k].pBase;
+    if (!isStatisRequired(pBase->functionId)) {
+      continue;
+    }
+
+    // the statistics of the same column is computed only once
+    int32_t j = 0;
+    for (; j < k; ++j) {
+      SSqlFuncMsg *p = &pQuery->pSelectExpr[j].pBase;
+      if (isStatisRequired(p->functionId) && p->colInfo.colId == pBase->colInfo.colId) {
+        break;
+      }
+    }
+
+    if (j < k) {
+      memcpy(&pStatis[k * numOfWins], &pStatis[j * numOfWins], sizeof(SDataStatis) * numOfWins);
+    } else {
+      computeWindowStatis(&pCtx[k], pRange, numOfWins, &pStatis[k * numOfWins]);
+    }
+  }
+
+  // 3. invoke the functions for each window with the pre-aggregated values
+  int32_t index = -1;
+  for (int32_t w = 0; w < numOfWins; ++w) {
+    STimeWindow w1 = {.skey = pRange[w].skey, .ekey = pRange[w].skey + pQuery->intervalTime - 1};
+    if (w == 0) {
+      w1 = win;  // keep the same window as the generic path
+    }
+
+    if (setWindowOutputBufByKey(pRuntimeEnv, pWindowResInfo, pDataBlockInfo->sid, &w1) != TSDB_CODE_SUCCESS) {
+      break;
+    }
+
+    if (index < 0) {
+      index = pWindowResInfo->curIndex;
+    }
+
+    for (int32_t k = 0; k < pQuery->numOfOutput; ++k) {
+      int32_t functionId = pQuery->pSelectExpr[k].pBase.functionId;
+
+      pCtx[k].nStartQueryTimestamp = pRange[w].skey;
+      pCtx[k].size = pRange[w].rows;
+      pCtx[k].startOffset = pRange[w].start;
+
+      if ((aAggs[functionId].nStatus & TSDB_FUNCSTATE_SELECTIVITY) != 0) {
+        pCtx[k].ptsList = &primaryKeyCol[pRange[w].start];
+      }
+
+      if (isStatisRequired(functionId)) {
+        SDataStatis *pWinStatis = &pStatis[k * numOfWins + w];
+
+        // no qualified value for min/max in this window
+        if ((functionId == TSDB_FUNC_MIN || functionId == TSDB_FUNC_MAX) && pWinStatis->numOfNull == pRange[w].rows) {
+          continue;
+        }
+
+        pCtx[k].preAggVals.isSet = true;
+        pCtx[k].preAggVals.size = pRange[w].rows;
+        pCtx[k].preAggVals.statis = *pWinStatis;
+      }
+
+      if (functionNeedToExecute(pRuntimeEnv, &pCtx[k], functionId)) {
+        aAggs[functionId].xFunction(&pCtx[k]);
+      }
+    }
+  }
+
+  for (int32_t k = 0; k < pQuery->numOfOutput; ++k) {
+    pCtx[k].preAggVals.isSet = false;
+  }
+
+  if (index >= 0) {
+    pWindowResInfo->curIndex = index;
+  }
+
+  tfree(pRange);
+  tfree(pStatis);
+  return true;
+}
+
 /**
  *
  * @param pRuntimeEnv
@@ -908,7 +1079,10 @@ static void blockwiseApplyFunctions(SQueryRuntimeEnv *pRuntimeEnv, SDataStatis *
   }
 
   int32_t step = GET_FORWARD_DIRECTION_FACTOR(pQuery->order.order);
-  if (isIntervalQuery(pQuery)) {
+  if (pRuntimeEnv->fusedIntervalAgg && fusedIntervalApplyFunctions(pRuntimeEnv, pDataBlockInfo, pWindowResInfo,
+                                                                    primaryKeyCol)) {
+    // all windows in current block are aggregated
+  } else if (isIntervalQuery(pQuery)) {
     int32_t offset = GET_COL_DATA_POS(pQuery, 0, step);
     TSKEY   ts = primaryKeyCol[offset];
 
@@ -985,7 +1159,10 @@ static int32_t setGroupResultOutputBuf(SQueryRuntimeEnv *pRuntimeEnv, char *pDat
     }
   }
 
-  setWindowResOutputBuf(pRuntimeEnv, pWindowRes);
+  if (setWindowResOutputBuf(pRuntimeEnv, pWindowRes) != TSDB_CODE_SUCCESS) {
+    return -1;
+  }
+
   initCtxOutputBuf(pRuntimeEnv);
   return TSDB_CODE_SUCCESS;
 }
@@ -1106,10 +1283,18 @@ static void rowwiseApplyFunctions(SQueryRuntimeEnv *pRuntimeEnv, SDataStatis *pS
                   &sasArray[k], pRuntimeEnv->scanFlag);
   }
 
-  // set the input column data
+  // set the input column data, the filter column is not necessarily one of the output columns
+  size_t numOfCols = taosArrayGetSize(pDataBlock);
   for (int32_t k = 0; k < pQuery->numOfFilterCols; ++k) {
     SSingleColumnFilterInfo *pFilterInfo = &pQuery->pFilterInfo[k];
-    pFilterInfo->pData = getDataBlocks(pRuntimeEnv, &sasArray[k], pFilterInfo->info.colId, pDataBlockInfo->rows, pDataBlock);
+
+    for (int32_t i = 0; i < numOfCols; ++i) {
+      SColumnInfoData *p = taosArrayGet(pDataBlock, i);
+      if (pFilterInfo->info.colId == p->info.colId) {
+        pFilterInfo->pData = p->pData;
+        break;
+      }
+    }
   }
 
   int32_t step = GET_FORWARD_DIRECTION_FACTOR(pQuery->order.order);
@@ -1252,11 +1437,17 @@ static int32_t tableApplyFunctionsOnBlock(SQueryRuntimeEnv *pRuntimeEnv, SDataBl
   // update the number of output result
   if (numOfRes > 0 && pQuery->checkBuffer == 1) {
     assert(numOfRes >= pQuery->rec.rows);
+    pRuntimeEnv->numOfTableRes += (numOfRes - pQuery->rec.rows);
     pQuery->rec.rows = numOfRes;
 
     if (numOfRes >= pQuery->rec.threshold) {
       setQueryStatus(pQuery, QUERY_RESBUF_FULL);
     }
+
+    // the first limit rows of current table are enough for the client to produce the globally ordered results
+    if (pRuntimeEnv->tableLimit && pQuery->limit.limit > 0 && pRuntimeEnv->numOfTableRes >= pQuery->limit.limit) {
+      setQueryStatus(pQuery, QUERY_COMPLETED);
+    }
   }
 
   return numOfRes;
@@ -1307,6 +1498,10 @@ void setExecParams(SQuery *pQuery, SQLFunctionCtx *pCtx, void *inputData, TSKEY
 
   } else if (functionId == TSDB_FUNC_ARITHM) {
     pCtx->param[1].pz = param;
+  } else if (functionId == TSDB_FUNC_LAST_ROW && tsCol != NULL) {
+    // the timestamp of the last row
+    pCtx->param[0].i64Key = tsCol[pCtx->startOffset];
+    pCtx->param[0].nType = TSDB_DATA_TYPE_BIGINT;
   }
 
 #if defined(_DEBUG_VIEW)
@@ -1429,6 +1624,7 @@ static int32_t setupQueryRuntimeEnv(SQueryRuntimeEnv *pRuntimeEnv, int16_t order
   }
 
   setCtxTagColumnInfo(pQuery, pRuntimeEnv->pCtx);
+  pRuntimeEnv->fusedIntervalAgg = isFusedIntervalAggQuery(pRuntimeEnv);
   return TSDB_CODE_SUCCESS;
 
 _error_clean:
@@ -1576,6 +1772,15 @@ bool notHasQueryTimeRange(SQuery *pQuery) {
          (pQuery->window.skey == INT64_MAX && pQuery->window.ekey == 0 && (!QUERY_IS_ASC_QUERY(pQuery)));
 }
 
+/*
+ * the last row query without time range is served by the last row cache of tsdb. The cached row is the newest row of
+ * the table, so it does not apply to queries with column filters or ts-comp join.
+ */
+static bool isLastRowCacheQuery(SQuery *pQuery, STSBuf *pTSBuf) {
+  return isFirstLastRowQuery(pQuery) && notHasQueryTimeRange(pQuery) && pQuery->numOfFilterCols == 0 &&
+         pTSBuf == NULL;
+}
+
 static bool needReverseScan(SQuery *pQuery) {
   for (int32_t i = 0; i < pQuery->numOfOutput; ++i) {
     int32_t functionId = pQuery->pSelectExpr[i].pBase.functionId;
@@ -1950,8 +2155,8 @@ void pointInterpSupporterSetData(SQInfo *pQInfo, SPointInterpoSupporter *pPointI
   SQueryRuntimeEnv *pRuntimeEnv = &pQInfo->runtimeEnv;
   SQuery *          pQuery = pRuntimeEnv->pQuery;
 
-  // not point interpolation query, abort
-  if (!isPointInterpoQuery(pQuery)) {
+  // not point interpolation query, abort. the timestamp of last row query is set with the data block
+  if (!isPointInterpoQuery(pQuery) || isFirstLastRowQuery(pQuery)) {
     return;
   }
 
@@ -2135,11 +2340,30 @@ static int32_t getNumOfRowsInResultPage(SQuery *pQuery, bool isSTableQuery) {
   return (DEFAULT_INTERN_BUF_SIZE - sizeof(tFilePage)) / rowSize;
 }
 
-char *getPosInResultPage(SQueryRuntimeEnv *pRuntimeEnv, int32_t columnIndex, SWindowResult *pResult) {
+/*
+ * get the result page of the window and pin it, the caller releases the page once the positions in it are not used
+ * any more. The query is aborted if the page can not be loaded from the temp file.
+ */
+tFilePage *getWindowResPage(SQueryRuntimeEnv *pRuntimeEnv, SWindowResult *pResult) {
   assert(pResult != NULL && pRuntimeEnv != NULL);
 
-  SQuery *   pQuery = pRuntimeEnv->pQuery;
   tFilePage *page = getResultBufferPageById(pRuntimeEnv->pResultBuf, pResult->pos.pageId);
+  if (page == NULL) {
+    SQInfo *pQInfo = GET_QINFO_ADDR(pRuntimeEnv);
+    qError("QInfo:%p failed to load result page:%d, abort query", pQInfo, pResult->pos.pageId);
+
+    if (pQInfo->code == TSDB_CODE_SUCCESS) {
+      pQInfo->code = TSDB_CODE_SERV_OUT_OF_MEMORY;
+    }
+  }
+
+  return page;
+}
+
+// position of the column of the window in the page, which is pinned by getWindowResPage
+char *getPosInResultPage(SQueryRuntimeEnv *pRuntimeEnv, int32_t columnIndex, SWindowResult *pResult,
+                         tFilePage *page) {
+  SQuery *pQuery = pRuntimeEnv->pQuery;
 
   int32_t numOfRows = getNumOfRowsInResultPage(pQuery, pRuntimeEnv->stableQuery);
   int32_t realRowId = pResult->pos.rowId * getRowParamForMultiRowsOutput(pQuery, pRuntimeEnv->stableQuery);
@@ -2459,6 +2683,11 @@ static int64_t doScanAllDataBlocks(SQueryRuntimeEnv *pRuntimeEnv) {
     if (Q_STATUS_EQUAL(pQuery->status, QUERY_RESBUF_FULL)) {
       break;
     }
+
+    // no more data of current table is required by the per-table limit
+    if (pRuntimeEnv->tableLimit && Q_STATUS_EQUAL(pQuery->status, QUERY_COMPLETED)) {
+      break;
+    }
   }
 
   // if the result buffer is not full, set the query completed flag
@@ -2529,10 +2758,15 @@ void setTagVal(SQueryRuntimeEnv *pRuntimeEnv, STableId id, void *tsdb) {
   }
 }
 
-static void doMerge(SQueryRuntimeEnv *pRuntimeEnv, int64_t timestamp, SWindowResult *pWindowRes, bool mergeFlag) {
+static int32_t doMerge(SQueryRuntimeEnv *pRuntimeEnv, int64_t timestamp, SWindowResult *pWindowRes, bool mergeFlag) {
   SQuery *        pQuery = pRuntimeEnv->pQuery;
   SQLFunctionCtx *pCtx = pRuntimeEnv->pCtx;
 
+  tFilePage *page = getWindowResPage(pRuntimeEnv, pWindowRes);
+  if (page == NULL) {
+    return -1;
+  }
+
   for (int32_t i = 0; i < pQuery->numOfOutput; ++i) {
     int32_t functionId = pQuery->pSelectExpr[i].pBase.functionId;
     if (!mergeFlag) {
@@ -2545,7 +2779,7 @@ static void doMerge(SQueryRuntimeEnv *pRuntimeEnv, int64_t timestamp, SWindowRes
 
     pCtx[i].hasNull = true;
     pCtx[i].nStartQueryTimestamp = timestamp;
-    pCtx[i].aInputElemBuf = getPosInResultPage(pRuntimeEnv, i, pWindowRes);
+    pCtx[i].aInputElemBuf = getPosInResultPage(pRuntimeEnv, i, pWindowRes, page);
     //    pCtx[i].aInputElemBuf = ((char *)inputSrc->data) +
     //                            ((int32_t)pRuntimeEnv->offset[i] * pRuntimeEnv->numOfRowsPerPage) +
     //                            pCtx[i].outputBytes * inputIdx;
@@ -2565,6 +2799,9 @@ static void doMerge(SQueryRuntimeEnv *pRuntimeEnv, int64_t timestamp, SWindowRes
 
     aAggs[functionId].distMergeFunc(&pCtx[i]);
   }
+
+  releaseResBufPage(pRuntimeEnv->pResultBuf, pWindowRes->pos.pageId);
+  return TSDB_CODE_SUCCESS;
 }
 
 static UNUSED_FUNC void printBinaryData(int32_t functionId, char *data, int32_t srcDataType) {
@@ -2690,8 +2927,7 @@ int32_t tableResultComparFn(const void *pLeft, const void *pRight, void *param)
   int32_t left = *(int32_t *)pLeft;
   int32_t right = *(int32_t *)pRight;
 
-  SCompSupporter *  supporter = (SCompSupporter *)param;
-  SQueryRuntimeEnv *pRuntimeEnv = &supporter->pQInfo->runtimeEnv;
+  SCompSupporter *supporter = (SCompSupporter *)param;
 
   int32_t leftPos = supporter->position[left];
   int32_t rightPos = supporter->position[right];
@@ -2706,17 +2942,14 @@ int32_t tableResultComparFn(const void *pLeft, const void *pRight, void *param)
     return -1;
   }
 
+  // the timestamp in the result page is the start key of the window, so the result pages are not loaded
   SWindowResInfo *pWindowResInfo1 = &supporter->pTableDataInfo[left]->pTableQInfo->windowResInfo;
   SWindowResult * pWindowRes1 = getWindowResult(pWindowResInfo1, leftPos);
-
-  char *b1 = getPosInResultPage(pRuntimeEnv, PRIMARYKEY_TIMESTAMP_COL_INDEX, pWindowRes1);
-  TSKEY leftTimestamp = GET_INT64_VAL(b1);
+  TSKEY           leftTimestamp = pWindowRes1->window.skey;
 
   SWindowResInfo *pWindowResInfo2 = &supporter->pTableDataInfo[right]->pTableQInfo->windowResInfo;
   SWindowResult * pWindowRes2 = getWindowResult(pWindowResInfo2, rightPos);
-
-  char *b2 = getPosInResultPage(pRuntimeEnv, PRIMARYKEY_TIMESTAMP_COL_INDEX, pWindowRes2);
-  TSKEY rightTimestamp = GET_INT64_VAL(b2);
+  TSKEY           rightTimestamp = pWindowRes2->window.skey;
 
   if (leftTimestamp == rightTimestamp) {
     return 0;
@@ -2764,11 +2997,10 @@ void copyResToQueryResultBuf(SQInfo *pQInfo, SQuery *pQuery) {
       return;  // failed to save data in the disk
     }
 
-    // set current query completed
-    //    if (pQInfo->numOfGroupResultPages == 0 && pQInfo->groupIndex == pQInfo->pSidSet->numOfSubSet) {
-    //      pQInfo->tableIndex = pQInfo->pSidSet->numOfTables;
-    //      return;
-    //    }
+    // all groups are merged and sent to client
+    if (pQInfo->numOfGroupResultPages == 0) {
+      return;
+    }
   }
 
   SQueryRuntimeEnv *   pRuntimeEnv = &pQInfo->runtimeEnv;
@@ -2780,7 +3012,14 @@ void copyResToQueryResultBuf(SQInfo *pQInfo, SQuery *pQuery) {
   int32_t total = 0;
   for (int32_t i = 0; i < list.size; ++i) {
     tFilePage *pData = getResultBufferPageById(pResultBuf, list.pData[i]);
+    if (pData == NULL) {
+      qError("QInfo:%p failed to load result page:%d, abort query", pQInfo, list.pData[i]);
+      pQInfo->code = TSDB_CODE_SERV_OUT_OF_MEMORY;
+      return;
+    }
+
     total += pData->numOfElems;
+    releaseResBufPage(pResultBuf, list.pData[i]);
   }
 
   int32_t rows = total;
@@ -2788,6 +3027,11 @@ void copyResToQueryResultBuf(SQInfo *pQInfo, SQuery *pQuery) {
   int32_t offset = 0;
   for (int32_t num = 0; num < list.size; ++num) {
     tFilePage *pData = getResultBufferPageById(pResultBuf, list.pData[num]);
+    if (pData == NULL) {
+      qError("QInfo:%p failed to load result page:%d, abort query", pQInfo, list.pData[num]);
+      pQInfo->code = TSDB_CODE_SERV_OUT_OF_MEMORY;
+      return;
+    }
 
     for (int32_t i = 0; i < pQuery->numOfOutput; ++i) {
       int32_t bytes = pRuntimeEnv->pCtx[i].outputBytes;
@@ -2798,6 +3042,7 @@ void copyResToQueryResultBuf(SQInfo *pQInfo, SQuery *pQuery) {
     }
 
     offset += pData->numOfElems;
+    releaseResBufPage(pResultBuf, list.pData[num]);
   }
 
   assert(pQuery->rec.rows == 0);
@@ -2836,8 +3081,8 @@ int32_t mergeIntoGroupResultImpl(SQInfo *pQInfo, SArray *pGroup) {
 
   size_t size = taosArrayGetSize(pGroup);
 
-  tFilePage **buffer = (tFilePage **)pQuery->sdata;
-  int32_t *   posList = calloc(size, sizeof(int32_t));
+  SData **buffer = pQuery->sdata;
+  int32_t *posList = calloc(size, sizeof(int32_t));
 
   STableDataInfo **pTableList = malloc(POINTER_BYTES * size);
 
@@ -2874,16 +3119,29 @@ int32_t mergeIntoGroupResultImpl(SQInfo *pQInfo, SArray *pGroup) {
   int64_t lastTimestamp = -1;
   int64_t startt = taosGetTimestampMs();
 
+  /*
+   * windows are merged in ascending order of time stamp, so for an ascending query only the first limit+offset windows
+   * of each group are required by the client, which applies the offset and limit to the merged results of all vnodes.
+   * A descending query requires the last ones, so all windows are kept.
+   */
+  int64_t numOfWindows = 0;
+  int64_t maxWindows = -1;
+  if (QUERY_IS_ASC_QUERY(pQuery) && pQuery->limit.limit > 0) {
+    maxWindows = pQuery->limit.limit + pQuery->limit.offset;
+  }
+
   while (1) {
     int32_t pos = pTree->pNode[0].index;
 
     SWindowResInfo *pWindowResInfo = &pTableList[pos]->pTableQInfo->windowResInfo;
     SWindowResult * pWindowRes = getWindowResult(pWindowResInfo, cs.position[pos]);
 
-    char *b = getPosInResultPage(pRuntimeEnv, PRIMARYKEY_TIMESTAMP_COL_INDEX, pWindowRes);
-    TSKEY ts = GET_INT64_VAL(b);
+    TSKEY ts = pWindowRes->window.skey;
+    if (maxWindows > 0 && numOfWindows >= maxWindows && ts != lastTimestamp) {
+      qTrace("QInfo:%p %" PRId64 " windows generated for group, remain windows are discarded", pQInfo, numOfWindows);
+      break;
+    }
 
-    assert(ts == pWindowRes->window.skey);
     int64_t num = getNumOfResultWindowRes(pRuntimeEnv, pWindowRes);
     if (num <= 0) {
       cs.position[pos] += 1;
@@ -2898,9 +3156,11 @@ int32_t mergeIntoGroupResultImpl(SQInfo *pQInfo, SArray *pGroup) {
       }
     } else {
       if (ts == lastTimestamp) {  // merge with the last one
-        doMerge(pRuntimeEnv, ts, pWindowRes, true);
+        if (doMerge(pRuntimeEnv, ts, pWindowRes, true) != TSDB_CODE_SUCCESS) {
+          return -1;
+        }
       } else {  // copy data to disk buffer
-        if (buffer[0]->numOfElems == pQuery->rec.capacity) {
+        if (buffer[0]->num == pQuery->rec.capacity) {
           if (flushFromResultBuf(pQInfo) != TSDB_CODE_SUCCESS) {
             return -1;
           }
@@ -2908,8 +3168,11 @@ int32_t mergeIntoGroupResultImpl(SQInfo *pQInfo, SArray *pGroup) {
           resetMergeResultBuf(pQuery, pRuntimeEnv->pCtx, pResultInfo);
         }
 
-        doMerge(pRuntimeEnv, ts, pWindowRes, false);
-        buffer[0]->numOfElems += 1;
+        if (doMerge(pRuntimeEnv, ts, pWindowRes, false) != TSDB_CODE_SUCCESS) {
+          return -1;
+        }
+        buffer[0]->num += 1;
+        numOfWindows += 1;
       }
 
       lastTimestamp = ts;
@@ -2928,7 +3191,7 @@ int32_t mergeIntoGroupResultImpl(SQInfo *pQInfo, SArray *pGroup) {
     tLoserTreeAdjust(pTree, pos + pTree->numOfEntries);
   }
 
-  if (buffer[0]->numOfElems != 0) {  // there are data in buffer
+  if (buffer[0]->num != 0) {  // there are data in buffer
     if (flushFromResultBuf(pQInfo) != TSDB_CODE_SUCCESS) {
       qError("QInfo:%p failed to flush data into temp file, abort query", pQInfo);
 
@@ -2982,6 +3245,9 @@ int32_t flushFromResultBuf(SQInfo *pQInfo) {
 
     int32_t    id = getGroupResultId(pQInfo->groupIndex) + pQInfo->numOfGroupResultPages;
     tFilePage *buf = getNewDataBuf(pResultBuf, id, &pageId);
+    if (buf == NULL) {
+      return TSDB_CODE_SERV_OUT_OF_MEMORY;
+    }
 
     // pagewise copy to dest buffer
     for (int32_t i = 0; i < pQuery->numOfOutput; ++i) {
@@ -2992,6 +3258,8 @@ int32_t flushFromResultBuf(SQInfo *pQInfo) {
              buf->numOfElems * bytes);
     }
 
+    releaseResBufPage(pResultBuf, pageId);
+
     offset += r;
     remain -= r;
   }
@@ -3187,15 +3455,21 @@ void skipResults(SQueryRuntimeEnv *pRuntimeEnv) {
     int32_t numOfSkip = (int32_t) pQuery->limit.offset;
     pQuery->rec.rows -= numOfSkip;
 
+    // the remain results are moved to the head of the buffer, the results of next table are appended after them
     for (int32_t i = 0; i < pQuery->numOfOutput; ++i) {
       int32_t functionId = pQuery->pSelectExpr[i].pBase.functionId;
       int32_t bytes = pRuntimeEnv->pCtx[i].outputBytes;
       
       memmove(pQuery->sdata[i]->data, pQuery->sdata[i]->data + bytes * numOfSkip, pQuery->rec.rows * bytes);
-      pRuntimeEnv->pCtx[i].aOutputBuf += bytes * numOfSkip;
+      pRuntimeEnv->pCtx[i].aOutputBuf = pQuery->sdata[i]->data + bytes * pQuery->rec.rows;
 
       if (functionId == TSDB_FUNC_DIFF || functionId == TSDB_FUNC_TOP || functionId == TSDB_FUNC_BOTTOM) {
-        pRuntimeEnv->pCtx[i].ptsOutputBuf += TSDB_KEYSIZE * numOfSkip;
+        pRuntimeEnv->pCtx[i].ptsOutputBuf -= TSDB_KEYSIZE * numOfSkip;
+      }
+
+      SResultInfo *pResInfo = GET_RES_INFO(&pRuntimeEnv->pCtx[i]);
+      if (pResInfo != NULL && pResInfo->numOfRes >= numOfSkip) {
+        pResInfo->numOfRes -= numOfSkip;
       }
     }
 
@@ -3227,7 +3501,9 @@ bool needScanDataBlocksAgain(SQueryRuntimeEnv *pRuntimeEnv) {
         continue;
       }
 
-      setWindowResOutputBuf(pRuntimeEnv, pResult);
+      if (setWindowResOutputBuf(pRuntimeEnv, pResult) != TSDB_CODE_SUCCESS) {
+        break;
+      }
 
       for (int32_t j = 0; j < pQuery->numOfOutput; ++j) {
         int16_t functId = pQuery->pSelectExpr[j].pBase.functionId;
@@ -3408,7 +3684,9 @@ void finalizeQueryResult(SQueryRuntimeEnv *pRuntimeEnv) {
         continue;
       }
 
-      setWindowResOutputBuf(pRuntimeEnv, buf);
+      if (setWindowResOutputBuf(pRuntimeEnv, buf) != TSDB_CODE_SUCCESS) {
+        return;
+      }
 
       for (int32_t j = 0; j < pQuery->numOfOutput; ++j) {
         aAggs[pQuery->pSelectExpr[j].pBase.functionId].xFinalize(&pRuntimeEnv->pCtx[j]);
@@ -3521,20 +3799,38 @@ void setExecutionContext(SQInfo *pQInfo, STableQueryInfo *pTableQueryInfo, STabl
     }
   }
 
-  setWindowResOutputBuf(pRuntimeEnv, pWindowRes);
+  if (setWindowResOutputBuf(pRuntimeEnv, pWindowRes) != TSDB_CODE_SUCCESS) {
+    return;
+  }
+
   initCtxOutputBuf(pRuntimeEnv);
 
   pTableQueryInfo->lastKey = nextKey;
   setAdditionalInfo(pQInfo, pTable, pTableQueryInfo);
 }
 
-static void setWindowResOutputBuf(SQueryRuntimeEnv *pRuntimeEnv, SWindowResult *pResult) {
+/*
+ * the output buffers of the functions point into the page of the window, so the page is kept pinned until the output
+ * buffers are set to another window
+ */
+static int32_t setWindowResOutputBuf(SQueryRuntimeEnv *pRuntimeEnv, SWindowResult *pResult) {
   SQuery *pQuery = pRuntimeEnv->pQuery;
 
+  tFilePage *page = getWindowResPage(pRuntimeEnv, pResult);
+  if (page == NULL) {
+    return -1;
+  }
+
+  if (pRuntimeEnv->outputPageId >= 0) {
+    releaseResBufPage(pRuntimeEnv->pResultBuf, pRuntimeEnv->outputPageId);
+  }
+
+  pRuntimeEnv->outputPageId = pResult->pos.pageId;
+
   // Note: pResult->pos[i]->numOfElems == 0, there is only fixed number of results for each group
   for (int32_t i = 0; i < pQuery->numOfOutput; ++i) {
     SQLFunctionCtx *pCtx = &pRuntimeEnv->pCtx[i];
-    pCtx->aOutputBuf = getPosInResultPage(pRuntimeEnv, i, pResult);
+    pCtx->aOutputBuf = getPosInResultPage(pRuntimeEnv, i, pResult, page);
 
     int32_t functionId = pQuery->pSelectExpr[i].pBase.functionId;
     if (functionId == TSDB_FUNC_TOP || functionId == TSDB_FUNC_BOTTOM || functionId == TSDB_FUNC_DIFF) {
@@ -3551,6 +3847,8 @@ static void setWindowResOutputBuf(SQueryRuntimeEnv *pRuntimeEnv, SWindowResult *
     SResultInfo *pResInfo = GET_RES_INFO(pCtx);
     pResInfo->superTableQ = pRuntimeEnv->stableQuery;
   }
+
+  return TSDB_CODE_SUCCESS;
 }
 
 int32_t setAdditionalInfo(SQInfo *pQInfo, STable *pTable, STableQueryInfo *pTableQueryInfo) {
@@ -3612,16 +3910,16 @@ void setIntervalQueryRange(STableQueryInfo *pTableQueryInfo, SQInfo *pQInfo, TSK
     STimeWindow     w = {0};
     SWindowResInfo *pWindowResInfo = &pTableQueryInfo->windowResInfo;
 
-    getAlignQueryTimeWindow(pQuery, win.skey, win.skey, win.ekey, &skey1, &ekey1, &w);
+    if (QUERY_IS_ASC_QUERY(pQuery)) {
+      getAlignQueryTimeWindow(pQuery, win.skey, win.skey, win.ekey, &skey1, &ekey1, &w);
+    } else {  // the first time window of a descending query covers the last key of the table, win.ekey < win.skey
+      getAlignQueryTimeWindow(pQuery, win.skey, win.ekey, win.skey, &skey1, &ekey1, &w);
+    }
+
     pWindowResInfo->startTime = pQuery->window.skey;  // windowSKey may be 0 in case of 1970 timestamp
 
     if (pWindowResInfo->prevSKey == 0) {
-      if (QUERY_IS_ASC_QUERY(pQuery)) {
-        pWindowResInfo->prevSKey = w.skey;
-      } else {
-        assert(win.ekey == pQuery->window.skey);
-        pWindowResInfo->prevSKey = w.skey;
-      }
+      pWindowResInfo->prevSKey = w.skey;
     }
 
     pTableQueryInfo->queryRangeSet = 1;
@@ -3714,14 +4012,21 @@ static int32_t doCopyToSData(SQInfo *pQInfo, SWindowResult *result, int32_t orde
       pQInfo->groupIndex += 1;
     }
 
+    tFilePage *page = getWindowResPage(pRuntimeEnv, &result[i]);
+    if (page == NULL) {
+      break;
+    }
+
     for (int32_t j = 0; j < pQuery->numOfOutput; ++j) {
       int32_t size = pRuntimeEnv->pCtx[j].outputBytes;
 
       char *out = pQuery->sdata[j]->data + numOfResult * size;
-      char *in = getPosInResultPage(pRuntimeEnv, j, &result[i]);
+      char *in = getPosInResultPage(pRuntimeEnv, j, &result[i], page);
       memcpy(out, in + oldOffset * size, size * numOfRowsToCopy);
     }
 
+    releaseResBufPage(pRuntimeEnv->pResultBuf, result[i].pos.pageId);
+
     numOfResult += numOfRowsToCopy;
     if (numOfResult == pQuery->rec.capacity) {
       break;
@@ -3876,6 +4181,13 @@ static void doCopyQueryResultToMsg(SQInfo *pQInfo, int32_t numOfRows, char *data
 
   // all data returned, set query over
   if (Q_STATUS_EQUAL(pQuery->status, QUERY_COMPLETED)) {
+    // merged interval results of super table are sent to client page by page
+    if (pQInfo->runtimeEnv.stableQuery && isIntervalQuery(pQuery) &&
+        (pQInfo->offset < pQInfo->numOfGroupResultPages ||
+         pQInfo->groupIndex < taosArrayGetSize(pQInfo->groupInfo.pGroupList))) {
+      return;
+    }
+
     setQueryStatus(pQuery, QUERY_OVER);
   }
 }
@@ -4162,12 +4474,18 @@ int32_t doInitQInfo(SQInfo *pQInfo, void *param, void *tsdb, bool isSTableQuery)
       .numOfCols = pQuery->numOfCols,
   };
 
-  pRuntimeEnv->pQueryHandle = tsdbQueryTables(tsdb, &cond, &pQInfo->groupInfo);
+  if (isLastRowCacheQuery(pQuery, param)) {
+    pRuntimeEnv->pQueryHandle = tsdbQueryLastRow(tsdb, &cond, &pQInfo->groupInfo);
+  } else {
+    pRuntimeEnv->pQueryHandle = tsdbQueryTables(tsdb, &cond, &pQInfo->groupInfo);
+  }
+
   pQInfo->tsdb = tsdb;
 
   pRuntimeEnv->pQuery = pQuery;
   pRuntimeEnv->pTSBuf = param;
   pRuntimeEnv->cur.vnodeIndex = -1;
+  pRuntimeEnv->outputPageId = -1;
   pRuntimeEnv->stableQuery = isSTableQuery;
 
   if (param != NULL) {
@@ -4185,7 +4503,7 @@ int32_t doInitQInfo(SQInfo *pQInfo, void *param, void *tsdb, bool isSTableQuery)
 
   if (isSTableQuery) {
     int32_t rows = getInitialPageNum(pQInfo);
-    code = createDiskbasedResultBuffer(&pRuntimeEnv->pResultBuf, rows, pQuery->rowSize);
+    code = createDiskbasedResultBuffer(&pRuntimeEnv->pResultBuf, rows, pQuery->rowSize, tsQueryBufferSize * 1048576L);
     if (code != TSDB_CODE_SUCCESS) {
       return code;
     }
@@ -4204,7 +4522,7 @@ int32_t doInitQInfo(SQInfo *pQInfo, void *param, void *tsdb, bool isSTableQuery)
 
   } else if (isGroupbyNormalCol(pQuery->pGroupbyExpr) || isIntervalQuery(pQuery)) {
     int32_t rows = getInitialPageNum(pQInfo);
-    code = createDiskbasedResultBuffer(&pRuntimeEnv->pResultBuf, rows, pQuery->rowSize);
+    code = createDiskbasedResultBuffer(&pRuntimeEnv->pResultBuf, rows, pQuery->rowSize, tsQueryBufferSize * 1048576L);
     if (code != TSDB_CODE_SUCCESS) {
       return code;
     }
@@ -4335,7 +4653,8 @@ static int64_t queryOnDataBlocks(SQInfo *pQInfo) {
     SDataStatis *pStatis = NULL;
     SArray *     pDataBlock = loadDataBlockOnDemand(pRuntimeEnv, &blockInfo, &pStatis);
 
-    TSKEY nextKey = blockInfo.window.skey;
+    // the first key of the block in the scan order
+    TSKEY nextKey = QUERY_IS_ASC_QUERY(pQuery) ? blockInfo.window.skey : blockInfo.window.ekey;
     if (!isIntervalQuery(pQuery)) {
       setExecutionContext(pQInfo, pTableQueryInfo, pTable, pTableDataInfo->groupIdx, nextKey);
     } else {  // interval query
@@ -4447,6 +4766,44 @@ static UNUSED_FUNC int64_t doCheckMetersInGroup(SQInfo *pQInfo, int32_t index, i
   return numOfRes;
 }
 
+/*
+ * the last row of each group is retrieved from the last row cache of tsdb as a data block with only one row, and the
+ * results of groups are kept in the output buffer one after another.
+ */
+static void lastRowCacheProcess(SQInfo *pQInfo) {
+  SQueryRuntimeEnv *pRuntimeEnv = &pQInfo->runtimeEnv;
+  SQuery *          pQuery = pRuntimeEnv->pQuery;
+
+  TsdbQueryHandleT pQueryHandle = pRuntimeEnv->pQueryHandle;
+  while (pQuery->rec.rows < pQuery->rec.capacity && tsdbNextDataBlock(pQueryHandle)) {
+    if (isQueryKilled(pQInfo)) {
+      return;
+    }
+
+    SDataBlockInfo blockInfo = tsdbRetrieveDataBlockInfo(pQueryHandle);
+    STableId       tableId = {.uid = blockInfo.uid, .tid = blockInfo.sid};
+
+    setTagVal(pRuntimeEnv, tableId, pQInfo->tsdb);
+    initCtxOutputBuf(pRuntimeEnv);
+
+    SArray *pDataBlock = tsdbRetrieveDataBlock(pQueryHandle, NULL);
+
+    pQuery->pos = 0;
+    blockwiseApplyFunctions(pRuntimeEnv, NULL, &blockInfo, &pRuntimeEnv->windowResInfo, binarySearchForKey,
+                            pDataBlock);
+
+    pQuery->rec.rows += 1;
+    forwardCtxOutputBuf(pRuntimeEnv, 1);
+  }
+
+  // the remain groups are retrieved in the next round
+  if (pQuery->rec.rows >= pQuery->rec.capacity) {
+    setQueryStatus(pQuery, QUERY_RESBUF_FULL);
+  }
+
+  qTrace("QInfo:%p last row query from cache, %d rows returned", pQInfo, pQuery->rec.rows);
+}
+
 /**
  * super table query handler
  * 1. super table projection query, group-by on normal columns query, ts-comp query
@@ -4465,6 +4822,10 @@ static void sequentialTableProcess(SQInfo *pQInfo) {
     resetCtxOutputBuf(pRuntimeEnv);
     assert(pQuery->limit.offset == 0 && pQuery->limit.limit != 0);
 
+    if (isLastRowCacheQuery(pQuery, pRuntimeEnv->pTSBuf)) {
+      lastRowCacheProcess(pQInfo);
+    }
+
 #if 0
     while (pQInfo->groupIndex < numOfGroups) {
 
@@ -4565,6 +4926,7 @@ static void sequentialTableProcess(SQInfo *pQInfo) {
 
       if (!multiTableMultioutputHelper(pQInfo, pQInfo->tableIndex)) {
         pQInfo->tableIndex++;
+        pRuntimeEnv->numOfTableRes = 0;
         continue;
       }
 
@@ -4585,8 +4947,14 @@ static void sequentialTableProcess(SQInfo *pQInfo) {
       pQuery->rec.rows = getNumOfResult(pRuntimeEnv);
       skipResults(pRuntimeEnv);
 
-      // the limitation of output result is reached, set the query completed
-      if (limitResults(pQInfo)) {
+      /*
+       * the limitation of output result is reached, set the query completed.
+       * With the limit pushed down, each table stops at limit+offset rows and the global limit is applied by the
+       * client. Group by tbname queries do not come here, each table is a group merged by mergeIntoGroupResultImpl,
+       * which stops at limit+offset windows per group. The top-N across groups is not pruned in vnode, since it is
+       * ordered by the merged aggregate values that are only known at the client.
+       */
+      if (!pRuntimeEnv->tableLimit && limitResults(pQInfo)) {
         pQInfo->tableIndex = pQInfo->groupInfo.numOfTables;
         break;
       }
@@ -4603,25 +4971,29 @@ static void sequentialTableProcess(SQInfo *pQInfo) {
          */
         pQInfo->tableIndex++;
         pInfo->pTableQInfo->lastKey = pQuery->lastKey;
+        pRuntimeEnv->numOfTableRes = 0;
 
         // if the buffer is full or group by each table, we need to jump out of the loop
         if (Q_STATUS_EQUAL(pQuery->status, QUERY_RESBUF_FULL) /*||
             isGroupbyEachTable(pQuery->pGroupbyExpr, pSupporter->pSidSet)*/) {
+          // only current table is completed, the remain tables are queried in the next round
+          if (pQInfo->tableIndex < pQInfo->groupInfo.numOfTables) {
+            pQuery->status = QUERY_RESBUF_FULL;
+          }
           break;
         }
 
       } else {  // forward query range
         pQuery->window.skey = pQuery->lastKey;
+        pInfo->pTableQInfo->lastKey = pQuery->lastKey;
 
         // all data in the result buffer are skipped due to the offset, continue to retrieve data from current meter
         if (pQuery->rec.rows == 0) {
           assert(!Q_STATUS_EQUAL(pQuery->status, QUERY_RESBUF_FULL));
           continue;
         } else {
-          //          pQInfo->pTableQuerySupporter->pMeterSidExtInfo[k]->key = pQuery->lastKey;
-          //          // buffer is full, wait for the next round to retrieve data from current meter
-          //          assert(Q_STATUS_EQUAL(pQuery->over, QUERY_RESBUF_FULL));
-          //          break;
+          // buffer is full, wait for the next round to retrieve data from current meter
+          break;
         }
       }
     }
@@ -4788,8 +5160,6 @@ static void multiTableQueryProcess(SQInfo *pQInfo) {
       copyFromWindowResToSData(pQInfo, pRuntimeEnv->windowResInfo.pResult);
     }
 
-    pQuery->rec.rows += pQuery->rec.rows;
-
     if (pQuery->rec.rows == 0) {
       //      vnodePrintQueryStatistics(pSupporter);
     }
@@ -5119,8 +5489,11 @@ static void stableQueryImpl(SQInfo *pQInfo) {
 
   int64_t st = taosGetTimestampUs();
 
-  if (isIntervalQuery(pQuery) ||
-      (isFixedOutputQuery(pQuery) && (!isPointInterpoQuery(pQuery)) && !isGroupbyNormalCol(pQuery->pGroupbyExpr))) {
+  // the last_row query that can not be served by the last row cache scans the data blocks of all tables
+  bool scanLastRow = isFirstLastRowQuery(pQuery) && !isLastRowCacheQuery(pQuery, pQInfo->runtimeEnv.pTSBuf);
+
+  if (isIntervalQuery(pQuery) || (isFixedOutputQuery(pQuery) && (!isPointInterpoQuery(pQuery) || scanLastRow) &&
+                                  !isGroupbyNormalCol(pQuery->pGroupbyExpr))) {
     multiTableQueryProcess(pQInfo);
   } else {
     assert((pQuery->checkBuffer == 1 && pQuery->intervalTime == 0) || isPointInterpoQuery(pQuery) ||
@@ -5822,6 +6195,8 @@ static int32_t initQInfo(SQueryTableMsg *pQueryMsg, void *tsdb, SQInfo *pQInfo,
     goto _error;
   }
 
+  pQInfo->runtimeEnv.tableLimit = isSTable && ((pQueryMsg->queryType & TSDB_QUERY_TYPE_TABLE_LIMIT) != 0);
+
   // qTrace("QInfo:%p set query flag and prepare runtime environment completed, ref:%d, wait for schedule", pQInfo,
   //       pQInfo->refCount);
   return code;
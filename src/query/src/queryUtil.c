@@ -217,16 +217,25 @@ void clearTimeWindowResBuf(SQueryRuntimeEnv *pRuntimeEnv, SWindowResult *pWindow
     return;
   }
   
+  // the query is aborted if the page can not be loaded, and only the result info is reset
+  tFilePage *page = getWindowResPage(pRuntimeEnv, pWindowRes);
+
   for (int32_t i = 0; i < pRuntimeEnv->pQuery->numOfOutput; ++i) {
     SResultInfo *pResultInfo = &pWindowRes->resultInfo[i];
     
-    char * s = getPosInResultPage(pRuntimeEnv, i, pWindowRes);
-    size_t size = pRuntimeEnv->pQuery->pSelectExpr[i].bytes;
-    memset(s, 0, size);
+    if (page != NULL) {
+      char * s = getPosInResultPage(pRuntimeEnv, i, pWindowRes, page);
+      size_t size = pRuntimeEnv->pQuery->pSelectExpr[i].bytes;
+      memset(s, 0, size);
+    }
     
     resetResultInfo(pResultInfo);
   }
   
+  if (page != NULL) {
+    releaseResBufPage(pRuntimeEnv->pResultBuf, pWindowRes->pos.pageId);
+  }
+  
   pWindowRes->numOfRows = 0;
   //  pWindowRes->nAlloc = 0;
   pWindowRes->pos = (SPosInfo){-1, -1};
@@ -247,6 +256,16 @@ void copyTimeWindowResBuf(SQueryRuntimeEnv *pRuntimeEnv, SWindowResult *dst, con
   
   int32_t nOutputCols = pRuntimeEnv->pQuery->numOfOutput;
   
+  // both pages are pinned while copying, the query is aborted if any of them can not be loaded
+  tFilePage *dstPage = getWindowResPage(pRuntimeEnv, dst);
+  tFilePage *srcPage = (dstPage == NULL) ? NULL : getWindowResPage(pRuntimeEnv, (SWindowResult *)src);
+  if (srcPage == NULL) {
+    if (dstPage != NULL) {
+      releaseResBufPage(pRuntimeEnv->pResultBuf, dst->pos.pageId);
+    }
+    return;
+  }
+  
   for (int32_t i = 0; i < nOutputCols; ++i) {
     SResultInfo *pDst = &dst->resultInfo[i];
     SResultInfo *pSrc = &src->resultInfo[i];
@@ -259,11 +278,124 @@ void copyTimeWindowResBuf(SQueryRuntimeEnv *pRuntimeEnv, SWindowResult *dst, con
     memcpy(pDst->interResultBuf, pSrc->interResultBuf, pDst->bufLen);
     
     // copy the output buffer data from src to dst, the position info keep unchanged
-    char * dstBuf = getPosInResultPage(pRuntimeEnv, i, dst);
-    char * srcBuf = getPosInResultPage(pRuntimeEnv, i, (SWindowResult *)src);
+    char * dstBuf = getPosInResultPage(pRuntimeEnv, i, dst, dstPage);
+    char * srcBuf = getPosInResultPage(pRuntimeEnv, i, (SWindowResult *)src, srcPage);
     size_t s = pRuntimeEnv->pQuery->pSelectExpr[i].bytes;
     
     memcpy(dstBuf, srcBuf, s);
   }
+  
+  releaseResBufPage(pRuntimeEnv->pResultBuf, dst->pos.pageId);
+  releaseResBufPage(pRuntimeEnv->pResultBuf, src->pos.pageId);
 }
 
+/*
+ * split the ascending rows from pos into tumbling windows arithmetically, the first window is given by the caller
+ * since it may be continued from the previous block. The empty windows are skipped and the rows after the query
+ * end key are ignored. The number of windows is returned, which is no more than the number of rows.
+ */
+int32_t splitIntoTumblingWindows(TSKEY *primaryKeyCol, int32_t pos, int32_t numOfRows, STimeWindow *pFirstWin,
+                                 int64_t intervalTime, TSKEY ekey, SWindowRowRange *pRange) {
+  int32_t numOfWins = 0;
+  TSKEY   wskey = pFirstWin->skey;
+  TSKEY   wekey = MIN(pFirstWin->ekey, ekey);
+
+  for (int32_t i = pos; i < numOfRows && primaryKeyCol[i] <= ekey;) {
+    if (primaryKeyCol[i] > wekey) {  // skip the empty windows
+      wskey += ((primaryKeyCol[i] - wskey) / intervalTime) * intervalTime;
+      wekey = MIN(wskey + intervalTime - 1, ekey);
+    }
+
+    int32_t start = i;
+    while (i < numOfRows && primaryKeyCol[i] <= wekey) {
+      i++;
+    }
+
+    pRange[numOfWins++] = (SWindowRowRange){.skey = wskey, .start = start, .rows = i - start};
+  }
+
+  return numOfWins;
+}
+
+#define COMPUTE_WINDOW_STATIS(_type, _sumType, _data, _hasNull, _pRange, _numOfWins, _pStatis)       \
+  do {                                                                                               \
+    _type *__d = (_type *)(_data);                                                                   \
+    for (int32_t w = 0; w < (_numOfWins); ++w) {                                                     \
+      SDataStatis *__s = &(_pStatis)[w];                                                             \
+      int32_t      __start = (_pRange)[w].start;                                                     \
+      _sumType     __sum = 0;                                                                        \
+      _type        __min = 0, __max = 0;                                                             \
+      int16_t      __minIndex = -1, __maxIndex = -1, __numOfNull = 0;                                \
+      for (int32_t j = 0; j < (_pRange)[w].rows; ++j) {                                              \
+        _type __v = __d[__start + j];                                                                \
+        if ((_hasNull) && isNull((char *)&__d[__start + j], type)) {                                 \
+          __numOfNull += 1;                                                                          \
+          continue;                                                                                  \
+        }                                                                                            \
+        __sum += __v;                                                                                \
+        if (__minIndex < 0 || __v < __min) {                                                         \
+          __min = __v;                                                                               \
+          __minIndex = j;                                                                            \
+        }                                                                                            \
+        if (__maxIndex < 0 || __v > __max) {                                                         \
+          __max = __v;                                                                               \
+          __maxIndex = j;                                                                            \
+        }                                                                                            \
+      }                                                                                              \
+      __s->numOfNull = __numOfNull;                                                                  \
+      __s->minIndex = MAX(__minIndex, 0);                                                            \
+      __s->maxIndex = MAX(__maxIndex, 0);                                                            \
+      if (type == TSDB_DATA_TYPE_FLOAT || type == TSDB_DATA_TYPE_DOUBLE) {                           \
+        *(double *)&__s->sum = (double)__sum;                                                        \
+        *(double *)&__s->min = (double)__min;                                                        \
+        *(double *)&__s->max = (double)__max;                                                        \
+      } else {                                                                                       \
+        __s->sum = (int64_t)__sum;                                                                   \
+        __s->min = (int64_t)__min;                                                                   \
+        __s->max = (int64_t)__max;                                                                   \
+      }                                                                                              \
+    }                                                                                                \
+  } while (0)
+
+/*
+ * one pass over the column of the data block, and the statistics of all windows are kept in a contiguous array.
+ * only the number of null values is required for the non-numeric column, which is used by count function.
+ */
+void computeWindowStatis(SQLFunctionCtx *pCtx, SWindowRowRange *pRange, int32_t numOfWins,
+                                SDataStatis *pStatis) {
+  int16_t type = pCtx->inputType;
+  char *  data = pCtx->aInputElemBuf;
+
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:
+      COMPUTE_WINDOW_STATIS(int8_t, int64_t, data, pCtx->hasNull, pRange, numOfWins, pStatis);
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      COMPUTE_WINDOW_STATIS(int16_t, int64_t, data, pCtx->hasNull, pRange, numOfWins, pStatis);
+      break;
+    case TSDB_DATA_TYPE_INT:
+      COMPUTE_WINDOW_STATIS(int32_t, int64_t, data, pCtx->hasNull, pRange, numOfWins, pStatis);
+      break;
+    case TSDB_DATA_TYPE_BIGINT:
+      COMPUTE_WINDOW_STATIS(int64_t, int64_t, data, pCtx->hasNull, pRange, numOfWins, pStatis);
+      break;
+    case TSDB_DATA_TYPE_FLOAT:
+      COMPUTE_WINDOW_STATIS(float, double, data, pCtx->hasNull, pRange, numOfWins, pStatis);
+      break;
+    case TSDB_DATA_TYPE_DOUBLE:
+      COMPUTE_WINDOW_STATIS(double, double, data, pCtx->hasNull, pRange, numOfWins, pStatis);
+      break;
+    default:
+      for (int32_t w = 0; w < numOfWins; ++w) {
+        memset(&pStatis[w], 0, sizeof(SDataStatis));
+
+        if (pCtx->hasNull) {
+          for (int32_t j = 0; j < pRange[w].rows; ++j) {
+            if (isNull(data + (pRange[w].start + j) * pCtx->inputBytes, type)) {
+              pStatis[w].numOfNull += 1;
+            }
+          }
+        }
+      }
+  }
+}
@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+#include "taos.h"
+#include "qextbuffer.h"
+#include "tsdb.h"
+#include "ttime.h"
+
+namespace {
+const int32_t numOfCols = 5;  // ts, int, double, binary, row id
+
+SColumnModel* createSortModel(int32_t capacity) {
+  SSchema s[numOfCols] = {{0}};
+  s[0].type = TSDB_DATA_TYPE_TIMESTAMP;
+  s[0].bytes = sizeof(int64_t);
+  s[1].type = TSDB_DATA_TYPE_INT;
+  s[1].bytes = sizeof(int32_t);
+  s[2].type = TSDB_DATA_TYPE_DOUBLE;
+  s[2].bytes = sizeof(double);
+  s[3].type = TSDB_DATA_TYPE_BINARY;
+  s[3].bytes = 16;
+  s[4].type = TSDB_DATA_TYPE_INT;
+  s[4].bytes = sizeof(int32_t);
+
+  return createColumnModel(s, numOfCols, capacity);
+}
+
+char* colData(SColumnModel* pModel, char* data, int32_t capacity, int32_t col) {
+  return data + pModel->pFields[col].offset * capacity;
+}
+
+// each column has at most distinct values, so the rows with the same value are ordered by the next order column
+void fillRandomData(SColumnModel* pModel, char* data, int32_t numOfRows, int32_t distinct) {
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    ((int64_t*)colData(pModel, data, numOfRows, 0))[i] = 1500000000000L + (rand() % distinct) * 10;
+    ((int32_t*)colData(pModel, data, numOfRows, 1))[i] = rand() % distinct - distinct / 2;
+    ((double*)colData(pModel, data, numOfRows, 2))[i] = (rand() % distinct - distinct / 2) / 1000.0;
+    snprintf(colData(pModel, data, numOfRows, 3) + i * 16, 16, "k%d", rand() % distinct);
+    ((int32_t*)colData(pModel, data, numOfRows, 4))[i] = i;
+  }
+}
+
+// sort by the given columns, check the order with the comparator and check every row is moved as a whole
+void sortAndCheck(int32_t* cols, int32_t numOfOrderCols, int32_t order, int32_t numOfRows, int32_t distinct,
+                  bool print) {
+  SColumnModel* pModel = createSortModel(numOfRows);
+  char*         data = (char*)calloc(numOfRows, pModel->rowSize);
+  char*         origin = (char*)malloc(numOfRows * pModel->rowSize);
+
+  fillRandomData(pModel, data, numOfRows, distinct);
+  memcpy(origin, data, numOfRows * pModel->rowSize);
+
+  tOrderDescriptor* pDesc = tOrderDesCreate(cols, numOfOrderCols, pModel, order);
+
+  int64_t st = taosGetTimestampUs();
+  tColDataQSort(pDesc, numOfRows, 0, numOfRows - 1, data, order);
+  int64_t et = taosGetTimestampUs();
+
+  if (print) {
+    printf("Elapsed time:%" PRId64 " us to sort %d rows on %d column(s), first type:%d, order:%d\n", et - st,
+           numOfRows, numOfOrderCols, pModel->pFields[cols[0]].field.type, order);
+  }
+
+  __col_compar_fn_t compareFn = (order == TSDB_ORDER_ASC) ? compare_sa : compare_sd;
+  for (int32_t i = 1; i < numOfRows; ++i) {
+    ASSERT_LE(compareFn(pDesc, numOfRows, i - 1, i, data), 0);
+  }
+
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    int32_t id = ((int32_t*)colData(pModel, data, numOfRows, 4))[i];
+    ASSERT_TRUE(id >= 0 && id < numOfRows);
+
+    for (int32_t j = 0; j < numOfCols - 1; ++j) {
+      int32_t bytes = pModel->pFields[j].field.bytes;
+      ASSERT_EQ(memcmp(colData(pModel, data, numOfRows, j) + i * bytes,
+                       colData(pModel, origin, numOfRows, j) + id * bytes, bytes), 0);
+    }
+  }
+
+  tOrderDescDestroy(pDesc);  // column model is destroyed as well
+  free(origin);
+  free(data);
+}
+}  // namespace
+
+TEST(testCase, colDataSortTest) {
+  int32_t rows[] = {2, 7, 9, 100, 5000};
+  for (int32_t i = 0; i < sizeof(rows) / sizeof(rows[0]); ++i) {
+    for (int32_t col = 0; col < numOfCols - 1; ++col) {
+      sortAndCheck(&col, 1, TSDB_ORDER_ASC, rows[i], 100000, false);
+      sortAndCheck(&col, 1, TSDB_ORDER_DESC, rows[i], 100000, false);
+    }
+  }
+}
+
+TEST(testCase, colDataMultiColSortTest) {
+  // the keys of the first two are no longer than 8 bytes, the others are longer
+  int32_t cols[][3] = {{1, 4, 0}, {3, 0, 0}, {2, 1, 4}, {0, 3, 1}};
+  int32_t numOfOrderCols[] = {2, 2, 3, 3};
+
+  int32_t rows[] = {9, 100, 5000};
+  for (int32_t i = 0; i < sizeof(rows) / sizeof(rows[0]); ++i) {
+    for (int32_t j = 0; j < sizeof(numOfOrderCols) / sizeof(numOfOrderCols[0]); ++j) {
+      sortAndCheck(cols[j], numOfOrderCols[j], TSDB_ORDER_ASC, rows[i], 5, false);
+      sortAndCheck(cols[j], numOfOrderCols[j], TSDB_ORDER_DESC, rows[i], 5, false);
+    }
+  }
+}
+
+TEST(testCase, colDataSortSpecialFloatTest) {
+  // -0.0 equals to 0.0 and NaN is larger than any value, the rows with equal values are ordered by the row id
+  const int32_t numOfRows = 100;
+  const double  values[] = {0.0, -0.0, NAN, -NAN, 1.0, -1.0, INFINITY, -INFINITY};
+  const int32_t numOfValues = sizeof(values) / sizeof(values[0]);
+
+  SSchema s[3] = {{0}};
+  s[0].type = TSDB_DATA_TYPE_FLOAT;
+  s[0].bytes = sizeof(float);
+  s[1].type = TSDB_DATA_TYPE_DOUBLE;
+  s[1].bytes = sizeof(double);
+  s[2].type = TSDB_DATA_TYPE_INT;
+  s[2].bytes = sizeof(int32_t);
+
+  for (int32_t col = 0; col < 2; ++col) {
+    for (int32_t order = TSDB_ORDER_ASC; order <= TSDB_ORDER_DESC; ++order) {
+      SColumnModel* pModel = createColumnModel(s, 3, numOfRows);
+      char*         data = (char*)calloc(numOfRows, pModel->rowSize);
+
+      for (int32_t i = 0; i < numOfRows; ++i) {
+        ((float*)colData(pModel, data, numOfRows, 0))[i] = (float)values[i % numOfValues];
+        ((double*)colData(pModel, data, numOfRows, 1))[i] = values[i % numOfValues];
+        ((int32_t*)colData(pModel, data, numOfRows, 2))[i] = i;
+      }
+
+      int32_t           orderIdx[] = {col, 2};
+      tOrderDescriptor* pDesc = tOrderDesCreate(orderIdx, 2, pModel, order);
+      tColDataQSort(pDesc, numOfRows, 0, numOfRows - 1, data, order);
+
+      for (int32_t i = 1; i < numOfRows; ++i) {
+        double prev = (col == 0) ? ((float*)colData(pModel, data, numOfRows, 0))[i - 1]
+                                 : ((double*)colData(pModel, data, numOfRows, 1))[i - 1];
+        double cur = (col == 0) ? ((float*)colData(pModel, data, numOfRows, 0))[i]
+                                : ((double*)colData(pModel, data, numOfRows, 1))[i];
+        int32_t prevId = ((int32_t*)colData(pModel, data, numOfRows, 2))[i - 1];
+        int32_t curId = ((int32_t*)colData(pModel, data, numOfRows, 2))[i];
+
+        if (order == TSDB_ORDER_DESC) {
+          std::swap(prev, cur);
+          std::swap(prevId, curId);
+        }
+
+        if (std::isnan(prev) || std::isnan(cur)) {
+          ASSERT_TRUE(std::isnan(cur));
+          ASSERT_TRUE(!std::isnan(prev) || prevId < curId);
+        } else if (prev == cur) {
+          ASSERT_LT(prevId, curId);
+        } else {
+          ASSERT_LT(prev, cur);
+        }
+      }
+
+      tOrderDescDestroy(pDesc);
+      free(data);
+    }
+  }
+}
+
+// a benchmark of sorting large blocks, run it with --gtest_also_run_disabled_tests
+TEST(testCase, DISABLED_colDataSortPerfTest) {
+  for (int32_t col = 0; col < numOfCols - 1; ++col) {
+    sortAndCheck(&col, 1, TSDB_ORDER_ASC, 500000, 100000, true);
+  }
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <cassert>
+#include <iostream>
+
+#include "taos.h"
+#include "qextbuffer.h"
+#include "tsdb.h"
+
+namespace {
+// write rows of (ts, val) into the external buffer, flush them to disk and load them back page by page
+void flushAndLoadTest(bool compressed) {
+  SSchema s[2] = {{0}};
+  s[0].type = TSDB_DATA_TYPE_TIMESTAMP;
+  s[0].bytes = sizeof(int64_t);
+  s[1].type = TSDB_DATA_TYPE_INT;
+  s[1].bytes = sizeof(int32_t);
+
+  const int32_t rowSize = sizeof(int64_t) + sizeof(int32_t);
+  const int32_t numOfRows = 10000;
+
+  SColumnModel*  pModel = createColumnModel(s, 2, numOfRows);
+  tExtMemBuffer* pMemBuffer = createExtMemBuffer(64 * DEFAULT_PAGE_SIZE, rowSize, pModel);
+  pMemBuffer->flushModel = MULTIPLE_APPEND_MODEL;
+  pMemBuffer->compressed = compressed;
+
+  char* data = (char*)calloc(numOfRows, rowSize);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    ((int64_t*)data)[i] = 1500000000000L + i * 10;
+    ((int32_t*)(data + sizeof(int64_t) * numOfRows))[i] = i;
+  }
+
+  // two flushes, each one of them is a separated flush out group
+  ASSERT_GT(tExtMemBufferPut(pMemBuffer, data, numOfRows), 0);
+  ASSERT_TRUE(tExtMemBufferFlush(pMemBuffer));
+  ASSERT_GT(tExtMemBufferPut(pMemBuffer, data, numOfRows), 0);
+  ASSERT_TRUE(tExtMemBufferFlush(pMemBuffer));
+
+  ASSERT_EQ(pMemBuffer->fileMeta.flushoutData.nLength, 2);
+  ASSERT_EQ(pMemBuffer->fileMeta.numOfElemsInFile, numOfRows * 2);
+
+  if (compressed) {
+    ASSERT_LT(pMemBuffer->fileMeta.pPageOffset[pMemBuffer->fileMeta.nFileSize],
+              (int64_t)pMemBuffer->fileMeta.nFileSize * pMemBuffer->pageSize);
+  }
+
+  tFilePage* pPage = (tFilePage*)malloc(pMemBuffer->pageSize);
+  int32_t    capacity = pMemBuffer->numOfElemsPerPage;
+
+  for (int32_t f = 0; f < 2; ++f) {
+    tFlushoutInfo* pInfo = &pMemBuffer->fileMeta.flushoutData.pFlushoutInfo[f];
+
+    int32_t index = 0;
+    for (int32_t i = 0; i < pInfo->numOfPages; ++i) {
+      ASSERT_TRUE(tExtMemBufferLoadData(pMemBuffer, pPage, f, i));
+
+      for (int32_t j = 0; j < pPage->numOfElems; ++j, ++index) {
+        ASSERT_EQ(((int64_t*)pPage->data)[j], 1500000000000L + index * 10);
+        ASSERT_EQ(((int32_t*)(pPage->data + sizeof(int64_t) * capacity))[j], index);
+      }
+    }
+
+    ASSERT_EQ(index, numOfRows);
+    ASSERT_FALSE(tExtMemBufferLoadData(pMemBuffer, pPage, f, pInfo->numOfPages));
+  }
+
+  ASSERT_FALSE(tExtMemBufferLoadData(pMemBuffer, pPage, 2, 0));
+
+  free(pPage);
+  free(data);
+  destoryExtMemBuffer(pMemBuffer);
+  destroyColumnModel(pModel);
+}
+}  // namespace
+
+TEST(testCase, extBufferTest) {
+  flushAndLoadTest(false);
+  flushAndLoadTest(true);
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <cassert>
+#include <iostream>
+
+#include "taos.h"
+#include "tsdb.h"
+
+extern "C" {
+#include "queryExecutor.h"
+#include "queryUtil.h"
+}
+
+namespace {
+const int64_t interval = 1000;
+const TSKEY   skey = 1500000000000L;
+
+// rows at random gaps, so some windows are empty and some have many rows
+void fillTimestamp(TSKEY* ts, int32_t numOfRows) {
+  ts[0] = skey + rand() % interval;
+  for (int32_t i = 1; i < numOfRows; ++i) {
+    ts[i] = ts[i - 1] + 1 + ((rand() % 10 == 0) ? rand() % (interval * 3) : rand() % (interval / 10));
+  }
+}
+
+void fillValue(char* data, int32_t type, int32_t numOfRows, int32_t nullRatio) {
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    if (nullRatio > 0 && rand() % nullRatio == 0) {
+      setNull(data + i * tDataTypeDesc[type].nSize, type, tDataTypeDesc[type].nSize);
+    } else if (type == TSDB_DATA_TYPE_INT) {
+      ((int32_t*)data)[i] = rand() % 20001 - 10000;
+    } else {
+      ((double*)data)[i] = (rand() % 20001 - 10000) / 100.0;
+    }
+  }
+}
+
+struct SFuncCtx {
+  SQLFunctionCtx ctx;
+  SResultInfo    resInfo;
+  char           output[16];
+};
+
+void initFuncCtx(SFuncCtx* p, int32_t functionId, int32_t type, char* data, TSKEY* ts, bool hasNull) {
+  memset(p, 0, sizeof(SFuncCtx));
+
+  int16_t interBytes = 0;
+  SQLFunctionCtx* pCtx = &p->ctx;
+  getResultDataInfo(type, tDataTypeDesc[type].nSize, functionId, 0, &pCtx->outputType, &pCtx->outputBytes,
+                    &interBytes, 0, false);
+
+  pCtx->functionId = functionId;
+  pCtx->inputType = type;
+  pCtx->inputBytes = tDataTypeDesc[type].nSize;
+  pCtx->aInputElemBuf = data;
+  pCtx->hasNull = hasNull;
+  pCtx->order = TSDB_ORDER_ASC;
+  pCtx->aOutputBuf = p->output;
+  pCtx->resultInfo = &p->resInfo;
+  pCtx->ptsList = ts;
+  setResultInfoBuf(&p->resInfo, interBytes, false);
+}
+
+/*
+ * aggregate each window from the raw rows as the generic path does, and from the per-window statistics as the fused
+ * path does, the results of both must be identical
+ */
+void compareWithRawRows(int32_t functionId, int32_t type, int32_t numOfRows, int32_t nullRatio) {
+  TSKEY* ts = (TSKEY*)malloc(sizeof(TSKEY) * numOfRows);
+  char*  data = (char*)malloc(sizeof(double) * numOfRows);
+  fillTimestamp(ts, numOfRows);
+  fillValue(data, type, numOfRows, nullRatio);
+
+  int32_t pos = rand() % (numOfRows / 2);
+  TSKEY   ekey = ts[numOfRows - 1] - rand() % (interval * 2);
+
+  STimeWindow win = {0};
+  win.skey = ts[pos] - (ts[pos] - skey) % interval;
+  win.ekey = win.skey + interval - 1;
+
+  SWindowRowRange* pRange = (SWindowRowRange*)malloc(sizeof(SWindowRowRange) * numOfRows);
+  int32_t          numOfWins = splitIntoTumblingWindows(ts, pos, numOfRows, &win, interval, ekey, pRange);
+
+  // the windows cover the qualified rows without gaps, and each row belongs to its own window
+  int32_t next = pos;
+  for (int32_t w = 0; w < numOfWins; ++w) {
+    ASSERT_EQ(pRange[w].start, next);
+    ASSERT_GT(pRange[w].rows, 0);
+    ASSERT_EQ((pRange[w].skey - skey) % interval, 0);
+
+    for (int32_t j = 0; j < pRange[w].rows; ++j) {
+      TSKEY key = ts[pRange[w].start + j];
+      ASSERT_TRUE(key >= pRange[w].skey && key < pRange[w].skey + interval && key <= ekey);
+    }
+
+    next += pRange[w].rows;
+  }
+
+  ASSERT_TRUE(next == numOfRows || ts[next] > ekey);
+
+  SFuncCtx raw, fused;
+  initFuncCtx(&raw, functionId, type, data, ts, nullRatio > 0);
+  initFuncCtx(&fused, functionId, type, data, ts, nullRatio > 0);
+
+  SDataStatis* pStatis = (SDataStatis*)malloc(sizeof(SDataStatis) * numOfWins);
+  computeWindowStatis(&fused.ctx, pRange, numOfWins, pStatis);
+
+  for (int32_t w = 0; w < numOfWins; ++w) {
+    raw.ctx.startOffset = pRange[w].start;
+    raw.ctx.size = pRange[w].rows;
+
+    fused.ctx.startOffset = pRange[w].start;
+    fused.ctx.size = pRange[w].rows;
+    fused.ctx.ptsList = &ts[pRange[w].start];
+    fused.ctx.preAggVals.isSet = true;
+    fused.ctx.preAggVals.size = pRange[w].rows;
+    fused.ctx.preAggVals.statis = pStatis[w];
+
+    SFuncCtx* p[] = {&raw, &fused};
+    for (int32_t k = 0; k < 2; ++k) {
+      resetResultInfo(&p[k]->resInfo);
+      aAggs[functionId].init(&p[k]->ctx);
+
+      // no qualified value for min/max in this window, the function is not invoked in fused path
+      bool allNull = (pStatis[w].numOfNull == pRange[w].rows);
+      if (k == 0 || !allNull || (functionId != TSDB_FUNC_MIN && functionId != TSDB_FUNC_MAX)) {
+        aAggs[functionId].xFunction(&p[k]->ctx);
+      }
+
+      aAggs[functionId].xFinalize(&p[k]->ctx);
+    }
+
+    ASSERT_EQ(raw.resInfo.numOfRes, fused.resInfo.numOfRes);
+    if (raw.ctx.outputType == TSDB_DATA_TYPE_DOUBLE && !isNull(raw.output, TSDB_DATA_TYPE_DOUBLE)) {
+      ASSERT_DOUBLE_EQ(*(double*)raw.output, *(double*)fused.output);
+    } else {
+      ASSERT_EQ(memcmp(raw.output, fused.output, raw.ctx.outputBytes), 0);
+    }
+  }
+
+  free(raw.resInfo.interResultBuf);
+  free(fused.resInfo.interResultBuf);
+  free(pStatis);
+  free(pRange);
+  free(data);
+  free(ts);
+}
+}  // namespace
+
+TEST(testCase, fusedIntervalAggTest) {
+  int32_t functions[] = {TSDB_FUNC_COUNT, TSDB_FUNC_SUM, TSDB_FUNC_AVG, TSDB_FUNC_MIN, TSDB_FUNC_MAX};
+  int32_t types[] = {TSDB_DATA_TYPE_INT, TSDB_DATA_TYPE_DOUBLE};
+  int32_t nullRatios[] = {0, 3, 1};  // no null, some null values, all null values
+  int32_t rows[] = {2, 10, 1000, 4096};
+
+  for (int32_t i = 0; i < sizeof(functions) / sizeof(functions[0]); ++i) {
+    for (int32_t j = 0; j < sizeof(types) / sizeof(types[0]); ++j) {
+      for (int32_t k = 0; k < sizeof(nullRatios) / sizeof(nullRatios[0]); ++k) {
+        for (int32_t r = 0; r < sizeof(rows) / sizeof(rows[0]); ++r) {
+          compareWithRawRows(functions[i], types[j], rows[r], nullRatios[k]);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include <cassert>
+#include <iostream>
+
+#include "taos.h"
+#include "tsdb.h"
+
+#include "../../client/inc/tscUtil.h"
+#include "ttime.h"
+#include "tutil.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+extern "C" int tsParseValues(char **str, STableDataBlocks *pDataBlock, STableMeta *pTableMeta, int maxRows,
+                             SParsedDataColInfo *spd, char *error, int32_t *code, char *tmpTokenBuf);
+
+namespace {
+// the schema of taosdemo: ts timestamp, f1 int, f2 bigint, f3 float, f4 double, f5 bool, f6 binary(16)
+const int32_t numOfCols = 7;
+
+STableMeta *createTableMeta() {
+  const int8_t  types[] = {TSDB_DATA_TYPE_TIMESTAMP, TSDB_DATA_TYPE_INT,  TSDB_DATA_TYPE_BIGINT,
+                          TSDB_DATA_TYPE_FLOAT,     TSDB_DATA_TYPE_DOUBLE, TSDB_DATA_TYPE_BOOL,
+                          TSDB_DATA_TYPE_BINARY};
+  const int16_t bytes[] = {8, 4, 8, 4, 8, 1, 16};
+
+  STableMeta *pTableMeta = (STableMeta *)calloc(1, sizeof(STableMeta) + sizeof(SSchema) * numOfCols);
+  pTableMeta->tableType = TSDB_NORMAL_TABLE;
+  pTableMeta->tableInfo.numOfColumns = numOfCols;
+  pTableMeta->tableInfo.precision = TSDB_TIME_PRECISION_MILLI;
+
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    pTableMeta->schema[i].type = types[i];
+    pTableMeta->schema[i].bytes = bytes[i];
+    pTableMeta->schema[i].colId = i;
+    sprintf(pTableMeta->schema[i].name, "f%d", i);
+    pTableMeta->tableInfo.rowSize += bytes[i];
+  }
+
+  return pTableMeta;
+}
+
+STableDataBlocks *createDataBlock(STableMeta *pTableMeta, int32_t size) {
+  STableDataBlocks *pBlock = (STableDataBlocks *)calloc(1, sizeof(STableDataBlocks));
+  pBlock->nAllocSize = size;
+  pBlock->headerSize = sizeof(SSubmitBlk);
+  pBlock->size = sizeof(SSubmitBlk);
+  pBlock->pData = (char *)calloc(1, size);
+  pBlock->ordered = true;
+  pBlock->prevTS = INT64_MIN;
+  pBlock->tsSource = -1;
+  pBlock->rowSize = pTableMeta->tableInfo.rowSize;
+  return pBlock;
+}
+
+void destroyDataBlock(STableDataBlocks *pBlock) {
+  free(pBlock->pData);
+  free(pBlock->params);
+  free(pBlock);
+}
+
+void initColInfo(SParsedDataColInfo *spd, STableMeta *pTableMeta) {
+  memset(spd, 0, sizeof(SParsedDataColInfo));
+  spd->numOfCols = numOfCols;
+  spd->numOfAssignedCols = numOfCols;
+
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    spd->hasVal[i] = true;
+    spd->elems[i].colIndex = i;
+    if (i > 0) {
+      spd->elems[i].offset = spd->elems[i - 1].offset + pTableMeta->schema[i - 1].bytes;
+    }
+  }
+}
+
+int32_t parseValues(char *sql, STableMeta *pTableMeta, STableDataBlocks *pBlock, int32_t *code) {
+  SParsedDataColInfo spd;
+  initColInfo(&spd, pTableMeta);
+
+  char  error[512] = {0};
+  char  tmpTokenBuf[4096] = {0};
+  char *str = sql;
+
+  int32_t maxRows = (pBlock->nAllocSize - pBlock->headerSize) / pTableMeta->tableInfo.rowSize;
+  return tsParseValues(&str, pBlock, pTableMeta, maxRows, &spd, error, code, tmpTokenBuf);
+}
+
+char *getRow(STableDataBlocks *pBlock, int32_t row) {
+  return pBlock->pData + sizeof(SSubmitBlk) + pBlock->rowSize * row;
+}
+}  // namespace
+
+TEST(testCase, insert_parse_values) {
+  STableMeta *      pTableMeta = createTableMeta();
+  STableDataBlocks *pBlock = createDataBlock(pTableMeta, 4096);
+
+  // the first row is in the common form, the second one needs the tokenizer
+  char sql[] =
+      "(1500000000000, -12, 9223372036854775, 3.25,   -1234.5678, true, 'abc') "
+      "(1500000000001, +16, +7, 1e2, 2.5e-1, false, 'a''b')";
+
+  int32_t code = 0;
+  int32_t numOfRows = parseValues(sql, pTableMeta, pBlock, &code);
+  ASSERT_EQ(numOfRows, 2);
+
+  char *row = getRow(pBlock, 0);
+  EXPECT_EQ(*(int64_t *)row, 1500000000000L);
+  EXPECT_EQ(*(int32_t *)(row + 8), -12);
+  EXPECT_EQ(*(int64_t *)(row + 12), 9223372036854775L);
+  EXPECT_EQ(*(float *)(row + 20), 3.25f);
+  EXPECT_EQ(*(double *)(row + 24), strtod("-1234.5678", NULL));
+  EXPECT_EQ(*(int8_t *)(row + 32), TSDB_TRUE);
+  EXPECT_STREQ(row + 33, "abc");
+
+  row = getRow(pBlock, 1);
+  EXPECT_EQ(*(int64_t *)row, 1500000000001L);
+  EXPECT_EQ(*(int32_t *)(row + 8), 16);
+  EXPECT_EQ(*(int64_t *)(row + 12), 7);
+  EXPECT_EQ(*(float *)(row + 20), 100.0f);
+  EXPECT_EQ(*(double *)(row + 24), 0.25);
+  EXPECT_EQ(*(int8_t *)(row + 32), TSDB_FALSE);
+  EXPECT_STREQ(row + 33, "a'b");
+
+  destroyDataBlock(pBlock);
+
+  // overflow values are rejected by the generic path
+  pBlock = createDataBlock(pTableMeta, 4096);
+  char overflow[] = "(1500000000000, 2147483648, 1, 1.0, 1.0, true, 'a')";
+  EXPECT_EQ(parseValues(overflow, pTableMeta, pBlock, &code), -1);
+  EXPECT_EQ(code, TSDB_CODE_INVALID_SQL);
+  destroyDataBlock(pBlock);
+
+  // too long string
+  pBlock = createDataBlock(pTableMeta, 4096);
+  char longStr[] = "(1500000000000, 1, 1, 1.0, 1.0, true, '0123456789abcdefg')";
+  EXPECT_EQ(parseValues(longStr, pTableMeta, pBlock, &code), -1);
+  destroyDataBlock(pBlock);
+
+  free(pTableMeta);
+}
+
+/*
+ * rows/sec of parsing the taosdemo style insert statement, run it with --gtest_also_run_disabled_tests
+ */
+TEST(testCase, DISABLED_insert_parse_benchmark) {
+  const int32_t rowsPerSql = 10000;
+  const int32_t numOfSql = 10;
+  STableMeta *  pTableMeta = createTableMeta();
+
+  char *sql[numOfSql] = {0};
+  for (int32_t j = 0; j < numOfSql; ++j) {
+    sql[j] = (char *)calloc(1, rowsPerSql * 128);
+
+    char *p = sql[j];
+    for (int32_t i = 0; i < rowsPerSql; ++i) {
+      p += sprintf(p, "(%" PRId64 ", %d, %" PRId64 ", %10.4f, %20.8f, %s, \"%s\")", 1500000000000L + i,
+                   rand() % 32767, (int64_t)rand() * 1000, rand() / 1000.0f, rand() / 1000.0, (i & 1) ? "true" : "false",
+                   "abcdefghij");
+    }
+  }
+
+  int64_t elapsed = 0;
+  int32_t total = 0;
+  for (int32_t j = 0; j < numOfSql; ++j) {
+    STableDataBlocks *pBlock = createDataBlock(pTableMeta, rowsPerSql * pTableMeta->tableInfo.rowSize + 1024);
+
+    int32_t code = 0;
+    int64_t st = taosGetTimestampUs();
+    int32_t rows = parseValues(sql[j], pTableMeta, pBlock, &code);
+    elapsed += taosGetTimestampUs() - st;
+
+    EXPECT_EQ(rows, rowsPerSql);
+    total += rows;
+
+    destroyDataBlock(pBlock);
+    free(sql[j]);
+  }
+
+  printf("parse %d rows, elapsed time:%.2f ms, %.2f rows/sec\n", total, elapsed / 1000.0,
+         total * 1000000.0 / elapsed);
+  free(pTableMeta);
+}
+
+#pragma GCC diagnostic pop
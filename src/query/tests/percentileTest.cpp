@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include "taos.h"
+#include "qpercentile.h"
+#include "tsdb.h"
+#include "ttime.h"
+
+namespace {
+tMemBucket* createBucket(int32_t type, int32_t bytes, int32_t bufferSize) {
+  SSchema field[1] = {{(uint8_t)type, "dummyCol", 0, (int16_t)bytes}};
+
+  SColumnModel* pModel = createColumnModel(field, 1, 1000);
+  int32_t       orderIdx = 0;
+
+  tOrderDescriptor* pDesc = tOrderDesCreate(&orderIdx, 1, pModel, TSDB_ORDER_DESC);
+  return tMemBucketCreate(1024, bufferSize, bytes, type, pDesc);
+}
+
+void destroyBucket(tMemBucket* pBucket) {
+  tOrderDescDestroy(pBucket->pOrderDesc);
+  tMemBucketDestroy(pBucket);
+}
+
+// the same definition of percentile as the bucket implementation, interpolated between the neighbours
+double expectedPercentile(std::vector<double> v, double percent) {
+  std::sort(v.begin(), v.end());
+
+  double  val = percent * (v.size() - 1) / 100.0;
+  int32_t idx = (int32_t)val;
+  if (idx >= v.size() - 1) {
+    return v[v.size() - 1];
+  }
+
+  return (1 - (val - idx)) * v[idx] + (val - idx) * v[idx + 1];
+}
+
+template <typename T>
+void percentileTest(int32_t type, int32_t numOfVals, int32_t bufferSize, int32_t range, bool inMem) {
+  double percents[] = {0, 1, 10, 25, 50, 75, 90, 99.9, 100};
+
+  for (int32_t p = 0; p < sizeof(percents) / sizeof(percents[0]); ++p) {
+    tMemBucket* pBucket = createBucket(type, sizeof(T), bufferSize);
+
+    std::vector<double> vals;
+    std::vector<T>      block;
+    for (int32_t i = 0; i < numOfVals; ++i) {
+      T v = (T)(rand() % range - range / 2);
+      vals.push_back(v);
+      block.push_back(v);
+
+      // put values in blocks of different sizes
+      if (block.size() == 100 || i == numOfVals - 1) {
+        tMemBucketPut(pBucket, &block[0], block.size());
+        block.clear();
+      }
+    }
+
+    ASSERT_EQ(pBucket->inMemMode, inMem);
+    ASSERT_EQ(pBucket->numOfElems, numOfVals);
+    ASSERT_DOUBLE_EQ(getPercentile(pBucket, percents[p]), expectedPercentile(vals, percents[p]));
+
+    destroyBucket(pBucket);
+  }
+}
+}  // namespace
+
+TEST(testCase, percentileInMemTest) {
+  percentileTest<int8_t>(TSDB_DATA_TYPE_TINYINT, 10000, 1 << 20, 200, true);
+  percentileTest<int16_t>(TSDB_DATA_TYPE_SMALLINT, 10000, 1 << 20, 20000, true);
+  percentileTest<int32_t>(TSDB_DATA_TYPE_INT, 100000, 1 << 20, 1000000, true);
+  percentileTest<int64_t>(TSDB_DATA_TYPE_BIGINT, 100000, 1 << 20, 1000000, true);
+  percentileTest<float>(TSDB_DATA_TYPE_FLOAT, 100000, 1 << 20, 1000000, true);
+  percentileTest<double>(TSDB_DATA_TYPE_DOUBLE, 100000, 1 << 20, 1000000, true);
+
+  // many identical values
+  percentileTest<int32_t>(TSDB_DATA_TYPE_INT, 100000, 1 << 20, 3, true);
+  percentileTest<int32_t>(TSDB_DATA_TYPE_INT, 1, 1 << 20, 100, true);
+}
+
+TEST(testCase, percentileBucketTest) {
+  // the values exceed the in-memory buffer and are moved into the buckets
+  percentileTest<int32_t>(TSDB_DATA_TYPE_INT, 20000, 64 * 1024, 1000000, false);
+  percentileTest<double>(TSDB_DATA_TYPE_DOUBLE, 20000, 64 * 1024, 1000000, false);
+}
+
+// a benchmark of finding the median, run it with --gtest_also_run_disabled_tests
+TEST(testCase, DISABLED_percentilePerfTest) {
+  const int32_t numOfVals = 200000;
+
+  int32_t* data = (int32_t*)malloc(sizeof(int32_t) * numOfVals);
+  for (int32_t i = 0; i < numOfVals; ++i) {
+    data[i] = rand();
+  }
+
+  int32_t bufferSize[] = {numOfVals * sizeof(int32_t), 256 * 1024};  // in memory and in buckets
+  for (int32_t i = 0; i < 2; ++i) {
+    tMemBucket* pBucket = createBucket(TSDB_DATA_TYPE_INT, sizeof(int32_t), bufferSize[i]);
+
+    int64_t st = taosGetTimestampUs();
+    tMemBucketPut(pBucket, data, numOfVals);
+    double v = getPercentile(pBucket, 50);
+    int64_t et = taosGetTimestampUs();
+
+    printf("Elapsed time:%" PRId64 " us to find median %lf of %d values, in memory:%d\n", et - st, v, numOfVals,
+           pBucket->inMemMode);
+    destroyBucket(pBucket);
+  }
+
+  free(data);
+}
@@ -10,7 +10,7 @@ namespace {
 // simple test
 void simpleTest() {
   SDiskbasedResultBuf* pResultBuf = NULL;
-  int32_t ret = createDiskbasedResultBuffer(&pResultBuf, 1000, 64);
+  int32_t ret = createDiskbasedResultBuffer(&pResultBuf, 1000, 64, 1024*1024);
   
   int32_t pageId = 0;
   int32_t groupId = 0;
@@ -28,8 +28,69 @@ void simpleTest() {
   
   destroyResultBuf(pResultBuf);
 }
+
+// more pages than the in-memory buffer size, cold pages are spilled into the temp file and loaded back
+void spillTest() {
+  SDiskbasedResultBuf* pResultBuf = NULL;
+  int32_t ret = createDiskbasedResultBuffer(&pResultBuf, 4, 64, 0);
+  ASSERT_EQ(ret, 0);
+
+  const int32_t numOfPages = 40;
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    int32_t pageId = 0;
+    tFilePage* pBufPage = getNewDataBuf(pResultBuf, i % 3, &pageId);
+    ASSERT_TRUE(pBufPage != NULL);
+    ASSERT_EQ(pageId, i);
+
+    pBufPage->numOfElems = i;
+    memset(pBufPage->data, i, 16384L - sizeof(tFilePage));
+    releaseResBufPage(pResultBuf, pageId);
+  }
+
+  ASSERT_EQ(pResultBuf->numOfInMemPages, RESULT_BUF_MIN_INMEM_PAGES);
+  ASSERT_GT(pResultBuf->numOfSpills, 0);
+  ASSERT_EQ(getNumOfResultBufGroupId(pResultBuf), 3);
+
+  // pinned pages are never spilled
+  tFilePage* pPinned = getResultBufferPageById(pResultBuf, 0);
+  ASSERT_EQ(pPinned->numOfElems, 0);
+
+  for (int32_t i = numOfPages - 1; i > 0; --i) {
+    tFilePage* pBufPage = getResultBufferPageById(pResultBuf, i);
+    ASSERT_TRUE(pBufPage != NULL);
+    ASSERT_EQ(pBufPage->numOfElems, i);
+    ASSERT_EQ(pBufPage->data[0], (char) i);
+    ASSERT_EQ(pBufPage->data[16384L - sizeof(tFilePage) - 1], (char) i);
+    releaseResBufPage(pResultBuf, i);
+
+    ASSERT_EQ(pPinned, pResultBuf->pageInfo[0].pData);
+  }
+
+  releaseResBufPage(pResultBuf, 0);
+  destroyResultBuf(pResultBuf);
+}
+
+// small results never touch the disk
+void inMemoryTest() {
+  SDiskbasedResultBuf* pResultBuf = NULL;
+  int32_t ret = createDiskbasedResultBuffer(&pResultBuf, 4, 64, 1024*1024);
+  ASSERT_EQ(ret, 0);
+
+  for (int32_t i = 0; i < 16; ++i) {
+    int32_t pageId = 0;
+    ASSERT_TRUE(getNewDataBuf(pResultBuf, 0, &pageId) != NULL);
+    releaseResBufPage(pResultBuf, pageId);
+  }
+
+  ASSERT_EQ(pResultBuf->numOfSpills, 0);
+  ASSERT_EQ(pResultBuf->fd, -1);
+
+  destroyResultBuf(pResultBuf);
+}
 } // namespace
 
 TEST(testCase, resultBufferTest) {
   simpleTest();
+  spillTest();
+  inMemoryTest();
 }
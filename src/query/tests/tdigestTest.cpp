@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include "taos.h"
+#include "qtdigest.h"
+#include "tsdb.h"
+
+namespace {
+double exactQuantile(std::vector<double>& v, double q) {
+  return v[(size_t)(q * (v.size() - 1))];
+}
+
+// the rank error of the estimated value in the sorted values, which is bounded for t-digest
+double rankError(std::vector<double>& v, double estimate, double q) {
+  size_t rank = std::lower_bound(v.begin(), v.end(), estimate) - v.begin();
+  return fabs((double)rank / v.size() - q);
+}
+}  // namespace
+
+TEST(testCase, tdigestAccuracyTest) {
+  STDigest* pDigest = tTDigestCreateFrom(malloc(sizeof(STDigest)));
+
+  const int32_t       numOfVals = 1000000;
+  std::vector<double> vals;
+  for (int32_t i = 0; i < numOfVals; ++i) {
+    double v = (rand() % 1000000) / 100.0;
+    vals.push_back(v);
+    tTDigestAdd(pDigest, v, 1);
+  }
+
+  ASSERT_EQ(pDigest->size, numOfVals);
+
+  std::sort(vals.begin(), vals.end());
+  double qs[] = {0.001, 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999};
+  for (int32_t i = 0; i < sizeof(qs) / sizeof(qs[0]); ++i) {
+    double estimate = tTDigestQuantile(pDigest, qs[i]);
+    ASSERT_LT(rankError(vals, estimate, qs[i]), 0.01);
+  }
+
+  ASSERT_LT(pDigest->numOfCentroids, TDIGEST_MAX_CENTROIDS);
+  ASSERT_EQ(tTDigestQuantile(pDigest, 0), exactQuantile(vals, 0));
+  ASSERT_EQ(tTDigestQuantile(pDigest, 1), exactQuantile(vals, 1));
+
+  free(pDigest);
+}
+
+TEST(testCase, tdigestMergeTest) {
+  const int32_t numOfDigests = 16;
+  STDigest*     pDigest[numOfDigests];
+
+  std::vector<double> vals;
+  for (int32_t i = 0; i < numOfDigests; ++i) {
+    pDigest[i] = tTDigestCreateFrom(malloc(sizeof(STDigest)));
+
+    // each digest contains a different part of the whole range, fed in blocks as the query does
+    double block[1000];
+    for (int32_t j = 0; j < 20; ++j) {
+      for (int32_t k = 0; k < 1000; ++k) {
+        block[k] = i * 1000 + rand() % 5000;
+        vals.push_back(block[k]);
+      }
+      tTDigestAddBatch(pDigest[i], block, 1000);
+    }
+
+    ASSERT_EQ(pDigest[i]->size, 20000);
+  }
+
+  STDigest* pRes = tTDigestCreateFrom(malloc(sizeof(STDigest)));
+
+  for (int32_t i = 0; i < numOfDigests; ++i) {
+    tTDigestMerge(pRes, pDigest[i]);
+  }
+
+  ASSERT_EQ(pRes->size, (int64_t)vals.size());
+
+  std::sort(vals.begin(), vals.end());
+  double qs[] = {0.01, 0.1, 0.5, 0.9, 0.99};
+  for (int32_t i = 0; i < sizeof(qs) / sizeof(qs[0]); ++i) {
+    ASSERT_LT(rankError(vals, tTDigestQuantile(pRes, qs[i]), qs[i]), 0.01);
+  }
+
+  // empty digest and single value
+  STDigest* pEmpty = tTDigestCreateFrom(malloc(sizeof(STDigest)));
+  ASSERT_TRUE(isnan(tTDigestQuantile(pEmpty, 0.5)));
+
+  tTDigestAdd(pEmpty, 12.5, 1);
+  ASSERT_EQ(tTDigestQuantile(pEmpty, 0.5), 12.5);
+
+  // a single centroid still reports min and max at both ends
+  tTDigestAdd(pEmpty, 10, 2);
+  tTDigestAdd(pEmpty, 15, 2);
+  tTDigestCompress(pEmpty);
+  pEmpty->centroids[0].mean = (12.5 + 10 * 2 + 15 * 2) / 5;
+  pEmpty->centroids[0].weight = 5;
+  pEmpty->numOfCentroids = 1;
+
+  ASSERT_EQ(tTDigestQuantile(pEmpty, 0), 10);
+  ASSERT_EQ(tTDigestQuantile(pEmpty, 1), 15);
+  ASSERT_EQ(tTDigestQuantile(pEmpty, 0.5), 12.5);
+
+  free(pEmpty);
+  free(pRes);
+  for (int32_t i = 0; i < numOfDigests; ++i) {
+    free(pDigest[i]);
+  }
+}
@@ -931,6 +931,15 @@ static void rpcProcessIncomingMsg(SRpcConn *pConn, SRpcHead *pHead) {
     rpcMsg.handle = pContext->ahandle;
     pConn->pContext = NULL;
 
+    if (pHead->code == TSDB_CODE_MISMATCHED_METER_ID) {
+      // peer is restarted and the link is unknown there, the request is sent again through a new link
+      tTrace("%s %p, link is not known by peer, set up a new one", pRpc->label, pConn);
+      rpcFreeMsg(pHead);
+      rpcCloseConn(pConn);
+      rpcSendReqToServer(pRpc, pContext);
+      return;
+    }
+
     // for UDP, port may be changed by server, the port in ipSet shall be used for cache
     rpcAddConnIntoCache(pRpc->pCache, pConn, pConn->peerIp, pContext->ipSet.port, pConn->connType);    
 
@@ -71,7 +71,9 @@ typedef struct STable {
   SDataRow       tagVal;
   SMemTable *    mem;
   SMemTable *    imem;
-  void *         pIndex;         // For TSDB_SUPER_TABLE, it is the skiplist index
+  SDataRow       lastRow;        // the latest row of the table, guarded by the repo mutex
+  bool           lastRowLoaded;  // the last row in data files has been merged into lastRow, guarded by the repo mutex
+  void *         pIndex;         // For TSDB_SUPER_TABLE, it is the tag index of all child tables
   void *         eventHandler;   // TODO
   void *         streamHandler;  // TODO
   struct STable *next;           // TODO: remove the next
@@ -124,11 +126,27 @@ STsdbMeta *tsdbGetMeta(TsdbRepoT *pRepo);
 
 int32_t tsdbCreateTableImpl(STsdbMeta *pMeta, STableCfg *pCfg);
 int32_t tsdbDropTableImpl(STsdbMeta *pMeta, STableId tableId);
+int32_t tsdbAlterTableImpl(STsdbMeta *pMeta, STableCfg *pCfg);
 STable *tsdbIsValidTableToInsert(STsdbMeta *pMeta, STableId tableId);
 // int32_t tsdbInsertRowToTableImpl(SSkipListNode *pNode, STable *pTable);
 STable *tsdbGetTableByUid(STsdbMeta *pMeta, int64_t uid);
 char *  getTupleKey(const void *data);
 
+// ---------- TSDB TAG INDEX DEFINITION
+typedef struct STagIndex STagIndex;
+struct tExprNode;
+
+STagIndex *tsdbNewTagIndex(STSchema *pTagSchema, int32_t maxTables);
+void       tsdbFreeTagIndex(STagIndex *pIndex);
+int        tsdbAddTableIntoTagIndex(STagIndex *pIndex, STable *pTable);
+int        tsdbRemoveTableFromTagIndex(STagIndex *pIndex, STable *pTable);
+int        tsdbUpdateTableTagInTagIndex(STagIndex *pIndex, STable *pTable, SDataRow tagVal);
+int32_t    tsdbQueryTagIndex(STagIndex *pIndex, STsdbMeta *pMeta, struct tExprNode *pExpr, SArray *pRes);
+int64_t    tsdbGetTagIndexVersion(STagIndex *pIndex);
+bool       tsdbGetTableGroupFromCache(STagIndex *pIndex, const char *key, int32_t keyLen, STableGroupInfo *pGroupInfo);
+void       tsdbPutTableGroupIntoCache(STagIndex *pIndex, const char *key, int32_t keyLen, int64_t version,
+                                      STableGroupInfo *pGroupInfo);
+
 // ------------------------------ TSDB CACHE INTERFACES ------------------------------
 #define TSDB_DEFAULT_CACHE_BLOCK_SIZE 16 * 1024 * 1024 /* 16M */
 
@@ -373,6 +391,8 @@ SSubmitBlk *tsdbGetSubmitMsgNext(SSubmitMsgIter *pIter);
 int32_t tsdbTriggerCommit(TsdbRepoT *repo);
 int32_t tsdbLockRepo(TsdbRepoT *repo);
 int32_t tsdbUnLockRepo(TsdbRepoT *repo);
+void    tsdbUpdateTableLastRow(STsdbRepo *pRepo, STable *pTable, SDataRow row);
+void    tsdbLoadTableLastRow(STsdbRepo *pRepo, STable *pTable, SDataRow row);
 
 typedef enum { TSDB_WRITE_HELPER, TSDB_READ_HELPER } tsdb_rw_helper_t;
 
@@ -12,7 +12,7 @@
 #define TSDB_MIN_ID 0
 #define TSDB_MAX_ID INT_MAX
 #define TSDB_MIN_TABLES 4
-#define TSDB_MAX_TABLES 100000
+#define TSDB_MAX_TABLES (TSDB_MAX_TABLES_PER_VNODE + 1)  // table ids start from 1, id 0 is unused
 #define TSDB_DEFAULT_TABLES 1000
 #define TSDB_DEFAULT_DAYS_PER_FILE 10
 #define TSDB_MIN_DAYS_PER_FILE 1
@@ -342,9 +342,9 @@ int tsdbCreateTable(TsdbRepoT *repo, STableCfg *pCfg) {
   return tsdbCreateTableImpl(pRepo->tsdbMeta, pCfg);
 }
 
-int tsdbAlterTable(TsdbRepoT *pRepo, STableCfg *pCfg) {
-  // TODO
-  return 0;
+int tsdbAlterTable(TsdbRepoT *repo, STableCfg *pCfg) {
+  STsdbRepo *pRepo = (STsdbRepo *)repo;
+  return tsdbAlterTableImpl(pRepo->tsdbMeta, pCfg);
 }
 
 int tsdbDropTable(TsdbRepoT *repo, STableId tableId) {
@@ -773,17 +773,68 @@ static int32_t tsdbInsertDataToTable(TsdbRepoT *repo, SSubmitBlk *pBlock) {
 
   SSubmitBlkIter blkIter;
   SDataRow row;
+  SDataRow lastRow = NULL;
 
   tsdbInitSubmitBlkIter(pBlock, &blkIter);
   while ((row = tsdbGetSubmitBlkNext(&blkIter)) != NULL) {
     if (tdInsertRowToTable(pRepo, row, pTable) < 0) {
       return -1;
     }
+
+    if (lastRow == NULL || dataRowKey(row) >= dataRowKey(lastRow)) {
+      lastRow = row;
+    }
+  }
+
+  // the last row cache is updated once for each submit block, with the newest row in the block
+  if (lastRow != NULL) {
+    tsdbUpdateTableLastRow(pRepo, pTable, lastRow);
   }
 
   return TSDB_CODE_SUCCESS;
 }
 
+static void tsdbUpdateTableLastRowImpl(STable *pTable, SDataRow row) {
+  if (pTable->lastRow != NULL && dataRowKey(row) < dataRowKey(pTable->lastRow)) {
+    return;
+  }
+
+  if (pTable->lastRow == NULL || dataRowLen(pTable->lastRow) < dataRowLen(row)) {
+    SDataRow pNew = realloc(pTable->lastRow, dataRowLen(row));
+    if (pNew == NULL) {
+      return;
+    }
+
+    pTable->lastRow = pNew;
+  }
+
+  dataRowCpy(pTable->lastRow, row);
+}
+
+/**
+ * Keep the newest row of a table in memory, so that the last row query does not need to scan any data block.
+ * The row is copied into the table object, and replaced only when it is newer than the cached one.
+ */
+void tsdbUpdateTableLastRow(STsdbRepo *pRepo, STable *pTable, SDataRow row) {
+  tsdbLockRepo((TsdbRepoT *)pRepo);
+  tsdbUpdateTableLastRowImpl(pTable, row);
+  tsdbUnLockRepo((TsdbRepoT *)pRepo);
+}
+
+/**
+ * Merge the last row restored from data files into the cache, and mark the table so the files are not checked
+ * again. The row may be NULL if the table has no data in files.
+ */
+void tsdbLoadTableLastRow(STsdbRepo *pRepo, STable *pTable, SDataRow row) {
+  tsdbLockRepo((TsdbRepoT *)pRepo);
+  if (row != NULL) {
+    tsdbUpdateTableLastRowImpl(pTable, row);
+  }
+
+  pTable->lastRowLoaded = true;
+  tsdbUnLockRepo((TsdbRepoT *)pRepo);
+}
+
 static int tsdbReadRowsFromCache(SSkipListIterator *pIter, TSKEY maxKey, int maxRowsToRead, SDataCols *pCols) {
   ASSERT(maxRowsToRead > 0);
   if (pIter == NULL) return 0;
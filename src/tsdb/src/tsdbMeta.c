@@ -7,7 +7,6 @@
 #include "hash.h"
 #include "tsdbMain.h"
 
-#define TSDB_SUPER_TABLE_SL_LEVEL 5 // TODO: may change here
 #define TSDB_META_FILE_NAME "META"
 
 static int     tsdbFreeTable(STable *pTable);
@@ -104,11 +103,6 @@ void tsdbFreeEncode(void *cont) {
   if (cont != NULL) free(cont);
 }
 
-static char* getTagIndexKey(const void* pData) {
-  STable* table = *(STable**) pData;
-  return getTupleKey(table->tagVal);
-}
-
 int tsdbRestoreTable(void *pHandle, void *cont, int contLen) {
   STsdbMeta *pMeta = (STsdbMeta *)pHandle;
 
@@ -116,9 +110,7 @@ int tsdbRestoreTable(void *pHandle, void *cont, int contLen) {
   if (pTable == NULL) return -1;
   
   if (pTable->type == TSDB_SUPER_TABLE) {
-    STColumn* pColSchema = schemaColAt(pTable->tagSchema, 0);
-    pTable->pIndex = tSkipListCreate(TSDB_SUPER_TABLE_SL_LEVEL, pColSchema->type, pColSchema->bytes,
-                                    1, 0, 0, getTagIndexKey);
+    pTable->pIndex = tsdbNewTagIndex(pTable->tagSchema, pMeta->maxTables);
   }
 
   tsdbAddTableToMeta(pMeta, pTable, false);
@@ -274,11 +266,8 @@ int32_t tsdbCreateTableImpl(STsdbMeta *pMeta, STableCfg *pCfg) {
       super->tagVal = tdDataRowDup(pCfg->tagValues);
       super->name = strdup(pCfg->sname);
 
-      // index the first tag column
-      STColumn* pColSchema = schemaColAt(super->tagSchema, 0);
-      super->pIndex = tSkipListCreate(TSDB_SUPER_TABLE_SL_LEVEL, pColSchema->type, pColSchema->bytes,
-          1, 0, 0, getTagIndexKey);  // Allow duplicate key, no lock
-
+      // index all tag columns
+      super->pIndex = tsdbNewTagIndex(super->tagSchema, pMeta->maxTables);
       if (super->pIndex == NULL) {
         tdFreeSchema(super->schema);
         tdFreeSchema(super->tagSchema);
@@ -328,6 +317,28 @@ int32_t tsdbCreateTableImpl(STsdbMeta *pMeta, STableCfg *pCfg) {
   return 0;
 }
 
+/**
+ * Alter a table. Only the tag values of a child table can be changed now, and the table is moved to the postings of
+ * the new values in the tag index of its super table.
+ */
+int32_t tsdbAlterTableImpl(STsdbMeta *pMeta, STableCfg *pCfg) {
+  STable *pTable = tsdbGetTableByUid(pMeta, pCfg->tableId.uid);
+  if (pTable == NULL) return -1;
+
+  if (pTable->type != TSDB_CHILD_TABLE || pCfg->tagValues == NULL) {
+    // TODO: implement altering the schema of a table
+    return 0;
+  }
+
+  STable *pSTable = tsdbGetTableByUid(pMeta, pTable->superUid);
+  assert(pSTable != NULL);
+
+  SDataRow tagVal = tdDataRowDup(pCfg->tagValues);
+  if (tagVal == NULL) return -1;
+
+  return tsdbUpdateTableTagInTagIndex(pSTable->pIndex, pTable, tagVal);
+}
+
 /**
  * Check if a table is valid to insert.
  * @return NULL for invalid and the pointer to the table if valid
@@ -390,11 +401,12 @@ static int tsdbFreeTable(STable *pTable) {
 
   // Free content
   if (TSDB_TABLE_IS_SUPER_TABLE(pTable)) {
-    tSkipListDestroy(pTable->pIndex);
+    tsdbFreeTagIndex(pTable->pIndex);
   }
 
   tsdbFreeMemTable(pTable->mem);
   tsdbFreeMemTable(pTable->imem);
+  tdFreeDataRow(pTable->lastRow);
 
   tfree(pTable->name);
   free(pTable);
@@ -463,29 +475,16 @@ static int tsdbAddTableIntoIndex(STsdbMeta *pMeta, STable *pTable) {
   assert(pTable->type == TSDB_CHILD_TABLE && pTable != NULL);
   STable* pSTable = tsdbGetTableByUid(pMeta, pTable->superUid);
   assert(pSTable != NULL);
-  
-  int32_t level = 0;
-  int32_t headSize = 0;
-  
-  tSkipListNewNodeInfo(pSTable->pIndex, &level, &headSize);
-  
-  // NOTE: do not allocate the space for key, since in each skip list node, only keep the pointer to pTable, not the
-  // actual key value, and the key value will be retrieved during query through the pTable and getTagIndexKey function
-  SSkipListNode* pNode = calloc(1, headSize + POINTER_BYTES);
-  pNode->level = level;
-  
-  SSkipList* list = pSTable->pIndex;
-  memcpy(SL_GET_NODE_DATA(pNode), &pTable, POINTER_BYTES);
-  
-  tSkipListPut(list, pNode);
 
-  return 0;
+  return tsdbAddTableIntoTagIndex(pSTable->pIndex, pTable);
 }
 
 static int tsdbRemoveTableFromIndex(STsdbMeta *pMeta, STable *pTable) {
   assert(pTable->type == TSDB_CHILD_TABLE);
-  // TODO
-  return 0;
+  STable* pSTable = tsdbGetTableByUid(pMeta, pTable->superUid);
+  assert(pSTable != NULL);
+
+  return tsdbRemoveTableFromTagIndex(pSTable->pIndex, pTable);
 }
 
 static int tsdbEstimateTableEncodeSize(STable *pTable) {
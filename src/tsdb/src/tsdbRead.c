@@ -34,6 +34,11 @@ enum {
   QUERY_RANGE_GREATER_EQUAL = 1,
 };
 
+enum {
+  TSDB_QUERY_TYPE_ALL = 0,
+  TSDB_QUERY_TYPE_LAST_ROW = 1,
+};
+
 typedef struct SField {
   // todo need the definition
 } SField;
@@ -73,6 +78,7 @@ typedef struct STableCheckInfo {
 
   SDataCols*         pDataCols;
   SSkipListIterator* iter;
+  SDataRow           pLastRow;  // snapshot of the cached last row, only for last row query
 } STableCheckInfo;
 
 typedef struct {
@@ -102,6 +108,7 @@ typedef struct STsdbQueryHandle {
   SLoadCompBlockInfo compBlockLoadInfo; /* record current compblock information in SQuery */
 
   int16_t     order;
+  int32_t     type;    // TSDB_QUERY_TYPE_ALL or TSDB_QUERY_TYPE_LAST_ROW
   STimeWindow window;  // the primary query time window that applies to all queries
   SCompBlock* pBlock;
   int32_t     numOfBlocks;
@@ -200,6 +207,238 @@ TsdbQueryHandleT* tsdbQueryTables(TsdbRepoT* tsdb, STsdbQueryCond* pCond, STable
   return (TsdbQueryHandleT)pQueryHandle;
 }
 
+static SDataRow getLastRowOfDataCols(SDataCols* pCols, STSchema* pSchema) {
+  if (pCols->numOfPoints <= 0) {
+    return NULL;
+  }
+
+  SDataRow row = tdNewDataRowFromSchema(pSchema);
+  if (row == NULL) {
+    return NULL;
+  }
+
+  int32_t last = pCols->numOfPoints - 1;
+  for (int32_t i = 0; i < pCols->numOfCols; ++i) {
+    SDataCol* pCol = &pCols->cols[i];
+    memcpy(dataRowAt(row, pCol->offset), (char*)pCol->pData + last * pCol->bytes, pCol->bytes);
+  }
+
+  return row;
+}
+
+/*
+ * The last row of a table is not cached until the first insertion after the repository is opened, so it is restored
+ * from the last data block of the table in files. The file groups are checked backwards only once for all the tables
+ * whose last row is not loaded yet. Return false if the last row of any table can not be loaded.
+ */
+static bool loadLastRowFromFiles(STsdbQueryHandle* pQueryHandle) {
+  enum { LAST_ROW_PENDING = 0, LAST_ROW_DONE = 1, LAST_ROW_FAILED = 2 };
+
+  STsdbRepo* pRepo = pQueryHandle->pTsdb;
+  size_t     numOfTables = taosArrayGetSize(pQueryHandle->pTableCheckInfo);
+
+  SArray* pTableList = taosArrayInit(numOfTables, POINTER_BYTES);
+
+  tsdbLockRepo((TsdbRepoT*)pRepo);
+  for (int32_t i = 0; i < numOfTables; ++i) {
+    STableCheckInfo* pCheckInfo = taosArrayGet(pQueryHandle->pTableCheckInfo, i);
+    if (!pCheckInfo->pTableObj->lastRowLoaded) {
+      taosArrayPush(pTableList, &pCheckInfo->pTableObj);
+    }
+  }
+  tsdbUnLockRepo((TsdbRepoT*)pRepo);
+
+  size_t remain = taosArrayGetSize(pTableList);
+  if (remain == 0) {
+    taosArrayDestroy(pTableList);
+    return true;
+  }
+
+  // a table failed in a newer file group is not checked in the older ones, which only have older rows
+  int8_t* status = calloc(remain, sizeof(int8_t));
+  if (status == NULL) {
+    taosArrayDestroy(pTableList);
+    return false;
+  }
+
+  SRWHelper* pHelper = &pQueryHandle->rhelper;
+
+  SFileGroupIter iter = {0};
+  tsdbInitFileGroupIter(pRepo->tsdbFileH, &iter, TSDB_FGROUP_ITER_BACKWARD);
+
+  SFileGroup* pGroup = NULL;
+  bool        error = false;
+  int32_t     numOfLoaded = 0;
+  int32_t     numOfFailed = 0;
+
+  while (remain > 0 && (pGroup = tsdbGetFileGroupNext(&iter)) != NULL) {
+    if (tsdbSetAndOpenHelperFile(pHelper, pGroup) < 0) {
+      uError("%p failed to open file group:%d to load the last row", pQueryHandle, pGroup->fileId);
+      error = true;
+      break;
+    }
+
+    for (int32_t i = 0; i < taosArrayGetSize(pTableList); ++i) {
+      STable* pTable = *(STable**)taosArrayGet(pTableList, i);
+
+      SCompIdx* pIdx = &pHelper->pCompIdx[pTable->tableId.tid];
+      if (status[i] != LAST_ROW_PENDING || pIdx->len == 0 || pIdx->numOfBlocks == 0) {
+        continue;
+      }
+
+      tsdbSetHelperTable(pHelper, pTable, pRepo);
+      if (tsdbLoadCompInfo(pHelper, NULL) < 0 || pHelper->pCompInfo->uid != pTable->tableId.uid) {
+        uError("%p failed to load the block info of uid:%" PRIu64 ", tid:%d", pQueryHandle, pTable->tableId.uid,
+               pTable->tableId.tid);
+        status[i] = LAST_ROW_FAILED;
+        numOfFailed += 1;
+        remain -= 1;
+        continue;
+      }
+
+      // the blocks are ordered by timestamp, so the last row is the last one of the last block
+      SCompBlock* pBlock = blockAtIdx(pHelper, pIdx->numOfBlocks - 1);
+      if (tsdbLoadBlockData(pHelper, pBlock, NULL) < 0) {
+        uError("%p failed to load the last block of uid:%" PRIu64 ", tid:%d", pQueryHandle, pTable->tableId.uid,
+               pTable->tableId.tid);
+        status[i] = LAST_ROW_FAILED;
+        numOfFailed += 1;
+        remain -= 1;
+        continue;
+      }
+
+      SDataRow row = getLastRowOfDataCols(pHelper->pDataCols[0], tsdbGetTableSchema(pRepo->tsdbMeta, pTable));
+      tsdbLoadTableLastRow(pRepo, pTable, row);
+      tdFreeDataRow(row);
+
+      status[i] = LAST_ROW_DONE;
+      numOfLoaded += 1;
+      remain -= 1;
+    }
+  }
+
+  tsdbCloseHelperFile(pHelper, false);
+
+  // all file groups are checked, the remain tables have no data in files
+  if (!error) {
+    for (int32_t i = 0; i < taosArrayGetSize(pTableList); ++i) {
+      if (status[i] == LAST_ROW_PENDING) {
+        tsdbLoadTableLastRow(pRepo, *(STable**)taosArrayGet(pTableList, i), NULL);
+      }
+    }
+  }
+
+  uTrace("%p last row of %d tables are loaded from files, %d failed", pQueryHandle, numOfLoaded, numOfFailed);
+  free(status);
+  taosArrayDestroy(pTableList);
+
+  return !error && numOfFailed == 0;
+}
+
+/*
+ * only the table with the newest last row in each group is kept, and its last row is copied into the query handle,
+ * so the subsequent writes do not affect the query. Return false if the last row of any table is not loaded, since the
+ * newest row of its group is unknown then.
+ */
+static bool keepNewestTableInGroup(STsdbQueryHandle* pQueryHandle, STableGroupInfo* groupList) {
+  size_t  numOfGroups = taosArrayGetSize(groupList->pGroupList);
+  SArray* pTableCheckInfo = taosArrayInit(numOfGroups, sizeof(STableCheckInfo));
+
+  int32_t index = 0;
+  tsdbLockRepo((TsdbRepoT*)pQueryHandle->pTsdb);
+
+  for (int32_t i = 0; i < numOfGroups; ++i) {
+    SArray* group = *(SArray**)taosArrayGet(groupList->pGroupList, i);
+    size_t  gsize = taosArrayGetSize(group);
+
+    STableCheckInfo* pNewest = NULL;
+    for (int32_t j = 0; j < gsize; ++j, ++index) {
+      STableCheckInfo* pCheckInfo = taosArrayGet(pQueryHandle->pTableCheckInfo, index);
+      if (!pCheckInfo->pTableObj->lastRowLoaded) {
+        tsdbUnLockRepo((TsdbRepoT*)pQueryHandle->pTsdb);
+        for (int32_t k = 0; k < taosArrayGetSize(pTableCheckInfo); ++k) {
+          tdFreeDataRow(((STableCheckInfo*)taosArrayGet(pTableCheckInfo, k))->pLastRow);
+        }
+        taosArrayDestroy(pTableCheckInfo);
+        return false;
+      }
+
+      SDataRow row = pCheckInfo->pTableObj->lastRow;
+      if (row != NULL && (pNewest == NULL || dataRowKey(row) > dataRowKey(pNewest->pTableObj->lastRow))) {
+        pNewest = pCheckInfo;
+      }
+    }
+
+    if (pNewest != NULL) {
+      STableCheckInfo info = *pNewest;
+      info.pLastRow = tdDataRowDup(pNewest->pTableObj->lastRow);
+      taosArrayPush(pTableCheckInfo, &info);
+    }
+  }
+
+  tsdbUnLockRepo((TsdbRepoT*)pQueryHandle->pTsdb);
+
+  taosArrayDestroy(pQueryHandle->pTableCheckInfo);
+  pQueryHandle->pTableCheckInfo = pTableCheckInfo;
+  return true;
+}
+
+TsdbQueryHandleT* tsdbQueryLastRow(TsdbRepoT* tsdb, STsdbQueryCond* pCond, STableGroupInfo* groupList) {
+  STsdbQueryHandle* pQueryHandle = (STsdbQueryHandle*)tsdbQueryTables(tsdb, pCond, groupList);
+
+  // the last row is found by scanning the tables if it is not cached for all of them
+  if (!loadLastRowFromFiles(pQueryHandle) || !keepNewestTableInGroup(pQueryHandle, groupList)) {
+    uWarn("%p last row is not cached for all tables, scan the tables instead", pQueryHandle);
+    tsdbCleanupQueryHandle(pQueryHandle);
+    return tsdbQueryTables(tsdb, pCond, groupList);
+  }
+
+  pQueryHandle->type = TSDB_QUERY_TYPE_LAST_ROW;
+  pQueryHandle->activeIndex = -1;
+
+  uTrace("%p last row query, numOfGroups:%d, tables with data:%d", pQueryHandle,
+         taosArrayGetSize(groupList->pGroupList), taosArrayGetSize(pQueryHandle->pTableCheckInfo));
+
+  return (TsdbQueryHandleT)pQueryHandle;
+}
+
+// copy the snapshot of the last row of next table into the column buffer as a data block with only one row
+static bool nextLastRowBlock(STsdbQueryHandle* pQueryHandle) {
+  size_t numOfTables = taosArrayGetSize(pQueryHandle->pTableCheckInfo);
+  if (pQueryHandle->activeIndex + 1 >= numOfTables) {
+    return false;
+  }
+
+  pQueryHandle->activeIndex += 1;
+  pQueryHandle->cur.fid = -1;
+  pQueryHandle->realNumOfRows = 1;
+
+  STableCheckInfo* pCheckInfo = taosArrayGet(pQueryHandle->pTableCheckInfo, pQueryHandle->activeIndex);
+  STSchema*        pSchema = tsdbGetTableSchema(tsdbGetMeta(pQueryHandle->pTsdb), pCheckInfo->pTableObj);
+
+  size_t numOfCols = QH_GET_NUM_OF_COLS(pQueryHandle);
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SColumnInfoData* pColInfo = taosArrayGet(pQueryHandle->pColumns, i);
+
+    STColumn* pCol = NULL;
+    for (int32_t j = 0; j < schemaNCols(pSchema); ++j) {
+      if (colColId(schemaColAt(pSchema, j)) == pColInfo->info.colId) {
+        pCol = schemaColAt(pSchema, j);
+        break;
+      }
+    }
+
+    // the row is shorter than the schema if the column is added after the row is written
+    if (pCol != NULL && colOffset(pCol) + pColInfo->info.bytes <= dataRowLen(pCheckInfo->pLastRow)) {
+      memcpy(pColInfo->pData, dataRowAt(pCheckInfo->pLastRow, colOffset(pCol)), pColInfo->info.bytes);
+    } else {
+      setNull(pColInfo->pData, pColInfo->info.type, pColInfo->info.bytes);
+    }
+  }
+
+  return true;
+}
+
 static bool hasMoreDataInCache(STsdbQueryHandle* pHandle) {
   size_t size = taosArrayGetSize(pHandle->pTableCheckInfo);
   assert(pHandle->activeIndex < size && pHandle->activeIndex >= 0 && size >= 1);
@@ -913,6 +1152,10 @@ static bool doHasDataInBuffer(STsdbQueryHandle* pQueryHandle) {
 bool tsdbNextDataBlock(TsdbQueryHandleT* pqHandle) {
   STsdbQueryHandle* pQueryHandle = (STsdbQueryHandle*) pqHandle;
   
+  if (pQueryHandle->type == TSDB_QUERY_TYPE_LAST_ROW) {
+    return nextLastRowBlock(pQueryHandle);
+  }
+
   size_t numOfTables = taosArrayGetSize(pQueryHandle->pTableCheckInfo);
   assert(numOfTables > 0);
   
@@ -1018,6 +1261,20 @@ SDataBlockInfo tsdbRetrieveDataBlockInfo(TsdbQueryHandleT* pQueryHandle) {
   int32_t rows = 0;
 
   int32_t step = ASCENDING_ORDER_TRAVERSE(pHandle->order)? 1:-1;
+
+  if (pHandle->type == TSDB_QUERY_TYPE_LAST_ROW) {
+    STableCheckInfo* pCheckInfo = taosArrayGet(pHandle->pTableCheckInfo, pHandle->activeIndex);
+    TSKEY            key = dataRowKey(pCheckInfo->pLastRow);
+
+    SDataBlockInfo blockInfo = {
+        .uid = pCheckInfo->tableId.uid,
+        .sid = pCheckInfo->tableId.tid,
+        .rows = 1,
+        .window = {.skey = key, .ekey = key},
+    };
+
+    return blockInfo;
+  }
   
   // data in file
   if (pHandle->cur.fid >= 0) {
@@ -1125,37 +1382,7 @@ static int32_t getAllTableIdList(STsdbRepo* tsdb, int64_t uid, SArray* list) {
   STable* pTable = tsdbGetTableByUid(tsdbGetMeta(tsdb), uid);
   assert(pTable != NULL);  // assert pTable is a super table
 
-  SSkipListIterator* iter = tSkipListCreateIter(pTable->pIndex);
-  while (tSkipListIterNext(iter)) {
-    SSkipListNode* pNode = tSkipListIterGet(iter);
-    
-    STable* t = *(STable**)SL_GET_NODE_DATA(pNode);
-    taosArrayPush(list, &t);
-  }
-  
-  return TSDB_CODE_SUCCESS;
-}
-
-typedef struct SExprTreeSupporter {
-  SSchema* pTagSchema;
-  int32_t  numOfTags;
-  int32_t  optr;
-} SExprTreeSupporter;
-
-/**
- * convert the result pointer to table id instead of table object pointer
- * @param pRes
- */
-static void convertQueryResult(SArray* pRes, SArray* pTableList) {
-  if (pTableList == NULL || taosArrayGetSize(pTableList) == 0) {
-    return;
-  }
-
-  size_t size = taosArrayGetSize(pTableList);
-  for (int32_t i = 0; i < size; ++i) {
-    STable* pTable = taosArrayGetP(pTableList, i);
-    taosArrayPush(pRes, &pTable);
-  }
+  return tsdbQueryTagIndex(pTable->pIndex, tsdbGetMeta(tsdb), NULL, list);
 }
 
 static void destroyHelper(void* param) {
@@ -1168,53 +1395,6 @@ static void destroyHelper(void* param) {
   free(param);
 }
 
-static void getTagColumnInfo(SExprTreeSupporter* pSupporter, SSchema* pSchema, int32_t* index) {
-  *index = 0;
-
-  // filter on table name(TBNAME)
-  if (strcasecmp(pSchema->name, TSQL_TBNAME_L) == 0) {
-    *index = TSDB_TBNAME_COLUMN_INDEX;
-    return;
-  }
-
-  while ((*index) < pSupporter->numOfTags) {
-    if (pSupporter->pTagSchema[*index].bytes == pSchema->bytes &&
-        pSupporter->pTagSchema[*index].type  == pSchema->type  &&
-        pSupporter->pTagSchema[*index].colId == pSchema->colId) {
-      break;
-    }
-  }
-}
-
-void filterPrepare(void* expr, void* param) {
-  tExprNode* pExpr = (tExprNode*)expr;
-  if (pExpr->_node.info != NULL) {
-    return;
-  }
-
-  int32_t i = 0, offset = 0;
-  pExpr->_node.info = calloc(1, sizeof(tQueryInfo));
-
-  tQueryInfo* pInfo = pExpr->_node.info;
-
-  SExprTreeSupporter* pSupporter = (SExprTreeSupporter*)param;
-
-  tVariant* pCond = pExpr->_node.pRight->pVal;
-  SSchema*  pSchema = pExpr->_node.pLeft->pSchema;
-
-  getTagColumnInfo(pSupporter, pSchema, &i);
-  assert((i >= 0 && i < TSDB_MAX_TAGS) || (i == TSDB_TBNAME_COLUMN_INDEX));
-  assert((offset >= 0 && offset < TSDB_MAX_TAGS_LEN) || (offset == TSDB_TBNAME_COLUMN_INDEX));
-
-  pInfo->sch      = *pSchema;
-  pInfo->colIndex = i;
-  pInfo->optr     = pExpr->_node.optr;
-  pInfo->compare  = getComparFunc(pSchema->type, pCond->nType, pInfo->optr);
-
-  tVariantAssign(&pInfo->q, pCond);
-  tVariantTypeSetType(&pInfo->q, pInfo->sch.type);
-}
-
 int32_t doCompare(const char* f1, const char* f2, int32_t type, size_t size) {
   switch (type) {
     case TSDB_DATA_TYPE_INT:        DEFAULT_COMP(GET_INT32_VAL(f1), GET_INT32_VAL(f2));
@@ -1304,7 +1484,7 @@ void createTableGroupImpl(SArray* pGroups, STable** pTables, size_t numOfTables,
       taosArrayPush(g, &p1);
     } else {
       taosArrayPush(pGroups, &g);  // current group is ended, start a new group
-      g = taosArrayInit(16, POINTER_BYTES);
+      g = taosArrayInit(16, sizeof(SPair));
   
       SPair p1 = {.first = pTables[i]};
       taosArrayPush(g, &p1);
@@ -1352,76 +1532,35 @@ SArray* createTableGroup(SArray* pTableList, STSchema* pTagSchema, SColIndex* pC
   return pTableGroup;
 }
 
-bool tSkipListNodeFilterCallback(const void* pNode, void* param) {
-  tQueryInfo* pInfo = (tQueryInfo*)param;
-
-  STable* pTable = *(STable**)(SL_GET_NODE_DATA((SSkipListNode*)pNode));
-
-  char*  val = dataRowTuple(pTable->tagVal);  // todo not only the first column
-  int8_t type = pInfo->sch.type;
-
-  int32_t ret = 0;
-  if (pInfo->q.nType == TSDB_DATA_TYPE_BINARY || pInfo->q.nType == TSDB_DATA_TYPE_NCHAR) {
-    ret = pInfo->compare(val, pInfo->q.pz);
-  } else {
-    tVariant t = {0};
-    tVariantCreateFromBinary(&t, val, (uint32_t)pInfo->sch.bytes, type);
+/*
+ * the table groups are cached with the key of tag schema version, group by columns and the serialized tag condition
+ */
+static char* getTableGroupCacheKey(STable* pSTable, const char* pTagCond, size_t len, SColIndex* pColIndex,
+                                   int32_t numOfCols, int32_t* keyLen) {
+  *keyLen = sizeof(int32_t) * 2 + numOfCols * (sizeof(int16_t) * 2 + sizeof(uint16_t)) + (int32_t)len;
 
-    ret = pInfo->compare(&t.i64Key, &pInfo->q.i64Key);
-  }
+  char* key = malloc(*keyLen);
+  char* p = key;
 
-  switch (pInfo->optr) {
-    case TSDB_RELATION_EQUAL: {
-      return ret == 0;
-    }
-    case TSDB_RELATION_NOT_EQUAL: {
-      return ret != 0;
-    }
-    case TSDB_RELATION_GREATER_EQUAL: {
-      return ret >= 0;
-    }
-    case TSDB_RELATION_GREATER: {
-      return ret > 0;
-    }
-    case TSDB_RELATION_LESS_EQUAL: {
-      return ret <= 0;
-    }
-    case TSDB_RELATION_LESS: {
-      return ret < 0;
-    }
-    case TSDB_RELATION_LIKE: {
-      return ret == 0;
-    }
+  memcpy(p, &pSTable->sversion, sizeof(int32_t));
+  p += sizeof(int32_t);
+  memcpy(p, &numOfCols, sizeof(int32_t));
+  p += sizeof(int32_t);
 
-    default:
-      assert(false);
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    memcpy(p, &pColIndex[i].colId, sizeof(int16_t));
+    p += sizeof(int16_t);
+    memcpy(p, &pColIndex[i].colIndex, sizeof(int16_t));
+    p += sizeof(int16_t);
+    memcpy(p, &pColIndex[i].flag, sizeof(uint16_t));
+    p += sizeof(uint16_t);
   }
-  return true;
-}
 
-static int32_t doQueryTableList(STable* pSTable, SArray* pRes, tExprNode* pExpr) {
-  // query according to the binary expression
-  STSchema* pSchema = pSTable->tagSchema;
-  SSchema*  schema = calloc(schemaNCols(pSchema), sizeof(SSchema));
-  for (int32_t i = 0; i < schemaNCols(pSchema); ++i) {
-    schema[i].colId = schemaColAt(pSchema, i)->colId;
-    schema[i].type = schemaColAt(pSchema, i)->type;
-    schema[i].bytes = schemaColAt(pSchema, i)->bytes;
+  if (len > 0) {
+    memcpy(p, pTagCond, len);
   }
 
-  SExprTreeSupporter s = {.pTagSchema = schema, .numOfTags = schemaNCols(pSTable->tagSchema)};
-
-  SBinaryFilterSupp supp = {
-      .fp = (__result_filter_fn_t)tSkipListNodeFilterCallback, .setupInfoFn = filterPrepare, .pExtInfo = &s,
-      };
-
-  SArray* pTableList = taosArrayInit(8, POINTER_BYTES);
-
-  tExprTreeTraverse(pExpr, pSTable->pIndex, pTableList, &supp);
-  tExprTreeDestroy(&pExpr, destroyHelper);
-
-  convertQueryResult(pRes, pTableList);
-  return TSDB_CODE_SUCCESS;
+  return key;
 }
 
 int32_t tsdbQueryByTagsCond(TsdbRepoT* tsdb, int64_t uid, const char* pTagCond, size_t len, STableGroupInfo* pGroupInfo,
@@ -1432,37 +1571,51 @@ int32_t tsdbQueryByTagsCond(TsdbRepoT* tsdb, int64_t uid, const char* pTagCond,
     uError("failed to get stable, uid:%" PRIu64, uid);
     return TSDB_CODE_INVALID_TABLE_ID;
   }
-  
+
+  // dashboards issue the same query repeatedly, so the table groups are cached until any child table is changed
+  int32_t keyLen = 0;
+  char*   key = getTableGroupCacheKey(pSTable, pTagCond, len, pColIndex, numOfCols, &keyLen);
+  if (tsdbGetTableGroupFromCache(pSTable->pIndex, key, keyLen, pGroupInfo)) {
+    free(key);
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int64_t version = tsdbGetTagIndexVersion(pSTable->pIndex);
+
   SArray* res = taosArrayInit(8, POINTER_BYTES);
   STSchema* pTagSchema = tsdbGetTableTagSchema(tsdbGetMeta(tsdb), pSTable);
-  
+  int32_t ret = TSDB_CODE_SUCCESS;
+
   if (pTagCond == NULL || len == 0) {  // no tags condition, all tables created according to this stable are involved
-    int32_t ret = getAllTableIdList(tsdb, uid, res);
-    if (ret != TSDB_CODE_SUCCESS) {
+    ret = getAllTableIdList(tsdb, uid, res);
+  } else {
+    tExprNode* pExprNode = NULL;
+
+    // failed to build expression, no result, return immediately
+    if (((ret = exprTreeFromBinary(pTagCond, len, &pExprNode)) != TSDB_CODE_SUCCESS) || (pExprNode == NULL)) {
+      uError("stable:%" PRIu64 ", failed to deserialize expression tree, error exists", uid);
       taosArrayDestroy(res);
+      free(key);
       return ret;
     }
-  
-    pGroupInfo->numOfTables = taosArrayGetSize(res);
-    pGroupInfo->pGroupList  = createTableGroup(res, pTagSchema, pColIndex, numOfCols);
-    return ret;
-  }
 
-  tExprNode* pExprNode = NULL;
-  int32_t    ret = TSDB_CODE_SUCCESS;
+    // query according to the binary expression on the tag index of super table
+    ret = tsdbQueryTagIndex(pSTable->pIndex, tsdbGetMeta(tsdb), pExprNode, res);
+    tExprTreeDestroy(&pExprNode, destroyHelper);
+  }
 
-  // failed to build expression, no result, return immediately
-  if ((ret = exprTreeFromBinary(pTagCond, len, &pExprNode) != TSDB_CODE_SUCCESS) || (pExprNode == NULL)) {
-    uError("stable:%" PRIu64 ", failed to deserialize expression tree, error exists", uid);
+  if (ret != TSDB_CODE_SUCCESS) {
     taosArrayDestroy(res);
+    free(key);
     return ret;
   }
 
-  doQueryTableList(pSTable, res, pExprNode);
-  
   pGroupInfo->numOfTables = taosArrayGetSize(res);
   pGroupInfo->pGroupList  = createTableGroup(res, pTagSchema, pColIndex, numOfCols);
+  tsdbPutTableGroupIntoCache(pSTable->pIndex, key, keyLen, version, pGroupInfo);
 
+  taosArrayDestroy(res);
+  free(key);
   return ret;
 }
 
@@ -1501,6 +1654,7 @@ void tsdbCleanupQueryHandle(TsdbQueryHandleT queryHandle) {
     tfree(pTableCheckInfo->pDataCols);
 
     tfree(pTableCheckInfo->pCompInfo);
+    tdFreeDataRow(pTableCheckInfo->pLastRow);
   }
 
   taosArrayDestroy(pQueryHandle->pTableCheckInfo);
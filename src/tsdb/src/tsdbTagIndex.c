@@ -0,0 +1,796 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+#include "hash.h"
+#include "tcompare.h"
+#include "tstoken.h"
+#include "tulog.h"
+#include "../../../query/inc/qast.h"  // todo move to common module
+#include "tsdb.h"
+#include "tsdbMain.h"
+
+/*
+ * The tag index of a super table covers every tag column of its child tables:
+ *  1. the postings of each distinct tag value in a hash table, for equality filters,
+ *  2. the entries in tag value order, which are rebuilt lazily after the child tables are changed, for range filters.
+ * The filter result of each condition is a bitmap of table ids in vnode, so the AND/OR operations of conditions are
+ * the bitwise operations of bitmaps.
+ */
+#define TAG_INDEX_WORDS(n) (((n) + 63) >> 6)
+#define TAG_INDEX_SET(b, i) ((b)[(i) >> 6] |= (1ull << ((i)&63)))
+#define TAG_INDEX_CLEAR(b, i) ((b)[(i) >> 6] &= ~(1ull << ((i)&63)))
+#define TAG_INDEX_ISSET(b, i) (((b)[(i) >> 6] & (1ull << ((i)&63))) != 0)
+
+// max number of cached table groups of each super table
+#define TSDB_TABLE_GROUP_CACHE_SIZE 16
+
+// number of table group cache lookups between two reports of the hit rate
+#define TSDB_TABLE_GROUP_CACHE_STAT_INTERVAL 1000
+
+typedef struct STagIndexEntry {
+  union {
+    int64_t i64Key;
+    double  dKey;
+    char *  pz;
+  };
+  int32_t len;  // only used for binary and nchar
+  int32_t tid;
+} STagIndexEntry;
+
+typedef struct SColumnTagIndex {
+  int8_t        type;
+  int16_t       colId;
+  int32_t       offset;      // offset of the column in the tag row
+  int32_t       nextVarCol;  // next binary/nchar column, whose data is next to the data of this column
+  SHashObj *    pPostings;   // tag value ==> SArray of table id
+  SArray *      pSorted;     // STagIndexEntry in the order of tag value, replaced as a whole once rebuilt
+  bool          dirty;       // the sorted entries need to be rebuilt, guarded by sortLock
+  __compar_fn_t compareFn;
+} SColumnTagIndex;
+
+/*
+ * the table groups resolved from the same tag condition and group by columns are cached, and they are invalidated once
+ * any child table is created or dropped, since the version of tag index is changed
+ */
+typedef struct STableGroupCache {
+  char *          key;
+  int32_t         keyLen;
+  int64_t         version;     // version of tag index when the table groups are created
+  int64_t         lastAccess;  // for evicting the least recently used one
+  STableGroupInfo groupInfo;
+} STableGroupCache;
+
+struct STagIndex {
+  pthread_rwlock_t rwLock;
+  pthread_mutex_t  sortLock;  // concurrent queries may rebuild the sorted entries of the same column
+  int32_t          maxTables;
+  int32_t          numOfTables;
+  int64_t          version;   // increased when child tables are changed
+  uint64_t *       pTables;   // all child tables of the super table
+
+  pthread_mutex_t  cacheLock;
+  int64_t          numOfAccess;
+  int64_t          numOfHits;
+  STableGroupCache cache[TSDB_TABLE_GROUP_CACHE_SIZE];
+
+  int32_t          numOfCols;
+  SColumnTagIndex  cols[];
+};
+
+static FORCE_INLINE bool tsdbIsVarType(int8_t type) {
+  return type == TSDB_DATA_TYPE_BINARY || type == TSDB_DATA_TYPE_NCHAR;
+}
+
+static int32_t tsdbCompareIntEntry(const void *p1, const void *p2) {
+  int64_t v1 = ((STagIndexEntry *)p1)->i64Key;
+  int64_t v2 = ((STagIndexEntry *)p2)->i64Key;
+
+  return (v1 == v2) ? 0 : ((v1 < v2) ? -1 : 1);
+}
+
+static int32_t tsdbCompareDoubleEntry(const void *p1, const void *p2) {
+  double v1 = ((STagIndexEntry *)p1)->dKey;
+  double v2 = ((STagIndexEntry *)p2)->dKey;
+
+  return (v1 == v2) ? 0 : ((v1 < v2) ? -1 : 1);
+}
+
+static int32_t tsdbCompareStrEntry(const void *p1, const void *p2) {
+  STagIndexEntry *e1 = (STagIndexEntry *)p1;
+  STagIndexEntry *e2 = (STagIndexEntry *)p2;
+
+  int32_t ret = memcmp(e1->pz, e2->pz, MIN(e1->len, e2->len));
+  if (ret != 0) {
+    return (ret < 0) ? -1 : 1;
+  }
+
+  return (e1->len == e2->len) ? 0 : ((e1->len < e2->len) ? -1 : 1);
+}
+
+// -0.0 equals to 0.0, but the bytes of them, which are the hash key of postings, are different
+static FORCE_INLINE double tsdbCanonicalDouble(double v) { return (v == 0) ? 0 : v; }
+
+static void tsdbGetTagIndexEntry(STagIndex *pIndex, int32_t col, STable *pTable, STagIndexEntry *pEntry) {
+  SColumnTagIndex *pCol = &pIndex->cols[col];
+  SDataRow         row = pTable->tagVal;
+  char *           val = dataRowAt(row, pCol->offset);
+
+  pEntry->tid = pTable->tableId.tid;
+  pEntry->len = 0;
+
+  switch (pCol->type) {
+    case TSDB_DATA_TYPE_BOOL:
+    case TSDB_DATA_TYPE_TINYINT:   pEntry->i64Key = GET_INT8_VAL(val); break;
+    case TSDB_DATA_TYPE_SMALLINT:  pEntry->i64Key = GET_INT16_VAL(val); break;
+    case TSDB_DATA_TYPE_INT:       pEntry->i64Key = GET_INT32_VAL(val); break;
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_TIMESTAMP: pEntry->i64Key = GET_INT64_VAL(val); break;
+    case TSDB_DATA_TYPE_FLOAT:     pEntry->dKey = tsdbCanonicalDouble(GET_FLOAT_VAL(val)); break;
+    case TSDB_DATA_TYPE_DOUBLE:    pEntry->dKey = tsdbCanonicalDouble(GET_DOUBLE_VAL(val)); break;
+    default: {
+      // the data of binary/nchar columns is appended to the row in the order of columns
+      int32_t start = *(int32_t *)val;
+      int32_t end = dataRowLen(row);
+      if (pCol->nextVarCol >= 0) {
+        end = *(int32_t *)dataRowAt(row, pIndex->cols[pCol->nextVarCol].offset);
+      }
+
+      pEntry->pz = dataRowAt(row, start);
+      pEntry->len = end - start;
+      break;
+    }
+  }
+}
+
+static const char *tsdbGetTagIndexKey(SColumnTagIndex *pCol, STagIndexEntry *pEntry, size_t *keyLen) {
+  if (tsdbIsVarType(pCol->type)) {
+    *keyLen = (size_t)pEntry->len;
+    return pEntry->pz;
+  }
+
+  *keyLen = sizeof(pEntry->i64Key);
+  return (const char *)&pEntry->i64Key;
+}
+
+static void tsdbFreeTagPostings(SColumnTagIndex *pCol) {
+  SHashMutableIterator *pIter = taosHashCreateIter(pCol->pPostings);
+  while (taosHashIterNext(pIter)) {
+    SArray **pList = taosHashIterGet(pIter);
+    taosArrayDestroy(*pList);
+  }
+
+  taosHashDestroyIter(pIter);
+  taosHashCleanup(pCol->pPostings);
+}
+
+static SArray *tsdbCloneTableGroup(SArray *pGroupList) {
+  size_t  numOfGroups = taosArrayGetSize(pGroupList);
+  SArray *pNew = taosArrayInit(numOfGroups, POINTER_BYTES);
+
+  for (int32_t i = 0; i < numOfGroups; ++i) {
+    SArray *group = taosArrayClone(taosArrayGetP(pGroupList, i));
+    taosArrayPush(pNew, &group);
+  }
+
+  return pNew;
+}
+
+static void tsdbDestroyTableGroup(SArray *pGroupList) {
+  if (pGroupList == NULL) return;
+
+  size_t numOfGroups = taosArrayGetSize(pGroupList);
+  for (int32_t i = 0; i < numOfGroups; ++i) {
+    taosArrayDestroy(taosArrayGetP(pGroupList, i));
+  }
+
+  taosArrayDestroy(pGroupList);
+}
+
+STagIndex *tsdbNewTagIndex(STSchema *pTagSchema, int32_t maxTables) {
+  int32_t    numOfCols = schemaNCols(pTagSchema);
+  STagIndex *pIndex = calloc(1, sizeof(STagIndex) + sizeof(SColumnTagIndex) * numOfCols);
+  if (pIndex == NULL) return NULL;
+
+  pIndex->maxTables = maxTables;
+  pIndex->numOfCols = numOfCols;
+  pIndex->pTables = calloc(TAG_INDEX_WORDS(maxTables), sizeof(uint64_t));
+  if (pIndex->pTables == NULL) {
+    free(pIndex);
+    return NULL;
+  }
+
+  int32_t offset = TD_DATA_ROW_HEAD_SIZE;
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    STColumn *       pColSchema = schemaColAt(pTagSchema, i);
+    SColumnTagIndex *pCol = &pIndex->cols[i];
+
+    pCol->type = colType(pColSchema);
+    pCol->colId = colColId(pColSchema);
+    pCol->offset = offset;
+    pCol->nextVarCol = -1;
+    offset += TYPE_BYTES[pCol->type];
+
+    if (tsdbIsVarType(pCol->type)) {
+      for (int32_t j = i - 1; j >= 0 && pIndex->cols[j].nextVarCol < 0; --j) {
+        if (tsdbIsVarType(pIndex->cols[j].type)) pIndex->cols[j].nextVarCol = i;
+      }
+      pCol->compareFn = tsdbCompareStrEntry;
+    } else if (pCol->type == TSDB_DATA_TYPE_FLOAT || pCol->type == TSDB_DATA_TYPE_DOUBLE) {
+      pCol->compareFn = tsdbCompareDoubleEntry;
+    } else {
+      pCol->compareFn = tsdbCompareIntEntry;
+    }
+
+    pCol->pPostings = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false);
+    pCol->pSorted = taosArrayInit(64, sizeof(STagIndexEntry));
+    if (pCol->pPostings == NULL || pCol->pSorted == NULL) {
+      pIndex->numOfCols = i + 1;
+      tsdbFreeTagIndex(pIndex);
+      return NULL;
+    }
+  }
+
+  pthread_rwlock_init(&pIndex->rwLock, NULL);
+  pthread_mutex_init(&pIndex->sortLock, NULL);
+  pthread_mutex_init(&pIndex->cacheLock, NULL);
+
+  return pIndex;
+}
+
+void tsdbFreeTagIndex(STagIndex *pIndex) {
+  if (pIndex == NULL) return;
+
+  for (int32_t i = 0; i < pIndex->numOfCols; ++i) {
+    SColumnTagIndex *pCol = &pIndex->cols[i];
+    if (pCol->pPostings != NULL) tsdbFreeTagPostings(pCol);
+    taosArrayDestroy(pCol->pSorted);
+  }
+
+  for (int32_t i = 0; i < TSDB_TABLE_GROUP_CACHE_SIZE; ++i) {
+    tfree(pIndex->cache[i].key);
+    tsdbDestroyTableGroup(pIndex->cache[i].groupInfo.pGroupList);
+  }
+
+  pthread_rwlock_destroy(&pIndex->rwLock);
+  pthread_mutex_destroy(&pIndex->sortLock);
+  pthread_mutex_destroy(&pIndex->cacheLock);
+
+  tfree(pIndex->pTables);
+  free(pIndex);
+}
+
+// the caller holds the write lock of the index
+static void tsdbAddTagPostings(STagIndex *pIndex, STable *pTable) {
+  int32_t tid = pTable->tableId.tid;
+
+  for (int32_t i = 0; i < pIndex->numOfCols; ++i) {
+    SColumnTagIndex *pCol = &pIndex->cols[i];
+
+    STagIndexEntry entry = {{0}};
+    tsdbGetTagIndexEntry(pIndex, i, pTable, &entry);
+
+    size_t      keyLen = 0;
+    const char *key = tsdbGetTagIndexKey(pCol, &entry, &keyLen);
+
+    SArray **pList = taosHashGet(pCol->pPostings, key, keyLen);
+    if (pList == NULL) {
+      SArray *list = taosArrayInit(4, sizeof(int32_t));
+      taosHashPut(pCol->pPostings, key, keyLen, &list, POINTER_BYTES);
+      pList = taosHashGet(pCol->pPostings, key, keyLen);
+    }
+
+    taosArrayPush(*pList, &tid);
+    pCol->dirty = true;
+  }
+}
+
+// the caller holds the write lock of the index
+static void tsdbRemoveTagPostings(STagIndex *pIndex, STable *pTable) {
+  int32_t tid = pTable->tableId.tid;
+
+  for (int32_t i = 0; i < pIndex->numOfCols; ++i) {
+    SColumnTagIndex *pCol = &pIndex->cols[i];
+
+    STagIndexEntry entry = {{0}};
+    tsdbGetTagIndexEntry(pIndex, i, pTable, &entry);
+
+    size_t      keyLen = 0;
+    const char *key = tsdbGetTagIndexKey(pCol, &entry, &keyLen);
+
+    SArray **pList = taosHashGet(pCol->pPostings, key, keyLen);
+    assert(pList != NULL);
+
+    // the order of table id in postings is not concerned, so move the last one to the removed position
+    SArray *list = *pList;
+    size_t  size = taosArrayGetSize(list);
+    for (int32_t j = 0; j < size; ++j) {
+      int32_t *p = taosArrayGet(list, j);
+      if (*p == tid) {
+        *p = *(int32_t *)taosArrayGet(list, size - 1);
+        taosArrayPop(list);
+        break;
+      }
+    }
+
+    if (taosArrayGetSize(list) == 0) {
+      taosArrayDestroy(list);
+      taosHashRemove(pCol->pPostings, key, keyLen);
+    }
+
+    pCol->dirty = true;
+  }
+}
+
+int tsdbAddTableIntoTagIndex(STagIndex *pIndex, STable *pTable) {
+  int32_t tid = pTable->tableId.tid;
+  assert(tid >= 0 && tid < pIndex->maxTables);
+
+  pthread_rwlock_wrlock(&pIndex->rwLock);
+  if (TAG_INDEX_ISSET(pIndex->pTables, tid)) {
+    pthread_rwlock_unlock(&pIndex->rwLock);
+    return 0;
+  }
+
+  tsdbAddTagPostings(pIndex, pTable);
+
+  TAG_INDEX_SET(pIndex->pTables, tid);
+  pIndex->numOfTables++;
+  atomic_add_fetch_64(&pIndex->version, 1);
+
+  pthread_rwlock_unlock(&pIndex->rwLock);
+  return 0;
+}
+
+int tsdbRemoveTableFromTagIndex(STagIndex *pIndex, STable *pTable) {
+  int32_t tid = pTable->tableId.tid;
+  assert(tid >= 0 && tid < pIndex->maxTables);
+
+  pthread_rwlock_wrlock(&pIndex->rwLock);
+  if (!TAG_INDEX_ISSET(pIndex->pTables, tid)) {
+    pthread_rwlock_unlock(&pIndex->rwLock);
+    return 0;
+  }
+
+  tsdbRemoveTagPostings(pIndex, pTable);
+
+  TAG_INDEX_CLEAR(pIndex->pTables, tid);
+  pIndex->numOfTables--;
+  atomic_add_fetch_64(&pIndex->version, 1);
+
+  pthread_rwlock_unlock(&pIndex->rwLock);
+  return 0;
+}
+
+/*
+ * the tag values of a child table are replaced under the write lock, so a query filters the table either by the old
+ * values or by the new ones. The increased version invalidates the cached table groups of the super table.
+ */
+int tsdbUpdateTableTagInTagIndex(STagIndex *pIndex, STable *pTable, SDataRow tagVal) {
+  int32_t tid = pTable->tableId.tid;
+  assert(tid >= 0 && tid < pIndex->maxTables);
+
+  pthread_rwlock_wrlock(&pIndex->rwLock);
+
+  bool indexed = TAG_INDEX_ISSET(pIndex->pTables, tid);
+  if (indexed) tsdbRemoveTagPostings(pIndex, pTable);
+
+  SDataRow oldTagVal = pTable->tagVal;
+  pTable->tagVal = tagVal;
+
+  if (indexed) tsdbAddTagPostings(pIndex, pTable);
+  atomic_add_fetch_64(&pIndex->version, 1);
+
+  pthread_rwlock_unlock(&pIndex->rwLock);
+
+  tdFreeDataRow(oldTagVal);
+  return 0;
+}
+
+/*
+ * the sorted entries are rebuilt into a new array by the first query after the child tables are changed, and the new
+ * array is published once it is complete, so other queries never see a partially built one. The old array is freed at
+ * once: it is only out of date after a table is added, removed or retagged under the write lock, so no query still
+ * holds it.
+ */
+static SArray *tsdbBuildSortedTagEntries(STagIndex *pIndex, STsdbMeta *pMeta, int32_t col) {
+  SColumnTagIndex *pCol = &pIndex->cols[col];
+
+  pthread_mutex_lock(&pIndex->sortLock);
+  if (!pCol->dirty) {
+    SArray *pSorted = pCol->pSorted;
+    pthread_mutex_unlock(&pIndex->sortLock);
+    return pSorted;
+  }
+
+  SArray *pSorted = taosArrayInit(pIndex->numOfTables + 1, sizeof(STagIndexEntry));
+  if (pSorted == NULL) {
+    pthread_mutex_unlock(&pIndex->sortLock);
+    return NULL;
+  }
+
+  int32_t words = TAG_INDEX_WORDS(pIndex->maxTables);
+  for (int32_t i = 0; i < words; ++i) {
+    uint64_t bits = pIndex->pTables[i];
+    while (bits != 0) {
+      int32_t tid = (i << 6) + BUILDIN_CTZL(bits);
+      bits &= (bits - 1);
+
+      STagIndexEntry entry = {{0}};
+      tsdbGetTagIndexEntry(pIndex, col, pMeta->tables[tid], &entry);
+      taosArrayPush(pSorted, &entry);
+    }
+  }
+
+  qsort(pSorted->pData, taosArrayGetSize(pSorted), sizeof(STagIndexEntry), pCol->compareFn);
+
+  SArray *pOld = atomic_exchange_ptr(&pCol->pSorted, pSorted);
+  taosArrayDestroy(pOld);
+  pCol->dirty = false;
+
+  uTrace("tag index of col:%d is rebuilt, %d entries", pCol->colId, (int32_t)taosArrayGetSize(pSorted));
+  pthread_mutex_unlock(&pIndex->sortLock);
+
+  return pSorted;
+}
+
+/*
+ * position of the first entry that is greater than the key if upper is true, otherwise the first entry that is not
+ * less than the key
+ */
+static size_t tsdbSearchTagEntry(SColumnTagIndex *pCol, SArray *pSorted, STagIndexEntry *pKey, bool upper) {
+  size_t s = 0, e = taosArrayGetSize(pSorted);
+
+  while (s < e) {
+    size_t  mid = s + ((e - s) >> 1);
+    int32_t ret = pCol->compareFn(taosArrayGet(pSorted, mid), pKey);
+
+    if (ret < 0 || (upper && ret == 0)) {
+      s = mid + 1;
+    } else {
+      e = mid;
+    }
+  }
+
+  return s;
+}
+
+static void tsdbSetPostings(SColumnTagIndex *pCol, STagIndexEntry *pKey, uint64_t *pResult, bool set) {
+  size_t      keyLen = 0;
+  const char *key = tsdbGetTagIndexKey(pCol, pKey, &keyLen);
+
+  SArray **pList = taosHashGet(pCol->pPostings, key, keyLen);
+  if (pList == NULL) {
+    return;
+  }
+
+  size_t size = taosArrayGetSize(*pList);
+  for (int32_t i = 0; i < size; ++i) {
+    int32_t tid = *(int32_t *)taosArrayGet(*pList, i);
+    if (set) {
+      TAG_INDEX_SET(pResult, tid);
+    } else {
+      TAG_INDEX_CLEAR(pResult, tid);
+    }
+  }
+}
+
+static bool tsdbIsQualified(uint8_t optr, int32_t ret) {
+  switch (optr) {
+    case TSDB_RELATION_EQUAL:         return ret == 0;
+    case TSDB_RELATION_NOT_EQUAL:     return ret != 0;
+    case TSDB_RELATION_GREATER_EQUAL: return ret >= 0;
+    case TSDB_RELATION_GREATER:       return ret > 0;
+    case TSDB_RELATION_LESS_EQUAL:    return ret <= 0;
+    case TSDB_RELATION_LESS:          return ret < 0;
+    case TSDB_RELATION_LIKE:          return ret == 0;
+    default:                          return false;
+  }
+}
+
+/*
+ * filters that can not be answered by the index, e.g., like operator and the filter on table name, are applied on
+ * every child table
+ */
+static void tsdbScanTagIndex(STagIndex *pIndex, STsdbMeta *pMeta, int32_t col, uint8_t optr, tVariant *pVal,
+                             uint64_t *pResult) {
+  char *        buf = NULL;
+  __compar_fn_t compareFn = NULL;
+
+  if (col == TSDB_TBNAME_COLUMN_INDEX) {
+    compareFn = getComparFunc(TSDB_DATA_TYPE_BINARY, TSDB_DATA_TYPE_BINARY, optr);
+  } else {
+    compareFn = getComparFunc(pIndex->cols[col].type, pIndex->cols[col].type, optr);
+  }
+
+  int32_t words = TAG_INDEX_WORDS(pIndex->maxTables);
+  for (int32_t i = 0; i < words; ++i) {
+    uint64_t bits = pIndex->pTables[i];
+    while (bits != 0) {
+      int32_t tid = (i << 6) + BUILDIN_CTZL(bits);
+      bits &= (bits - 1);
+
+      STable *pTable = pMeta->tables[tid];
+      char *  val = pTable->name;
+
+      if (col != TSDB_TBNAME_COLUMN_INDEX) {
+        STagIndexEntry entry = {{0}};
+        tsdbGetTagIndexEntry(pIndex, col, pTable, &entry);
+
+        // the string in tag row is not null-terminated
+        buf = realloc(buf, entry.len + TSDB_NCHAR_SIZE);
+        memcpy(buf, entry.pz, entry.len);
+        memset(buf + entry.len, 0, TSDB_NCHAR_SIZE);
+        val = buf;
+      }
+
+      if (tsdbIsQualified(optr, compareFn(val, pVal->pz))) {
+        TAG_INDEX_SET(pResult, tid);
+      }
+    }
+  }
+
+  tfree(buf);
+}
+
+static int32_t tsdbFilterByTagCond(STagIndex *pIndex, STsdbMeta *pMeta, tExprNode *pExpr, uint64_t *pResult) {
+  SSchema *pSchema = pExpr->_node.pLeft->pSchema;
+  uint8_t  optr = pExpr->_node.optr;
+  int32_t  words = TAG_INDEX_WORDS(pIndex->maxTables);
+
+  int32_t col = TSDB_TBNAME_COLUMN_INDEX;
+  int8_t  type = TSDB_DATA_TYPE_BINARY;
+  if (strcasecmp(pSchema->name, TSQL_TBNAME_L) != 0) {
+    for (col = 0; col < pIndex->numOfCols && pIndex->cols[col].colId != pSchema->colId; ++col) {
+    }
+
+    if (col == pIndex->numOfCols) {
+      uError("tag column:%s, colId:%d not exists", pSchema->name, pSchema->colId);
+      return TSDB_CODE_INVALID_SQL;
+    }
+
+    type = pIndex->cols[col].type;
+  }
+
+  tVariant q = {0};
+  tVariantAssign(&q, pExpr->_node.pRight->pVal);
+  if (tVariantTypeSetType(&q, type) != 0) {  // no table is qualified for an invalid value
+    tVariantDestroy(&q);
+    return TSDB_CODE_SUCCESS;
+  }
+
+  if (col == TSDB_TBNAME_COLUMN_INDEX || optr == TSDB_RELATION_LIKE) {
+    if (optr == TSDB_RELATION_LIKE && !tsdbIsVarType(type)) {
+      tVariantDestroy(&q);
+      return TSDB_CODE_INVALID_SQL;
+    }
+
+    tsdbScanTagIndex(pIndex, pMeta, col, optr, &q, pResult);
+    tVariantDestroy(&q);
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SColumnTagIndex *pCol = &pIndex->cols[col];
+
+  // the string value in tag row ends at the first '\0', see tdAppendColVal
+  STagIndexEntry key = {{0}};
+  if (tsdbIsVarType(type)) {
+    key.pz = q.pz;
+    key.len = (int32_t)((type == TSDB_DATA_TYPE_BINARY) ? strnlen(q.pz, q.nLen) : strlen(q.pz));
+  } else if (type == TSDB_DATA_TYPE_FLOAT || type == TSDB_DATA_TYPE_DOUBLE) {
+    key.dKey = tsdbCanonicalDouble(q.dKey);
+  } else {
+    key.i64Key = q.i64Key;
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  switch (optr) {
+    case TSDB_RELATION_EQUAL: {
+      tsdbSetPostings(pCol, &key, pResult, true);
+      break;
+    }
+    case TSDB_RELATION_NOT_EQUAL: {
+      memcpy(pResult, pIndex->pTables, words * sizeof(uint64_t));
+      tsdbSetPostings(pCol, &key, pResult, false);
+      break;
+    }
+    case TSDB_RELATION_LESS:
+    case TSDB_RELATION_LESS_EQUAL:
+    case TSDB_RELATION_GREATER:
+    case TSDB_RELATION_GREATER_EQUAL: {
+      SArray *pSorted = tsdbBuildSortedTagEntries(pIndex, pMeta, col);
+      if (pSorted == NULL) {
+        code = TSDB_CODE_SERV_OUT_OF_MEMORY;
+        break;
+      }
+
+      size_t s = 0, e = taosArrayGetSize(pSorted);
+      if (optr == TSDB_RELATION_LESS || optr == TSDB_RELATION_LESS_EQUAL) {
+        e = tsdbSearchTagEntry(pCol, pSorted, &key, optr == TSDB_RELATION_LESS_EQUAL);
+      } else {
+        s = tsdbSearchTagEntry(pCol, pSorted, &key, optr == TSDB_RELATION_GREATER);
+      }
+
+      for (size_t i = s; i < e; ++i) {
+        STagIndexEntry *pEntry = taosArrayGet(pSorted, i);
+        TAG_INDEX_SET(pResult, pEntry->tid);
+      }
+      break;
+    }
+    default: {
+      uError("invalid operator:%d on tag column:%s", optr, pSchema->name);
+      code = TSDB_CODE_INVALID_SQL;
+    }
+  }
+
+  tVariantDestroy(&q);
+  return code;
+}
+
+static int32_t tsdbFilterByTagIndex(STagIndex *pIndex, STsdbMeta *pMeta, tExprNode *pExpr, uint64_t *pResult) {
+  tExprNode *pLeft = pExpr->_node.pLeft;
+  tExprNode *pRight = pExpr->_node.pRight;
+
+  if (pLeft->nodeType != TSQL_NODE_EXPR && pRight->nodeType != TSQL_NODE_EXPR) {
+    assert(pLeft->nodeType == TSQL_NODE_COL && pRight->nodeType == TSQL_NODE_VALUE);
+    return tsdbFilterByTagCond(pIndex, pMeta, pExpr, pResult);
+  }
+
+  uint8_t optr = pExpr->_node.optr;
+  if (optr != TSDB_RELATION_AND && optr != TSDB_RELATION_OR) {
+    uError("invalid logical operator:%d in tag condition", optr);
+    return TSDB_CODE_INVALID_SQL;
+  }
+
+  int32_t code = tsdbFilterByTagIndex(pIndex, pMeta, pLeft, pResult);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  int32_t words = TAG_INDEX_WORDS(pIndex->maxTables);
+
+  // no need to check the right branch if no table is qualified for the left one
+  if (optr == TSDB_RELATION_AND) {
+    int32_t i = 0;
+    while (i < words && pResult[i] == 0) ++i;
+    if (i == words) return TSDB_CODE_SUCCESS;
+  }
+
+  uint64_t *pRightRes = calloc(words, sizeof(uint64_t));
+  if (pRightRes == NULL) {
+    return TSDB_CODE_SERV_OUT_OF_MEMORY;
+  }
+
+  code = tsdbFilterByTagIndex(pIndex, pMeta, pRight, pRightRes);
+  for (int32_t i = 0; i < words; ++i) {
+    if (optr == TSDB_RELATION_AND) {
+      pResult[i] &= pRightRes[i];
+    } else {
+      pResult[i] |= pRightRes[i];
+    }
+  }
+
+  free(pRightRes);
+  return code;
+}
+
+/*
+ * retrieve the child tables that satisfy the tag condition, all child tables are returned if pExpr is NULL
+ */
+int32_t tsdbQueryTagIndex(STagIndex *pIndex, STsdbMeta *pMeta, tExprNode *pExpr, SArray *pRes) {
+  int32_t   words = TAG_INDEX_WORDS(pIndex->maxTables);
+  uint64_t *pResult = calloc(words, sizeof(uint64_t));
+  if (pResult == NULL) {
+    return TSDB_CODE_SERV_OUT_OF_MEMORY;
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+
+  pthread_rwlock_rdlock(&pIndex->rwLock);
+  if (pExpr == NULL) {
+    memcpy(pResult, pIndex->pTables, words * sizeof(uint64_t));
+  } else {
+    code = tsdbFilterByTagIndex(pIndex, pMeta, pExpr, pResult);
+  }
+
+  if (code == TSDB_CODE_SUCCESS) {
+    for (int32_t i = 0; i < words; ++i) {
+      uint64_t bits = pResult[i];
+      while (bits != 0) {
+        int32_t tid = (i << 6) + BUILDIN_CTZL(bits);
+        bits &= (bits - 1);
+
+        STable *pTable = pMeta->tables[tid];
+        taosArrayPush(pRes, &pTable);
+      }
+    }
+  }
+
+  pthread_rwlock_unlock(&pIndex->rwLock);
+
+  free(pResult);
+  return code;
+}
+
+int64_t tsdbGetTagIndexVersion(STagIndex *pIndex) { return atomic_load_64(&pIndex->version); }
+
+static void tsdbUpdateTableGroupCacheStat(STagIndex *pIndex, bool hit) {
+  pIndex->numOfAccess++;
+  if (hit) pIndex->numOfHits++;
+
+  // the hit rate is reported periodically instead of on every lookup
+  if (pIndex->numOfAccess % TSDB_TABLE_GROUP_CACHE_STAT_INTERVAL == 0) {
+    uTrace("table group cache access:%" PRId64 ", hit:%" PRId64 ", hit rate:%.2f%%", pIndex->numOfAccess,
+           pIndex->numOfHits, pIndex->numOfHits * 100.0 / pIndex->numOfAccess);
+  }
+}
+
+bool tsdbGetTableGroupFromCache(STagIndex *pIndex, const char *key, int32_t keyLen, STableGroupInfo *pGroupInfo) {
+  int64_t version = tsdbGetTagIndexVersion(pIndex);
+  bool    hit = false;
+
+  pthread_mutex_lock(&pIndex->cacheLock);
+  for (int32_t i = 0; i < TSDB_TABLE_GROUP_CACHE_SIZE; ++i) {
+    STableGroupCache *pCache = &pIndex->cache[i];
+    if (pCache->key == NULL || pCache->version != version || pCache->keyLen != keyLen ||
+        memcmp(pCache->key, key, keyLen) != 0) {
+      continue;
+    }
+
+    // the table groups are updated by query, so a copy is returned
+    pGroupInfo->numOfTables = pCache->groupInfo.numOfTables;
+    pGroupInfo->pGroupList = tsdbCloneTableGroup(pCache->groupInfo.pGroupList);
+    pCache->lastAccess = pIndex->numOfAccess;
+
+    hit = true;
+    break;
+  }
+
+  tsdbUpdateTableGroupCacheStat(pIndex, hit);
+  pthread_mutex_unlock(&pIndex->cacheLock);
+
+  return hit;
+}
+
+void tsdbPutTableGroupIntoCache(STagIndex *pIndex, const char *key, int32_t keyLen, int64_t version,
+                                STableGroupInfo *pGroupInfo) {
+  pthread_mutex_lock(&pIndex->cacheLock);
+
+  // replace the out of date or the least recently used one
+  STableGroupCache *pCache = &pIndex->cache[0];
+  for (int32_t i = 0; i < TSDB_TABLE_GROUP_CACHE_SIZE; ++i) {
+    STableGroupCache *p = &pIndex->cache[i];
+    if (p->key == NULL || p->version != version) {
+      pCache = p;
+      break;
+    }
+
+    if (p->lastAccess < pCache->lastAccess) {
+      pCache = p;
+    }
+  }
+
+  tfree(pCache->key);
+  tsdbDestroyTableGroup(pCache->groupInfo.pGroupList);
+
+  pCache->key = malloc(keyLen);
+  memcpy(pCache->key, key, keyLen);
+  pCache->keyLen = keyLen;
+  pCache->version = version;
+  pCache->lastAccess = pIndex->numOfAccess;
+  pCache->groupInfo.numOfTables = pGroupInfo->numOfTables;
+  pCache->groupInfo.pGroupList = tsdbCloneTableGroup(pGroupInfo->pGroupList);
+
+  pthread_mutex_unlock(&pIndex->cacheLock);
+}
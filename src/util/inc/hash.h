@@ -25,6 +25,8 @@ extern "C" {
 #define HASH_MAX_CAPACITY (1024 * 1024 * 16)
 #define HASH_DEFAULT_LOAD_FACTOR (0.75)
 #define HASH_INDEX(v, c) ((v) & ((c)-1))
+#define HASH_LOCK_STRIPES 16  // buckets of a thread safe table are guarded by this many locks
+#define HASH_SPLIT_STEPS 2    // buckets split by one put at most, the table grows a few buckets at a time
 
 typedef void (*_hash_free_fn_t)(void *param);
 
@@ -46,18 +48,27 @@ typedef struct SHashEntry {
   uint32_t   num;
 } SHashEntry;
 
+/*
+ * the table grows by linear hashing: when it is too full, the buckets are split one by one in order, each
+ * moving part of its nodes to a new bucket in the upper half, so no put ever rehashes the whole table.
+ * a key stays in the same lock stripe while its bucket is split, a split only locks one stripe.
+ */
 typedef struct SHashObj {
   SHashEntry **   hashList;
-  size_t          capacity;  // number of slots
-  size_t          size;      // number of elements in hash table
-  _hash_fn_t      hashFp;    // hash function
-  _hash_free_fn_t freeFp;    // hash node free callback function
+  size_t          capacity;    // number of slots in hashList, the upper half is filled while buckets are split
+  size_t          size;        // number of elements in hash table
+  int64_t         splitState;  // high 32 bits: log2 of the buckets before the split, low 32 bits: buckets split
+  _hash_fn_t      hashFp;      // hash function
+  _hash_free_fn_t freeFp;      // hash node free callback function
+  SHashEntry ***  retired;     // hashLists replaced when growing, still read by concurrent gets, freed at cleanup
+  int32_t         numOfRetired;
 
 #if defined(LINUX)
-  pthread_rwlock_t *lock;
+  pthread_rwlock_t *lock;      // HASH_LOCK_STRIPES locks, a bucket is guarded by the one of its slot
 #else
   pthread_mutex_t *lock;
 #endif
+  pthread_mutex_t *splitLock;  // buckets are split by one thread at a time
 } SHashObj;
 
 typedef struct SHashMutableIterator {
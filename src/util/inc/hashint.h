@@ -22,5 +22,6 @@ void *sdbAddIntHash(void *handle, void *key, void *pData);
 void sdbDeleteIntHash(void *handle, void *key);
 void *sdbGetIntHashData(void *handle, void *key);
 void *sdbFetchIntHashData(void *handle, void *ptr, void **ppMeta);
+int   sdbGetIntHashNodeSize(void *handle);
 
 #endif
@@ -18,9 +18,11 @@
 
 void *sdbOpenStrHash(int maxSessions, int dataSize);
 void sdbCloseStrHash(void *handle);
+// the key is not copied, it shall stay valid until it is deleted from the hash
 void *sdbAddStrHash(void *handle, void *key, void *pData);
 void sdbDeleteStrHash(void *handle, void *key);
 void *sdbGetStrHashData(void *handle, void *key);
 void *sdbFetchStrHashData(void *handle, void *ptr, void **ppMeta);
+int   sdbGetStrHashNodeSize(void *handle);
 
 #endif
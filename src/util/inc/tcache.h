@@ -23,6 +23,7 @@ extern "C" {
 #include "os.h"
 #include "tref.h"
 #include "hash.h"
+#include "hashfunc.h"
 
 typedef struct SCacheStatis {
   int64_t missCount;
@@ -39,6 +40,9 @@ typedef struct SCacheDataNode {
   uint32_t size;         // allocated size for current SCacheDataNode
   uint16_t keySize : 15;
   bool     inTrash : 1;  // denote if it is in trash or not
+  uint8_t  shard;        // index of the shard this node belongs to
+  bool     accessed;     // referenced since the last eviction scan, gives the node a second chance
+  int8_t   renewing;     // a renew of the data is issued, set only once for each node
   T_REF_DECLARE()
   char *key;
   char  data[];
@@ -50,10 +54,10 @@ typedef struct STrashElem {
   SCacheDataNode *        pData;
 } STrashElem;
 
-typedef struct {
-  int64_t totalSize;  // total allocated buffer in this hash table, SCacheObj is not included.
-  int64_t refreshTime;
-  
+typedef struct SCacheShard {
+  int64_t totalSize;  // allocated buffer of nodes in the hash table of this shard, nodes in trash are not included
+  int64_t maxSize;    // the upper bound of totalSize, 0 means unlimited
+
   /*
    * to accommodate the old datanode which has the same key value of new one in hashList
    * when an new node is put into cache, if an existed one with the same key:
@@ -62,13 +66,11 @@ typedef struct {
    *
    * when the node in pTrash does not be referenced, it will be release at the expired expiredTime
    */
-  STrashElem * pTrash;
-  void *       tmrCtrl;
-  void *       pTimer;
-  SCacheStatis statistics;
-  SHashObj *   pHashTable;
-  int          numOfElemsInTrash;  // number of element in trash
-  int16_t      deleting;           // set the deleting flag to stop refreshing ASAP.
+  STrashElem *pTrash;
+  SHashObj *  pHashTable;
+  int         numOfElemsInTrash;  // number of element in trash
+  int64_t     missCount;
+  int64_t     hitCount;
 
 #if defined(LINUX)
   pthread_rwlock_t lock;
@@ -76,6 +78,21 @@ typedef struct {
   pthread_mutex_t lock;
 #endif
 
+} SCacheShard;
+
+/*
+ * the cache is split into shards by the hash value of key, and every shard has its own hash table, trash and lock,
+ * so threads that access different keys seldom contend for the same lock.
+ */
+typedef struct {
+  int64_t      refreshTime;
+  void *       tmrCtrl;
+  void *       pTimer;
+  SCacheStatis statistics;
+  _hash_fn_t   hashFp;
+  int32_t      numOfShards;
+  SCacheShard *pShards;
+  int16_t      deleting;  // set the deleting flag to stop refreshing ASAP.
 } SCacheObj;
 
 /**
@@ -88,6 +105,15 @@ typedef struct {
  */
 SCacheObj *taosCacheInit(void *tmrCtrl, int64_t refreshTimeInSeconds);
 
+/**
+ * set the upper bound of memory occupied by the cached data. When it is exceeded, the unreferenced nodes that are not
+ * accessed recently are evicted in the clock (second chance) order.
+ *
+ * @param pCacheObj     cache object
+ * @param maxSize       maximum size in bytes, 0 means unlimited
+ */
+void taosCacheSetMaxSize(SCacheObj *pCacheObj, int64_t maxSize);
+
 /**
  * add data into cache
  *
@@ -120,6 +146,17 @@ void *taosCacheAcquireByName(SCacheObj *pCacheObj, const char *key);
  */
 void *taosCacheAcquireByData(SCacheObj *pCacheObj, void *data);
 
+/**
+ * check if the data should be renewed by the caller ahead of its expiration. Only the first caller after the data
+ * enters the last quarter of its lifespan gets true, so one renew is issued for each node, and the renewed data
+ * replaces it with taosCachePut.
+ *
+ * @param pCacheObj     cache object
+ * @param data          referenced data
+ * @return
+ */
+bool taosCacheNeedRenew(SCacheObj *pCacheObj, void *data);
+
 /**
  * transfer the ownership of data in cache to another object without increasing reference count.
  * @param handle
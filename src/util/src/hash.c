@@ -88,14 +88,54 @@ static FORCE_INLINE int32_t taosHashCapacity(int32_t length) {
   return i;
 }
 
+static FORCE_INLINE int64_t taosHashSplitState(int32_t bits, uint32_t numOfSplit) {
+  return (((int64_t)bits) << 32) | numOfSplit;
+}
+
+static FORCE_INLINE int32_t taosHashLog2(size_t capacity) {
+  int32_t bits = 0;
+  while (((size_t)1 << bits) < capacity) bits++;
+  return bits;
+}
+
+/**
+ * the slot of a hash value, the buckets already split in this round are addressed with one more bit
+ * @param splitState  split state of the hash table
+ * @param hashVal     hash value of key
+ * @return
+ */
+static FORCE_INLINE int32_t taosHashSlot(int64_t splitState, uint32_t hashVal) {
+  uint32_t buckets = 1u << (uint32_t)(splitState >> 32);
+  uint32_t slot = HASH_INDEX(hashVal, buckets);
+  if (slot < (uint32_t)splitState) {
+    slot = HASH_INDEX(hashVal, buckets << 1u);
+  }
+
+  return slot;
+}
+
 /**
- * inplace update node in hash table
- * @param pHashObj      hash table object
+ * the lock of the stripe of a hash value, the capacity is never below the number of stripes, so all nodes of
+ * a bucket and of the bucket split from it are in the same stripe
+ */
+static FORCE_INLINE void *taosHashStripeLock(SHashObj *pHashObj, uint32_t hashVal) {
+  if (pHashObj->lock == NULL) {
+    return NULL;
+  }
+
+  return pHashObj->lock + HASH_INDEX(hashVal, HASH_LOCK_STRIPES);
+}
+
+/**
+ * inplace update node in hash table, the links to the node are reset since it may be moved by realloc
+ * @param pEntry    entry of the slot of the node
  * @param pNode     data node
  */
-static void doUpdateHashTable(SHashObj *pHashObj, SHashNode *pNode) {
-  if (pNode->prev1) {
-    pNode->prev1->next = pNode;
+static void doUpdateHashTable(SHashEntry *pEntry, SHashNode *pNode) {
+  if (pNode->prev1 == pEntry) {  // the first node of the linked list
+    pEntry->next = pNode;
+  } else {
+    pNode->prev->next = pNode;
   }
 
   if (pNode->next) {
@@ -104,17 +144,22 @@ static void doUpdateHashTable(SHashObj *pHashObj, SHashNode *pNode) {
 }
 
 /**
- * get SHashNode from hashlist, nodes from trash are not included.
+ * get SHashNode from hashlist, the lock of the stripe of hashVal must be held
  * @param pHashObj  Cache objection
  * @param key       key for hash
  * @param keyLen    key length
+ * @param hashVal   hash value of key
+ * @param ppEntry   return the entry of the slot of key
  * @return
  */
-static SHashNode *doGetNodeFromHashTable(SHashObj *pHashObj, const char *key, uint32_t keyLen, uint32_t *hashVal) {
-  uint32_t hash = (*pHashObj->hashFp)(key, keyLen);
+static SHashNode *doGetNodeFromHashTable(SHashObj *pHashObj, const char *key, uint32_t keyLen, uint32_t hashVal,
+                                         SHashEntry **ppEntry) {
+  // the split state is loaded before the hash list, a slot of a split bucket is always in the list loaded after it
+  int64_t      splitState = atomic_load_64(&pHashObj->splitState);
+  SHashEntry **hashList = atomic_load_ptr(&pHashObj->hashList);
 
-  int32_t     slot = HASH_INDEX(hash, pHashObj->capacity);
-  SHashEntry *pEntry = pHashObj->hashList[slot];
+  int32_t     slot = taosHashSlot(splitState, hashVal);
+  SHashEntry *pEntry = hashList[slot];
 
   SHashNode *pNode = pEntry->next;
   while (pNode) {
@@ -126,111 +171,184 @@ static SHashNode *doGetNodeFromHashTable(SHashObj *pHashObj, const char *key, ui
   }
 
   if (pNode) {
-    assert(HASH_INDEX(pNode->hashVal, pHashObj->capacity) == slot);
+    assert(pNode->hashVal == hashVal);
   }
 
-  // return the calculated hash value, to avoid calculating it again in other functions
-  if (hashVal != NULL) {
-    *hashVal = hash;
+  if (ppEntry != NULL) {
+    *ppEntry = pEntry;
   }
 
   return pNode;
 }
 
 /**
- * resize the hash list if the threshold is reached
+ * insert the hash node at the front of the linked list
  *
- * @param pHashObj
+ * @param pEntry
+ * @param pNode
  */
-static void taosHashTableResize(SHashObj *pHashObj) {
-  if (pHashObj->size < pHashObj->capacity * HASH_DEFAULT_LOAD_FACTOR) {
-    return;
+static void doAddToHashEntry(SHashEntry *pEntry, SHashNode *pNode) {
+  pNode->next = pEntry->next;
+
+  if (pEntry->next) {
+    pEntry->next->prev = pNode;
   }
 
-  // double the original capacity
-  SHashNode *pNode = NULL;
-  SHashNode *pNext = NULL;
+  pEntry->next = pNode;
+  pNode->prev1 = pEntry;
 
-  int32_t newSize = pHashObj->capacity << 1u;
-  if (newSize > HASH_MAX_CAPACITY) {
-//    uTrace("current capacity:%d, maximum capacity:%d, no resize applied due to limitation is reached",
-//           pHashObj->capacity, HASH_MAX_CAPACITY);
-    return;
+  pEntry->num++;
+}
+
+static void doRemoveFromHashEntry(SHashEntry *pEntry, SHashNode *pNode) {
+  if (pEntry->next == pNode) {  // the next node becomes the first one, which links back to the entry
+    pEntry->next = pNode->next;
+    if (pNode->next != NULL) {
+      (pNode->next)->prev1 = pEntry;
+    }
+  } else {
+    pNode->prev->next = pNode->next;
+    if (pNode->next != NULL) {
+      (pNode->next)->prev = pNode->prev;
+    }
   }
 
-//  int64_t st = taosGetTimestampUs();
+  pEntry->num--;
+  assert(pEntry->num >= 0);
 
-  SHashEntry **pNewEntry = realloc(pHashObj->hashList, sizeof(SHashEntry *) * newSize);
-  if (pNewEntry == NULL) {
-//    uTrace("cache resize failed due to out of memory, capacity remain:%d", pHashObj->capacity);
-    return;
+  pNode->next = NULL;
+  pNode->prev = NULL;
+}
+
+/**
+ * double the slots of hash list before the buckets are split again. the slots of the upper half are left empty, the
+ * entry of each is allocated when its bucket is split. gets of other threads may still read the old list, it is kept
+ * until the hash table is cleaned up
+ *
+ * @param pHashObj
+ * @return
+ */
+static bool taosHashExpandList(SHashObj *pHashObj) {
+  size_t newSize = pHashObj->capacity << 1u;
+  if (newSize > HASH_MAX_CAPACITY) {
+    return false;
   }
 
-  pHashObj->hashList = pNewEntry;
-  for (int32_t i = pHashObj->capacity; i < newSize; ++i) {
-    pHashObj->hashList[i] = calloc(1, sizeof(SHashEntry));
+  SHashEntry **pNewList = (SHashEntry **)calloc(newSize, sizeof(SHashEntry *));
+  if (pNewList == NULL) {
+    uError("failed to allocate memory for hash list, capacity remain:%zu", pHashObj->capacity);
+    return false;
+  }
+
+  if (pHashObj->lock != NULL) {
+    SHashEntry ***retired = realloc(pHashObj->retired, sizeof(SHashEntry **) * (pHashObj->numOfRetired + 1));
+    if (retired == NULL) {
+      free(pNewList);
+      return false;
+    }
+
+    pHashObj->retired = retired;
   }
 
+  SHashEntry **pOldList = pHashObj->hashList;
+  memcpy(pNewList, pOldList, sizeof(SHashEntry *) * pHashObj->capacity);
+
+  atomic_store_ptr(&pHashObj->hashList, pNewList);
   pHashObj->capacity = newSize;
 
-  for (int32_t i = 0; i < pHashObj->capacity; ++i) {
-    SHashEntry *pEntry = pHashObj->hashList[i];
+  if (pHashObj->lock != NULL) {
+    pHashObj->retired[pHashObj->numOfRetired++] = pOldList;
+  } else {
+    free(pOldList);
+  }
 
-    pNode = pEntry->next;
-    if (pNode != NULL) {
-      assert(pNode->prev1 == pEntry && pEntry->num > 0);
-    }
+  return true;
+}
 
-    while (pNode) {
-      int32_t j = HASH_INDEX(pNode->hashVal, pHashObj->capacity);
-      if (j == i) {  // this key resides in the same slot, no need to relocate it
-        pNode = pNode->next;
-      } else {
-        pNext = pNode->next;
+/**
+ * split the next bucket, nodes whose hash value has the new bit set are moved to the bucket in the upper half
+ *
+ * @param pHashObj
+ * @return false if the table can not grow any more
+ */
+static bool taosHashSplitBucket(SHashObj *pHashObj) {
+  int64_t  splitState = pHashObj->splitState;
+  int32_t  bits = (int32_t)(splitState >> 32);
+  uint32_t buckets = 1u << bits;
+  uint32_t slot = (uint32_t)splitState;
 
-        // remove from current slot
-        assert(pNode->prev1 != NULL);
+  if (slot == 0 && pHashObj->capacity <= buckets && !taosHashExpandList(pHashObj)) {
+    return false;
+  }
 
-        if (pNode->prev1 == pEntry) {  // first node of the overflow linked list
-          pEntry->next = pNode->next;
-        } else {
-          pNode->prev->next = pNode->next;
-        }
+  // the upper slot is not addressed until the split is published below, so its entry is set up without the lock
+  SHashEntry *pNewEntry = pHashObj->hashList[slot + buckets];
+  if (pNewEntry == NULL) {
+    pNewEntry = calloc(1, sizeof(SHashEntry));
+    if (pNewEntry == NULL) {
+      uError("failed to allocate memory for hash entry, slot:%u", slot + buckets);
+      return false;
+    }
 
-        pEntry->num--;
-        assert(pEntry->num >= 0);
+    pHashObj->hashList[slot + buckets] = pNewEntry;
+  }
 
-        if (pNode->next != NULL) {
-          (pNode->next)->prev = pNode->prev;
-        }
+  void *lock = taosHashStripeLock(pHashObj, slot);
+  __wr_lock(lock);
+
+  SHashEntry *pEntry = pHashObj->hashList[slot];
+  SHashNode * pNode = pEntry->next;
+  while (pNode) {
+    SHashNode *pNext = pNode->next;
+    if (HASH_INDEX(pNode->hashVal, buckets << 1u) != slot) {
+      doRemoveFromHashEntry(pEntry, pNode);
+      doAddToHashEntry(pNewEntry, pNode);
+    }
 
-        // added into new slot
-        pNode->next = NULL;
-        pNode->prev1 = NULL;
+    pNode = pNext;
+  }
 
-        SHashEntry *pNewIndexEntry = pHashObj->hashList[j];
+  // the bucket is addressed with one more bit from now on, when all are split, this is the start of next round
+  if (slot + 1 == buckets) {
+    atomic_store_64(&pHashObj->splitState, taosHashSplitState(bits + 1, 0));
+  } else {
+    atomic_store_64(&pHashObj->splitState, taosHashSplitState(bits, slot + 1));
+  }
 
-        if (pNewIndexEntry->next != NULL) {
-          assert(pNewIndexEntry->next->prev1 == pNewIndexEntry);
+  __unlock(lock);
+  return true;
+}
 
-          pNewIndexEntry->next->prev = pNode;
-        }
+static FORCE_INLINE bool taosHashNeedSplit(SHashObj *pHashObj) {
+  int64_t splitState = atomic_load_64(&pHashObj->splitState);
+  size_t  buckets = ((size_t)1 << (splitState >> 32)) + (uint32_t)splitState;
+  return atomic_load_64(&pHashObj->size) >= buckets * HASH_DEFAULT_LOAD_FACTOR;
+}
 
-        pNode->next = pNewIndexEntry->next;
-        pNode->prev1 = pNewIndexEntry;
+/**
+ * split a few buckets if the threshold is reached, the cost of growing is spread over the puts
+ *
+ * @param pHashObj
+ */
+static void taosHashTableResize(SHashObj *pHashObj) {
+  if (!taosHashNeedSplit(pHashObj)) {
+    return;
+  }
 
-        pNewIndexEntry->next = pNode;
-        pNewIndexEntry->num++;
+  // another thread is splitting the buckets, leave the work to it
+  if (pHashObj->splitLock != NULL && pthread_mutex_trylock(pHashObj->splitLock) != 0) {
+    return;
+  }
 
-        // continue
-        pNode = pNext;
-      }
+  for (int32_t i = 0; i < HASH_SPLIT_STEPS && taosHashNeedSplit(pHashObj); ++i) {
+    if (!taosHashSplitBucket(pHashObj)) {
+      break;
     }
   }
 
-//  int64_t et = taosGetTimestampUs();
-//  uTrace("hash table resize completed, new capacity:%d, load factor:%f, elapsed time:%fms", pHashObj->capacity,
-//         ((double)pHashObj->size) / pHashObj->capacity, (et - st) / 1000.0);
+  if (pHashObj->splitLock != NULL) {
+    pthread_mutex_unlock(pHashObj->splitLock);
+  }
 }
 
 /**
@@ -250,9 +368,10 @@ SHashObj *taosHashInit(size_t capacity, _hash_fn_t fn, bool threadsafe) {
   }
 
   // the max slots is not defined by user
-  pHashObj->capacity = taosHashCapacity(capacity);
+  pHashObj->capacity = taosHashCapacity(threadsafe ? MAX(capacity, HASH_LOCK_STRIPES) : capacity);
   assert((pHashObj->capacity & (pHashObj->capacity - 1)) == 0);
 
+  pHashObj->splitState = taosHashSplitState(taosHashLog2(pHashObj->capacity), 0);
   pHashObj->hashFp = fn;
 
   pHashObj->hashList = (SHashEntry **)calloc(pHashObj->capacity, sizeof(SHashEntry *));
@@ -268,18 +387,29 @@ SHashObj *taosHashInit(size_t capacity, _hash_fn_t fn, bool threadsafe) {
 
   if (threadsafe) {
 #if defined(LINUX)
-    pHashObj->lock = calloc(1, sizeof(pthread_rwlock_t));
+    pHashObj->lock = calloc(HASH_LOCK_STRIPES, sizeof(pthread_rwlock_t));
 #else
-    pHashObj->lock = calloc(1, sizeof(pthread_mutex_t));
+    pHashObj->lock = calloc(HASH_LOCK_STRIPES, sizeof(pthread_mutex_t));
 #endif
-  }
+    pHashObj->splitLock = calloc(1, sizeof(pthread_mutex_t));
 
-  if (__lock_init(pHashObj->lock) != 0) {
-    free(pHashObj->hashList);
-    free(pHashObj);
+    int32_t code = pthread_mutex_init(pHashObj->splitLock, NULL);
+    for (int32_t i = 0; i < HASH_LOCK_STRIPES && code == 0; ++i) {
+      code = __lock_init(pHashObj->lock + i);
+    }
 
-    uError("failed to init lock, reason:%s", strerror(errno));
-    return NULL;
+    if (code != 0) {
+      for (int32_t i = 0; i < pHashObj->capacity; ++i) {
+        free(pHashObj->hashList[i]);
+      }
+      free(pHashObj->hashList);
+      free(pHashObj->lock);
+      free(pHashObj->splitLock);
+      free(pHashObj);
+
+      uError("failed to init lock, reason:%s", strerror(errno));
+      return NULL;
+    }
   }
 
   return pHashObj;
@@ -316,7 +446,7 @@ static SHashNode *doCreateHashNode(const char *key, size_t keyLen, const char *p
 
 static SHashNode *doUpdateHashNode(SHashNode *pNode, const char *key, size_t keyLen, const char *pData,
                                    size_t dataSize) {
-  size_t size = dataSize + sizeof(SHashNode) + keyLen;
+  size_t size = dataSize + sizeof(SHashNode) + keyLen + 1;  // the key is still null-terminated
 
   SHashNode *pNewNode = (SHashNode *)realloc(pNode, size);
   if (pNewNode == NULL) {
@@ -333,37 +463,12 @@ static SHashNode *doUpdateHashNode(SHashNode *pNode, const char *key, size_t key
   return pNewNode;
 }
 
-/**
- * insert the hash node at the front of the linked list
- *
- * @param pHashObj
- * @param pNode
- */
-static void doAddToHashTable(SHashObj *pHashObj, SHashNode *pNode) {
-  assert(pNode != NULL);
-
-  int32_t     index = HASH_INDEX(pNode->hashVal, pHashObj->capacity);
-  SHashEntry *pEntry = pHashObj->hashList[index];
-
-  pNode->next = pEntry->next;
-
-  if (pEntry->next) {
-    pEntry->next->prev = pNode;
-  }
-
-  pEntry->next = pNode;
-  pNode->prev1 = pEntry;
-
-  pEntry->num++;
-  pHashObj->size++;
-}
-
 size_t taosHashGetSize(const SHashObj *pHashObj) {
   if (pHashObj == NULL) {
     return 0;
   }
 
-  return pHashObj->size;
+  return atomic_load_64(&((SHashObj *)pHashObj)->size);
 }
 
 /**
@@ -372,47 +477,54 @@ size_t taosHashGetSize(const SHashObj *pHashObj) {
  * @param pNode   hash node
  */
 int32_t taosHashPut(SHashObj *pHashObj, const char *key, size_t keyLen, void *data, size_t size) {
-  __wr_lock(pHashObj->lock);
+  uint32_t hashVal = (*pHashObj->hashFp)(key, keyLen);
+  void *   lock = taosHashStripeLock(pHashObj, hashVal);
 
-  uint32_t   hashVal = 0;
-  SHashNode *pNode = doGetNodeFromHashTable(pHashObj, key, keyLen, &hashVal);
+  __wr_lock(lock);
 
-  if (pNode == NULL) {  // no data in hash table with the specified key, add it into hash table
-    taosHashTableResize(pHashObj);
+  SHashEntry *pEntry = NULL;
+  SHashNode * pNode = doGetNodeFromHashTable(pHashObj, key, keyLen, hashVal, &pEntry);
 
+  if (pNode == NULL) {  // no data in hash table with the specified key, add it into hash table
     SHashNode *pNewNode = doCreateHashNode(key, keyLen, data, size, hashVal);
     if (pNewNode == NULL) {
-      __unlock(pHashObj->lock);
+      __unlock(lock);
 
       return -1;
     }
 
-    doAddToHashTable(pHashObj, pNewNode);
+    doAddToHashEntry(pEntry, pNewNode);
+    if (lock != NULL) {
+      atomic_add_fetch_64(&pHashObj->size, 1);
+    } else {
+      pHashObj->size++;
+    }
+    __unlock(lock);
+
+    taosHashTableResize(pHashObj);
   } else {
     SHashNode *pNewNode = doUpdateHashNode(pNode, key, keyLen, data, size);
     if (pNewNode == NULL) {
-      __unlock(pHashObj->lock);
+      __unlock(lock);
       return -1;
     }
 
-    doUpdateHashTable(pHashObj, pNewNode);
+    doUpdateHashTable(pEntry, pNewNode);
+    __unlock(lock);
   }
 
-  __unlock(pHashObj->lock);
   return 0;
 }
 
 void *taosHashGet(SHashObj *pHashObj, const char *key, size_t keyLen) {
-  __rd_lock(pHashObj->lock);
-
-  uint32_t   hashVal = 0;
-  SHashNode *pNode = doGetNodeFromHashTable(pHashObj, key, keyLen, &hashVal);
+  uint32_t hashVal = (*pHashObj->hashFp)(key, keyLen);
+  void *   lock = taosHashStripeLock(pHashObj, hashVal);
 
-  __unlock(pHashObj->lock);
+  __rd_lock(lock);
+  SHashNode *pNode = doGetNodeFromHashTable(pHashObj, key, keyLen, hashVal, NULL);
+  __unlock(lock);
 
   if (pNode != NULL) {
-    assert(pNode->hashVal == hashVal);
-
     return pNode->data;
   } else {
     return NULL;
@@ -425,41 +537,27 @@ void *taosHashGet(SHashObj *pHashObj, const char *key, size_t keyLen) {
  * @param pNode
  */
 void taosHashRemove(SHashObj *pHashObj, const char *key, size_t keyLen) {
-  __wr_lock(pHashObj->lock);
+  uint32_t hashVal = (*pHashObj->hashFp)(key, keyLen);
+  void *   lock = taosHashStripeLock(pHashObj, hashVal);
+
+  __wr_lock(lock);
 
-  uint32_t   val = 0;
-  SHashNode *pNode = doGetNodeFromHashTable(pHashObj, key, keyLen, &val);
+  SHashEntry *pEntry = NULL;
+  SHashNode * pNode = doGetNodeFromHashTable(pHashObj, key, keyLen, hashVal, &pEntry);
   if (pNode == NULL) {
-    __unlock(pHashObj->lock);
+    __unlock(lock);
     return;
   }
 
-  SHashNode *pNext = pNode->next;
-  if (pNode->prev != NULL) {
-    int32_t slot = HASH_INDEX(val, pHashObj->capacity);
-    if (pHashObj->hashList[slot]->next == pNode) {
-      pHashObj->hashList[slot]->next = pNext;
-    } else {
-      pNode->prev->next = pNext;
-    }
-  }
-
-  if (pNext != NULL) {
-    pNext->prev = pNode->prev;
+  doRemoveFromHashEntry(pEntry, pNode);
+  if (lock != NULL) {
+    atomic_sub_fetch_64(&pHashObj->size, 1);
+  } else {
+    pHashObj->size--;
   }
 
-  uint32_t index = HASH_INDEX(pNode->hashVal, pHashObj->capacity);
-
-  SHashEntry *pEntry = pHashObj->hashList[index];
-  pEntry->num--;
-
-  pHashObj->size--;
-
-  pNode->next = NULL;
-  pNode->prev = NULL;
-
   tfree(pNode);
-  __unlock(pHashObj->lock);
+  __unlock(lock);
 }
 
 void taosHashCleanup(SHashObj *pHashObj) {
@@ -469,13 +567,14 @@ void taosHashCleanup(SHashObj *pHashObj) {
 
   SHashNode *pNode, *pNext;
 
-  __wr_lock(pHashObj->lock);
-
   if (pHashObj->hashList) {
     for (int32_t i = 0; i < pHashObj->capacity; ++i) {
       SHashEntry *pEntry = pHashObj->hashList[i];
-      pNode = pEntry->next;
+      if (pEntry == NULL) {  // not split yet
+        continue;
+      }
 
+      pNode = pEntry->next;
       while (pNode) {
         pNext = pNode->next;
         if (pHashObj->freeFp) {
@@ -492,10 +591,20 @@ void taosHashCleanup(SHashObj *pHashObj) {
     free(pHashObj->hashList);
   }
 
-  __unlock(pHashObj->lock);
-  __lock_destroy(pHashObj->lock);
+  for (int32_t i = 0; i < pHashObj->numOfRetired; ++i) {
+    free(pHashObj->retired[i]);
+  }
+  tfree(pHashObj->retired);
+
+  if (pHashObj->lock != NULL) {
+    for (int32_t i = 0; i < HASH_LOCK_STRIPES; ++i) {
+      __lock_destroy(pHashObj->lock + i);
+    }
+    pthread_mutex_destroy(pHashObj->splitLock);
+  }
 
   tfree(pHashObj->lock);
+  tfree(pHashObj->splitLock);
   memset(pHashObj, 0, sizeof(SHashObj));
   free(pHashObj);
 }
@@ -521,9 +630,11 @@ SHashMutableIterator *taosHashCreateIter(SHashObj *pHashObj) {
 static SHashNode *getNextHashNode(SHashMutableIterator *pIter) {
   assert(pIter != NULL);
 
+  // the linked list of current entry is exhausted, start from the next entry
+  pIter->entryIndex++;
   while (pIter->entryIndex < pIter->pHashObj->capacity) {
     SHashEntry *pEntry = pIter->pHashObj->hashList[pIter->entryIndex];
-    if (pEntry->next == NULL) {
+    if (pEntry == NULL || pEntry->next == NULL) {
       pIter->entryIndex++;
       continue;
     }
@@ -550,7 +661,7 @@ bool taosHashIterNext(SHashMutableIterator *pIter) {
 
     while (1) {
       SHashEntry *pEntry = pIter->pHashObj->hashList[pIter->entryIndex];
-      if (pEntry->next == NULL) {
+      if (pEntry == NULL || pEntry->next == NULL) {
         pIter->entryIndex++;
         continue;
       }
@@ -607,9 +718,9 @@ int32_t taosHashGetMaxOverflowLinkLength(const SHashObj *pHashObj) {
 
   int32_t num = 0;
 
-  for (int32_t i = 0; i < pHashObj->size; ++i) {
+  for (int32_t i = 0; i < pHashObj->capacity; ++i) {
     SHashEntry *pEntry = pHashObj->hashList[i];
-    if (num < pEntry->num) {
+    if (pEntry != NULL && num < pEntry->num) {
       num = pEntry->num;
     }
   }
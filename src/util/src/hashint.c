@@ -199,3 +199,10 @@ void *sdbFetchIntHashData(void *handle, void *ptr, void **ppMeta) {
 
   return pNode;
 }
+
+int sdbGetIntHashNodeSize(void *handle) {
+  SHashObj *pObj = (SHashObj *)handle;
+  if (pObj == NULL) return 0;
+
+  return sizeof(SLongHash) + pObj->dataSize;
+}
@@ -19,7 +19,7 @@
 #define MAX_STR_LEN 40
 
 typedef struct _str_node_t {
-  char                string[TSDB_TABLE_ID_LEN];
+  char *              string;  // owned by the caller, see sdbAddStrHash
   int                 hash;
   struct _str_node_t *prev;
   struct _str_node_t *next;
@@ -72,7 +72,7 @@ void *sdbAddStrHash(void *handle, void *key, void *pData) {
   int size = sizeof(SHashNode) + pObj->dataSize;
   pNode = (SHashNode *)malloc(size);
   memset(pNode, 0, size);
-  strcpy(pNode->string, string);
+  pNode->string = string;
   memcpy(pNode->data, pData, pObj->dataSize);
   pNode->prev = 0;
   pNode->next = pObj->hashList[hash];
@@ -212,3 +212,10 @@ void *sdbFetchStrHashData(void *handle, void *ptr, void **ppMeta) {
 
   return pNode;
 }
+
+int sdbGetStrHashNodeSize(void *handle) {
+  SHashObj *pObj = (SHashObj *)handle;
+  if (pObj == NULL) return 0;
+
+  return sizeof(SHashNode) + pObj->dataSize;
+}
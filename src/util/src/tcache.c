@@ -23,43 +23,45 @@
 #include "hash.h"
 #include "hashfunc.h"
 
-static FORCE_INLINE void __cache_wr_lock(SCacheObj *pCacheObj) {
+#define CACHE_NUM_OF_SHARDS 32
+
+static FORCE_INLINE void __cache_wr_lock(SCacheShard *pShard) {
 #if defined(LINUX)
-  pthread_rwlock_wrlock(&pCacheObj->lock);
+  pthread_rwlock_wrlock(&pShard->lock);
 #else
-  pthread_mutex_lock(&pCacheObj->lock);
+  pthread_mutex_lock(&pShard->lock);
 #endif
 }
 
-static FORCE_INLINE void __cache_rd_lock(SCacheObj *pCacheObj) {
+static FORCE_INLINE void __cache_rd_lock(SCacheShard *pShard) {
 #if defined(LINUX)
-  pthread_rwlock_rdlock(&pCacheObj->lock);
+  pthread_rwlock_rdlock(&pShard->lock);
 #else
-  pthread_mutex_lock(&pCacheObj->lock);
+  pthread_mutex_lock(&pShard->lock);
 #endif
 }
 
-static FORCE_INLINE void __cache_unlock(SCacheObj *pCacheObj) {
+static FORCE_INLINE void __cache_unlock(SCacheShard *pShard) {
 #if defined(LINUX)
-  pthread_rwlock_unlock(&pCacheObj->lock);
+  pthread_rwlock_unlock(&pShard->lock);
 #else
-  pthread_mutex_unlock(&pCacheObj->lock);
+  pthread_mutex_unlock(&pShard->lock);
 #endif
 }
 
-static FORCE_INLINE int32_t __cache_lock_init(SCacheObj *pCacheObj) {
+static FORCE_INLINE int32_t __cache_lock_init(SCacheShard *pShard) {
 #if defined(LINUX)
-  return pthread_rwlock_init(&pCacheObj->lock, NULL);
+  return pthread_rwlock_init(&pShard->lock, NULL);
 #else
-  return pthread_mutex_init(&pCacheObj->lock, NULL);
+  return pthread_mutex_init(&pShard->lock, NULL);
 #endif
 }
 
-static FORCE_INLINE void __cache_lock_destroy(SCacheObj *pCacheObj) {
+static FORCE_INLINE void __cache_lock_destroy(SCacheShard *pShard) {
 #if defined(LINUX)
-  pthread_rwlock_destroy(&pCacheObj->lock);
+  pthread_rwlock_destroy(&pShard->lock);
 #else
-  pthread_mutex_destroy(&pCacheObj->lock);
+  pthread_mutex_destroy(&pShard->lock);
 #endif
 }
 
@@ -68,6 +70,15 @@ static FORCE_INLINE void taosFreeNode(void *data) {
   free(pNode);
 }
 
+/*
+ * the lower bits of hash value are used to locate the slot in the hash table of shard, so the shard is picked by
+ * higher bits to keep keys evenly distributed in both levels.
+ */
+static FORCE_INLINE int32_t taosCacheGetShardIndex(SCacheObj *pCacheObj, const char *key, size_t keyLen) {
+  uint32_t hashVal = (*pCacheObj->hashFp)(key, (uint32_t)keyLen);
+  return (int32_t)((hashVal >> 24) % pCacheObj->numOfShards);
+}
+
 /**
  * @param key      key of object for hash, usually a null-terminated string
  * @param keyLen   length of key
@@ -79,7 +90,8 @@ static FORCE_INLINE void taosFreeNode(void *data) {
  */
 static SCacheDataNode *taosCreateHashNode(const char *key, size_t keyLen, const char *pData, size_t size,
                                           uint64_t duration) {
-  size_t totalSize = size + sizeof(SCacheDataNode) + keyLen;
+  // the key is null-terminated, since it is printed as a string
+  size_t totalSize = size + sizeof(SCacheDataNode) + keyLen + 1;
   
   SCacheDataNode *pNewNode = calloc(1, totalSize);
   if (pNewNode == NULL) {
@@ -106,10 +118,10 @@ static SCacheDataNode *taosCreateHashNode(const char *key, size_t keyLen, const
 /**
  * addedTime object node into trash, and this object is closed for referencing if it is addedTime to trash
  * It will be removed until the pNode->refCount == 0
- * @param pCacheObj    Cache object
+ * @param pShard  Cache shard
  * @param pNode   Cache slot object
  */
-static void taosAddToTrash(SCacheObj *pCacheObj, SCacheDataNode *pNode) {
+static void taosAddToTrash(SCacheShard *pShard, SCacheDataNode *pNode) {
   if (pNode->inTrash) { /* node is already in trash */
     return;
   }
@@ -117,31 +129,31 @@ static void taosAddToTrash(SCacheObj *pCacheObj, SCacheDataNode *pNode) {
   STrashElem *pElem = calloc(1, sizeof(STrashElem));
   pElem->pData = pNode;
   
-  pElem->next = pCacheObj->pTrash;
-  if (pCacheObj->pTrash) {
-    pCacheObj->pTrash->prev = pElem;
+  pElem->next = pShard->pTrash;
+  if (pShard->pTrash) {
+    pShard->pTrash->prev = pElem;
   }
   
   pElem->prev = NULL;
-  pCacheObj->pTrash = pElem;
+  pShard->pTrash = pElem;
   
   pNode->inTrash = true;
-  pCacheObj->numOfElemsInTrash++;
+  pShard->numOfElemsInTrash++;
   
-  uTrace("key:%s %p move to trash, numOfElem in trash:%d", pNode->key, pNode, pCacheObj->numOfElemsInTrash);
+  uTrace("key:%s %p move to trash, numOfElem in trash:%d", pNode->key, pNode, pShard->numOfElemsInTrash);
 }
 
-static void taosRemoveFromTrash(SCacheObj *pCacheObj, STrashElem *pElem) {
+static void taosRemoveFromTrash(SCacheShard *pShard, STrashElem *pElem) {
   if (pElem->pData->signature != (uint64_t)pElem->pData) {
     uError("key:sig:%d %p data has been released, ignore", pElem->pData->signature, pElem->pData);
     return;
   }
   
-  pCacheObj->numOfElemsInTrash--;
+  pShard->numOfElemsInTrash--;
   if (pElem->prev) {
     pElem->prev->next = pElem->next;
   } else { /* pnode is the header, update header */
-    pCacheObj->pTrash = pElem->next;
+    pShard->pTrash = pElem->next;
   }
   
   if (pElem->next) {
@@ -154,25 +166,24 @@ static void taosRemoveFromTrash(SCacheObj *pCacheObj, STrashElem *pElem) {
 }
 /**
  * remove nodes in trash with refCount == 0 in cache
- * @param pNode
- * @param pCacheObj
+ * @param pShard
  * @param force   force model, if true, remove data in trash without check refcount.
  *                may cause corruption. So, forece model only applys before cache is closed
  */
-static void taosTrashEmpty(SCacheObj *pCacheObj, bool force) {
-  __cache_wr_lock(pCacheObj);
+static void taosTrashEmpty(SCacheShard *pShard, bool force) {
+  __cache_wr_lock(pShard);
   
-  if (pCacheObj->numOfElemsInTrash == 0) {
-    if (pCacheObj->pTrash != NULL) {
-      uError("key:inconsistency data in cache, numOfElem in trash:%d", pCacheObj->numOfElemsInTrash);
+  if (pShard->numOfElemsInTrash == 0) {
+    if (pShard->pTrash != NULL) {
+      uError("key:inconsistency data in cache, numOfElem in trash:%d", pShard->numOfElemsInTrash);
     }
-    pCacheObj->pTrash = NULL;
+    pShard->pTrash = NULL;
     
-    __cache_unlock(pCacheObj);
+    __cache_unlock(pShard);
     return;
   }
   
-  STrashElem *pElem = pCacheObj->pTrash;
+  STrashElem *pElem = pShard->pTrash;
   
   while (pElem) {
     T_REF_VAL_CHECK(pElem->pData);
@@ -182,51 +193,56 @@ static void taosTrashEmpty(SCacheObj *pCacheObj, bool force) {
     
     if (force || (T_REF_VAL_GET(pElem->pData) == 0)) {
       uTrace("key:%s %p removed from trash. numOfElem in trash:%d", pElem->pData->key, pElem->pData,
-             pCacheObj->numOfElemsInTrash - 1);
+             pShard->numOfElemsInTrash - 1);
       STrashElem *p = pElem;
       
       pElem = pElem->next;
-      taosRemoveFromTrash(pCacheObj, p);
+      taosRemoveFromTrash(pShard, p);
     } else {
       pElem = pElem->next;
     }
   }
   
-  assert(pCacheObj->numOfElemsInTrash >= 0);
-  __cache_unlock(pCacheObj);
+  assert(pShard->numOfElemsInTrash >= 0);
+  __cache_unlock(pShard);
 }
 
 /**
  * release node
- * @param pCacheObj      cache object
+ * @param pShard    cache shard
  * @param pNode     data node
  */
-static FORCE_INLINE void taosCacheReleaseNode(SCacheObj *pCacheObj, SCacheDataNode *pNode) {
+static FORCE_INLINE void taosCacheReleaseNode(SCacheShard *pShard, SCacheDataNode *pNode) {
   if (pNode->signature != (uint64_t)pNode) {
     uError("key:%s, %p data is invalid, or has been released", pNode->key, pNode);
     return;
   }
   
   int32_t size = pNode->size;
-  taosHashRemove(pCacheObj->pHashTable, pNode->key, pNode->keySize);
+  taosHashRemove(pShard->pHashTable, pNode->key, pNode->keySize);
+  pShard->totalSize -= size;
   
-  uTrace("key:%s is removed from cache,total:%d,size:%ldbytes", pNode->key, pCacheObj->totalSize, size);
+  uTrace("key:%s is removed from cache,total:%" PRId64 ",size:%d bytes", pNode->key, pShard->totalSize, size);
   free(pNode);
 }
 
 /**
  * move the old node into trash
- * @param pCacheObj
+ * @param pShard
  * @param pNode
  */
-static FORCE_INLINE void taosCacheMoveToTrash(SCacheObj *pCacheObj, SCacheDataNode *pNode) {
-  taosHashRemove(pCacheObj->pHashTable, pNode->key, pNode->keySize);
-  taosAddToTrash(pCacheObj, pNode);
+static FORCE_INLINE void taosCacheMoveToTrash(SCacheShard *pShard, SCacheDataNode *pNode) {
+  if (!pNode->inTrash) {
+    taosHashRemove(pShard->pHashTable, pNode->key, pNode->keySize);
+    pShard->totalSize -= pNode->size;
+  }
+  
+  taosAddToTrash(pShard, pNode);
 }
 
 /**
  * update data in cache
- * @param pCacheObj
+ * @param pShard
  * @param pNode
  * @param key
  * @param keyLen
@@ -234,13 +250,14 @@ static FORCE_INLINE void taosCacheMoveToTrash(SCacheObj *pCacheObj, SCacheDataNo
  * @param dataSize
  * @return
  */
-static SCacheDataNode *taosUpdateCacheImpl(SCacheObj *pCacheObj, SCacheDataNode *pNode, const char *key, int32_t keyLen,
+static SCacheDataNode *taosUpdateCacheImpl(SCacheShard *pShard, SCacheDataNode *pNode, const char *key, int32_t keyLen,
                                            const void *pData, uint32_t dataSize, uint64_t duration) {
   SCacheDataNode *pNewNode = NULL;
   
   // only a node is not referenced by any other object, in-place update it
   if (T_REF_VAL_GET(pNode) == 0) {
     size_t newSize = sizeof(SCacheDataNode) + dataSize + keyLen;
+    uint32_t oldSize = pNode->size;
     
     pNewNode = (SCacheDataNode *)realloc(pNode, newSize);
     if (pNewNode == NULL) {
@@ -248,6 +265,7 @@ static SCacheDataNode *taosUpdateCacheImpl(SCacheObj *pCacheObj, SCacheDataNode
     }
     
     pNewNode->signature = (uint64_t)pNewNode;
+    pNewNode->size = (uint32_t)newSize;
     memcpy(pNewNode->data, pData, dataSize);
     
     pNewNode->key = (char *)pNewNode + sizeof(SCacheDataNode) + dataSize;
@@ -257,23 +275,27 @@ static SCacheDataNode *taosUpdateCacheImpl(SCacheObj *pCacheObj, SCacheDataNode
     // update the timestamp information for updated key/value
     pNewNode->addedTime = taosGetTimestampMs();
     pNewNode->expiredTime = pNewNode->addedTime + duration;
+    pNewNode->renewing = 0;
+    pShard->totalSize += (int64_t)newSize - oldSize;
     
     T_REF_INC(pNewNode);
     
     // the address of this node may be changed, so the prev and next element should update the corresponding pointer
-    taosHashPut(pCacheObj->pHashTable, key, keyLen, &pNewNode, sizeof(void *));
+    taosHashPut(pShard->pHashTable, key, keyLen, &pNewNode, sizeof(void *));
   } else {
-    taosCacheMoveToTrash(pCacheObj, pNode);
+    taosCacheMoveToTrash(pShard, pNode);
     
     pNewNode = taosCreateHashNode(key, keyLen, pData, dataSize, duration);
     if (pNewNode == NULL) {
       return NULL;
     }
     
+    pNewNode->shard = pNode->shard;
+    pShard->totalSize += pNewNode->size;
     T_REF_INC(pNewNode);
     
     // addedTime new element to hashtable
-    taosHashPut(pCacheObj->pHashTable, key, keyLen, &pNewNode, sizeof(void *));
+    taosHashPut(pShard->pHashTable, key, keyLen, &pNewNode, sizeof(void *));
   }
   
   return pNewNode;
@@ -284,12 +306,12 @@ static SCacheDataNode *taosUpdateCacheImpl(SCacheObj *pCacheObj, SCacheDataNode
  * @param key
  * @param pData
  * @param size
- * @param pCacheObj
+ * @param pShard
  * @param keyLen
  * @param pNode
  * @return
  */
-static FORCE_INLINE SCacheDataNode *taosAddToCacheImpl(SCacheObj *pCacheObj, const char *key, size_t keyLen, const void *pData,
+static FORCE_INLINE SCacheDataNode *taosAddToCacheImpl(SCacheShard *pShard, const char *key, size_t keyLen, const void *pData,
                                                        size_t dataSize, uint64_t duration) {
   SCacheDataNode *pNode = taosCreateHashNode(key, keyLen, pData, dataSize, duration);
   if (pNode == NULL) {
@@ -297,34 +319,84 @@ static FORCE_INLINE SCacheDataNode *taosAddToCacheImpl(SCacheObj *pCacheObj, con
   }
   
   T_REF_INC(pNode);
-  taosHashPut(pCacheObj->pHashTable, key, keyLen, &pNode, sizeof(void *));
+  taosHashPut(pShard->pHashTable, key, keyLen, &pNode, sizeof(void *));
+  pShard->totalSize += pNode->size;
   return pNode;
 }
 
-static void doCleanupDataCache(SCacheObj *pCacheObj) {
-  __cache_wr_lock(pCacheObj);
+/**
+ * evict the unreferenced nodes until the shard is shrunk to 7/8 of its upper bound. A node accessed since the last
+ * scan is skipped once with its access flag cleared, so the hot table metas survive the scan of cold ones.
+ * The write lock of shard must be held by caller.
+ *
+ * @param pShard   cache shard
+ * @param pExclude the node that has just been put, it should not be evicted immediately
+ */
+static void taosCacheEvict(SCacheShard *pShard, SCacheDataNode *pExclude) {
+  int64_t threshold = pShard->maxSize - (pShard->maxSize >> 3);
+  int32_t numOfEvicted = 0;
   
-  if (taosHashGetSize(pCacheObj->pHashTable) > 0) {
-    taosHashCleanup(pCacheObj->pHashTable);
+  // the second round evicts the nodes whose access flags are cleared in the first round
+  for (int32_t round = 0; round < 2 && pShard->totalSize > threshold; ++round) {
+    SHashMutableIterator *pIter = taosHashCreateIter(pShard->pHashTable);
+    
+    while (pShard->totalSize > threshold && taosHashIterNext(pIter)) {
+      SCacheDataNode *pNode = *(SCacheDataNode **)taosHashIterGet(pIter);
+      if (pNode == pExclude || T_REF_VAL_GET(pNode) > 0) {
+        continue;
+      }
+      
+      if (pNode->accessed) {
+        pNode->accessed = false;
+      } else {
+        taosCacheReleaseNode(pShard, pNode);
+        numOfEvicted++;
+      }
+    }
+    
+    taosHashDestroyIter(pIter);
   }
   
-  __cache_unlock(pCacheObj);
-  
-  taosTrashEmpty(pCacheObj, true);
-  __cache_lock_destroy(pCacheObj);
+  uTrace("%d nodes are evicted from cache, total:%" PRId64 ", max:%" PRId64, numOfEvicted, pShard->totalSize,
+         pShard->maxSize);
+}
+
+static void doCleanupDataCache(SCacheObj *pCacheObj) {
+  for (int32_t i = 0; i < pCacheObj->numOfShards; ++i) {
+    SCacheShard *pShard = &pCacheObj->pShards[i];
+    
+    __cache_wr_lock(pShard);
+    taosHashCleanup(pShard->pHashTable);
+    pShard->pHashTable = NULL;
+    __cache_unlock(pShard);
+    
+    taosTrashEmpty(pShard, true);
+    __cache_lock_destroy(pShard);
+  }
   
+  free(pCacheObj->pShards);
   memset(pCacheObj, 0, sizeof(SCacheObj));
   free(pCacheObj);
 }
 
+static size_t taosCacheGetSize(SCacheObj *pCacheObj) {
+  size_t size = 0;
+  for (int32_t i = 0; i < pCacheObj->numOfShards; ++i) {
+    size += taosHashGetSize(pCacheObj->pShards[i].pHashTable);
+  }
+  
+  return size;
+}
+
 /**
  * refresh cache to remove data in both hash list and trash, if any nodes' refcount == 0, every pCacheObj->refreshTime
+ * Shards are scanned one after another, and only the shard being scanned is locked.
  * @param handle   Cache object handle
  */
 static void taosCacheRefresh(void *handle, void *tmrId) {
   SCacheObj *pCacheObj = (SCacheObj *)handle;
   
-  if (pCacheObj == NULL || taosHashGetSize(pCacheObj->pHashTable) == 0) {
+  if (pCacheObj == NULL) {
     uTrace("object is destroyed. no refresh retry");
     return;
   }
@@ -334,32 +406,41 @@ static void taosCacheRefresh(void *handle, void *tmrId) {
     return;
   }
   
+  // nothing to refresh yet, check it again in the next period
+  if (taosCacheGetSize(pCacheObj) == 0) {
+    taosTmrReset(taosCacheRefresh, pCacheObj->refreshTime, pCacheObj, pCacheObj->tmrCtrl, &pCacheObj->pTimer);
+    return;
+  }
+  
   uint64_t expiredTime = taosGetTimestampMs();
   pCacheObj->statistics.refreshCount++;
   
-  SHashMutableIterator *pIter = taosHashCreateIter(pCacheObj->pHashTable);
-  
-  __cache_wr_lock(pCacheObj);
-  while (taosHashIterNext(pIter)) {
-    if (pCacheObj->deleting == 1) {
-      taosHashDestroyIter(pIter);
-      break;
-    }
+  for (int32_t i = 0; i < pCacheObj->numOfShards && pCacheObj->deleting != 1; ++i) {
+    SCacheShard *pShard = &pCacheObj->pShards[i];
+    
+    __cache_wr_lock(pShard);
+    SHashMutableIterator *pIter = taosHashCreateIter(pShard->pHashTable);
     
-    SCacheDataNode *pNode = *(SCacheDataNode **)taosHashIterGet(pIter);
-    if (pNode->expiredTime <= expiredTime && T_REF_VAL_GET(pNode) <= 0) {
-      taosCacheReleaseNode(pCacheObj, pNode);
+    while (taosHashIterNext(pIter)) {
+      if (pCacheObj->deleting == 1) {
+        break;
+      }
+      
+      SCacheDataNode *pNode = *(SCacheDataNode **)taosHashIterGet(pIter);
+      if (pNode->expiredTime <= expiredTime && T_REF_VAL_GET(pNode) <= 0) {
+        taosCacheReleaseNode(pShard, pNode);
+      }
     }
+    
+    taosHashDestroyIter(pIter);
+    __cache_unlock(pShard);
+    
+    taosTrashEmpty(pShard, false);
   }
   
-  __cache_unlock(pCacheObj);
-  
-  taosHashDestroyIter(pIter);
-  
   if (pCacheObj->deleting == 1) {  // clean up resources and abort
     doCleanupDataCache(pCacheObj);
   } else {
-    taosTrashEmpty(pCacheObj, false);
     taosTmrReset(taosCacheRefresh, pCacheObj->refreshTime, pCacheObj, pCacheObj->tmrCtrl, &pCacheObj->pTimer);
   }
 }
@@ -375,89 +456,135 @@ SCacheObj *taosCacheInit(void *tmrCtrl, int64_t refreshTime) {
     return NULL;
   }
   
-  pCacheObj->pHashTable = taosHashInit(1024, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false);
-  if (pCacheObj->pHashTable == NULL) {
+  pCacheObj->numOfShards = CACHE_NUM_OF_SHARDS;
+  pCacheObj->hashFp = taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY);
+  
+  pCacheObj->pShards = calloc(pCacheObj->numOfShards, sizeof(SCacheShard));
+  if (pCacheObj->pShards == NULL) {
     free(pCacheObj);
     uError("failed to allocate memory, reason:%s", strerror(errno));
     return NULL;
   }
   
-  // set free cache node callback function for hash table
-  taosHashSetFreecb(pCacheObj->pHashTable, taosFreeNode);
+  for (int32_t i = 0; i < pCacheObj->numOfShards; ++i) {
+    SCacheShard *pShard = &pCacheObj->pShards[i];
+    
+    pShard->pHashTable = taosHashInit(1024 / CACHE_NUM_OF_SHARDS, pCacheObj->hashFp, false);
+    if (pShard->pHashTable == NULL || __cache_lock_init(pShard) != 0) {
+      uError("failed to init cache shard, reason:%s", strerror(errno));
+      
+      taosHashCleanup(pShard->pHashTable);
+      for (int32_t j = 0; j < i; ++j) {
+        taosHashCleanup(pCacheObj->pShards[j].pHashTable);
+        __cache_lock_destroy(&pCacheObj->pShards[j]);
+      }
+      
+      free(pCacheObj->pShards);
+      free(pCacheObj);
+      return NULL;
+    }
+    
+    // set free cache node callback function for hash table
+    taosHashSetFreecb(pShard->pHashTable, taosFreeNode);
+  }
   
   pCacheObj->refreshTime = refreshTime * 1000;
   pCacheObj->tmrCtrl = tmrCtrl;
   
   taosTmrReset(taosCacheRefresh, pCacheObj->refreshTime, pCacheObj, pCacheObj->tmrCtrl, &pCacheObj->pTimer);
+  return pCacheObj;
+}
+
+void taosCacheSetMaxSize(SCacheObj *pCacheObj, int64_t maxSize) {
+  if (pCacheObj == NULL || maxSize < 0) {
+    return;
+  }
   
-  if (__cache_lock_init(pCacheObj) != 0) {
-    taosTmrStopA(&pCacheObj->pTimer);
-    taosHashCleanup(pCacheObj->pHashTable);
-    free(pCacheObj);
+  // every shard holds an equal part of the memory, since keys are evenly distributed among shards
+  for (int32_t i = 0; i < pCacheObj->numOfShards; ++i) {
+    SCacheShard *pShard = &pCacheObj->pShards[i];
     
-    uError("failed to init lock, reason:%s", strerror(errno));
-    return NULL;
+    __cache_wr_lock(pShard);
+    pShard->maxSize = maxSize / pCacheObj->numOfShards;
+    if (pShard->maxSize > 0 && pShard->totalSize > pShard->maxSize) {
+      taosCacheEvict(pShard, NULL);
+    }
+    __cache_unlock(pShard);
   }
-  
-  return pCacheObj;
 }
 
 void *taosCachePut(SCacheObj *pCacheObj, const char *key, const void *pData, size_t dataSize, int duration) {
   SCacheDataNode *pNode;
   
-  if (pCacheObj == NULL || pCacheObj->pHashTable == NULL) {
+  if (pCacheObj == NULL || pCacheObj->pShards == NULL) {
     return NULL;
   }
   
-  size_t keyLen = strlen(key);
+  size_t       keyLen = strlen(key);
+  int32_t      index = taosCacheGetShardIndex(pCacheObj, key, keyLen);
+  SCacheShard *pShard = &pCacheObj->pShards[index];
   
-  __cache_wr_lock(pCacheObj);
-  SCacheDataNode **pt = (SCacheDataNode **)taosHashGet(pCacheObj->pHashTable, key, keyLen);
+  __cache_wr_lock(pShard);
+  SCacheDataNode **pt = (SCacheDataNode **)taosHashGet(pShard->pHashTable, key, keyLen);
   SCacheDataNode * pOld = (pt != NULL) ? (*pt) : NULL;
   
   if (pOld == NULL) {  // do addedTime to cache
-    pNode = taosAddToCacheImpl(pCacheObj, key, keyLen, pData, dataSize, duration * 1000L);
+    pNode = taosAddToCacheImpl(pShard, key, keyLen, pData, dataSize, duration * 1000L);
     if (NULL != pNode) {
-      pCacheObj->totalSize += pNode->size;
+      pNode->shard = (uint8_t)index;
       
-      uTrace("key:%s %p added into cache, added:%" PRIu64 ", expire:%" PRIu64 ", total:%d, size:%" PRId64 " bytes",
-             key, pNode, pNode->addedTime, pNode->expiredTime, pCacheObj->totalSize, dataSize);
+      uTrace("key:%s %p added into cache, added:%" PRIu64 ", expire:%" PRIu64 ", total:%" PRId64 ", size:%" PRId64
+             " bytes", key, pNode, pNode->addedTime, pNode->expiredTime, pShard->totalSize, (int64_t)dataSize);
     }
   } else {  // old data exists, update the node
-    pNode = taosUpdateCacheImpl(pCacheObj, pOld, key, keyLen, pData, dataSize, duration * 1000L);
+    pNode = taosUpdateCacheImpl(pShard, pOld, key, keyLen, pData, dataSize, duration * 1000L);
     uTrace("key:%s %p exist in cache, updated", key, pNode);
   }
   
-  __cache_unlock(pCacheObj);
+  if (pNode != NULL && pShard->maxSize > 0 && pShard->totalSize > pShard->maxSize) {
+    taosCacheEvict(pShard, pNode);
+  }
+  
+  __cache_unlock(pShard);
   
   return (pNode != NULL) ? pNode->data : NULL;
 }
 
 void *taosCacheAcquireByName(SCacheObj *pCacheObj, const char *key) {
-  if (pCacheObj == NULL || taosHashGetSize(pCacheObj->pHashTable) == 0) {
+  if (pCacheObj == NULL || pCacheObj->pShards == NULL) {
     return NULL;
   }
   
-  uint32_t keyLen = (uint32_t)strlen(key);
+  uint32_t     keyLen = (uint32_t)strlen(key);
+  SCacheShard *pShard = &pCacheObj->pShards[taosCacheGetShardIndex(pCacheObj, key, keyLen)];
   
-  __cache_rd_lock(pCacheObj);
+  if (taosHashGetSize(pShard->pHashTable) == 0) {
+    return NULL;
+  }
+  
+  __cache_rd_lock(pShard);
   
-  SCacheDataNode **ptNode = (SCacheDataNode **)taosHashGet(pCacheObj->pHashTable, key, keyLen);
+  SCacheDataNode **ptNode = (SCacheDataNode **)taosHashGet(pShard->pHashTable, key, keyLen);
   if (ptNode != NULL) {
     T_REF_INC(*ptNode);
+    
+    // avoid dirtying the cache line of node on every access, since it is shared by all readers
+    if (!(*ptNode)->accessed) {
+      (*ptNode)->accessed = true;
+    }
   }
   
-  __cache_unlock(pCacheObj);
+  __cache_unlock(pShard);
   
+  // the counters are kept in shard to avoid all threads contending for one cache line
   if (ptNode != NULL) {
-    atomic_add_fetch_32(&pCacheObj->statistics.hitCount, 1);
+    atomic_add_fetch_64(&pShard->hitCount, 1);
     uTrace("key:%s is retrieved from cache, %p refcnt:%d", key, (*ptNode), T_REF_VAL_GET(*ptNode));
   } else {
-    atomic_add_fetch_32(&pCacheObj->statistics.missCount, 1);
+    atomic_add_fetch_64(&pShard->missCount, 1);
     uTrace("key:%s not in cache, retrieved failed", key);
   }
   
-  atomic_add_fetch_32(&pCacheObj->statistics.totalAccess, 1);
   return (ptNode != NULL) ? (*ptNode)->data : NULL;
 }
 
@@ -501,8 +628,26 @@ void *taosCacheTransfer(SCacheObj *pCacheObj, void **data) {
   return d;
 }
 
+bool taosCacheNeedRenew(SCacheObj *pCacheObj, void *data) {
+  if (pCacheObj == NULL || data == NULL) {
+    return false;
+  }
+
+  SCacheDataNode *pNode = (SCacheDataNode *)((char *)data - offsetof(SCacheDataNode, data));
+  if (pNode->signature != (uint64_t)pNode || pNode->inTrash || pNode->renewing) {
+    return false;
+  }
+
+  uint64_t renewTime = pNode->expiredTime - (pNode->expiredTime - pNode->addedTime) / 4;
+  if ((uint64_t)taosGetTimestampMs() < renewTime) {
+    return false;
+  }
+
+  return atomic_val_compare_exchange_8(&pNode->renewing, 0, 1) == 0;
+}
+
 void taosCacheRelease(SCacheObj *pCacheObj, void **data, bool _remove) {
-  if (pCacheObj == NULL || (*data) == NULL || (taosHashGetSize(pCacheObj->pHashTable) + pCacheObj->numOfElemsInTrash == 0)) {
+  if (pCacheObj == NULL || (*data) == NULL) {
     return;
   }
   
@@ -520,31 +665,38 @@ void taosCacheRelease(SCacheObj *pCacheObj, void **data, bool _remove) {
   uTrace("%p data released, refcnt:%d", pNode, ref);
   
   if (_remove) {
-    __cache_wr_lock(pCacheObj);
+    SCacheShard *pShard = &pCacheObj->pShards[pNode->shard];
+    
+    __cache_wr_lock(pShard);
     // pNode may be released immediately by other thread after the reference count of pNode is set to 0,
     // So we need to lock it in the first place.
-    taosCacheMoveToTrash(pCacheObj, pNode);
-    __cache_unlock(pCacheObj);
+    taosCacheMoveToTrash(pShard, pNode);
+    __cache_unlock(pShard);
   }
 }
 
 void taosCacheEmpty(SCacheObj *pCacheObj) {
-  SHashMutableIterator *pIter = taosHashCreateIter(pCacheObj->pHashTable);
-  
-  __cache_wr_lock(pCacheObj);
-  while (taosHashIterNext(pIter)) {
-    if (pCacheObj->deleting == 1) {
+  for (int32_t i = 0; i < pCacheObj->numOfShards; ++i) {
+    SCacheShard *pShard = &pCacheObj->pShards[i];
+    
+    __cache_wr_lock(pShard);
+    
+    // the iterator stops early when nodes are removed during iteration, so scan until the hash table is empty
+    while (taosHashGetSize(pShard->pHashTable) > 0 && pCacheObj->deleting != 1) {
+      SHashMutableIterator *pIter = taosHashCreateIter(pShard->pHashTable);
+      
+      while (taosHashIterNext(pIter)) {
+        SCacheDataNode *pNode = *(SCacheDataNode **)taosHashIterGet(pIter);
+        taosCacheMoveToTrash(pShard, pNode);
+      }
+      
       taosHashDestroyIter(pIter);
-      break;
     }
     
-    SCacheDataNode *pNode = *(SCacheDataNode **)taosHashIterGet(pIter);
-    taosCacheMoveToTrash(pCacheObj, pNode);
+    __cache_unlock(pShard);
+    
+    taosTrashEmpty(pShard, false);
   }
-  __cache_unlock(pCacheObj);
-  
-  taosHashDestroyIter(pIter);
-  taosTrashEmpty(pCacheObj, false);
 }
 
 void taosCacheCleanup(SCacheObj *pCacheObj) {
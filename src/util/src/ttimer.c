@@ -40,6 +40,11 @@
 #define TIMER_STATE_STOPPED 2
 #define TIMER_STATE_CANCELED 3
 
+// timers are spread over shards by id, each shard has its own wheels and locks, so threads starting
+// and stopping timers at the same time rarely wait for each other, and never for a global lock
+#define TIMER_SHARDS 8
+#define TIMER_WHEELS 3
+
 typedef union _tmr_ctrl_t {
   char label[16];
   struct {
@@ -59,7 +64,7 @@ typedef struct tmr_obj_t {
   uint8_t           wheel;
   uint8_t           state;
   uint8_t           refCount;
-  uint8_t           reserved1;
+  uint8_t           shard;
   uint16_t          reserved2;
   union {
     int64_t expireAt;
@@ -102,12 +107,10 @@ static int             numOfTmrCtrl = 0;
 int taosTmrThreads = 1;
 static uintptr_t nextTimerId = 0;
 
-static time_wheel_t wheels[] = {
-    {.resolution = MSECONDS_PER_TICK, .size = 4096},
-    {.resolution = 1000, .size = 1024},
-    {.resolution = 60000, .size = 1024},
-};
-static timer_map_t timerMap;
+static const uint32_t wheelResolution[TIMER_WHEELS] = {MSECONDS_PER_TICK, 1000, 60000};
+static const uint16_t wheelSize[TIMER_WHEELS] = {4096, 1024, 1024};
+static time_wheel_t   wheels[TIMER_SHARDS][TIMER_WHEELS];
+static timer_map_t    timerMap;
 
 static uintptr_t getNextTimerId() {
   uintptr_t id;
@@ -145,7 +148,8 @@ static void unlockTimerList(timer_list_t* list) {
 
 static void addTimer(tmr_obj_t* timer) {
   timerAddRef(timer);
-  timer->wheel = tListLen(wheels);
+  timer->wheel = TIMER_WHEELS;
+  timer->shard = (uint8_t)(timer->id % TIMER_SHARDS);
 
   uint32_t      idx = (uint32_t)(timer->id % timerMap.size);
   timer_list_t* list = timerMap.slots + idx;
@@ -197,16 +201,15 @@ static void addToWheel(tmr_obj_t* timer, uint32_t delay) {
   timerAddRef(timer);
   // select a wheel for the timer, we are not an accurate timer,
   // but the inaccuracy should not be too large.
-  timer->wheel = tListLen(wheels) - 1;
-  for (uint8_t i = 0; i < tListLen(wheels); i++) {
-    time_wheel_t* wheel = wheels + i;
-    if (delay < wheel->resolution * wheel->size) {
+  timer->wheel = TIMER_WHEELS - 1;
+  for (uint8_t i = 0; i < TIMER_WHEELS; i++) {
+    if (delay < wheelResolution[i] * wheelSize[i]) {
       timer->wheel = i;
       break;
     }
   }
 
-  time_wheel_t* wheel = wheels + timer->wheel;
+  time_wheel_t* wheel = &wheels[timer->shard][timer->wheel];
   timer->prev = NULL;
   timer->expireAt = taosGetTimestampMs() + delay;
 
@@ -232,15 +235,16 @@ static void addToWheel(tmr_obj_t* timer, uint32_t delay) {
 }
 
 static bool removeFromWheel(tmr_obj_t* timer) {
-  if (timer->wheel >= tListLen(wheels)) {
+  uint8_t wheelIdx = timer->wheel;
+  if (wheelIdx >= TIMER_WHEELS) {
     return false;
   }
-  time_wheel_t* wheel = wheels + timer->wheel;
+  time_wheel_t* wheel = &wheels[timer->shard][wheelIdx];
 
   bool removed = false;
   pthread_mutex_lock(&wheel->mutex);
   // other thread may modify timer->wheel, check again.
-  if (timer->wheel < tListLen(wheels)) {
+  if (timer->wheel == wheelIdx) {
     if (timer->prev != NULL) {
       timer->prev->next = timer->next;
     }
@@ -250,7 +254,7 @@ static bool removeFromWheel(tmr_obj_t* timer) {
     if (timer == wheel->slots[timer->slot]) {
       wheel->slots[timer->slot] = timer->next;
     }
-    timer->wheel = tListLen(wheels);
+    timer->wheel = TIMER_WHEELS;
     timer->next = NULL;
     timer->prev = NULL;
     timerDecRef(timer);
@@ -261,8 +265,7 @@ static bool removeFromWheel(tmr_obj_t* timer) {
   return removed;
 }
 
-static void processExpiredTimer(void* handle, void* arg) {
-  tmr_obj_t* timer = (tmr_obj_t*)handle;
+static void processExpiredTimer(tmr_obj_t* timer) {
   timer->executedBy = taosGetPthreadId();
   uint8_t state = atomic_val_compare_exchange_8(&timer->state, TIMER_STATE_WAITING, TIMER_STATE_EXPIRED);
   if (state == TIMER_STATE_WAITING) {
@@ -279,24 +282,31 @@ static void processExpiredTimer(void* handle, void* arg) {
   timerDecRef(timer);
 }
 
-static void addToExpired(tmr_obj_t* head) {
-  const char* fmt = "%s adding expired timer[id=%" PRIuPTR ", fp=%p, param=%p] to queue.";
-
-  while (head != NULL) {
-    uintptr_t id = head->id;
-    tmr_obj_t* next = head->next;
-    tmrTrace(fmt, head->ctrl->label, id, head->fp, head->param);
+static void processExpiredTimers(void* handle, void* arg) {
+  tmr_obj_t* timer = (tmr_obj_t*)handle;
+  while (timer != NULL) {
+    // the timer may be freed once processed, the link is taken first
+    tmr_obj_t* next = timer->next;
+    processExpiredTimer(timer);
+    timer = next;
+  }
+}
 
-    SSchedMsg  schedMsg;
-    schedMsg.fp = NULL;
-    schedMsg.tfp = processExpiredTimer;
-    schedMsg.ahandle = head;
-    schedMsg.thandle = NULL;
-    taosScheduleTask(tmrQhandle, &schedMsg);
+// timers expired in the same tick of a shard are queued as one task, instead of one task for each timer
+static void addToExpired(tmr_obj_t* head) {
+  if (head == NULL) return;
 
-    tmrTrace("timer[id=%" PRIuPTR "] has been added to queue.", id);
-    head = next;
+  const char* fmt = "%s adding expired timer[id=%" PRIuPTR ", fp=%p, param=%p] to queue.";
+  for (tmr_obj_t* timer = head; timer != NULL; timer = timer->next) {
+    tmrTrace(fmt, timer->ctrl->label, timer->id, timer->fp, timer->param);
   }
+
+  SSchedMsg schedMsg;
+  schedMsg.fp = NULL;
+  schedMsg.tfp = processExpiredTimers;
+  schedMsg.ahandle = head;
+  schedMsg.thandle = NULL;
+  taosScheduleTask(tmrQhandle, &schedMsg);
 }
 
 static uintptr_t doStartTimer(tmr_obj_t* timer, TAOS_TMR_CALLBACK fp, int mseconds, void* param, tmr_ctrl_t* ctrl) {
@@ -312,7 +322,8 @@ static uintptr_t doStartTimer(tmr_obj_t* timer, TAOS_TMR_CALLBACK fp, int msecon
   tmrTrace(fmt, ctrl->label, timer->id, timer->fp, timer->param);
 
   if (mseconds == 0) {
-    timer->wheel = tListLen(wheels);
+    timer->wheel = TIMER_WHEELS;
+    timer->next = NULL;
     timerAddRef(timer);
     addToExpired(timer);
   } else {
@@ -338,54 +349,60 @@ tmr_h taosTmrStart(TAOS_TMR_CALLBACK fp, int mseconds, void* param, void* handle
   return (tmr_h)doStartTimer(timer, fp, mseconds, param, ctrl);
 }
 
+static tmr_obj_t* scanTimeWheel(time_wheel_t* wheel, int64_t now, tmr_obj_t* expired) {
+  while (now >= wheel->nextScanAt) {
+    pthread_mutex_lock(&wheel->mutex);
+    wheel->index = (wheel->index + 1) % wheel->size;
+    tmr_obj_t* timer = wheel->slots[wheel->index];
+    while (timer != NULL) {
+      tmr_obj_t* next = timer->next;
+      if (now < timer->expireAt) {
+        timer = next;
+        continue;
+      }
+
+      // remove from the wheel
+      if (timer->prev == NULL) {
+        wheel->slots[wheel->index] = next;
+        if (next != NULL) {
+          next->prev = NULL;
+        }
+      } else {
+        timer->prev->next = next;
+        if (next != NULL) {
+          next->prev = timer->prev;
+        }
+      }
+      timer->wheel = TIMER_WHEELS;
+
+      // add to temporary expire list
+      timer->next = expired;
+      timer->prev = NULL;
+      if (expired != NULL) {
+        expired->prev = timer;
+      }
+      expired = timer;
+
+      timer = next;
+    }
+    pthread_mutex_unlock(&wheel->mutex);
+    wheel->nextScanAt += wheel->resolution;
+  }
+
+  return expired;
+}
+
 static void taosTimerLoopFunc(int signo) {
   int64_t now = taosGetTimestampMs();
 
-  for (int i = 0; i < tListLen(wheels); i++) {
+  for (int i = 0; i < TIMER_SHARDS; i++) {
     // `expried` is a temporary expire list.
-    // expired timers are first add to this list, then move
-    // to expired queue as a batch to improve performance.
+    // expired timers of all wheels in a shard are first add to this list,
+    // then move to expired queue as a batch to improve performance.
     // note this list is used as a stack in this function.
     tmr_obj_t* expired = NULL;
-
-    time_wheel_t* wheel = wheels + i;
-    while (now >= wheel->nextScanAt) {
-      pthread_mutex_lock(&wheel->mutex);
-      wheel->index = (wheel->index + 1) % wheel->size;
-      tmr_obj_t* timer = wheel->slots[wheel->index];
-      while (timer != NULL) {
-        tmr_obj_t* next = timer->next;
-        if (now < timer->expireAt) {
-          timer = next;
-          continue;
-        }
-
-        // remove from the wheel
-        if (timer->prev == NULL) {
-          wheel->slots[wheel->index] = next;
-          if (next != NULL) {
-            next->prev = NULL;
-          }
-        } else {
-          timer->prev->next = next;
-          if (next != NULL) {
-            next->prev = timer->prev;
-          }
-        }
-        timer->wheel = tListLen(wheels);
-
-        // add to temporary expire list
-        timer->next = expired;
-        timer->prev = NULL;
-        if (expired != NULL) {
-          expired->prev = timer;
-        }
-        expired = timer;
-
-        timer = next;
-      }
-      pthread_mutex_unlock(&wheel->mutex);
-      wheel->nextScanAt += wheel->resolution;
+    for (int j = 0; j < TIMER_WHEELS; j++) {
+      expired = scanTimeWheel(&wheels[i][j], now, expired);
     }
 
     addToExpired(expired);
@@ -506,20 +523,24 @@ static void taosTmrModuleInit(void) {
   pthread_mutex_init(&tmrCtrlMutex, NULL);
 
   int64_t now = taosGetTimestampMs();
-  for (int i = 0; i < tListLen(wheels); i++) {
-    time_wheel_t* wheel = wheels + i;
-    if (pthread_mutex_init(&wheel->mutex, NULL) != 0) {
-      tmrError("failed to create the mutex for wheel, reason:%s", strerror(errno));
-      return;
-    }
-    wheel->nextScanAt = now + wheel->resolution;
-    wheel->index = 0;
-    wheel->slots = (tmr_obj_t**)calloc(wheel->size, sizeof(tmr_obj_t*));
-    if (wheel->slots == NULL) {
-      tmrError("failed to allocate wheel slots");
-      return;
+  for (int i = 0; i < TIMER_SHARDS; i++) {
+    for (int j = 0; j < TIMER_WHEELS; j++) {
+      time_wheel_t* wheel = &wheels[i][j];
+      if (pthread_mutex_init(&wheel->mutex, NULL) != 0) {
+        tmrError("failed to create the mutex for wheel, reason:%s", strerror(errno));
+        return;
+      }
+      wheel->resolution = wheelResolution[j];
+      wheel->size = wheelSize[j];
+      wheel->nextScanAt = now + wheel->resolution;
+      wheel->index = 0;
+      wheel->slots = (tmr_obj_t**)calloc(wheel->size, sizeof(tmr_obj_t*));
+      if (wheel->slots == NULL) {
+        tmrError("failed to allocate wheel slots");
+        return;
+      }
+      timerMap.size += wheel->size;
     }
-    timerMap.size += wheel->size;
   }
 
   timerMap.count = 0;
@@ -577,10 +598,12 @@ void taosTmrCleanUp(void* handle) {
     
     taosCleanUpScheduler(tmrQhandle);
 
-    for (int i = 0; i < tListLen(wheels); i++) {
-      time_wheel_t* wheel = wheels + i;
-      pthread_mutex_destroy(&wheel->mutex); 
-      free(wheel->slots);
+    for (int i = 0; i < TIMER_SHARDS; i++) {
+      for (int j = 0; j < TIMER_WHEELS; j++) {
+        time_wheel_t* wheel = &wheels[i][j];
+        pthread_mutex_destroy(&wheel->mutex);
+        free(wheel->slots);
+      }
     }
 
     pthread_mutex_destroy(&tmrCtrlMutex);
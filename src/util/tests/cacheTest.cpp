@@ -139,4 +139,75 @@ TEST(testCase, cache_resize_test) {
   taosCacheCleanup(pCache);
   taosMsleep(20000);
   getchar();
-}
\ No newline at end of file
+}
+TEST(testCase, cache_evict_test) {
+  const int32_t REFRESH_TIME_IN_SEC = 2;
+  void* tscTmr = taosTmrInit(1000, 200, 6000, "TSC");
+
+  SCacheObj* pCache = taosCacheInit(tscTmr, REFRESH_TIME_IN_SEC);
+  ASSERT_TRUE(pCache != NULL);
+
+  const int64_t maxSize = 256 * 1024;
+  taosCacheSetMaxSize(pCache, maxSize);
+
+  char key[256] = {0};
+  char data[1024] = "abcdefghijk";
+
+  // keep the first object referenced, it should never be evicted
+  char* pFirst = (char*) taosCachePut(pCache, "first", data, sizeof(data), 3600);
+  ASSERT_TRUE(pFirst != NULL);
+
+  int32_t num = 10000;
+  for (int32_t i = 0; i < num; ++i) {
+    sprintf(key, "abc_%7d", i);
+    void* p = taosCachePut(pCache, key, data, sizeof(data), 3600);
+    taosCacheRelease(pCache, &p, false);
+  }
+
+  int64_t totalSize = 0;
+  for (int32_t i = 0; i < pCache->numOfShards; ++i) {
+    EXPECT_LE(pCache->pShards[i].totalSize, pCache->pShards[i].maxSize + (int64_t)sizeof(data) * 2);
+    totalSize += pCache->pShards[i].totalSize;
+  }
+
+  EXPECT_LE(totalSize, maxSize + (int64_t)sizeof(data) * 2 * pCache->numOfShards);
+
+  char* p = (char*) taosCacheAcquireByName(pCache, "first");
+  EXPECT_EQ(p, pFirst);
+  taosCacheRelease(pCache, (void**) &p, false);
+
+  // the recently put object is still in cache
+  sprintf(key, "abc_%7d", num - 1);
+  p = (char*) taosCacheAcquireByName(pCache, key);
+  EXPECT_TRUE(p != NULL);
+  taosCacheRelease(pCache, (void**) &p, false);
+
+  taosCacheRelease(pCache, (void**) &pFirst, false);
+  taosCacheCleanup(pCache);
+}
+
+TEST(testCase, cache_renew_test) {
+  void*      tscTmr = taosTmrInit(1000, 200, 6000, "TSC");
+  SCacheObj* pCache = taosCacheInit(tscTmr, 10);
+  ASSERT_TRUE(pCache != NULL);
+
+  char  data[64] = "abcdefghijk";
+  void* p = taosCachePut(pCache, "renew", data, sizeof(data), 1);
+  ASSERT_TRUE(p != NULL);
+  EXPECT_FALSE(taosCacheNeedRenew(pCache, p));
+
+  // only the first caller in the last quarter of the lifespan renews the data
+  taosMsleep(800);
+  EXPECT_TRUE(taosCacheNeedRenew(pCache, p));
+  EXPECT_FALSE(taosCacheNeedRenew(pCache, p));
+
+  // the renewed data replaces the referenced one, and starts a new lifespan
+  void* pNew = taosCachePut(pCache, "renew", data, sizeof(data), 1);
+  ASSERT_TRUE(pNew != NULL);
+  EXPECT_NE(p, pNew);
+  EXPECT_FALSE(taosCacheNeedRenew(pCache, pNew));
+
+  taosCacheRelease(pCache, &p, false);
+  taosCacheRelease(pCache, &pNew, false);
+  taosCacheCleanup(pCache);
+}
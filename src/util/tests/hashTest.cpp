@@ -88,6 +88,74 @@ void stringKeyTest() {
   taosHashCleanup(hashTable);
 }
 
+// update the values in place after the first nodes of the linked lists are removed, while buckets are split
+void updateAfterRemoveTest() {
+  auto* hashTable = (SHashObj*) taosHashInit(4, taosGetDefaultHashFunction(TSDB_DATA_TYPE_TIMESTAMP), false);
+
+  const int32_t num = 6000;
+  for(int32_t i = 0; i < num; ++i) {
+    int64_t key = 1500000000000L + i * 1000L;
+    taosHashPut(hashTable, (const char*) &key, sizeof(int64_t), (char*) &i, sizeof(int32_t));
+  }
+
+  for(int32_t i = 0; i < 100; ++i) {
+    int64_t key = 1500000000000L + i * 1000L;
+    taosHashRemove(hashTable, (const char*) &key, sizeof(int64_t));
+  }
+
+  for(int32_t i = 100; i < num; ++i) {
+    int64_t key = 1500000000000L + i * 1000L;
+    char* p = (char*) taosHashGet(hashTable, (const char*) &key, sizeof(int64_t));
+    ASSERT_TRUE(p != nullptr);
+
+    int32_t v = *reinterpret_cast<int32_t*>(p) - 100;
+    taosHashPut(hashTable, (const char*) &key, sizeof(int64_t), (char*) &v, sizeof(int32_t));
+  }
+
+  ASSERT_EQ(taosHashGetSize(hashTable), num - 100);
+
+  for(int32_t i = 100; i < num; ++i) {
+    int64_t key = 1500000000000L + i * 1000L;
+    char* p = (char*) taosHashGet(hashTable, (const char*) &key, sizeof(int64_t));
+    ASSERT_TRUE(p != nullptr);
+    ASSERT_EQ(*reinterpret_cast<int32_t*>(p), i - 100);
+  }
+
+  taosHashCleanup(hashTable);
+}
+
+// the table grows from a few slots, every key is still reached by get and by the iterator after many splits
+void splitIterateTest() {
+  auto* hashTable = (SHashObj*) taosHashInit(8, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), false);
+  const int32_t num = 10000;
+
+  for(int32_t i = 0; i < num; ++i) {
+    taosHashPut(hashTable, (const char*) &i, sizeof(int32_t), (char*) &i, sizeof(int32_t));
+  }
+
+  ASSERT_EQ(taosHashGetSize(hashTable), num);
+
+  for(int32_t i = 0; i < num; ++i) {
+    char* p = (char*) taosHashGet(hashTable, (const char*) &i, sizeof(int32_t));
+    ASSERT_TRUE(p != nullptr);
+    ASSERT_EQ(*reinterpret_cast<int32_t*>(p), i);
+  }
+
+  int64_t sum = 0;
+  int32_t count = 0;
+  SHashMutableIterator* pIter = taosHashCreateIter(hashTable);
+  while(taosHashIterNext(pIter)) {
+    sum += *(int32_t*) taosHashIterGet(pIter);
+    count++;
+  }
+  taosHashDestroyIter(pIter);
+
+  ASSERT_EQ(count, num);
+  ASSERT_EQ(sum, (int64_t) num * (num - 1) / 2);
+
+  taosHashCleanup(hashTable);
+}
+
 void functionTest() {
 
 }
@@ -132,8 +200,68 @@ void noLockPerformanceTest() {
   taosHashCleanup(hashTable);
 }
 
-void multithreadsTest() {
-  //todo
+typedef struct {
+  SHashObj* pHashObj;
+  int32_t   index;
+  int32_t   num;
+} SHashThreadInfo;
+
+// each thread puts, gets and removes keys of its own, while the table is split by all of them
+void* putGetRemoveFn(void* param) {
+  SHashThreadInfo* pInfo = (SHashThreadInfo*) param;
+  char key[128] = {0};
+
+  for(int32_t i = 0; i < pInfo->num; ++i) {
+    int32_t len = sprintf(key, "%d_%d_abcefg_", pInfo->index, i);
+    taosHashPut(pInfo->pHashObj, key, len, (char*) &i, sizeof(int32_t));
+  }
+
+  for(int32_t i = 0; i < pInfo->num; ++i) {
+    int32_t len = sprintf(key, "%d_%d_abcefg_", pInfo->index, i);
+    char* p = (char*) taosHashGet(pInfo->pHashObj, key, len);
+    if (p == nullptr || *reinterpret_cast<int32_t*>(p) != i) {
+      return param;
+    }
+  }
+
+  for(int32_t i = 0; i < pInfo->num; i += 2) {
+    int32_t len = sprintf(key, "%d_%d_abcefg_", pInfo->index, i);
+    taosHashRemove(pInfo->pHashObj, key, len);
+  }
+
+  return NULL;
+}
+
+/**
+ * evaluate the performance of a thread safe hash table, by put, get and remove the elements
+ * from 1, 2, 4 and 8 threads
+ */
+void multithreadsTest(int32_t total) {
+  for(int32_t numOfThreads = 1; numOfThreads <= 8; numOfThreads <<= 1) {
+    auto* hashTable = (SHashObj*) taosHashInit(4096, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true);
+
+    pthread_t       threads[8];
+    SHashThreadInfo info[8];
+
+    int64_t st = taosGetTimestampUs();
+    for(int32_t i = 0; i < numOfThreads; ++i) {
+      info[i] = {hashTable, i, total / numOfThreads};
+      pthread_create(&threads[i], NULL, putGetRemoveFn, &info[i]);
+    }
+
+    for(int32_t i = 0; i < numOfThreads; ++i) {
+      void* ret = NULL;
+      pthread_join(threads[i], &ret);
+      ASSERT_TRUE(ret == NULL);
+    }
+
+    int64_t et = taosGetTimestampUs();
+    printf("%d threads, elapsed time:%" PRId64 " us to put, get and remove %d elements, %.0f ops per second\n",
+           numOfThreads, et - st, total, total * 2.5 * 1000000 / (et - st));
+
+    ASSERT_EQ(taosHashGetSize(hashTable), total / 2);
+    taosHashCleanup(hashTable);
+  }
 }
 
 // check the function robustness
@@ -149,8 +277,15 @@ int main(int argc, char** argv) {
 }
 
 TEST(testCase, hashTest) {
-//  simpleTest();
-//  stringKeyTest();
-//  noLockPerformanceTest();
-//  multithreadsTest();
+  simpleTest();
+  stringKeyTest();
+  updateAfterRemoveTest();
+  splitIterateTest();
+  multithreadsTest(40000);
+}
+
+// millions of elements, run it with --gtest_also_run_disabled_tests
+TEST(testCase, DISABLED_hashPerformanceTest) {
+  noLockPerformanceTest();
+  multithreadsTest(4000000);
 }
\ No newline at end of file
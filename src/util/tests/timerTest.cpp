@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <limits.h>
+#include <taosdef.h>
+#include <iostream>
+
+#include "os.h"
+#include "ttimer.h"
+#include "tutil.h"
+
+namespace {
+const int32_t numOfThreads = 4;
+const int32_t numOfTimers = 1000;  // timers started by each thread
+
+int32_t numOfFired = 0;
+
+void timerFp(void* param, void* tmrId) { atomic_add_fetch_32(&numOfFired, 1); }
+
+typedef struct {
+  void* tmrCtrl;
+  tmr_h tmrIds[numOfTimers];
+} SThreadInfo;
+
+// every thread starts its timers, then stops the odd ones and resets the ones of index 2, 6, 10 ...
+void* startTimers(void* param) {
+  SThreadInfo* pInfo = (SThreadInfo*)param;
+
+  for (int32_t i = 0; i < numOfTimers; ++i) {
+    pInfo->tmrIds[i] = taosTmrStart(timerFp, 100 + i % 200, NULL, pInfo->tmrCtrl);
+  }
+
+  for (int32_t i = 1; i < numOfTimers; i += 2) {
+    taosTmrStopA(&pInfo->tmrIds[i]);
+  }
+
+  for (int32_t i = 2; i < numOfTimers; i += 4) {
+    taosTmrReset(timerFp, 50, NULL, pInfo->tmrCtrl, &pInfo->tmrIds[i]);
+  }
+
+  return NULL;
+}
+}  // namespace
+
+TEST(testCase, timer_test) {
+  void* tmrCtrl = taosTmrInit(numOfThreads * numOfTimers, 100, 60000, "TMR-TEST");
+  ASSERT_TRUE(tmrCtrl != NULL);
+
+  pthread_t   threads[numOfThreads];
+  SThreadInfo info[numOfThreads];
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    info[i].tmrCtrl = tmrCtrl;
+    pthread_create(&threads[i], NULL, startTimers, &info[i]);
+  }
+
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+
+  // stopped timers never fire, reset timers fire only once
+  taosMsleep(1000);
+  ASSERT_EQ(atomic_load_32(&numOfFired), numOfThreads * numOfTimers / 2);
+
+  // a timer with no delay is fired at once
+  taosTmrStart(timerFp, 0, NULL, tmrCtrl);
+  taosMsleep(100);
+  ASSERT_EQ(atomic_load_32(&numOfFired), numOfThreads * numOfTimers / 2 + 1);
+}
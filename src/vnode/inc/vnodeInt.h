@@ -23,6 +23,15 @@ extern "C" {
 #include "tsync.h"
 #include "twal.h"
 
+// vnode state carried in the dnode status msg
+typedef struct {
+  int8_t       status;
+  int8_t       role;
+  int8_t       replica;
+  int64_t      pointsWritten;
+  uint32_t     queryTime;  // in ms
+} SVnodeReport;
+
 typedef struct {
   int32_t      vgId;      // global vnode group ID
   int32_t      refCount;  // reference count
@@ -36,6 +45,10 @@ typedef struct {
   void        *sync;
   void        *events;
   void        *cq;  // continuous query
+  int64_t      pointsWritten;  // rows accepted since the vnode was opened, reported in dnode status
+  int64_t      queryTime;      // query execution time in us since the vnode was opened
+  SVnodeReport reported;       // state put into the status msg in flight
+  SVnodeReport acked;          // state the mnode has acknowledged, unchanged vnodes are left out of status msg
   STsdbCfg    tsdbCfg;
   SSyncCfg    syncCfg;
   SWalCfg     walCfg;
@@ -35,6 +35,7 @@ static int32_t  tsOpennedVnodes;
 static void    *tsDnodeVnodesHash;
 static void     vnodeCleanUp(SVnodeObj *pVnode);
 static void     vnodeBuildVloadMsg(char *pNode, void * param);
+static void     vnodeAckVload(char *pNode, void *param);
 static int      vnodeWalCallback(void *arg);
 static int32_t  vnodeSaveCfg(SMDCreateVnodeMsg *pVnodeCfg);
 static int32_t  vnodeReadCfg(SVnodeObj *pVnode);
@@ -99,7 +100,7 @@ int32_t vnodeCreate(SMDCreateVnodeMsg *pVnodeCfg) {
   tsdbCfg.precision           = pVnodeCfg->cfg.precision;
   tsdbCfg.compression         = pVnodeCfg->cfg.compression;;
   tsdbCfg.tsdbId              = pVnodeCfg->cfg.vgId;
-  tsdbCfg.maxTables           = pVnodeCfg->cfg.maxTables;
+  tsdbCfg.maxTables           = pVnodeCfg->cfg.maxTables + 1;  // table ids start from 1
   tsdbCfg.daysPerFile         = pVnodeCfg->cfg.daysPerFile;
   tsdbCfg.minRowsPerFileBlock = pVnodeCfg->cfg.minRowsPerFileBlock;
   tsdbCfg.maxRowsPerFileBlock = pVnodeCfg->cfg.maxRowsPerFileBlock;
@@ -205,6 +206,9 @@ int32_t vnodeOpen(int32_t vnode, char *rootDir) {
   syncInfo.writeToCache = vnodeWriteToQueue;
   syncInfo.confirmForward = dnodeSendRpcWriteRsp; 
   syncInfo.notifyRole = vnodeNotifyRole;
+
+  // a vnode without replicas serves as master, otherwise the role is notified by sync module
+  if (pVnode->syncCfg.replica <= 1) pVnode->role = TAOS_SYNC_ROLE_MASTER;
   pVnode->sync = syncStart(&syncInfo);
 
   pVnode->events = NULL;
@@ -323,6 +327,15 @@ void vnodeBuildStatusMsg(void *param) {
   taosVisitIntHashWithFp(tsDnodeVnodesHash, vnodeBuildVloadMsg, pStatus);
 }
 
+static void vnodeAckVload(char *pNode, void *param) {
+  SVnodeObj *pVnode = *(SVnodeObj **) pNode;
+  pVnode->acked = pVnode->reported;
+}
+
+void vnodeAckStatusMsg() {
+  taosVisitIntHashWithFp(tsDnodeVnodesHash, vnodeAckVload, NULL);
+}
+
 static void vnodeBuildVloadMsg(char *pNode, void * param) {
   SVnodeObj *pVnode = *(SVnodeObj **) pNode;
   if (pVnode->status == TAOS_VN_STATUS_DELETING) return;
@@ -330,14 +343,30 @@ static void vnodeBuildVloadMsg(char *pNode, void * param) {
   SDMStatusMsg *pStatus = param;
   if (pStatus->openVnodes >= TSDB_MAX_VNODES) return;
 
+  SVnodeReport *pReport = &pVnode->reported;
+  pReport->status = pVnode->status;
+  pReport->role = pVnode->role;
+  pReport->replica = pVnode->syncCfg.replica;
+  pReport->pointsWritten = pVnode->pointsWritten;
+  pReport->queryTime = (uint32_t)(pVnode->queryTime / 1000);
+
+  // a vnode whose state is the same as the one acked by mnode is left out of a partial status msg
+  SVnodeReport *pAcked = &pVnode->acked;
+  if (!pStatus->fullStatus && pReport->status == pAcked->status && pReport->role == pAcked->role &&
+      pReport->replica == pAcked->replica && pReport->pointsWritten == pAcked->pointsWritten &&
+      pReport->queryTime == pAcked->queryTime) {
+    return;
+  }
+
   SVnodeLoad *pLoad = &pStatus->load[pStatus->openVnodes++];
   pLoad->vgId = htonl(pVnode->vgId);
   pLoad->totalStorage = htobe64(pLoad->totalStorage);
   pLoad->compStorage = htobe64(pLoad->compStorage);
-  pLoad->pointsWritten = htobe64(pLoad->pointsWritten);
-  pLoad->status = pVnode->status;
-  pLoad->role = pVnode->role;
-  pLoad->replica = pVnode->syncCfg.replica;
+  pLoad->pointsWritten = htobe64(pReport->pointsWritten);
+  pLoad->status = pReport->status;
+  pLoad->role = pReport->role;
+  pLoad->replica = pReport->replica;
+  pLoad->queryTime = htonl(pReport->queryTime);
 }
 
 static void vnodeCleanUp(SVnodeObj *pVnode) {
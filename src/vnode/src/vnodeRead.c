@@ -18,6 +18,7 @@
 #include "taosmsg.h"
 #include "taoserror.h"
 #include "tqueue.h"
+#include "ttime.h"
 #include "trpc.h"
 #include "tsdb.h"
 #include "twal.h"
@@ -53,6 +54,7 @@ static int32_t vnodeProcessQueryMsg(SVnodeObj *pVnode, void *pCont, int32_t cont
   memset(pRet, 0, sizeof(SRspRet));
 
   int32_t code = TSDB_CODE_SUCCESS;
+  int64_t st = taosGetTimestampUs();  // the query time covers the creation of query info and every execution
   
   qinfo_t pQInfo = NULL;
   if (contLen != 0) {
@@ -72,6 +74,7 @@ static int32_t vnodeProcessQueryMsg(SVnodeObj *pVnode, void *pCont, int32_t cont
   }
 
   qTableQuery(pQInfo); // do execute query
+  atomic_add_fetch_64(&pVnode->queryTime, taosGetTimestampUs() - st);
   
   return code;
 }
@@ -82,6 +85,8 @@ static int32_t vnodeProcessRetrieveMsg(SVnodeObj *pVnode, void *pCont, int32_t c
   memset(pRet, 0, sizeof(SRspRet));
 
   int32_t code = TSDB_CODE_SUCCESS;
+  int64_t st = taosGetTimestampUs();
+  bool    completed = false;
 
   dTrace("pVnode:%p vgId:%d QInfo:%p, retrieve msg is received", pVnode, pVnode->vgId, pQInfo);
   
@@ -98,12 +103,15 @@ static int32_t vnodeProcessRetrieveMsg(SVnodeObj *pVnode, void *pCont, int32_t c
       pRet->qhandle = pQInfo;
       code = TSDB_CODE_ACTION_NEED_REPROCESSED;
     } else {  
-      // no further execution invoked, release the ref to vnode
+      // no further execution invoked, release the ref to vnode once the query time is counted
       qDestroyQueryInfo(pQInfo);
-      vnodeRelease(pVnode);
+      completed = true;
     }
   }
   
+  atomic_add_fetch_64(&pVnode->queryTime, taosGetTimestampUs() - st);
   dTrace("pVnode:%p vgId:%d QInfo:%p, retrieve msg is disposed", pVnode, pVnode->vgId, pQInfo);
+
+  if (completed) vnodeRelease(pVnode);
   return code;
 }
@@ -85,6 +85,19 @@ int32_t vnodeProcessWrite(void *param1, int qtype, void *param2, void *item) {
   return code;
 }
 
+// the submit msg has been converted into host order by tsdbInsertData
+static int32_t vnodeGetNumOfSubmitRows(SSubmitMsg *pSubmit) {
+  int32_t     numOfRows = 0;
+  SSubmitBlk *pBlock = pSubmit->blocks;
+
+  for (int32_t i = 0; i < pSubmit->numOfBlocks; ++i) {
+    numOfRows += pBlock->numOfRows;
+    pBlock = (SSubmitBlk *)((char *)pBlock + sizeof(SSubmitBlk) + pBlock->len);
+  }
+
+  return numOfRows;
+}
+
 static int32_t vnodeProcessSubmitMsg(SVnodeObj *pVnode, void *pCont, SRspRet *pRet) {
   int32_t code = 0;
 
@@ -92,6 +105,9 @@ static int32_t vnodeProcessSubmitMsg(SVnodeObj *pVnode, void *pCont, SRspRet *pR
 
   dTrace("pVnode:%p vgId:%d, submit msg is processed", pVnode, pVnode->vgId);
   code = tsdbInsertData(pVnode->tsdb, pCont);
+  if (code == TSDB_CODE_SUCCESS) {
+    atomic_add_fetch_64(&pVnode->pointsWritten, vnodeGetNumOfSubmitRows(pCont));
+  }
 
   pRet->len = sizeof(SShellSubmitRspMsg);
   pRet->rsp = rpcMallocCont(pRet->len);
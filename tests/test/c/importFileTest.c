@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "taos.h"
+#include "tulog.h"
+#include "tutil.h"
+#include "tglobal.h"
+
+#define GREEN "\033[1;32m"
+#define RED "\033[1;31m"
+#define NC "\033[0m"
+
+#define CHECK(cond)                                                      \
+  do {                                                                   \
+    if (!(cond)) {                                                       \
+      pPrint("%s line %d: %s failed %s", RED, __LINE__, #cond, NC);      \
+      exit(EXIT_FAILURE);                                                \
+    }                                                                    \
+  } while (0)
+
+static char *ip = "127.0.0.1";
+static char *dir = "/tmp";
+
+static void execSql(TAOS *taos, const char *sql) {
+  if (taos_query(taos, sql) != 0) {
+    pPrint("%s failed to run: %s, reason:%s %s", RED, sql, taos_errstr(taos), NC);
+    exit(EXIT_FAILURE);
+  }
+}
+
+static void checkCount(TAOS *taos, const char *sql, int64_t expected) {
+  execSql(taos, sql);
+
+  TAOS_RES *result = taos_use_result(taos);
+  CHECK(result != NULL);
+
+  int64_t  count = -1;
+  TAOS_ROW row = taos_fetch_row(result);
+  if (row != NULL && row[0] != NULL) {
+    count = *(int64_t *)row[0];
+  }
+
+  taos_free_result(result);
+
+  if (count != expected) {
+    pPrint("%s %s returns %" PRId64 ", expected:%" PRId64 " %s", RED, sql, count, expected, NC);
+    exit(EXIT_FAILURE);
+  }
+}
+
+// writes rows ts, ts + 1, ..., the line at badLine is not a valid row if it is not less than 0
+static void writeFile(const char *path, int64_t ts, int32_t numOfRows, int32_t badLine) {
+  FILE *fp = fopen(path, "w");
+  CHECK(fp != NULL);
+
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    if (i == badLine) {
+      fprintf(fp, "%" PRId64 ", abc\n", ts + i);
+    } else {
+      // blank lines and windows line endings are skipped
+      fprintf(fp, (i % 1000 == 0) ? "%" PRId64 ", %d\r\n\n" : "%" PRId64 ", %d\n", ts + i, i);
+    }
+  }
+
+  fclose(fp);
+}
+
+int main(int argc, char *argv[]) {
+  for (int i = 1; i < argc - 1; ++i) {
+    if (strcmp(argv[i], "-c") == 0) {
+      taos_options(TSDB_OPTION_CONFIGDIR, argv[++i]);
+    } else if (strcmp(argv[i], "-h") == 0) {
+      ip = argv[++i];
+    } else if (strcmp(argv[i], "-d") == 0) {
+      dir = argv[++i];
+    }
+  }
+
+  taos_init();
+
+  // split the large file among several parser threads
+  tsNumOfImportThreads = 4;
+
+  TAOS *taos = taos_connect(ip, "root", "taosdata", NULL, 0);
+  CHECK(taos != NULL);
+
+  execSql(taos, "drop database if exists import_db");
+  execSql(taos, "create database import_db");
+  execSql(taos, "create table import_db.t0 (ts timestamp, v int)");
+  execSql(taos, "create table import_db.t1 (ts timestamp, v int)");
+  execSql(taos, "create table import_db.t2 (ts timestamp, v int)");
+
+  const int64_t start = 1500000000000L;
+  const int32_t numOfRows = 600000;
+
+  char large[PATH_MAX], small[PATH_MAX], bad[PATH_MAX], sql[3 * PATH_MAX];
+  snprintf(large, sizeof(large), "%s/import_large.csv", dir);
+  snprintf(small, sizeof(small), "%s/import_small.csv", dir);
+  snprintf(bad, sizeof(bad), "%s/import_bad.csv", dir);
+
+  writeFile(large, start, numOfRows, -1);
+  writeFile(small, start, 100, -1);
+  writeFile(bad, start, 100, 50);
+
+  // one statement imports files of two tables
+  snprintf(sql, sizeof(sql), "import into import_db.t0 file '%s' import_db.t1 file '%s'", large, small);
+  execSql(taos, sql);
+
+  // vnode acknowledges each submit as one row, the rows are checked by count
+  CHECK(taos_affected_rows(taos) > 0);
+
+  checkCount(taos, "select count(*) from import_db.t0", numOfRows);
+  checkCount(taos, "select count(*) from import_db.t1", 100);
+
+  // the invalid line fails the statement
+  snprintf(sql, sizeof(sql), "import into import_db.t2 file '%s'", bad);
+  CHECK(taos_query(taos, sql) != 0);
+
+  remove(large);
+  remove(small);
+  remove(bad);
+
+  execSql(taos, "drop database import_db");
+  taos_close(taos);
+
+  pPrint("%s import file test passed %s", GREEN, NC);
+  return 0;
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "taos.h"
+#include "tulog.h"
+#include "tutil.h"
+
+#define GREEN "\033[1;32m"
+#define RED "\033[1;31m"
+#define NC "\033[0m"
+
+#define CHECK(cond)                                                      \
+  do {                                                                   \
+    if (!(cond)) {                                                       \
+      pPrint("%s line %d: %s failed %s", RED, __LINE__, #cond, NC);      \
+      exit(EXIT_FAILURE);                                                \
+    }                                                                    \
+  } while (0)
+
+static char *ip = "127.0.0.1";
+
+static void execSql(TAOS *taos, const char *sql) {
+  if (taos_query(taos, sql) != 0) {
+    pPrint("%s failed to run: %s, reason:%s %s", RED, sql, taos_errstr(taos), NC);
+    exit(EXIT_FAILURE);
+  }
+}
+
+static int64_t queryCount(TAOS *taos, const char *sql) {
+  execSql(taos, sql);
+
+  TAOS_RES *result = taos_use_result(taos);
+  CHECK(result != NULL);
+
+  int64_t  count = -1;
+  TAOS_ROW row = taos_fetch_row(result);
+  if (row != NULL && row[0] != NULL) {
+    count = *(int64_t *)row[0];
+  }
+
+  taos_free_result(result);
+  return count;
+}
+
+static void checkCount(TAOS *taos, const char *sql, int64_t expected) {
+  int64_t count = queryCount(taos, sql);
+  if (count != expected) {
+    pPrint("%s %s returns %" PRId64 ", expected:%" PRId64 " %s", RED, sql, count, expected, NC);
+    exit(EXIT_FAILURE);
+  }
+}
+
+// binds rows ts, ts + 1, ... with values v, v + 1, ..., the value of the second row is null
+static int bindRows(TAOS_STMT *stmt, int64_t ts, int32_t v, int num) {
+  int64_t       tsBuf[16];
+  int32_t       vBuf[16];
+  unsigned char vNull[2] = {0x02, 0};
+
+  for (int i = 0; i < num; ++i) {
+    tsBuf[i] = ts + i;
+    vBuf[i] = v + i;
+  }
+
+  TAOS_MULTI_BIND bind[2] = {{0}};
+  bind[0].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+  bind[0].buffer = tsBuf;
+  bind[0].buffer_length = sizeof(int64_t);
+  bind[0].num = num;
+
+  bind[1].buffer_type = TSDB_DATA_TYPE_INT;
+  bind[1].buffer = vBuf;
+  bind[1].buffer_length = sizeof(int32_t);
+  bind[1].is_null = vNull;
+  bind[1].num = num;
+
+  return taos_stmt_bind_param_batch(stmt, bind);
+}
+
+int main(int argc, char *argv[]) {
+  for (int i = 1; i < argc - 1; ++i) {
+    if (strcmp(argv[i], "-c") == 0) {
+      taos_options(TSDB_OPTION_CONFIGDIR, argv[++i]);
+    } else if (strcmp(argv[i], "-h") == 0) {
+      ip = argv[++i];
+    }
+  }
+
+  taos_init();
+
+  TAOS *taos = taos_connect(ip, "root", "taosdata", NULL, 0);
+  CHECK(taos != NULL);
+
+  execSql(taos, "drop database if exists prepare_db");
+  execSql(taos, "create database prepare_db");
+  execSql(taos, "create table prepare_db.st (ts timestamp, v int) tags (t int)");
+  execSql(taos, "create table prepare_db.t0 using prepare_db.st tags (0)");
+  execSql(taos, "create table prepare_db.t1 using prepare_db.st tags (1)");
+  execSql(taos, "create table prepare_db.t2 (ts timestamp, v bigint)");
+  execSql(taos, "create table prepare_db.t3 (ts timestamp, b binary(8))");
+
+  const int64_t start = 1500000000000L;
+
+  TAOS_STMT *stmt = taos_stmt_init(taos);
+  CHECK(stmt != NULL);
+
+  // the meta of the prepared table is resolved asynchronously while parsing, load it into the cache first
+  queryCount(taos, "select count(*) from prepare_db.t0");
+
+  const char *sql = "insert into prepare_db.t0 values(?, ?)";
+  CHECK(taos_stmt_prepare(stmt, sql, 0) == 0);
+
+  // column-wise binding, the rows of all batches are kept
+  CHECK(bindRows(stmt, start, 0, 3) == 0);
+  CHECK(bindRows(stmt, start + 3, 3, 2) == 0);
+
+  // switch to a table of the same super table
+  CHECK(taos_stmt_set_tbname(stmt, "prepare_db.t1") == 0);
+  CHECK(bindRows(stmt, start, 10, 4) == 0);
+
+  // rejected names leave the statement bound to t1
+  CHECK(taos_stmt_set_tbname(stmt, "prepare_db.not_exist") != 0);
+  CHECK(taos_stmt_set_tbname(stmt, "prepare_db.t2") != 0);
+  CHECK(taos_stmt_set_tbname(stmt, "prepare_db.st") != 0);
+  CHECK(bindRows(stmt, start + 4, 14, 1) == 0);
+
+  CHECK(taos_stmt_execute(stmt) == 0);
+  checkCount(taos, "select count(*) from prepare_db.t0", 5);
+  checkCount(taos, "select count(v) from prepare_db.t0", 3);
+  checkCount(taos, "select count(*) from prepare_db.t1", 5);
+  checkCount(taos, "select count(v) from prepare_db.t1", 4);
+
+  taos_stmt_close(stmt);
+
+  // a rejected name as the first switch, the rows still go to the prepared table
+  stmt = taos_stmt_init(taos);
+  CHECK(stmt != NULL);
+  CHECK(taos_stmt_prepare(stmt, sql, 0) == 0);
+
+  CHECK(taos_stmt_set_tbname(stmt, "prepare_db.t2") != 0);
+  CHECK(taos_stmt_set_tbname(stmt, "prepare_db.t0") == 0);
+  CHECK(bindRows(stmt, start + 5, 5, 2) == 0);
+
+  CHECK(taos_stmt_execute(stmt) == 0);
+  taos_stmt_close(stmt);
+
+  checkCount(taos, "select count(*) from prepare_db.t0", 7);
+  checkCount(taos, "select count(v) from prepare_db.t0", 4);
+  checkCount(taos, "select count(*) from prepare_db.t1", 5);
+
+  // binary values are bound with their lengths, a bind without them is rejected. The rows are not executed, since
+  // the submit of binary columns is not supported yet
+  queryCount(taos, "select count(*) from prepare_db.t3");
+  stmt = taos_stmt_init(taos);
+  CHECK(stmt != NULL);
+  CHECK(taos_stmt_prepare(stmt, "insert into prepare_db.t3 values(?, ?)", 0) == 0);
+
+  int64_t         tsBuf[2] = {start, start + 1};
+  char            bBuf[2][8] = {"abc", "defgh"};
+  int32_t         bLen[2] = {3, 5};
+  TAOS_MULTI_BIND bind[2] = {{0}};
+  bind[0].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+  bind[0].buffer = tsBuf;
+  bind[0].buffer_length = sizeof(int64_t);
+  bind[0].num = 2;
+
+  bind[1].buffer_type = TSDB_DATA_TYPE_BINARY;
+  bind[1].buffer = bBuf;
+  bind[1].buffer_length = sizeof(bBuf[0]);
+  bind[1].num = 2;
+  CHECK(taos_stmt_bind_param_batch(stmt, bind) != 0);
+
+  bind[1].length = bLen;
+  CHECK(taos_stmt_bind_param_batch(stmt, bind) == 0);
+  taos_stmt_close(stmt);
+
+  execSql(taos, "drop database prepare_db");
+  taos_close(taos);
+
+  pPrint("%s prepare test passed %s", GREEN, NC);
+  return 0;
+}
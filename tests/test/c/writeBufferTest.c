@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "taos.h"
+#include "tulog.h"
+#include "tutil.h"
+
+#define GREEN "\033[1;32m"
+#define RED "\033[1;31m"
+#define NC "\033[0m"
+
+#define CHECK(cond)                                                      \
+  do {                                                                   \
+    if (!(cond)) {                                                       \
+      pPrint("%s line %d: %s failed %s", RED, __LINE__, #cond, NC);      \
+      exit(EXIT_FAILURE);                                                \
+    }                                                                    \
+  } while (0)
+
+static char *ip = "127.0.0.1";
+
+static void execSql(TAOS *taos, const char *sql) {
+  if (taos_query(taos, sql) != 0) {
+    pPrint("%s failed to run: %s, reason:%s %s", RED, sql, taos_errstr(taos), NC);
+    exit(EXIT_FAILURE);
+  }
+}
+
+static void checkCount(TAOS *taos, const char *sql, int64_t expected) {
+  execSql(taos, sql);
+
+  TAOS_RES *result = taos_use_result(taos);
+  CHECK(result != NULL);
+
+  // no row is returned for an empty table
+  int64_t  count = 0;
+  TAOS_ROW row = taos_fetch_row(result);
+  if (row != NULL && row[0] != NULL) {
+    count = *(int64_t *)row[0];
+  }
+
+  taos_free_result(result);
+
+  if (count != expected) {
+    pPrint("%s %s returns %" PRId64 ", expected:%" PRId64 " %s", RED, sql, count, expected, NC);
+    exit(EXIT_FAILURE);
+  }
+}
+
+static void insertRows(TAOS *taos, int64_t ts, int32_t numOfRows) {
+  char sql[256];
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    snprintf(sql, sizeof(sql), "insert into wbuf_db.t0 values(%" PRId64 ", %d)", ts + i, i);
+    execSql(taos, sql);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  for (int i = 1; i < argc - 1; ++i) {
+    if (strcmp(argv[i], "-c") == 0) {
+      taos_options(TSDB_OPTION_CONFIGDIR, argv[++i]);
+    } else if (strcmp(argv[i], "-h") == 0) {
+      ip = argv[++i];
+    }
+  }
+
+  taos_init();
+
+  TAOS *taos = taos_connect(ip, "root", "taosdata", NULL, 0);
+  CHECK(taos != NULL);
+
+  execSql(taos, "drop database if exists wbuf_db");
+  execSql(taos, "create database wbuf_db");
+  execSql(taos, "create table wbuf_db.t0 (ts timestamp, v int)");
+
+  int64_t ts = 1500000000000L;
+  int64_t total = 0;
+
+  // rows are invisible until flushed by maxRows or taos_flush
+  CHECK(taos_set_write_buffer(taos, 10, 0) == 0);
+  insertRows(taos, ts, 5);
+  checkCount(taos, "select count(*) from wbuf_db.t0", 0);
+
+  insertRows(taos, ts + 5, 5);
+  CHECK(taos_flush(taos) == 0);
+  checkCount(taos, "select count(*) from wbuf_db.t0", 10);
+
+  insertRows(taos, ts + 10, 3);
+  CHECK(taos_flush(taos) == 0);
+  checkCount(taos, "select count(*) from wbuf_db.t0", 13);
+
+  // the flush timer submits the rows
+  CHECK(taos_set_write_buffer(taos, 1000, 20) == 0);
+  insertRows(taos, ts + 13, 2);
+  taosMsleep(500);
+  checkCount(taos, "select count(*) from wbuf_db.t0", 15);
+
+  CHECK(taos_set_write_buffer(taos, 0, 0) == 0);
+  ts += 15;
+  total = 15;
+
+  // close connections while the flush timer is about to fire, is firing, or has fired, no rows are lost
+  for (int32_t i = 0; i < 40; ++i) {
+    TAOS *conn = taos_connect(ip, "root", "taosdata", NULL, 0);
+    CHECK(conn != NULL);
+
+    CHECK(taos_set_write_buffer(conn, 1000, 1 + i % 4) == 0);
+    insertRows(conn, ts, 3);
+    taosMsleep(i % 6);
+    taos_close(conn);
+
+    ts += 3;
+    total += 3;
+  }
+
+  checkCount(taos, "select count(*) from wbuf_db.t0", total);
+
+  execSql(taos, "drop database wbuf_db");
+  taos_close(taos);
+
+  pPrint("%s write buffer test passed %s", GREEN, NC);
+  return 0;
+}